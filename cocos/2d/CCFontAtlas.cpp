@@ -23,21 +23,26 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "CCFontAtlas.h"
+#include "CCGlyphRasterizer.h"
 #include "renderer/gfx/Texture2D.h"
 #include "renderer/gfx/DeviceGraphics.h"
 #include "base/ccConfig.h"
+#include "platform/CCApplication.h"
+#include "base/CCScheduler.h"
 #include <cassert>
+#include <climits>
 
 #if CC_ENABLE_TTF_LABEL_RENDERER
 
 static const int PIXEL_PADDING = 2;
 
+// frames an atlas fills before letters no label uses are dropped
+#define FONT_ATLAS_MAX_FRAMES 4
+
 namespace cocos2d {
 
     FontAtlasFrame::FontAtlasFrame()
     {
-        _currentRowX = PIXEL_PADDING;
-        _currentRowY = PIXEL_PADDING;
     }
 
     FontAtlasFrame::FontAtlasFrame(FontAtlasFrame&& o)
@@ -50,9 +55,7 @@ namespace cocos2d {
 #endif
         _WIDTH = o._WIDTH;
         _HEIGHT = o._HEIGHT;
-        _currentRowX = o._currentRowX;
-        _currentRowY = o._currentRowY;
-        _currRowHeight = o._currRowHeight;
+        _skyline = std::move(o._skyline);
         _pixelMode = o._pixelMode;
         _texture = o._texture;
 
@@ -69,9 +72,8 @@ namespace cocos2d {
         _pixelMode = pixelMode;
         _WIDTH = width;
         _HEIGHT = height;
-        _currentRowY = PIXEL_PADDING;
-        _currentRowY = PIXEL_PADDING;
-        _currRowHeight = 0;
+        _skyline.clear();
+        _skyline.push_back({ PIXEL_PADDING, PIXEL_PADDING, width - PIXEL_PADDING });
 #if CC_ENABLE_CACHE_TTF_FONT_TEXTURE 
         _buffer.resize(PixelModeSize(pixelMode) * width * height);
         std::fill(_buffer.begin(), _buffer.end(), 0);
@@ -87,16 +89,35 @@ namespace cocos2d {
         assert(_buffer.size() > 0);
         assert(width <= _WIDTH && height <= _HEIGHT);
 #endif
-        if (!hasSpace(width, height)) {
+        // bottom-left skyline, each box keeps padding on its right and top
+        const int boxWidth = width + PIXEL_PADDING;
+        const int boxHeight = height + PIXEL_PADDING;
+        int bestIndex = -1;
+        int bestTop = INT_MAX;
+        int bestWidth = INT_MAX;
+        for (size_t i = 0; i < _skyline.size(); i++)
+        {
+            int y = fitSkyline(i, boxWidth, boxHeight);
+            if (y < 0) continue;
+            if (y + boxHeight < bestTop || (y + boxHeight == bestTop && _skyline[i].width < bestWidth))
+            {
+                bestIndex = (int)i;
+                bestTop = y + boxHeight;
+                bestWidth = _skyline[i].width;
+            }
+        }
+        if (bestIndex < 0) {
             return FrameResult::E_FULL;
         }
+        const int posX = _skyline[bestIndex].x;
+        const int posY = bestTop - boxHeight;
 
 #if CC_ENABLE_CACHE_TTF_FONT_TEXTURE 
         //update texture-data in CPU memory
         const int pixelSize = PixelModeSize(_pixelMode);
         uint8_t* dst = _buffer.data();
         uint8_t* src = data.data();
-        uint8_t* dstOrigin = pixelSize * (_currentRowY * _WIDTH + _currentRowX) + dst;
+        uint8_t* dstOrigin = pixelSize * (posY * _WIDTH + posX) + dst;
         const int BytesEachRow = pixelSize * width;
         for (int i = 0; i < height; i++)
         {
@@ -106,18 +127,18 @@ namespace cocos2d {
         if (_dirtyFlag == 0)
         {
             _dirtyFlag |= DIRTY_RECT;
-            _dirtyRegion = Rect(_currentRowX, _currentRowY, width, height);
+            _dirtyRegion = Rect(posX, posY, width, height);
         }
         else
         {
-            _dirtyRegion.merge(Rect(_currentRowX, _currentRowY, width, height));
+            _dirtyRegion.merge(Rect(posX, posY, width, height));
         }
 #else 
         //update GPU texture immediately
         renderer::Texture::SubImageOption opt;
         opt.imageData = data.data();
-        opt.x = _currentRowX;
-        opt.y = _currentRowY;
+        opt.x = posX;
+        opt.y = posY;
         opt.width = width;
         opt.height = height;
         opt.imageDataLength = data.size();
@@ -125,72 +146,76 @@ namespace cocos2d {
 #endif
 
 
-        out.origin.set(_currentRowX, _currentRowY);
+        out.origin.set(posX, posY);
         out.size.width = width;
         out.size.height = height;
-        // move cursor
-        moveToNextCursor(width, height);
+        addSkylineLevel(bestIndex, posX, posY, boxWidth, boxHeight);
         return FrameResult::SUCCESS;
 
     }
 
-    bool FontAtlasFrame::hasSpace(int width, int height)
+    int FontAtlasFrame::fitSkyline(size_t index, int width, int height) const
     {
-        if (hasRowXSpace(width) && hasYSpace(height)) {
-            return true;
-        }
-        if (hasNextRowXSpace(width) && hasNextRowYSpace(height))
+        if (_skyline[index].x + width > _WIDTH) return -1;
+        int y = _skyline[index].y;
+        int widthLeft = width;
+        for (size_t i = index; widthLeft > 0; i++)
         {
-            moveToNextRow();
-            return true;
+            if (i >= _skyline.size()) return -1;
+            y = std::max(y, _skyline[i].y);
+            if (y + height > _HEIGHT) return -1;
+            widthLeft -= _skyline[i].width;
         }
-        return false;
+        return y;
     }
 
-
-    int FontAtlasFrame::remainRowXSpace() const 
-    { 
-        return _WIDTH - _currentRowX; 
-    }
-
-    int FontAtlasFrame::remainYSpace() const 
-    { 
-        return _HEIGHT - _currentRowY; 
-    }
-
-    bool FontAtlasFrame::hasRowXSpace(int x) const 
-    { 
-        return x + PIXEL_PADDING <= remainRowXSpace();
-    }
-
-    bool FontAtlasFrame::hasYSpace(int y) const 
+    void FontAtlasFrame::addSkylineLevel(size_t index, int x, int y, int width, int height)
     {
-        return y + PIXEL_PADDING <= remainYSpace();
-    }
-
-    bool FontAtlasFrame::hasNextRowXSpace(int x) const 
-    { 
-        return x + PIXEL_PADDING <= _WIDTH;
-    }
-
-    bool FontAtlasFrame::hasNextRowYSpace(int y) const 
-    { 
-        return y + PIXEL_PADDING <= remainYSpace() - _currRowHeight;
-    }
+        _skyline.insert(_skyline.begin() + index, { x, y + height, width });
 
+        // nodes covered by the new one shrink or go away
+        for (size_t i = index + 1; i < _skyline.size();)
+        {
+            const SkylineNode &prev = _skyline[i - 1];
+            SkylineNode &node = _skyline[i];
+            int overlap = prev.x + prev.width - node.x;
+            if (overlap <= 0) break;
+            node.x += overlap;
+            node.width -= overlap;
+            if (node.width > 0) break;
+            _skyline.erase(_skyline.begin() + i);
+        }
 
-    void FontAtlasFrame::moveToNextRow()
-    {
-        _currentRowY += _currRowHeight + PIXEL_PADDING;
-        _currentRowX = PIXEL_PADDING;
-        _currRowHeight = 0;
+        for (size_t i = 0; i + 1 < _skyline.size();)
+        {
+            if (_skyline[i].y == _skyline[i + 1].y)
+            {
+                _skyline[i].width += _skyline[i + 1].width;
+                _skyline.erase(_skyline.begin() + i + 1);
+            }
+            else
+            {
+                i++;
+            }
+        }
     }
 
-    void FontAtlasFrame::moveToNextCursor(int width, int height)
+#if CC_ENABLE_CACHE_TTF_FONT_TEXTURE
+    void FontAtlasFrame::copyPixels(const Rect &rect, std::vector<uint8_t> &out) const
     {
-        _currRowHeight = std::max(_currRowHeight, height);
-        _currentRowX += width + PIXEL_PADDING;
+        const int pixelSize = PixelModeSize(_pixelMode);
+        const int x = rect.origin.x;
+        const int y = rect.origin.y;
+        const int width = rect.size.width;
+        const int height = rect.size.height;
+        const int BytesEachRow = pixelSize * width;
+        out.resize(BytesEachRow * height);
+        for (int i = 0; i < height; i++)
+        {
+            memcpy(out.data() + i * BytesEachRow, _buffer.data() + pixelSize * ((y + i) * _WIDTH + x), BytesEachRow);
+        }
     }
+#endif
 
     renderer::Texture2D * FontAtlasFrame::getTexture()
     {
@@ -255,7 +280,7 @@ namespace cocos2d {
 
 
     FontAtlas::FontAtlas(PixelMode pixelMode, int width, int height, bool hasoutline)
-        :_pixelMode(pixelMode), _width(width), _height(height), _useSDF(hasoutline)
+        :_pixelMode(pixelMode), _width(width), _height(height), _useSDF(hasoutline), _maxFrames(FONT_ATLAS_MAX_FRAMES)
     {
     }
 
@@ -282,6 +307,14 @@ namespace cocos2d {
         Rect rect;
         FontAtlasFrame::FrameResult ret = _textureFrame.append(bitmap->getWidth(), bitmap->getHeight(), bitmap->getData(), rect);
 
+#if CC_ENABLE_CACHE_TTF_FONT_TEXTURE
+        if (ret == FontAtlasFrame::FrameResult::E_FULL && _textureBufferIndex + 1 >= _maxFrames)
+        {
+            compact();
+            ret = _textureFrame.append(bitmap->getWidth(), bitmap->getHeight(), bitmap->getData(), rect);
+        }
+#endif
+
         switch (ret) {
         case FontAtlasFrame::FrameResult::E_ERROR:
             //TODO: ERROR LOG
@@ -303,34 +336,185 @@ namespace cocos2d {
         return false;
     }
 
+    bool FontAtlas::appendToFrames(int width, int height, std::vector<uint8_t> &data, Rect &out)
+    {
+        FontAtlasFrame::FrameResult ret = _textureFrame.append(width, height, data, out);
+        if (ret == FontAtlasFrame::FrameResult::E_FULL)
+        {
+            _buffers.push_back(std::move(_textureFrame));
+            _textureBufferIndex += 1;
+            _textureFrame.reinit(_pixelMode, _width, _height);
+            ret = _textureFrame.append(width, height, data, out);
+        }
+        return ret == FontAtlasFrame::FrameResult::SUCCESS;
+    }
+
+    void FontAtlas::compact()
+    {
+#if CC_ENABLE_CACHE_TTF_FONT_TEXTURE
+        // letters in use move to new frames, tallest first to keep the skyline flat
+        std::vector<std::pair<unsigned long, FontLetterDefinition*>> letters;
+        for (auto it = _letterMap.begin(); it != _letterMap.end();)
+        {
+            auto ref = _letterRefs.find(it->first);
+            if (ref == _letterRefs.end())
+            {
+                it = _letterMap.erase(it);
+            }
+            else
+            {
+                letters.emplace_back(it->first, &it->second);
+                ++it;
+            }
+        }
+        std::sort(letters.begin(), letters.end(), [](const std::pair<unsigned long, FontLetterDefinition*> &a, const std::pair<unsigned long, FontLetterDefinition*> &b) {
+            return a.second->frameRect.size.height > b.second->frameRect.size.height;
+        });
+
+        // textures of old frames stay alive in effects still referencing them
+        std::vector<FontAtlasFrame> oldFrames = std::move(_buffers);
+        oldFrames.push_back(std::move(_textureFrame));
+        _buffers.clear();
+        _textureBufferIndex = 0;
+        _textureFrame.reinit(_pixelMode, _width, _height);
+
+        std::vector<uint8_t> pixels;
+        Rect rect;
+        for (auto &letter : letters)
+        {
+            FontLetterDefinition &def = *letter.second;
+            oldFrames[def.textureID].copyPixels(def.frameRect, pixels);
+            if (appendToFrames(def.frameRect.size.width, def.frameRect.size.height, pixels, rect))
+            {
+                updateLetterFrame(def, rect);
+            }
+            else
+            {
+                _letterMap.erase(letter.first);
+            }
+        }
+
+        // letters in use taking most of the frames should not be repacked for each new letter
+        _maxFrames = std::max(FONT_ATLAS_MAX_FRAMES, 2 * (_textureBufferIndex + 1));
+        _generation += 1;
+
+        std::weak_ptr<FontAtlas> weakThis = shared_from_this();
+        Application::getInstance()->getScheduler()->performFunctionInCocosThread([weakThis]() {
+            auto atlas = weakThis.lock();
+            if (atlas) atlas->notifyRepacked();
+        });
+#endif
+    }
+
+    void FontAtlas::retainLetters(void *owner, const std::u32string &text, const LettersReadyCallback &onRepacked)
+    {
+        LetterUser &user = _letterUsers[owner];
+        user.onRepacked = onRepacked;
+        if (user.text == text) return;
+        changeLetterRefs(text, 1);
+        changeLetterRefs(user.text, -1);
+        user.text = text;
+    }
+
+    void FontAtlas::releaseLetters(void *owner)
+    {
+        auto it = _letterUsers.find(owner);
+        if (it == _letterUsers.end()) return;
+        changeLetterRefs(it->second.text, -1);
+        _letterUsers.erase(it);
+    }
+
+    void FontAtlas::changeLetterRefs(const std::u32string &text, int delta)
+    {
+        for (auto ch : text)
+        {
+            auto it = _letterRefs.find(ch);
+            if (it == _letterRefs.end())
+            {
+                it = _letterRefs.emplace(ch, 0).first;
+            }
+            it->second += delta;
+            if (it->second <= 0)
+            {
+                _letterRefs.erase(it);
+            }
+        }
+    }
+
+    void FontAtlas::notifyRepacked()
+    {
+        // users may release letters while others are notified
+        std::vector<void*> owners;
+        owners.reserve(_letterUsers.size());
+        for (auto &it : _letterUsers)
+        {
+            owners.push_back(it.first);
+        }
+        for (auto *owner : owners)
+        {
+            auto it = _letterUsers.find(owner);
+            if (it == _letterUsers.end()) continue;
+            LettersReadyCallback callback = it->second.onRepacked;
+            if (callback) callback();
+        }
+    }
+
     void FontAtlas::addLetterDef(unsigned long ch, std::shared_ptr<GlyphBitmap> bitmap, const Rect& rect)
     {
         assert(bitmap->getPixelMode() == _pixelMode);
 
         auto& def = _letterMap[ch];
         def.validate = true;
-        def.textureID = _textureBufferIndex;
         def.xAdvance = bitmap->getXAdvance();
         def.rect = bitmap->getRect();
+        def.outline = bitmap->getOutline();
+        updateLetterFrame(def, rect);
+    }
+
+    void FontAtlas::updateLetterFrame(FontLetterDefinition &def, const Rect &rect)
+    {
+        def.textureID = _textureBufferIndex;
+        def.frameRect = rect;
         def.texX = (rect.origin.x - 0.5f) / _textureFrame.getWidth();
         def.texY = (rect.origin.y -0.5f)/ _textureFrame.getHeight();
         def.texWidth = (rect.size.width + 1.0f) / _textureFrame.getWidth();
         def.texHeight = (rect.size.height + 1.0f) / _textureFrame.getHeight();
-        def.outline = bitmap->getOutline();
     }
 
     bool FontAtlas::prepareLetters(const std::u32string &text, cocos2d::FontFreeType *font)
     {
         bool ok = true;
+#if CC_ENABLE_TTF_LABEL_ASYNC_GLYPH
+        std::vector<unsigned long> requests;
+#endif
         for (int i = 0; i < text.length(); i++) 
         {
             auto it = _letterMap.find(text[i]);
             if(it == _letterMap.end())
             {
+#if CC_ENABLE_TTF_LABEL_ASYNC_GLYPH
+                if (_missingLetters.find(text[i]) != _missingLetters.end()) continue;
+                ok = false;
+                if (_pendingLetters.insert(text[i]).second)
+                {
+                    requests.push_back(text[i]);
+                }
+#else
                 auto glyph = font->getGlyphBitmap(text[i], _useSDF);
                 ok &= prepareLetter(text[i], glyph);
+#endif
             }
         }
+#if CC_ENABLE_TTF_LABEL_ASYNC_GLYPH
+        if (!requests.empty())
+        {
+            std::weak_ptr<FontAtlas> weakThis = shared_from_this();
+            GlyphRasterizer::getInstance()->rasterize(font, _useSDF, std::move(requests), [weakThis](GlyphRasterizer::GlyphList &glyphs) {
+                auto atlas = weakThis.lock();
+                if (atlas) atlas->onLettersLoaded(glyphs);
+            });
+        }
+#endif
         return ok;
     }
 
@@ -339,6 +523,13 @@ namespace cocos2d {
         auto it = _letterMap.find(ch);
         if (it != _letterMap.end()) return &it->second;
 
+#if CC_ENABLE_TTF_LABEL_ASYNC_GLYPH
+        if (_pendingLetters.find(ch) != _pendingLetters.end() || _missingLetters.find(ch) != _missingLetters.end())
+        {
+            return nullptr;
+        }
+#endif
+
         if (font) {
             auto bitmap = font->getGlyphBitmap(ch, _useSDF);
             if (bitmap) {
@@ -350,6 +541,46 @@ namespace cocos2d {
         return nullptr;
     }
 
+    void FontAtlas::addLettersReadyListener(void *owner, const LettersReadyCallback &callback)
+    {
+        _lettersReadyListeners[owner] = callback;
+    }
+
+    void FontAtlas::removeLettersReadyListener(void *owner)
+    {
+        _lettersReadyListeners.erase(owner);
+    }
+
+    void FontAtlas::onLettersLoaded(std::vector<std::pair<unsigned long, std::shared_ptr<GlyphBitmap>>> &letters)
+    {
+        // all letters of the batch are appended before any texture is used, so each
+        // dirty frame is uploaded by a single updateSubImage in getTexture
+        for (auto &letter : letters)
+        {
+            _pendingLetters.erase(letter.first);
+            if (!letter.second || !prepareLetter(letter.first, letter.second))
+            {
+                _missingLetters.insert(letter.first);
+            }
+        }
+
+        // listeners may register again or be removed while others are notified
+        std::vector<void*> owners;
+        owners.reserve(_lettersReadyListeners.size());
+        for (auto &it : _lettersReadyListeners)
+        {
+            owners.push_back(it.first);
+        }
+        for (auto *owner : owners)
+        {
+            auto it = _lettersReadyListeners.find(owner);
+            if (it == _lettersReadyListeners.end()) continue;
+            LettersReadyCallback callback = std::move(it->second);
+            _lettersReadyListeners.erase(it);
+            callback();
+        }
+    }
+
 
     FontAtlasFrame& FontAtlas::frameAt(int idx)
     {
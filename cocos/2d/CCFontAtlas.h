@@ -27,7 +27,9 @@ THE SOFTWARE.
 #include "CCFontFreetype.h"
 
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
+#include <functional>
 
 #include "base/ccConfig.h"
 #if CC_ENABLE_TTF_LABEL_RENDERER
@@ -49,6 +51,8 @@ namespace cocos2d {
         float xAdvance = 0;
         int outline = 0;
         bool validate = false;
+        // pixels occupied in frame
+        Rect frameRect;
     };
 
     class FontAtlasFrame
@@ -69,6 +73,10 @@ namespace cocos2d {
         void reinit(PixelMode mode, int width, int height);
         FrameResult append(int width, int height, std::vector<uint8_t> &, Rect &out);
 
+#if CC_ENABLE_CACHE_TTF_FONT_TEXTURE
+        void copyPixels(const Rect &rect, std::vector<uint8_t> &out) const;
+#endif
+
 
         float getWidth() const { return _WIDTH; }
         float getHeight() const { return _HEIGHT; }
@@ -82,17 +90,15 @@ namespace cocos2d {
             DIRTY_ALL= 2,
         };
 
-        bool hasSpace(int width, int height);
-
-        int remainRowXSpace() const;
-        int remainYSpace() const;
-        bool hasRowXSpace(int x) const;
-        bool hasYSpace(int y) const;
-        bool hasNextRowXSpace(int x) const;
-        bool hasNextRowYSpace(int y) const;
+        struct SkylineNode {
+            int x;
+            int y;
+            int width;
+        };
 
-        void moveToNextRow();
-        void moveToNextCursor(int width, int height);
+        // lowest y to place a box of width x height at skyline node index, -1 if not fit
+        int fitSkyline(size_t index, int width, int height) const;
+        void addSkylineLevel(size_t index, int x, int y, int width, int height);
 
 #if CC_ENABLE_CACHE_TTF_FONT_TEXTURE
         mutable std::vector<uint8_t> _buffer;
@@ -102,19 +108,20 @@ namespace cocos2d {
 
         int _WIDTH = 0;
         int _HEIGHT = 0;
-        int _currentRowY = 0;
-        int _currentRowX = 0;
-        int _currRowHeight = 0;
+        // top edges of the packed area from left to right
+        std::vector<SkylineNode> _skyline;
         PixelMode _pixelMode = PixelMode::A8;
         renderer::Texture2D *_texture = nullptr;
         
         friend class FontAtlas;
     };
 
-    class FontAtlas {
+    class FontAtlas : public std::enable_shared_from_this<FontAtlas> {
 
     public:
 
+        typedef std::function<void()> LettersReadyCallback;
+
         FontAtlas(PixelMode mode, int width, int height, bool hasoutline);
         virtual ~FontAtlas();
 
@@ -122,16 +129,63 @@ namespace cocos2d {
 
         bool prepareLetter(unsigned long ch, std::shared_ptr<GlyphBitmap> bitmap);
 
+        /**
+         * Makes sure all letters of text are in the atlas. With asynchronous glyph loading
+         * missing letters are queued and false is returned until they land.
+         */
         bool prepareLetters(const std::u32string &text, cocos2d::FontFreeType *font);
 
+        /** Returns nullptr for letters that are still being rasterized. */
         FontLetterDefinition* getOrLoad(unsigned long ch, FontFreeType* font);
 
+        /** Callback is invoked once in cocos thread when queued letters land, owner replaces its previous callback. */
+        void addLettersReadyListener(void *owner, const LettersReadyCallback &callback);
+        void removeLettersReadyListener(void *owner);
+
+        /**
+         * Keeps letters of text in atlas while owner uses them, replacing the ones owner kept before.
+         * Letters no owner keeps are dropped when frames are full, the rest are packed into fewer
+         * frames and onRepacked is invoked in cocos thread since the letters moved.
+         */
+        void retainLetters(void *owner, const std::u32string &text, const LettersReadyCallback &onRepacked);
+        void releaseLetters(void *owner);
+
+        /** Increased each time letters are repacked, layouts of an older generation are invalid. */
+        uint32_t getGeneration() const { return _generation; }
+
         FontAtlasFrame& frameAt(int idx);
+
+        int getFrameCount() const { return _textureBufferIndex + 1; }
+        size_t getLetterCount() const { return _letterMap.size(); }
+        /** Bytes of one frame texture. */
+        size_t getFrameBytes() const { return (size_t)PixelModeSize(_pixelMode) * _width * _height; }
     private:
 
         void addLetterDef(unsigned long ch, std::shared_ptr<GlyphBitmap> bitmap, const Rect& rect);
+        void updateLetterFrame(FontLetterDefinition &def, const Rect &rect);
+        // appends to current frame, opens a new one if it is full
+        bool appendToFrames(int width, int height, std::vector<uint8_t> &data, Rect &out);
+        void changeLetterRefs(const std::u32string &text, int delta);
+        void compact();
+        void notifyRepacked();
+
+        void onLettersLoaded(std::vector<std::pair<unsigned long, std::shared_ptr<GlyphBitmap>>> &letters);
 
         std::unordered_map<uint64_t, FontLetterDefinition> _letterMap;
+        // letters queued for rasterization
+        std::unordered_set<unsigned long> _pendingLetters;
+        // letters failed to rasterize, not requested again
+        std::unordered_set<unsigned long> _missingLetters;
+        std::unordered_map<void*, LettersReadyCallback> _lettersReadyListeners;
+
+        struct LetterUser {
+            std::u32string text;
+            LettersReadyCallback onRepacked;
+        };
+        std::unordered_map<void*, LetterUser> _letterUsers;
+        std::unordered_map<unsigned long, int> _letterRefs;
+        uint32_t _generation = 0;
+        int _maxFrames = 0;
 
         FontAtlasFrame   _textureFrame;
         std::vector<FontAtlasFrame> _buffers;
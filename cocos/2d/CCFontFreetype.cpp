@@ -25,9 +25,10 @@ THE SOFTWARE.
 #include "CCFontFreetype.h"
 
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 #include "platform/CCFileUtils.h"
 #include "platform/CCDevice.h"
-#include "external/sources/edtaa3func/edtaa3func.h"
 #include "base/ccConfig.h"
 
 #if CC_ENABLE_TTF_LABEL_RENDERER
@@ -54,13 +55,11 @@ THE SOFTWARE.
 #if FFT_SDF_TMP_VECTOR
 namespace {
     //cache vector in thread
-    thread_local std::vector<short> xdistV;
-    thread_local std::vector<short> ydistV;
-    thread_local std::vector<double> gxV;
-    thread_local std::vector<double> gyV;
-    thread_local std::vector<double> dataV;
-    thread_local std::vector<double> outsideV;
-    thread_local std::vector<double> insideV;
+    thread_local std::vector<float> gridOuterV;
+    thread_local std::vector<float> gridInnerV;
+    thread_local std::vector<float> lineFV;
+    thread_local std::vector<float> lineZV;
+    thread_local std::vector<int> lineVV;
 }
 #endif
 
@@ -108,109 +107,119 @@ namespace cocos2d {
             }
         }
 
+        const float SDF_INF = 1e20f;
+
+        /**
+         * 1D squared euclidean distance transform (Felzenszwalb & Huttenlocher) of length samples
+         * in grid, starting at offset and `stride` apart. f, z and v are scratch of length + 1.
+         */
+        void distanceTransform1D(float *grid, long offset, long stride, long length, float *f, float *z, int *v)
+        {
+            v[0] = 0;
+            z[0] = -SDF_INF;
+            z[1] = SDF_INF;
+            f[0] = grid[offset];
+
+            for (long q = 1, k = 0; q < length; q++)
+            {
+                f[q] = grid[offset + q * stride];
+                const float q2 = (float)(q * q);
+                float s;
+                do
+                {
+                    const int r = v[k];
+                    s = (f[q] - f[r] + q2 - (float)r * r) / (float)(q - r) * 0.5f;
+                } while (s <= z[k] && --k > -1);
+                k++;
+                v[k] = (int)q;
+                z[k] = s;
+                z[k + 1] = SDF_INF;
+            }
+
+            for (long q = 0, k = 0; q < length; q++)
+            {
+                while (z[k + 1] < q) k++;
+                const int r = v[k];
+                const float d = (float)(q - r);
+                grid[offset + q * stride] = f[r] + d * d;
+            }
+        }
+
+        void distanceTransform2D(float *grid, long width, long height, float *f, float *z, int *v)
+        {
+            for (long x = 0; x < width; x++)
+            {
+                distanceTransform1D(grid, x, width, height, f, z, v);
+            }
+            for (long y = 0; y < height; y++)
+            {
+                distanceTransform1D(grid, y * width, 1, width, f, z, v);
+            }
+        }
+
+        /**
+         * Signed distance field of an 8-bit coverage image, padded by distanceMapSpread on each side.
+         * Partially covered pixels are placed at sub-pixel distance from the edge, which keeps the
+         * anti-aliased edge precision of the glyph bitmap.
+         */
         std::vector<uint8_t> makeDistanceMap(unsigned char *img, long width, long height, int distanceMapSpread)
         {
-            long pixelAmount = (width + 2 * distanceMapSpread) * (height + 2 * distanceMapSpread);
+            long outWidth = width + 2 * distanceMapSpread;
+            long outHeight = height + 2 * distanceMapSpread;
+            long pixelAmount = outWidth * outHeight;
+            long lineLength = std::max(outWidth, outHeight) + 1;
 
-#if FFT_SDF_TMP_VECTOR
-            xdistV.resize(pixelAmount);
-            ydistV.resize(pixelAmount);
-            gxV.resize(pixelAmount);
-            gyV.resize(pixelAmount);
-            dataV.resize(pixelAmount);
-            outsideV.resize(pixelAmount);
-            insideV.resize(pixelAmount);
-
-            std::fill(gxV.begin(), gxV.end(), 0.0);
-            std::fill(gyV.begin(), gyV.end(), 0.0);
-            std::fill(dataV.begin(), dataV.end(), 0.0);
-            std::fill(outsideV.begin(), outsideV.end(), 0.0);
-            std::fill(insideV.begin(), insideV.end(), 0.0);
-
-            short * xdist = xdistV.data();
-            short * ydist = ydistV.data();
-            double * gx = gxV.data();
-            double * gy = gyV.data();
-            double * data = dataV.data();
-            double * outside = outsideV.data();
-            double * inside = insideV.data();
-#else
-            short * xdist = (short *)malloc(pixelAmount * sizeof(short));
-            short * ydist = (short *)malloc(pixelAmount * sizeof(short));
-            double * gx = (double *)calloc(pixelAmount, sizeof(double));
-            double * gy = (double *)calloc(pixelAmount, sizeof(double));
-            double * data = (double *)calloc(pixelAmount, sizeof(double));
-            double * outside = (double *)calloc(pixelAmount, sizeof(double));
-            double * inside = (double *)calloc(pixelAmount, sizeof(double));
+#if !FFT_SDF_TMP_VECTOR
+            std::vector<float> gridOuterV, gridInnerV, lineFV, lineZV;
+            std::vector<int> lineVV;
 #endif
-            long i, j;
+            // outer: squared distance to the glyph, inner: squared distance to the background
+            gridOuterV.assign(pixelAmount, SDF_INF);
+            gridInnerV.assign(pixelAmount, 0.0f);
+            lineFV.resize(lineLength);
+            lineZV.resize(lineLength + 1);
+            lineVV.resize(lineLength);
 
-            // Convert img into double (data) rescale image levels between 0 and 1
-            long outWidth = width + 2 * distanceMapSpread;
-            for (i = 0; i < width; ++i)
+            float *gridOuter = gridOuterV.data();
+            float *gridInner = gridInnerV.data();
+
+            for (long j = 0; j < height; ++j)
             {
-                for (j = 0; j < height; ++j)
+                long dst = (j + distanceMapSpread) * outWidth + distanceMapSpread;
+                const unsigned char *src = img + j * width;
+                for (long i = 0; i < width; ++i)
                 {
-                    data[(j + distanceMapSpread) * outWidth + distanceMapSpread + i] = img[j * width + i] / 255.0;
+                    unsigned char a = src[i];
+                    if (a == 0) continue;
+                    if (a == 255)
+                    {
+                        gridOuter[dst + i] = 0.0f;
+                        gridInner[dst + i] = SDF_INF;
+                    }
+                    else
+                    {
+                        float d = 0.5f - a / 255.0f;
+                        gridOuter[dst + i] = d > 0.0f ? d * d : 0.0f;
+                        gridInner[dst + i] = d < 0.0f ? d * d : 0.0f;
+                    }
                 }
             }
 
-            width += 2 * distanceMapSpread;
-            height += 2 * distanceMapSpread;
-
-            // Transform background (outside contour, in areas of 0's)   
-            computegradient(data, (int)width, (int)height, gx, gy);
-            edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, outside);
-            for (i = 0; i < pixelAmount; i++)
-                if (outside[i] < 0.0)
-                    outside[i] = 0.0;
-
-            // Transform foreground (inside contour, in areas of 1's)   
-            for (i = 0; i < pixelAmount; i++)
-                data[i] = 1 - data[i];
-            computegradient(data, (int)width, (int)height, gx, gy);
-            edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, inside);
-            for (i = 0; i < pixelAmount; i++)
-                if (inside[i] < 0.0)
-                    inside[i] = 0.0;
-
-            // The bipolar distance field is now outside-inside
-            double dist;
+            distanceTransform2D(gridOuter, outWidth, outHeight, lineFV.data(), lineZV.data(), lineVV.data());
+            distanceTransform2D(gridInner, outWidth, outHeight, lineFV.data(), lineZV.data(), lineVV.data());
+
+            // The bipolar distance field is outside-inside
             /* Single channel 8-bit output (bad precision and range, but simple) */
             std::vector<uint8_t> out;
             out.resize(pixelAmount);
-            for (i = 0; i < pixelAmount; i++)
+            for (long i = 0; i < pixelAmount; i++)
             {
-                dist = outside[i] - inside[i];
-                dist = 128.0 - dist * 16;
+                float dist = std::sqrt(gridOuter[i]) - std::sqrt(gridInner[i]);
+                dist = 128.0f - dist * 16;
                 if (dist < 0) dist = 0;
                 if (dist > 255) dist = 255;
                 out[i] = (unsigned char)dist;
             }
-            /* Dual channel 16-bit output (more complicated, but good precision and range) */
-            /*unsigned char *out = (unsigned char *) malloc( pixelAmount * 3 * sizeof(unsigned char) );
-            for( i=0; i< pixelAmount; i++)
-            {
-                dist = outside[i] - inside[i];
-                dist = 128.0 - dist*16;
-                if( dist < 0.0 ) dist = 0.0;
-                if( dist >= 256.0 ) dist = 255.999;
-                // R channel is a copy of the original grayscale image
-                out[3*i] = img[i];
-                // G channel is fraction
-                out[3*i + 1] = (unsigned char) ( 256 - (dist - floor(dist)* 256.0 ));
-                // B channel is truncated integer part
-                out[3*i + 2] = (unsigned char)dist;
-            }*/
-#if !FFT_SDF_TMP_VECTOR
-            free(xdist);
-            free(ydist);
-            free(gx);
-            free(gy);
-            free(data);
-            free(outside);
-            free(inside);
-#endif
             return out;
         }
 
@@ -258,8 +267,13 @@ namespace cocos2d {
         } else {
             faceData = itr->second;
         }
-        
-        if (FT_New_Memory_Face(getFTLibrary(), faceData->getBytes(), faceData->getSize(), 0, &_face))
+
+        return loadFont(getFTLibrary(), faceData);
+    }
+
+    bool FontFreeType::loadFont(FT_Library library, std::shared_ptr<Data> faceData)
+    {
+        if (FT_New_Memory_Face(library, faceData->getBytes(), faceData->getSize(), 0, &_face))
         {
             cocos2d::log("[error] failed to parse font %s", _fontName.c_str());
             return false;
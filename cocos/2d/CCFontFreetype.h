@@ -59,6 +59,11 @@ namespace cocos2d {
         FT_Library& getFTLibrary();
 
         bool loadFont();
+        /**
+         * Creates the face from already loaded font data with the given library.
+         * Used by worker threads, which must not share a FT_Library with the cocos thread.
+         */
+        bool loadFont(FT_Library library, std::shared_ptr<Data> faceData);
 
         int getHorizontalKerningForChars(uint64_t a, uint64_t b) const;
         std::unique_ptr<std::vector<int>> getHorizontalKerningForUTF32Text(const std::u32string &text) const;
@@ -66,6 +71,10 @@ namespace cocos2d {
         int getFontAscender() const;
         const char* getFontFamily() const;
 
+        const std::string& getFontName() const { return _fontName; }
+        float getFontSize() const { return _fontSize; }
+        std::shared_ptr<Data> getFontFaceData() const { return _fontFaceData; }
+
 
         std::shared_ptr<GlyphBitmap> getGlyphBitmap(unsigned long ch, bool hasOutline = false);
 
@@ -0,0 +1,160 @@
+/****************************************************************************
+Copyright (c) 2020 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCGlyphRasterizer.h"
+#include "base/CCThreadPool.h"
+#include "base/CCScheduler.h"
+#include "platform/CCApplication.h"
+
+#include <thread>
+#include <cassert>
+
+#if CC_ENABLE_TTF_LABEL_RENDERER && CC_ENABLE_TTF_LABEL_ASYNC_GLYPH
+
+// max worker threads used to rasterize glyphs
+#define GLYPH_RASTERIZER_MAX_THREADS 2
+// glyphs rasterized by one task, larger batches are split across workers
+#define GLYPH_RASTERIZER_TASK_SIZE 16
+// faces cached by each worker before they are all released
+#define GLYPH_RASTERIZER_MAX_FACES 16
+
+namespace cocos2d {
+
+    namespace {
+        GlyphRasterizer *_instance = nullptr;
+    }
+
+    GlyphRasterizer* GlyphRasterizer::getInstance()
+    {
+        if (!_instance)
+        {
+            _instance = new GlyphRasterizer();
+        }
+        return _instance;
+    }
+
+    void GlyphRasterizer::destroyInstance()
+    {
+        delete _instance;
+        _instance = nullptr;
+    }
+
+    GlyphRasterizer::GlyphRasterizer()
+    {
+        int threadNum = (int)std::thread::hardware_concurrency() - 1;
+        threadNum = std::max(1, std::min(threadNum, GLYPH_RASTERIZER_MAX_THREADS));
+        _workers.resize(threadNum);
+        _threadPool = ThreadPool::newFixedThreadPool(threadNum);
+    }
+
+    GlyphRasterizer::~GlyphRasterizer()
+    {
+        // waits for running tasks, so workers are idle when their faces are released
+        delete _threadPool;
+        for (auto &worker : _workers)
+        {
+            worker.faces.clear();
+            if (worker.library) FT_Done_FreeType(worker.library);
+        }
+    }
+
+    void GlyphRasterizer::rasterize(FontFreeType *font, bool sdf, std::vector<unsigned long> &&chars, const Callback &callback)
+    {
+        if (chars.empty()) return;
+
+        auto batch = std::make_shared<Batch>();
+        batch->fontName = font->getFontName();
+        batch->fontSize = font->getFontSize();
+        batch->faceData = font->getFontFaceData();
+        batch->sdf = sdf;
+        batch->callback = callback;
+        batch->glyphs.resize(chars.size());
+        for (size_t i = 0; i < chars.size(); i++)
+        {
+            batch->glyphs[i].first = chars[i];
+        }
+
+        size_t total = chars.size();
+        int taskNum = (int)((total + GLYPH_RASTERIZER_TASK_SIZE - 1) / GLYPH_RASTERIZER_TASK_SIZE);
+        batch->remainTasks = taskNum;
+        for (size_t begin = 0; begin < total; begin += GLYPH_RASTERIZER_TASK_SIZE)
+        {
+            size_t end = std::min(total, begin + GLYPH_RASTERIZER_TASK_SIZE);
+            _threadPool->pushTask([this, batch, begin, end](int threadId) {
+                rasterizeRange(threadId, batch.get(), begin, end);
+                if (--batch->remainTasks == 0)
+                {
+                    Application::getInstance()->getScheduler()->performFunctionInCocosThread([batch]() {
+                        batch->callback(batch->glyphs);
+                    });
+                }
+            });
+        }
+    }
+
+    void GlyphRasterizer::rasterizeRange(int threadId, Batch *batch, size_t begin, size_t end)
+    {
+        FontFreeType *face = getWorkerFace(threadId, batch);
+        if (!face) return;
+
+        // each task writes its own range of the batch, no lock is needed
+        for (size_t i = begin; i < end; i++)
+        {
+            auto &glyph = batch->glyphs[i];
+            glyph.second = face->getGlyphBitmap(glyph.first, batch->sdf);
+        }
+    }
+
+    FontFreeType* GlyphRasterizer::getWorkerFace(int threadId, Batch *batch)
+    {
+        assert(threadId >= 0 && threadId < (int)_workers.size());
+        Worker &worker = _workers[threadId];
+        if (!worker.library && FT_Init_FreeType(&worker.library))
+        {
+            worker.library = nullptr;
+            return nullptr;
+        }
+
+        char key[512] = { 0 };
+        snprintf(key, 511, "s:%f/p:%s", batch->fontSize, batch->fontName.c_str());
+        auto it = worker.faces.find(key);
+        if (it != worker.faces.end()) return it->second.get();
+
+        if (worker.faces.size() >= GLYPH_RASTERIZER_MAX_FACES)
+        {
+            worker.faces.clear();
+        }
+
+        std::unique_ptr<FontFreeType> face(new FontFreeType(batch->fontName, batch->fontSize, nullptr));
+        if (!batch->faceData || !face->loadFont(worker.library, batch->faceData))
+        {
+            return nullptr;
+        }
+        FontFreeType *ret = face.get();
+        worker.faces[key] = std::move(face);
+        return ret;
+    }
+}
+
+#endif
@@ -0,0 +1,90 @@
+/****************************************************************************
+Copyright (c) 2020 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#pragma once
+
+#include "CCFontFreetype.h"
+
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+
+#include "base/ccConfig.h"
+#if CC_ENABLE_TTF_LABEL_RENDERER && CC_ENABLE_TTF_LABEL_ASYNC_GLYPH
+
+namespace cocos2d {
+
+    class ThreadPool;
+
+    /**
+     * Rasterizes glyphs on a worker pool. Each worker owns its FT_Library and one FT_Face
+     * per font & size, so FreeType is never shared between threads.
+     */
+    class GlyphRasterizer
+    {
+    public:
+        typedef std::vector<std::pair<unsigned long, std::shared_ptr<GlyphBitmap>>> GlyphList;
+        typedef std::function<void(GlyphList &)> Callback;
+
+        static GlyphRasterizer* getInstance();
+        static void destroyInstance();
+
+        /**
+         * Queues glyphs of font for rasterization. The callback is invoked in cocos thread
+         * once the whole batch is done, failed glyphs have a null bitmap.
+         */
+        void rasterize(FontFreeType *font, bool sdf, std::vector<unsigned long> &&chars, const Callback &callback);
+
+    private:
+
+        struct Batch
+        {
+            std::string fontName;
+            float fontSize = 0.0f;
+            std::shared_ptr<Data> faceData;
+            bool sdf = false;
+            GlyphList glyphs;
+            std::atomic<int> remainTasks;
+            Callback callback;
+        };
+
+        struct Worker
+        {
+            FT_Library library = nullptr;
+            std::unordered_map<std::string, std::unique_ptr<FontFreeType>> faces;
+        };
+
+        GlyphRasterizer();
+        ~GlyphRasterizer();
+
+        void rasterizeRange(int threadId, Batch *batch, size_t begin, size_t end);
+        FontFreeType* getWorkerFace(int threadId, Batch *batch);
+
+        ThreadPool *_threadPool = nullptr;
+        // indexed by thread id, each worker only touches its own slot
+        std::vector<Worker> _workers;
+    };
+}
+
+#endif
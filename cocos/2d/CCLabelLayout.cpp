@@ -43,6 +43,7 @@ THE SOFTWARE.
 #include <algorithm>
 #include <fstream>
 #include <unordered_map>
+#include <list>
 #include <chrono>
 
 #include "base/ccConfig.h"
@@ -50,6 +51,8 @@ THE SOFTWARE.
 #if CC_ENABLE_TTF_LABEL_RENDERER
 
 #define INIT_VERTEX_SIZE 32
+// finished layouts kept for labels showing the same text again
+#define LABEL_LAYOUT_CACHE_SIZE 128
 
 namespace {
     const std::string textureKey = "texture";
@@ -337,6 +340,62 @@ namespace cocos2d {
 
 
 
+    namespace {
+        class LabelLayoutCache {
+        public:
+            struct Entry {
+                std::weak_ptr<TTFLabelAtlas> atlas;
+                std::vector<TextRowSpace> textSpace;
+                float scale = 1.0f;
+                float contentWidth = 0.0f;
+                float contentHeight = 0.0f;
+            };
+
+            static LabelLayoutCache& getInstance()
+            {
+                static LabelLayoutCache instance;
+                return instance;
+            }
+
+            const Entry* find(const std::string &key, const TTFLabelAtlas *atlas)
+            {
+                auto it = _index.find(key);
+                if (it == _index.end()) return nullptr;
+                // the atlas at this address may be a new one
+                if (it->second->second.atlas.lock().get() != atlas)
+                {
+                    _entries.erase(it->second);
+                    _index.erase(it);
+                    return nullptr;
+                }
+                _entries.splice(_entries.begin(), _entries, it->second);
+                return &it->second->second;
+            }
+
+            void add(const std::string &key, Entry &&entry)
+            {
+                auto it = _index.find(key);
+                if (it != _index.end())
+                {
+                    _entries.erase(it->second);
+                    _index.erase(it);
+                }
+                _entries.emplace_front(key, std::move(entry));
+                _index[key] = _entries.begin();
+                if (_entries.size() > LABEL_LAYOUT_CACHE_SIZE)
+                {
+                    _index.erase(_entries.back().first);
+                    _entries.pop_back();
+                }
+            }
+
+        private:
+            typedef std::list<std::pair<std::string, Entry>> EntryList;
+            EntryList _entries;
+            std::unordered_map<std::string, EntryList::iterator> _index;
+        };
+    }
+
     struct TextSpaceArray {
 
         void addSpace(TextRowSpace& space)
@@ -365,7 +424,7 @@ namespace cocos2d {
         return _data[_data.size() - 1];
     }
 
-    TextRowSpace::TextRowSpace(TextRowSpace &&other)
+    TextRowSpace::TextRowSpace(TextRowSpace &&other) noexcept
     {
         _left = other._left;
         _bottom = other._bottom;
@@ -404,6 +463,23 @@ namespace cocos2d {
         block.texId = texId;
     }
 
+    void TextRowSpace::truncate(size_t n)
+    {
+        if (n >= _data.size()) return;
+        _data.resize(n);
+        _left = FLT_MAX;
+        _bottom = FLT_MAX;
+        _right = FLT_MIN;
+        _top = FLT_MIN;
+        for (auto &block : _data)
+        {
+            _left = std::min(_left, block.area.getMinX());
+            _right = std::max(_right, block.area.getMaxX());
+            _bottom = std::min(_bottom, block.area.getMinY());
+            _top = std::max(_top, block.area.getMaxY());
+        }
+    }
+
     void TextRowSpace::translate(float x, float y)
     {
         _x += x;
@@ -475,11 +551,18 @@ namespace cocos2d {
         _inited = true;
         _layoutInfo = info;
         _retinaFontSize = std::max(fontSize, retinaFontSize);
+        if (_fontAtlas)
+        {
+            _fontAtlas->getFontAtlas()->removeLettersReadyListener(this);
+            _fontAtlas->getFontAtlas()->releaseLetters(this);
+        }
+        _glyphReady = false;
         _fontAtlas = TTFLabelAtlasCache::getInstance()->load(font, _retinaFontSize, info);
         if(!_fontAtlas) {
             return false;
         }
         _fontScale = fontSize / _fontAtlas->getFontSize();
+        _outlineScale = TTFLabelAtlasCache::getInstance()->getOutlineScale(_fontAtlas.get(), _retinaFontSize);
         _groups = std::make_shared<TextRenderGroup>();
         if (info->shadowBlur >= 0)
         {
@@ -498,6 +581,11 @@ namespace cocos2d {
 
     LabelLayout::~LabelLayout()
     {
+        if (_fontAtlas)
+        {
+            _fontAtlas->getFontAtlas()->removeLettersReadyListener(this);
+            _fontAtlas->getFontAtlas()->releaseLetters(this);
+        }
     }
 
 
@@ -516,50 +604,81 @@ namespace cocos2d {
     }
 
 
-    bool LabelLayout::updateContent()
+    void LabelLayout::onLettersReady()
+    {
+        updateContent();
+        _renderer->doRender();
+    }
+
+    bool LabelLayout::layoutGlyphs()
     {
-        if(!_fontAtlas)
-        {
-            return false;
-        }
         auto *atlas = _fontAtlas->getFontAtlas();
         auto *ttf = _fontAtlas->getTTF();
 
         FontLetterDefinition* letterDef = nullptr;
-        Rect row;
-
 
-        const float LineHeight = _layoutInfo->lineHeight;
         const float SpaceX = _layoutInfo->spaceX;
         const LabelOverflow OverFlow = _layoutInfo->overflow;
         const bool ClampAndWrap = _layoutInfo->wrap && OverFlow == LabelOverflow::CLAMP;
         const bool ResizeHeight = OverFlow == LabelOverflow::RESIZE_HEIGHT;
         const int ContentWidth = _layoutInfo->width;
-        const int ContentHeight = _layoutInfo->height;
-        const LabelAlignmentH HAlign = _layoutInfo->halign;
-        const LabelAlignmentV VAlign = _layoutInfo->valign;
-        const float AnchorX = _layoutInfo->anchorX;
-        const float AnchorY = _layoutInfo->anchorY;
-        const bool Underline = _layoutInfo->underline;
+
+        bool lettersReady = atlas->prepareLetters(_u32string, ttf);
+        if (!lettersReady)
+        {
+            // lay out with the letters already in atlas, and again when the rest land
+            atlas->addLettersReadyListener(this, [this]() {
+                onLettersReady();
+            });
+        }
+
+        // letters of the common prefix with the last laid out string keep their place
+        char inputs[128] = { 0 };
+        snprintf(inputs, sizeof(inputs), "%p/%u/%g/%g/%d/%d/%d", _fontAtlas.get(), atlas->getGeneration(), _fontScale, SpaceX, ClampAndWrap, ResizeHeight, ContentWidth);
+        size_t start = 0;
+        if (_glyphReady && _glyphInputs == inputs)
+        {
+            size_t n = std::min(_glyphText.size(), _u32string.size());
+            while (start < n && _glyphText[start] == _u32string[start]) start++;
+        }
 
         //LabelCursor cursor;
         float cursorX = 0;
+        int lastOutline = -1;
 
-        TextSpaceArray textSpaces;
+        std::vector<TextRowSpace> rows;
         TextRowSpace rowSpace;
 
+        if (start > 0)
+        {
+            const GlyphCursor &cursor = _glyphCursors[start];
+            rows = std::move(_glyphRows);
+            rows.resize(cursor.rows + 1);
+            rows.back().truncate(cursor.blocks);
+            rowSpace = std::move(rows.back());
+            rows.pop_back();
+            cursorX = cursor.x;
+            lastOutline = cursor.lastOutline;
+        }
+        _glyphCursors.resize(_u32string.size() + 1);
+
         Rect letterRect;
 
+        // kerning of the first relaid letter depends on the letter before it
+        size_t kerningStart = start > 0 ? start - 1 : 0;
         std::unique_ptr<std::vector<int> > kerning = nullptr;
         if (_enableKerning) {
-            kerning = ttf->getHorizontalKerningForUTF32Text(_u32string);
+            kerning = ttf->getHorizontalKerningForUTF32Text(kerningStart > 0 ? _u32string.substr(kerningStart) : _u32string);
         }
 
-
-        atlas->prepareLetters(_u32string, ttf);
-
-        for (int i = 0; i < _u32string.size(); i++)
+        for (size_t i = start; i < _u32string.size(); i++)
         {
+            GlyphCursor &cursor = _glyphCursors[i];
+            cursor.rows = rows.size();
+            cursor.blocks = rowSpace.size();
+            cursor.x = cursorX;
+            cursor.lastOutline = lastOutline;
+
             auto ch = _u32string[i];
 
             if (ch == u'\r')
@@ -570,12 +689,13 @@ namespace cocos2d {
 
             if (ch == u'\n')
             {
-                textSpaces.addSpace(rowSpace);
+                rows.emplace_back(std::move(rowSpace));
                 cursorX = 0;
                 continue;
             }
 
             letterDef = atlas->getOrLoad(ch, ttf);
+            lastOutline = letterDef ? letterDef->outline : -1;
             if (!letterDef) continue;
             
             letterRect = letterDef->rect;
@@ -583,7 +703,7 @@ namespace cocos2d {
             letterRect.size = Size(letterRect.size.width * _fontScale, letterRect.size.height * _fontScale);
 
             if (_enableKerning && kerning) {
-                auto const kerningX = kerning->at(i) * _fontScale;
+                auto const kerningX = kerning->at(i - kerningStart) * _fontScale;
                 cursorX += kerningX;
             }
 
@@ -593,7 +713,7 @@ namespace cocos2d {
             if ((ResizeHeight || ClampAndWrap) && rowSpace.getExtentedWidth(left, left + letterRect.size.width) > ContentWidth)
             {
                 // RESIZE_HEIGHT or (CLAMP & Enable Wrap)
-                textSpaces.addSpace(rowSpace);
+                rows.emplace_back(std::move(rowSpace));
                 cursorX = 0;
                 left = cursorX - letterDef->outline * _fontScale + letterRect.getMinX();
             }
@@ -609,20 +729,80 @@ namespace cocos2d {
             cursorX += SpaceX + letterDef->xAdvance * _fontScale;
         }
 
-        textSpaces.addSpace(rowSpace);
+        GlyphCursor &cursor = _glyphCursors[_u32string.size()];
+        cursor.rows = rows.size();
+        cursor.blocks = rowSpace.size();
+        cursor.x = cursorX;
+        cursor.lastOutline = lastOutline;
+
+        rows.emplace_back(std::move(rowSpace));
+        _glyphRows = std::move(rows);
+        _glyphText = _u32string;
+        _glyphInputs = inputs;
+        _glyphReady = lettersReady;
+        return lettersReady;
+    }
+
+    bool LabelLayout::updateContent()
+    {
+        if(!_fontAtlas)
+        {
+            return false;
+        }
+
+        // keep letters of text from being dropped when atlas frames are full
+        _fontAtlas->getFontAtlas()->retainLetters(this, _u32string, [this]() {
+            onLettersReady();
+        });
+
+        // the cache key and the layout both belong to the atlas generation seen here
+        const uint32_t generation = _fontAtlas->getFontAtlas()->getGeneration();
+        std::string cacheKey = getCacheKey();
+        const LabelLayoutCache::Entry *cached = LabelLayoutCache::getInstance().find(cacheKey, _fontAtlas.get());
+        if (cached)
+        {
+            _layoutGeneration = generation;
+            _textSpace = cached->textSpace;
+            _scale = cached->scale;
+            updateNodeSize(cached->contentWidth, cached->contentHeight);
+            return true;
+        }
+
+        auto *atlas = _fontAtlas->getFontAtlas();
+        auto *ttf = _fontAtlas->getTTF();
+
+        const float LineHeight = _layoutInfo->lineHeight;
+        const LabelOverflow OverFlow = _layoutInfo->overflow;
+        const int ContentWidth = _layoutInfo->width;
+        const int ContentHeight = _layoutInfo->height;
+        const LabelAlignmentH HAlign = _layoutInfo->halign;
+        const LabelAlignmentV VAlign = _layoutInfo->valign;
+        const float AnchorX = _layoutInfo->anchorX;
+        const float AnchorY = _layoutInfo->anchorY;
+        const bool Underline = _layoutInfo->underline;
+
+        bool lettersReady = layoutGlyphs();
+        _layoutGeneration = generation;
+
+        TextSpaceArray textSpaces;
+        for (auto &glyphRow : _glyphRows)
+        {
+            TextRowSpace rowSpace(glyphRow);
+            textSpaces.addSpace(rowSpace);
+        }
+        const int lastOutline = _glyphCursors[_u32string.size()].lastOutline;
 
         auto& list = textSpaces._data;
 
         //add underline
-        if(Underline){
-            auto underline = atlas->getOrLoad('_', ttf);
-
+        auto underline = Underline ? atlas->getOrLoad('_', ttf) : nullptr;
+        if(underline){
             for (auto &space : list) {
                 Rect letterRect = underline->rect;
                 letterRect.origin *= _fontScale;
                 letterRect.size = Size(letterRect.size.width * _fontScale, letterRect.size.height * _fontScale);
                 float bottom = underline->outline * _fontScale - letterRect.getMaxY();
-                float left =  -letterDef->outline * _fontScale + space.getLeft();
+                float left =  -(lastOutline >= 0 ? lastOutline : underline->outline) * _fontScale + space.getLeft();
 
                 Rect letterRectInline(left, bottom, space.getWidth(), letterRect.size.height);
                 Rect letterTexture(underline->texX, underline->texY, underline->texWidth, underline->texHeight);
@@ -778,6 +958,30 @@ namespace cocos2d {
         }
 
 
+        float contentWidth = OverFlow == LabelOverflow::RESIZE_HEIGHT ? ContentWidth : maxLineWidth;
+        updateNodeSize(contentWidth, TotalTextHeight);
+        
+        _textSpace = std::move(textSpaces._data);
+
+        // layouts with letters still being loaded are not final, and letters repacked
+        // while loading (e.g. the underline) leave a layout that is laid out again on draw
+        if (lettersReady && generation == atlas->getGeneration())
+        {
+            LabelLayoutCache::Entry entry;
+            entry.atlas = _fontAtlas;
+            entry.textSpace = _textSpace;
+            entry.scale = _scale;
+            entry.contentWidth = contentWidth;
+            entry.contentHeight = TotalTextHeight;
+            LabelLayoutCache::getInstance().add(cacheKey, std::move(entry));
+        }
+
+        return true;
+    }
+
+    void LabelLayout::updateNodeSize(float width, float height)
+    {
+        const LabelOverflow OverFlow = _layoutInfo->overflow;
         se::Object *comp = _renderer->getJsComponent();
         if ((OverFlow == LabelOverflow::NONE || OverFlow == LabelOverflow::RESIZE_HEIGHT) && comp) {
             se::Value funcVal;
@@ -785,15 +989,23 @@ namespace cocos2d {
             if(comp->getProperty("node", &nodeVal) && nodeVal.isObject() &&
                 nodeVal.toObject()->getProperty("setContentSize", &funcVal)) {
                 se::ValueArray args;
-                args.push_back(se::Value( OverFlow == LabelOverflow::RESIZE_HEIGHT ? ContentWidth: maxLineWidth));
-                args.push_back(se::Value(TotalTextHeight));
+                args.push_back(se::Value(width));
+                args.push_back(se::Value(height));
                 funcVal.toObject()->call(args, nodeVal.toObject());
             }
         }
-        
-        _textSpace = std::move(textSpaces._data);
+    }
 
-        return true;
+    std::string LabelLayout::getCacheKey() const
+    {
+        const LabelLayoutInfo *info = _layoutInfo;
+        char keybuffer[256] = { 0 };
+        snprintf(keybuffer, sizeof(keybuffer), "%p/%u/%g/%g/%g/%g/%g/%g/%g/%d/%d/%d/%d/%d/",
+            _fontAtlas.get(), _fontAtlas->getFontAtlas()->getGeneration(), _fontSize, info->lineHeight, info->spaceX, info->width, info->height, info->anchorX, info->anchorY,
+            info->wrap, info->underline, (int)info->halign, (int)info->valign, (int)info->overflow);
+        std::string key(keybuffer);
+        key.append(_string);
+        return key;
     }
 
     void LabelLayout::fillAssembler(renderer::CustomAssembler *assembler, EffectVariant *templateEffect)
@@ -802,6 +1014,11 @@ namespace cocos2d {
         if(!_groups) {
             return;
         }
+        // quads refer to frames of letters before they were repacked
+        if (_layoutGeneration != _fontAtlas->getFontAtlas()->getGeneration())
+        {
+            updateContent();
+        }
         _groups->reset();
         int groupIndex = 0;
         if (_textSpace.empty())
@@ -823,6 +1040,8 @@ namespace cocos2d {
         float scale = _scale;
 
         const bool Italics = _layoutInfo->italic;
+        // outline size in the distance field of atlas
+        float outlineSize = _layoutInfo->outlineSize * _outlineScale;
 
         if (_shadowGroups && _layoutInfo->shadowBlur >= 0)
         {
@@ -848,7 +1067,7 @@ namespace cocos2d {
 
             groupIndex = _shadowGroups->fill(assembler, groupIndex,  this, templateEffect);
 
-            Technique::Parameter outlineSizeP(outlineSizeKey, Technique::Parameter::Type::FLOAT, (float*)&(_layoutInfo->outlineSize));
+            Technique::Parameter outlineSizeP(outlineSizeKey, Technique::Parameter::Type::FLOAT, &outlineSize);
             if (_layoutInfo->outlineSize > 0.0f)
             {
                 // use shadow color to replace outline color
@@ -895,7 +1114,7 @@ namespace cocos2d {
         {
             Color4F outlineColor(_layoutInfo->outlineColor);
             Technique::Parameter outlineColorP(outlineColorKey, Technique::Parameter::Type::COLOR4, (float*)&outlineColor);
-            Technique::Parameter outlineSizeP(outlineSizeKey, Technique::Parameter::Type::FLOAT, (float*)&(_layoutInfo->outlineSize));
+            Technique::Parameter outlineSizeP(outlineSizeKey, Technique::Parameter::Type::FLOAT, &outlineSize);
             for (auto i = textStartIndex; i < groupIndex; i++) 
             {
                 auto *e = assembler->getEffect(i);
@@ -905,7 +1124,7 @@ namespace cocos2d {
         }
         else {
             Color4F outlineColor(_layoutInfo->outlineColor);
-            Technique::Parameter outlineSizeP(outlineSizeKey, Technique::Parameter::Type::FLOAT, (float*)&(_layoutInfo->outlineSize));
+            Technique::Parameter outlineSizeP(outlineSizeKey, Technique::Parameter::Type::FLOAT, &outlineSize);
             for (auto i = textStartIndex; i < groupIndex; i++)
             {
                 auto *e = assembler->getEffect(i);
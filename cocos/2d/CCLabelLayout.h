@@ -68,7 +68,11 @@ namespace cocos2d {
         };
 
         TextRowSpace() = default;
-        TextRowSpace(TextRowSpace &&other);
+        TextRowSpace(TextRowSpace &&other) noexcept;
+        TextRowSpace(const TextRowSpace &other) = default;
+        TextRowSpace& operator=(const TextRowSpace &other) = default;
+        // keep the first n blocks only
+        void truncate(size_t n);
 
         void fillRect(int texId, Rect &rect, Rect &uv);
         void translate(float x, float y);
@@ -139,6 +143,22 @@ namespace cocos2d {
 
         bool updateContent();
 
+        // place letters into rows, reusing the rows of the unchanged prefix
+        bool layoutGlyphs();
+
+        void updateNodeSize(float width, float height);
+
+        std::string getCacheKey() const;
+
+        void onLettersReady();
+
+        struct GlyphCursor {
+            size_t rows = 0;
+            size_t blocks = 0;
+            float x = 0.0f;
+            int lastOutline = -1;
+        };
+
     private:
         std::string _string;
         std::u32string _u32string;
@@ -147,6 +167,7 @@ namespace cocos2d {
         float         _retinaFontSize = 0.0f;
         float      _fontScale = 1.0f;
         float       _scale = 1.0f;
+        float      _outlineScale = 1.0f;
 
         //weak reference
         LabelLayoutInfo *_layoutInfo = nullptr;
@@ -158,6 +179,14 @@ namespace cocos2d {
 
         std::vector<TextRowSpace> _textSpace;
 
+        // rows of the last glyph pass, and the cursor before each letter
+        std::vector<TextRowSpace> _glyphRows;
+        std::vector<GlyphCursor> _glyphCursors;
+        std::u32string _glyphText;
+        std::string _glyphInputs;
+        bool _glyphReady = false;
+        uint32_t _layoutGeneration = 0;
+
         std::shared_ptr<TextRenderGroup> _groups;
         std::shared_ptr<TextRenderGroup> _shadowGroups;
         LabelRenderer *_renderer = nullptr;
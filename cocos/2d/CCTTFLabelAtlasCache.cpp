@@ -22,10 +22,12 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 #include "CCTTFLabelAtlasCache.h"
+#include "CCGlyphRasterizer.h"
 
 #include "platform/CCFileUtils.h"
 
 #include <cmath>
+#include <algorithm>
 #include <cassert>
 #include "base/ccConfig.h"
 #if CC_ENABLE_TTF_LABEL_RENDERER
@@ -35,6 +37,10 @@ THE SOFTWARE.
 
 #define FTT_TEXTURE_SIZE 1024
 
+// distance fields are stored as 128 - dist * 16 (see CCFontFreetype.cpp),
+// so outlines wider than 8 atlas pixels are clipped
+#define FTT_SDF_MAX_OUTLINE_SIZE 8.0f
+
 namespace cocos2d {
 
     namespace {
@@ -95,6 +101,9 @@ namespace cocos2d {
     {
         delete _instance;
         _instance = nullptr;
+#if CC_ENABLE_TTF_LABEL_ASYNC_GLYPH
+        GlyphRasterizer::destroyInstance();
+#endif
     }
 
     void TTFLabelAtlasCache::reset()
@@ -104,7 +113,7 @@ namespace cocos2d {
 
     std::shared_ptr<TTFLabelAtlas> TTFLabelAtlasCache::load(const std::string &font, float fontSizeF, LabelLayoutInfo *info)
     {
-        int fontSize = mapFontSize(fontSizeF);
+        int fontSize = atlasFontSizeFor(fontSizeF, info);
         std::string keybuffer = cacheKeyFor(font, fontSize, info);
 #if CC_TTF_LABELATLAS_ENABLE_GC
         std::weak_ptr<TTFLabelAtlas> &atlasWeak= _cache[keybuffer];
@@ -135,12 +144,61 @@ namespace cocos2d {
 
     void TTFLabelAtlasCache::unload(TTFLabelAtlas *atlas)
     {
-        int fontSize = mapFontSize(atlas->_fontSize);
+        int fontSize = atlasFontSizeFor(atlas->_fontSize, atlas->_info);
         std::string key = cacheKeyFor(atlas->_fontName, fontSize, atlas->_info);
         _cache.erase(key);
     }
 
 
+    int TTFLabelAtlasCache::atlasFontSizeFor(float fontSize, LabelLayoutInfo *info) const
+    {
+#if CC_ENABLE_TTF_LABEL_SHARED_SDF
+        // distance fields scale down well, outline or bold labels up to the atlas size use a single atlas,
+        // unless the scaled outline no longer fits in the range of the shared distance field.
+        // larger labels keep an atlas of their own size, upscaled glyphs would lose their edges
+        int mappedSize = mapFontSize(fontSize);
+        if ((info->outlineSize > 0 || info->bold) && mappedSize <= CC_TTF_LABEL_SDF_FONT_SIZE)
+        {
+            float scale = (float)CC_TTF_LABEL_SDF_FONT_SIZE / std::max(1, mappedSize);
+            if (info->outlineSize * scale <= FTT_SDF_MAX_OUTLINE_SIZE)
+            {
+                return CC_TTF_LABEL_SDF_FONT_SIZE;
+            }
+        }
+        return mappedSize;
+#else
+        return mapFontSize(fontSize);
+#endif
+    }
+
+    float TTFLabelAtlasCache::getOutlineScale(const TTFLabelAtlas *atlas, float fontSize) const
+    {
+        return atlas->getFontSize() / std::max(1, mapFontSize(fontSize));
+    }
+
+    TTFLabelAtlasCache::Stats TTFLabelAtlasCache::getStats() const
+    {
+        Stats stats;
+        for (auto &it : _cache)
+        {
+#if CC_TTF_LABELATLAS_ENABLE_GC
+            std::shared_ptr<TTFLabelAtlas> atlas = it.second.lock();
+#else
+            const std::shared_ptr<TTFLabelAtlas> &atlas = it.second;
+#endif
+            if (!atlas || !atlas->getFontAtlas()) continue;
+            FontAtlas *fontAtlas = atlas->getFontAtlas();
+            stats.atlases += 1;
+            stats.pages += fontAtlas->getFrameCount();
+            stats.glyphs += fontAtlas->getLetterCount();
+            stats.textureBytes += fontAtlas->getFrameCount() * fontAtlas->getFrameBytes();
+#if CC_ENABLE_CACHE_TTF_FONT_TEXTURE
+            stats.bufferBytes += fontAtlas->getFrameCount() * fontAtlas->getFrameBytes();
+#endif
+        }
+        return stats;
+    }
+
     std::string TTFLabelAtlasCache::cacheKeyFor(const std::string &font, int fontSize, LabelLayoutInfo * info)
     {
         char keybuffer[512] = { 0 };
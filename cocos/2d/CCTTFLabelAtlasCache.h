@@ -77,10 +77,30 @@ namespace cocos2d {
 
         void unload(TTFLabelAtlas *);
 
+        /**
+         * Ratio between the distance field of atlas and the one of a label of fontSize,
+         * outline sizes of labels sharing an atlas of another size are scaled with it.
+         */
+        float getOutlineScale(const TTFLabelAtlas *atlas, float fontSize) const;
+
+        struct Stats {
+            int atlases = 0;
+            int pages = 0;
+            size_t glyphs = 0;
+            // bytes of frame textures
+            size_t textureBytes = 0;
+            // bytes of frame copies kept in memory
+            size_t bufferBytes = 0;
+        };
+
+        Stats getStats() const;
+
     protected:
 
         std::string cacheKeyFor(const std::string &font, int fontSize, LabelLayoutInfo *info);
 
+        int atlasFontSizeFor(float fontSize, LabelLayoutInfo *info) const;
+
         TTFLabelAtlasCache() {}
     private:
 #if CC_TTF_LABELATLAS_ENABLE_GC
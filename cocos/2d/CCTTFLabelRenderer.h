@@ -100,6 +100,7 @@ namespace cocos2d {
         cocos2d::renderer::NodeProxy* _nodeProxy = nullptr;
         cocos2d::renderer::EffectVariant * _effect = nullptr;
 
+        friend class LabelLayout;
     };
 }
 
@@ -91,6 +91,7 @@ scripting/js-bindings/event/EventDispatcher.cpp \
 ../external/sources/edtaa3func/edtaa3func.h \
 ui/edit-box/EditBox-android.cpp \
 2d/CCFontAtlas.cpp \
+2d/CCGlyphRasterizer.cpp \
 2d/CCFontFreetype.cpp \
 2d/CCLabelLayout.cpp \
 2d/CCTTFLabelAtlasCache.cpp \
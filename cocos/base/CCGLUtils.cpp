@@ -23,6 +23,7 @@
  ****************************************************************************/
 #include "CCGLUtils.h"
 #include "platform/CCApplication.h"
+#include "base/ccPixelKernels.h"
 #include <stdio.h>
 #include <cfloat>
 #include <cassert>
@@ -279,40 +280,9 @@ void ccScissor(GLint x, GLint y, GLsizei width, GLsizei height)
     glScissor(x, y, width, height);
 }
 
-//IDEA:: ONLY SUPPORT RGBA format now.
 static void flipPixelsY(GLubyte *pixels, int bytesPerRow, int rows)
 {
-    if( !pixels ) { return; }
-
-    GLuint middle = rows/2;
-    GLuint intsPerRow = bytesPerRow / sizeof(GLuint);
-    GLuint remainingBytes = bytesPerRow - intsPerRow * sizeof(GLuint);
-
-    for( GLuint rowTop = 0, rowBottom = rows-1; rowTop < middle; rowTop++, rowBottom-- ) {
-
-        // Swap bytes in packs of sizeof(GLuint) bytes
-        GLuint *iTop = (GLuint *)(pixels + rowTop * bytesPerRow);
-        GLuint *iBottom = (GLuint *)(pixels + rowBottom * bytesPerRow);
-
-        GLuint itmp;
-        GLint n = intsPerRow;
-        do {
-            itmp = *iTop;
-            *iTop++ = *iBottom;
-            *iBottom++ = itmp;
-        } while(--n > 0);
-
-        // Swap the remaining bytes
-        GLubyte *bTop = (GLubyte *)iTop;
-        GLubyte *bBottom = (GLubyte *)iBottom;
-
-        GLubyte btmp;
-        switch( remainingBytes ) {
-            case 3: btmp = *bTop; *bTop++ = *bBottom; *bBottom++ = btmp;
-            case 2: btmp = *bTop; *bTop++ = *bBottom; *bBottom++ = btmp;
-            case 1: btmp = *bTop; *bTop = *bBottom; *bBottom = btmp;
-        }
-    }
+    PixelKernels::flipRows(pixels, bytesPerRow, rows);
 }
 
 static void flipPixelsYByFormat(GLubyte *pixels, GLenum format, uint32_t width, uint32_t height, uint32_t expectedTotalBytes)
@@ -376,13 +346,8 @@ void premultiplyPixels(const GLubyte *inPixels, GLubyte *outPixels, GLenum forma
     {
         byteLength = width * height * 4;
         assert(byteLength == expectedTotalBytes);
-        for( int i = 0; i < byteLength; i += 4 ) {
-            unsigned short a = inPixels[i+3] * 256;
-            outPixels[i+0] = table[ a + inPixels[i+0] ];
-            outPixels[i+1] = table[ a + inPixels[i+1] ];
-            outPixels[i+2] = table[ a + inPixels[i+2] ];
-            outPixels[i+3] = inPixels[i+3];
-        }
+        // same values as the table, computed in vector registers
+        PixelKernels::premultiplyRGBA8888Rounded(inPixels, outPixels, width * height);
     }
     else if ( format == GL_LUMINANCE_ALPHA )
     {
@@ -27,221 +27,462 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
-#include "base/utlist.h"
-#include "base/ccCArray.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
 
 #define CC_REPEAT_FOREVER (UINT_MAX -1)
 
-NS_CC_BEGIN
+// The timing wheel has 4 levels of 64 slots and a level 0 slot is 1 millisecond,
+// so the levels cover 64ms, 4s, 4min and 4.6 hours. Farther callbacks are cascaded again.
+#define TIMER_WHEEL_TICK (0.001)
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+// Callbacks with 0 interval are triggered every frame
+#define TIMER_PER_FRAME_BUCKET (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS)
+#define TIMER_BUCKET_COUNT (TIMER_PER_FRAME_BUCKET + 1)
+#define TIMER_NO_BUCKET (0xffff)
+#define TIMER_NONE (0xffffffff)
+// Handles keep 21 bits of generation, so they're exact in JavaScript numbers.
+#define TIMER_MAX_GENERATION (0x1fffff)
+// Tolerance of accumulated frame time
+#define TIMER_EPSILON (1e-6)
 
-// data structures
+NS_CC_BEGIN
 
-// A list double-linked list used for "updates with priority"
-typedef struct _listEntry
+namespace
 {
-    struct _listEntry   *prev, *next;
-    ccSchedulerFunc     callback;
-    void                *target;
-    int                 priority;
-    bool                paused;
-    bool                markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
-} tListEntry;
+    enum TimerState
+    {
+        TIMER_FREE,
+        TIMER_PENDING,      // Waiting for the end of the next update to start counting
+        TIMER_SCHEDULED,
+        TIMER_PAUSED,
+        TIMER_REMOVED       // Unscheduled while its callback is being invoked
+    };
+}
+
+// implementation of Scheduler
 
-typedef struct _hashUpdateEntry
+// Node of the lock-free queue used by performFunctionInCocosThread
+struct Scheduler::PerformFunctionNode
 {
-    tListEntry          **list;        // Which list does it belong to ?
-    tListEntry          *entry;        // entry in the list
-    void                *target;
-    ccSchedulerFunc     callback;
-    UT_hash_handle      hh;
-} tHashUpdateEntry;
+    PerformFunctionNode() : priority(0), next(nullptr) {}
+
+    std::function<void()> function;
+    int priority;
+    std::atomic<PerformFunctionNode*> next;
+};
 
-// Hash Element used for "selectors with interval"
-typedef struct _hashSelectorEntry
+Scheduler::Scheduler()
+: _triggeringTimer(TIMER_NONE)
+, _functionsToPerformCount(0)
 {
-    ccArray             *timers;
-    void                *target;
-    int                 timerIndex;
-    Timer               *currentTimer;
-    bool                currentTimerSalvaged;
-    bool                paused;
-    UT_hash_handle      hh;
-} tHashTimerEntry;
+    _bucketHeads.assign(TIMER_BUCKET_COUNT, TIMER_NONE);
 
-// implementation Timer
+    // The head of the queue is always a consumed node, so producers never touch it.
+    _performQueueHead = new (std::nothrow) PerformFunctionNode();
+    _performQueueTail.store(_performQueueHead);
+}
 
-Timer::Timer()
+Scheduler::~Scheduler(void)
 {
+    unscheduleAll();
+
+    while (_performQueueHead != nullptr)
+    {
+        PerformFunctionNode* next = _performQueueHead->next.load();
+        delete _performQueueHead;
+        _performQueueHead = next;
+    }
 }
 
-void Timer::setupTimerWithInterval(float seconds, unsigned int repeat, float delay)
+TimerHandle Scheduler::makeHandle(uint32_t index) const
 {
-    _elapsed = -1;
-    _interval = seconds;
-    _delay = delay;
-    _useDelay = (_delay > 0.0f) ? true : false;
-    _repeat = repeat;
-    _runForever = (_repeat == CC_REPEAT_FOREVER) ? true : false;
+    return ((TimerHandle)_timers[index].generation << 32) | index;
 }
 
-void Timer::update(float dt)
+uint32_t Scheduler::findTimer(TimerHandle handle) const
 {
-    if (_elapsed == -1)
+    uint32_t index = (uint32_t)(handle & 0xffffffff);
+    uint32_t generation = (uint32_t)(handle >> 32);
+    if (index >= _timers.size())
     {
-        _elapsed = 0;
-        _timesExecuted = 0;
-        return;
+        return TIMER_NONE;
     }
 
-    // accumulate elapsed time
-    _elapsed += dt;
+    const TimerEntry& entry = _timers[index];
+    if (entry.generation != generation || entry.state == TIMER_FREE || entry.state == TIMER_REMOVED)
+    {
+        return TIMER_NONE;
+    }
+    return index;
+}
 
-    // deal with delay
-    if (_useDelay)
+TimerHandle Scheduler::addTimer(const ccSchedulerFunc& callback, void *target, const std::string& key, float interval, unsigned int repeat, float delay, bool paused)
+{
+    uint32_t index = 0;
+    if (!_freeTimers.empty())
     {
-        if (_elapsed < _delay)
-        {
-            return;
-        }
-        trigger(_delay);
-        _elapsed = _elapsed - _delay;
-        _timesExecuted += 1;
-        _useDelay = false;
-        // after delay, the rest time should compare with interval
-        if (!_runForever && _timesExecuted > _repeat)
-        {    //unschedule timer
-            cancel();
-            return;
-        }
+        index = _freeTimers.back();
+        _freeTimers.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)_timers.size();
+        _timers.emplace_back();
+        _timers.back().generation = 1;
     }
 
-    // if _interval == 0, should trigger once every frame
-    float interval = (_interval > 0) ? _interval : _elapsed;
-    while (_elapsed >= interval)
+    TimerEntry& entry = _timers[index];
+    entry.callback = callback;
+    entry.target = target;
+    entry.key = key;
+    entry.interval = interval;
+    entry.delay = delay;
+    entry.useDelay = delay > 0.0f;
+    entry.repeat = repeat;
+    entry.timesExecuted = 0;
+    entry.bucket = TIMER_NO_BUCKET;
+    entry.state = TIMER_PENDING;
+
+    TargetEntry& targetEntry = _targets[target];
+    if (targetEntry.timers.empty())
     {
-        trigger(interval);
-        _elapsed -= interval;
-        _timesExecuted += 1;
+        // Is this the 1st timer ? Then set the pause level to all the timers of this target
+        targetEntry.paused = paused;
+    }
+    else
+    {
+        CCASSERT(targetEntry.paused == paused, "element's paused should be paused!");
+    }
+    targetEntry.timers.push_back(index);
 
-        if (!_runForever && _timesExecuted > _repeat)
-        {
-            cancel();
-            break;
-        }
+    TimerHandle handle = makeHandle(index);
+    _timersToArm.push_back(handle);
+    return handle;
+}
 
-        if (_elapsed <= 0.f)
-        {
-            break;
-        }
-        
-        if (_scheduler->isCurrentTargetSalvaged())
+void Scheduler::removeTimer(uint32_t index)
+{
+    TimerEntry& entry = _timers[index];
+
+    auto iter = _targets.find(entry.target);
+    if (iter != _targets.end())
+    {
+        auto& timers = iter->second.timers;
+        timers.erase(std::find(timers.begin(), timers.end(), index));
+        if (timers.empty())
         {
-            break;
+            _targets.erase(iter);
         }
     }
-}
 
-// TimerTargetCallback
+    if (entry.bucket != TIMER_NO_BUCKET)
+    {
+        unlinkTimer(index);
+    }
 
-TimerTargetCallback::TimerTargetCallback()
-{
+    if (index == _triggeringTimer)
+    {
+        // The callback is still running, it's released after it returns.
+        entry.state = TIMER_REMOVED;
+        return;
+    }
+    releaseTimer(index);
 }
 
-bool TimerTargetCallback::initWithCallback(Scheduler* scheduler, const ccSchedulerFunc& callback, void *target, const std::string& key, float seconds, unsigned int repeat, float delay)
+void Scheduler::releaseTimer(uint32_t index)
 {
-    _scheduler = scheduler;
-    _target = target;
-    _callback = callback;
-    _key = key;
-    setupTimerWithInterval(seconds, repeat, delay);
-    return true;
+    TimerEntry& entry = _timers[index];
+    entry.callback = nullptr;
+    entry.target = nullptr;
+    entry.key.clear();
+    entry.state = TIMER_FREE;
+    // Invalidates the handles of the released callback
+    entry.generation = (entry.generation % TIMER_MAX_GENERATION) + 1;
+    _freeTimers.push_back(index);
 }
 
-void TimerTargetCallback::trigger(float dt)
+void Scheduler::armTimer(uint32_t index)
 {
-    if (_callback)
+    TimerEntry& entry = _timers[index];
+    entry.expire = _currentTime + (entry.useDelay ? entry.delay : entry.interval);
+
+    auto iter = _targets.find(entry.target);
+    if (iter != _targets.end() && iter->second.paused)
+    {
+        entry.expire -= _currentTime;
+        entry.state = TIMER_PAUSED;
+    }
+    else
     {
-        _callback(dt);
+        insertTimer(index);
     }
 }
 
-void TimerTargetCallback::cancel()
+void Scheduler::insertTimer(uint32_t index)
 {
-    _scheduler->unschedule(_key, _target);
+    TimerEntry& entry = _timers[index];
+    entry.state = TIMER_SCHEDULED;
+
+    if (!entry.useDelay && entry.interval <= 0.0f)
+    {
+        linkTimer(index, TIMER_PER_FRAME_BUCKET);
+        return;
+    }
+
+    int64_t tick = std::max((int64_t)(entry.expire / TIMER_WHEEL_TICK), _wheelTick);
+    int64_t delta = tick - _wheelTick;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= ((int64_t)1 << ((level + 1) * TIMER_WHEEL_SLOT_BITS)))
+    {
+        ++level;
+    }
+
+    const int64_t maxDelta = ((int64_t)1 << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1;
+    if (delta > maxDelta)
+    {
+        // Too far away, it will be cascaded again when the top level slot is reached.
+        tick = _wheelTick + maxDelta;
+    }
+
+    int slot = (int)((tick >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK);
+    linkTimer(index, (uint16_t)(level * TIMER_WHEEL_SLOTS + slot));
 }
 
-// implementation of Scheduler
+void Scheduler::linkTimer(uint32_t index, uint16_t bucket)
+{
+    // Buckets are circular lists, new timers are appended to the tail.
+    TimerEntry& entry = _timers[index];
+    entry.bucket = bucket;
 
-Scheduler::Scheduler()
+    uint32_t head = _bucketHeads[bucket];
+    if (head == TIMER_NONE)
+    {
+        entry.prev = entry.next = index;
+        _bucketHeads[bucket] = index;
+    }
+    else
+    {
+        uint32_t tail = _timers[head].prev;
+        entry.prev = tail;
+        entry.next = head;
+        _timers[tail].next = index;
+        _timers[head].prev = index;
+    }
+}
+
+void Scheduler::unlinkTimer(uint32_t index)
 {
-    // I don't expect to have more than 30 functions to all per frame
-    _functionsToPerform.reserve(30);
+    TimerEntry& entry = _timers[index];
+    uint16_t bucket = entry.bucket;
+    entry.bucket = TIMER_NO_BUCKET;
+
+    if (entry.next == index)
+    {
+        _bucketHeads[bucket] = TIMER_NONE;
+        return;
+    }
+
+    _timers[entry.prev].next = entry.next;
+    _timers[entry.next].prev = entry.prev;
+    if (_bucketHeads[bucket] == index)
+    {
+        _bucketHeads[bucket] = entry.next;
+    }
 }
 
-Scheduler::~Scheduler(void)
+void Scheduler::pauseTimer(uint32_t index)
 {
-    unscheduleAll();
+    TimerEntry& entry = _timers[index];
+    if (entry.state != TIMER_SCHEDULED)
+    {
+        return;
+    }
+
+    if (entry.bucket != TIMER_NO_BUCKET)
+    {
+        unlinkTimer(index);
+    }
+    // Keeps the time left until it's resumed
+    entry.expire -= _currentTime;
+    entry.state = TIMER_PAUSED;
 }
 
-void Scheduler::removeHashElement(_hashSelectorEntry *element)
+void Scheduler::resumeTimer(uint32_t index)
 {
-    ccArrayFree(element->timers);
-    HASH_DEL(_hashForTimers, element);
-    free(element);
+    TimerEntry& entry = _timers[index];
+    if (entry.state != TIMER_PAUSED)
+    {
+        return;
+    }
+
+    entry.expire += _currentTime;
+    if (index == _triggeringTimer)
+    {
+        // It's inserted again after its callback returns.
+        entry.state = TIMER_SCHEDULED;
+        return;
+    }
+    insertTimer(index);
 }
 
-void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
+void Scheduler::collectDueTimers(uint16_t bucket)
 {
-    this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
+    uint32_t index = _bucketHeads[bucket];
+    if (index == TIMER_NONE)
+    {
+        return;
+    }
+
+    // Only the slot of the current tick may contain timers which are not due yet.
+    uint32_t tail = _timers[index].prev;
+    while (true)
+    {
+        uint32_t next = _timers[index].next;
+        bool isTail = (index == tail);
+        if (_timers[index].expire <= _currentTime + TIMER_EPSILON)
+        {
+            unlinkTimer(index);
+            _dueTimers.push_back(makeHandle(index));
+        }
+
+        if (isTail)
+        {
+            break;
+        }
+        index = next;
+    }
 }
 
-void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, const std::string& key)
+void Scheduler::advanceTimers()
 {
-    CCASSERT(target, "Argument target must be non-nullptr");
-    CCASSERT(!key.empty(), "key should not be empty!");
+    const int64_t nowTick = (int64_t)((_currentTime + TIMER_EPSILON) / TIMER_WHEEL_TICK);
 
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    // Timers of the current tick which were not due in the last frame
+    collectDueTimers((uint16_t)(_wheelTick & TIMER_WHEEL_SLOT_MASK));
 
-    if (! element)
+    while (_wheelTick < nowTick)
     {
-        element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
-        element->target = target;
+        ++_wheelTick;
 
-        HASH_ADD_PTR(_hashForTimers, target, element);
+        // Moves timers of upper levels down when a lower level completes a round.
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; ++level)
+        {
+            if ((_wheelTick & (((int64_t)1 << (level * TIMER_WHEEL_SLOT_BITS)) - 1)) != 0)
+            {
+                break;
+            }
 
-        // Is this the 1st element ? Then set the pause level to all the selectors of this target
-        element->paused = paused;
+            uint16_t bucket = (uint16_t)(level * TIMER_WHEEL_SLOTS + ((_wheelTick >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK));
+            uint32_t index = _bucketHeads[bucket];
+            while (index != TIMER_NONE)
+            {
+                unlinkTimer(index);
+                insertTimer(index);
+                index = _bucketHeads[bucket];
+            }
+        }
+
+        collectDueTimers((uint16_t)(_wheelTick & TIMER_WHEEL_SLOT_MASK));
     }
-    else
+}
+
+void Scheduler::triggerTimer(uint32_t index, float dt)
+{
+    TimerEntry& entry = _timers[index];
+    if (entry.bucket != TIMER_NO_BUCKET)
     {
-        CCASSERT(element->paused == paused, "element's paused should be paused!");
+        unlinkTimer(index);
     }
 
-    if (element->timers == nullptr)
+    while (true)
     {
-        element->timers = ccArrayNew(10);
+        float triggerDt = dt;
+        if (entry.useDelay)
+        {
+            triggerDt = entry.delay;
+            entry.useDelay = false;
+        }
+        else if (entry.interval > 0.0f)
+        {
+            triggerDt = entry.interval;
+        }
+
+        _triggeringTimer = index;
+        if (entry.callback)
+        {
+            entry.callback(triggerDt);
+        }
+        _triggeringTimer = TIMER_NONE;
+
+        if (entry.state == TIMER_REMOVED)
+        {
+            releaseTimer(index);
+            return;
+        }
+
+        entry.timesExecuted += 1;
+        if (entry.repeat != CC_REPEAT_FOREVER && entry.timesExecuted > entry.repeat)
+        {
+            removeTimer(index);
+            return;
+        }
+
+        // If it was paused by the callback, 'expire' is the time left which works as well.
+        entry.expire += entry.interval;
+        if (entry.state == TIMER_PAUSED)
+        {
+            return;
+        }
+
+        // Triggers it again if more than one interval passed in this frame
+        if (entry.interval > 0.0f && entry.expire <= _currentTime + TIMER_EPSILON)
+        {
+            continue;
+        }
+
+        insertTimer(index);
+        return;
     }
-    else
+}
+
+void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
+{
+    this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
+}
+
+void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, const std::string& key)
+{
+    CCASSERT(target, "Argument target must be non-nullptr");
+    CCASSERT(!key.empty(), "key should not be empty!");
+
+    auto iter = _targets.find(target);
+    if (iter != _targets.end())
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        for (auto index : iter->second.timers)
         {
-            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
-
-            if (timer && key == timer->getKey())
+            TimerEntry& entry = _timers[index];
+            if (key == entry.key)
             {
-                CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
-                timer->setInterval(interval);
+                CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", entry.interval, interval);
+                entry.interval = interval;
                 return;
             }
         }
-        ccArrayEnsureExtraCapacity(element->timers, 1);
     }
 
-    TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
-    timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
-    timer->release();
+    addTimer(callback, target, key, interval, repeat, delay, paused);
+}
+
+TimerHandle Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused)
+{
+    CCASSERT(target, "Argument target must be non-nullptr");
+    return addTimer(callback, target, "", interval, repeat, delay, paused);
 }
 
 void Scheduler::unschedule(const std::string &key, void *target)
@@ -252,96 +493,67 @@ void Scheduler::unschedule(const std::string &key, void *target)
         return;
     }
 
-    //CCASSERT(target);
-    //CCASSERT(selector);
-
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-
-    if (element)
+    auto iter = _targets.find(target);
+    if (iter != _targets.end())
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        for (auto index : iter->second.timers)
         {
-            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
-
-            if (timer && key == timer->getKey())
+            if (key == _timers[index].key)
             {
-                if (timer == element->currentTimer && (! element->currentTimerSalvaged))
-                {
-                    element->currentTimer->retain();
-                    element->currentTimerSalvaged = true;
-                }
-
-                ccArrayRemoveObjectAtIndex(element->timers, i, true);
-
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-
-                if (element->timers->num == 0)
-                {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
-                }
-
+                removeTimer(index);
                 return;
             }
         }
     }
 }
 
+void Scheduler::unschedule(TimerHandle handle)
+{
+    uint32_t index = findTimer(handle);
+    if (index != TIMER_NONE)
+    {
+        removeTimer(index);
+    }
+}
+
 bool Scheduler::isScheduled(const std::string& key, void *target)
 {
     CCASSERT(!key.empty(), "Argument key must not be empty");
     CCASSERT(target, "Argument target must be non-nullptr");
 
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-
-    if (!element)
+    auto iter = _targets.find(target);
+    if (iter == _targets.end())
     {
         return false;
     }
 
-    if (element->timers == nullptr)
-    {
-        return false;
-    }
-    else
+    for (auto index : iter->second.timers)
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        if (key == _timers[index].key)
         {
-            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
-
-            if (timer && key == timer->getKey())
-            {
-                return true;
-            }
+            return true;
         }
-
-        return false;
     }
+    return false;
+}
 
-    return false;  // should never get here
+bool Scheduler::isScheduled(TimerHandle handle) const
+{
+    return findTimer(handle) != TIMER_NONE;
 }
 
 void Scheduler::unscheduleAll()
 {
-    for (tHashTimerEntry *element = _hashForTimers, *nextElement = nullptr; element != nullptr;)
+    std::vector<void*> targets;
+    targets.reserve(_targets.size());
+    for (const auto& e : _targets)
+    {
+        targets.push_back(e.first);
+    }
+
+    for (auto target : targets)
     {
-        // element may be removed in unscheduleAllSelectorsForTarget
-        nextElement = (tHashTimerEntry *)element->hh.next;
-        unscheduleAllForTarget(element->target);
-        
-        element = nextElement;
+        unscheduleAllForTarget(target);
     }
 }
 
@@ -353,27 +565,14 @@ void Scheduler::unscheduleAllForTarget(void *target)
         return;
     }
 
-    // Custom Selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-
-    if (element)
+    auto iter = _targets.find(target);
+    if (iter != _targets.end())
     {
-        if (ccArrayContainsObject(element->timers, element->currentTimer)
-            && (! element->currentTimerSalvaged))
-        {
-            element->currentTimer->retain();
-            element->currentTimerSalvaged = true;
-        }
-        ccArrayRemoveAllObjects(element->timers);
-
-        if (_currentTarget == element)
+        // The target entry is erased with its last timer
+        std::vector<uint32_t> timers = iter->second.timers;
+        for (auto index : timers)
         {
-            _currentTargetSalvaged = true;
-        }
-        else
-        {
-            removeHashElement(element);
+            removeTimer(index);
         }
     }
 }
@@ -382,12 +581,14 @@ void Scheduler::resumeTarget(void *target)
 {
     CCASSERT(target != nullptr, "target can't be nullptr!");
 
-    // custom selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    auto iter = _targets.find(target);
+    if (iter != _targets.end() && iter->second.paused)
     {
-        element->paused = false;
+        iter->second.paused = false;
+        for (auto index : iter->second.timers)
+        {
+            resumeTimer(index);
+        }
     }
 }
 
@@ -395,12 +596,14 @@ void Scheduler::pauseTarget(void *target)
 {
     CCASSERT(target != nullptr, "target can't be nullptr!");
 
-    // custom selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    auto iter = _targets.find(target);
+    if (iter != _targets.end() && !iter->second.paused)
     {
-        element->paused = true;
+        iter->second.paused = true;
+        for (auto index : iter->second.timers)
+        {
+            pauseTimer(index);
+        }
     }
 }
 
@@ -408,12 +611,10 @@ bool Scheduler::isTargetPaused(void *target)
 {
     CCASSERT( target != nullptr, "target must be non nil" );
 
-    // Custom selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    if( element )
+    auto iter = _targets.find(target);
+    if (iter != _targets.end())
     {
-        return element->paused;
+        return iter->second.paused;
     }
 
     return false;  // should never get here
@@ -422,15 +623,17 @@ bool Scheduler::isTargetPaused(void *target)
 std::set<void*> Scheduler::pauseAllTargets()
 {
     std::set<void*> idsWithSelectors;
-    
-    // Custom Selectors
-    for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
-        element = (tHashTimerEntry*)element->hh.next)
+
+    for (const auto& e : _targets)
     {
-        element->paused = true;
-        idsWithSelectors.insert(element->target);
+        idsWithSelectors.insert(e.first);
     }
-    
+
+    for (auto target : idsWithSelectors)
+    {
+        pauseTarget(target);
+    }
+
     return idsWithSelectors;
 }
 
@@ -441,83 +644,142 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
     }
 }
 
-void Scheduler::performFunctionInCocosThread(const std::function<void ()> &function)
+void Scheduler::performFunctionInCocosThread(const std::function<void ()> &function, int priority)
 {
-    _performMutex.lock();
-    _functionsToPerform.push_back(function);
-    _performMutex.unlock();
+    PerformFunctionNode* node = new (std::nothrow) PerformFunctionNode();
+    node->function = function;
+    node->priority = priority;
+
+    // Multi-producer queue: claim the tail, then link the previous tail to the new node.
+    // The consumer stops at an unlinked node and picks the rest up in the next frame.
+    PerformFunctionNode* prev = _performQueueTail.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
 }
 
 void Scheduler::removeAllFunctionsToBePerformedInCocosThread()
 {
     std::unique_lock<std::mutex> lock(_performMutex);
+    collectFunctionsToPerform();
     _functionsToPerform.clear();
+    _functionsToPerformCount = 0;
 }
 
-// main loop
-void Scheduler::update(float dt)
+// Moves functions from the lock-free queue to '_functionsToPerform', '_performMutex' has to be locked.
+void Scheduler::collectFunctionsToPerform()
 {
-    _updateHashLocked = true;
+    PerformFunctionNode* next = nullptr;
+    while ((next = _performQueueHead->next.load(std::memory_order_acquire)) != nullptr)
+    {
+        delete _performQueueHead;
+        _performQueueHead = next;
+        _functionsToPerform[next->priority].push_back(std::move(next->function));
+        next->function = nullptr;
+        ++_functionsToPerformCount;
+    }
+}
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
+void Scheduler::performFunctions()
+{
+    // Testing the queue is faster than locking / unlocking.
+    // And almost never there will be functions scheduled to be called.
+    if (_functionsToPerformCount == 0 && _performQueueHead->next.load(std::memory_order_acquire) == nullptr)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+        _performStats.performed = 0;
+        _performStats.pending = 0;
+        _performStats.elapsed = 0.0f;
+        return;
+    }
 
-        if (! _currentTarget->paused)
-        {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                elt->currentTimerSalvaged = false;
+    auto start = std::chrono::steady_clock::now();
+    unsigned int performed = 0;
+    float elapsed = 0.0f;
 
-                elt->currentTimer->update(dt);
+    {
+        std::lock_guard<std::mutex> lock(_performMutex);
+        // Functions added while performing are left to the next frame.
+        collectFunctionsToPerform();
+    }
 
-                if (elt->currentTimerSalvaged)
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
+    while (true)
+    {
+        // fixed #4123: The callback functions must be invoked after '_performMutex' is unlocked, otherwise if new functions are added in callback, it will cause thread deadlock.
+        std::function<void()> function;
+        {
+            std::lock_guard<std::mutex> lock(_performMutex);
+            if (_functionsToPerform.empty())
+            {
+                break;
+            }
 
-                elt->currentTimer = nullptr;
+            auto iter = _functionsToPerform.begin();
+            function = std::move(iter->second.front());
+            iter->second.pop_front();
+            if (iter->second.empty())
+            {
+                _functionsToPerform.erase(iter);
             }
+            --_functionsToPerformCount;
         }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
+        function();
+        ++performed;
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
+        elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (_performTimeBudget > 0.0f && elapsed >= _performTimeBudget)
         {
-            removeHashElement(_currentTarget);
+            break;
         }
     }
 
-    _updateHashLocked = false;
-    _currentTarget = nullptr;
+    _performStats.performed = performed;
+    _performStats.pending = _functionsToPerformCount;
+    _performStats.elapsed = elapsed;
+    _performStats.maxElapsed = std::max(_performStats.maxElapsed, elapsed);
+}
 
-    //
-    // Functions allocated from another thread
-    //
+// main loop
+void Scheduler::update(float dt)
+{
+    _currentTime += dt;
 
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = _functionsToPerform;
-        _functionsToPerform.clear();
-        _performMutex.unlock();
-        for( const auto &function : temp ) {
-            function();
+    // Timers triggered every frame go first, they're collected before the others which may join them.
+    for (uint32_t index = _bucketHeads[TIMER_PER_FRAME_BUCKET], head = index; index != TIMER_NONE; )
+    {
+        _dueTimers.push_back(makeHandle(index));
+        index = _timers[index].next;
+        if (index == head)
+        {
+            break;
         }
+    }
+    advanceTimers();
 
+    for (size_t i = 0; i < _dueTimers.size(); ++i)
+    {
+        // Callbacks may unschedule or pause the others
+        uint32_t index = findTimer(_dueTimers[i]);
+        if (index != TIMER_NONE && _timers[index].state == TIMER_SCHEDULED)
+        {
+            triggerTimer(index, dt);
+        }
     }
+    _dueTimers.clear();
+
+    // Callbacks scheduled before this point start counting from now, like the first update of Timer did.
+    for (size_t i = 0; i < _timersToArm.size(); ++i)
+    {
+        uint32_t index = findTimer(_timersToArm[i]);
+        if (index != TIMER_NONE && _timers[index].state == TIMER_PENDING)
+        {
+            armTimer(index);
+        }
+    }
+    _timersToArm.clear();
+
+    //
+    // Functions allocated from another thread
+    //
+    performFunctions();
 }
 
 NS_CC_END
@@ -27,13 +27,20 @@ THE SOFTWARE.
 ****************************************************************************/
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <map>
 #include <mutex>
 #include <set>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "base/CCRef.h"
 #include "base/CCVector.h"
-#include "base/uthash.h"
 
 NS_CC_BEGIN
 
@@ -41,73 +48,14 @@ class Scheduler;
 
 typedef std::function<void(float)> ccSchedulerFunc;
 
-/**
- * @cond
- */
-class CC_DLL Timer : public Ref
-{
-public:
-    /** get interval in seconds */
-    inline float getInterval() const { return _interval; };
-    /** set interval in seconds */
-    inline void setInterval(float interval) { _interval = interval; };
-
-    void setupTimerWithInterval(float seconds, unsigned int repeat, float delay);
-
-    virtual void trigger(float dt) = 0;
-    virtual void cancel() = 0;
-
-    /** triggers the timer */
-    void update(float dt);
-    
-protected:
-    Timer();
-
-protected:
-
-    Scheduler* _scheduler = nullptr;
-    float _elapsed = 0.f;
-    bool _runForever = false;
-    bool _useDelay = false;
-    unsigned int _timesExecuted = 0;
-    unsigned int _repeat = 0; //0 = once, 1 is 2 x executed
-    float _delay = 0.f;
-    float _interval = 0.f;
-};
-
-class CC_DLL TimerTargetCallback final : public Timer
-{
-public:
-    TimerTargetCallback();
-
-    // Initializes a timer with a target, a lambda and an interval in seconds, repeat in number of times to repeat, delay in seconds.
-    bool initWithCallback(Scheduler* scheduler, const ccSchedulerFunc& callback, void *target, const std::string& key, float seconds, unsigned int repeat, float delay);
-
-    inline const ccSchedulerFunc& getCallback() const { return _callback; };
-    inline const std::string& getKey() const { return _key; };
-
-    virtual void trigger(float dt) override;
-    virtual void cancel() override;
-
-protected:
-    void* _target = nullptr;
-    ccSchedulerFunc _callback = nullptr;
-    std::string _key;
-};
-
-/**
- * @endcond
- */
+/** Identifies a callback scheduled without a key, 0 is never a valid handle. */
+typedef uint64_t TimerHandle;
 
 /**
  * @addtogroup base
  * @{
  */
 
-struct _listEntry;
-struct _hashSelectorEntry;
-struct _hashUpdateEntry;
-
 /** @brief Scheduler is responsible for triggering the scheduled callbacks.
 You should not use system timer for your game logic. Instead, use this class.
 
@@ -176,6 +124,12 @@ public:
      */
     void schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key);
 
+    /** Schedules a callback like the method above, but identifies it with the returned handle instead of a key.
+     Unlike keys, handles are never reused by another callback, so it's cheap to unschedule or check it later.
+     @return The handle of the scheduled callback.
+     */
+    TimerHandle schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused);
+
     /////////////////////////////////////
 
     // unschedule
@@ -188,6 +142,11 @@ public:
      */
     void unschedule(const std::string& key, void *target);
 
+    /** Unschedules a callback by the handle returned by 'schedule'.
+     Nothing happens if the callback was already unscheduled.
+     */
+    void unschedule(TimerHandle handle);
+
     /** Unschedules all selectors for a given target.
      This also includes the "update" selector.
      @param target The target to be unscheduled.
@@ -222,6 +181,10 @@ public:
      */
     bool isScheduled(const std::string& key, void *target);
 
+    /** Checks whether a callback associated with the handle is scheduled.
+     */
+    bool isScheduled(TimerHandle handle) const;
+
     /////////////////////////////////////
 
     /** Pauses the target.
@@ -270,12 +233,39 @@ public:
     void resumeTargets(const std::set<void*>& targetsToResume);
 
     /** Calls a function on the cocos2d thread. Useful when you need to call a cocos2d function from another thread.
-     This function is thread safe.
+     This function is thread safe and lock free.
      @param function The function to be run in cocos2d thread.
+     @param priority Functions with higher priority are run first, functions with the same priority are run in order.
      @since v3.0
      @js NA
      */
-    void performFunctionInCocosThread( const std::function<void()> &function);
+    void performFunctionInCocosThread( const std::function<void()> &function, int priority = 0);
+
+    /** Statistics of functions performed in cocos2d thread, updated every frame. */
+    struct PerformFunctionStats
+    {
+        // Number of functions performed in the last frame.
+        unsigned int performed = 0;
+        // Number of functions left to the next frames because of the time budget.
+        unsigned int pending = 0;
+        // Milliseconds spent on performing functions in the last frame.
+        float elapsed = 0.0f;
+        // The max of 'elapsed' since the scheduler was created.
+        float maxElapsed = 0.0f;
+    };
+
+    /**
+     * Sets the milliseconds could be spent on performing functions in a frame, the rest functions are left to the next frames.
+     * At least one function is performed every frame. 0 means no limit, it's the default value.
+     * @js NA
+     */
+    void setPerformFunctionTimeBudget(float milliseconds) { _performTimeBudget = milliseconds; }
+    float getPerformFunctionTimeBudget() const { return _performTimeBudget; }
+
+    /**
+     * @js NA
+     */
+    const PerformFunctionStats& getPerformFunctionStats() const { return _performStats; }
 
     /**
      * Remove all pending functions queued to be performed with Scheduler::performFunctionInCocosThread
@@ -285,25 +275,74 @@ public:
      * @js NA
      */
     void removeAllFunctionsToBePerformedInCocosThread();
-    
-    bool isCurrentTargetSalvaged () const { return _currentTargetSalvaged; };
 
 private:
-    void removeHashElement(struct _hashSelectorEntry *element);
-    void removeUpdateFromHash(struct _listEntry *entry);
-
-    // update specific
-
-    // Used for "selectors with interval"
-    struct _hashSelectorEntry *_hashForTimers = nullptr;
-    struct _hashSelectorEntry *_currentTarget = nullptr;
-    bool _currentTargetSalvaged = false;
-    // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
-    bool _updateHashLocked = false;
+    // Scheduled callbacks are stored in a slab and indexed by a hierarchical timing wheel,
+    // so a frame only visits the callbacks which are due instead of all of them.
+    struct TimerEntry
+    {
+        ccSchedulerFunc callback;
+        void* target = nullptr;
+        std::string key;
+        double expire = 0;          // Time to be triggered, or time left while it's paused
+        float interval = 0;
+        float delay = 0;
+        unsigned int repeat = 0;
+        unsigned int timesExecuted = 0;
+        uint32_t generation = 0;
+        uint32_t prev = 0;          // Links of the bucket list
+        uint32_t next = 0;
+        uint16_t bucket = 0;
+        uint8_t state = 0;
+        bool useDelay = false;
+    };
+
+    struct TargetEntry
+    {
+        std::vector<uint32_t> timers;
+        bool paused = false;
+    };
+
+    TimerHandle addTimer(const ccSchedulerFunc& callback, void *target, const std::string& key, float interval, unsigned int repeat, float delay, bool paused);
+    uint32_t findTimer(TimerHandle handle) const;
+    void removeTimer(uint32_t index);
+    void releaseTimer(uint32_t index);
+    void armTimer(uint32_t index);
+    void insertTimer(uint32_t index);
+    void linkTimer(uint32_t index, uint16_t bucket);
+    void unlinkTimer(uint32_t index);
+    void pauseTimer(uint32_t index);
+    void resumeTimer(uint32_t index);
+    void advanceTimers();
+    void collectDueTimers(uint16_t bucket);
+    void triggerTimer(uint32_t index, float dt);
+    TimerHandle makeHandle(uint32_t index) const;
+
+    std::deque<TimerEntry> _timers; // Never moves entries, callbacks can schedule while being invoked
+    std::vector<uint32_t> _freeTimers;
+    std::vector<uint32_t> _bucketHeads;
+    std::unordered_map<void*, TargetEntry> _targets;
+    // Callbacks scheduled since the last frame, they start counting from the end of the next update.
+    std::vector<TimerHandle> _timersToArm;
+    std::vector<TimerHandle> _dueTimers;
+    double _currentTime = 0;
+    int64_t _wheelTick = 0;
+    uint32_t _triggeringTimer;
+
+    void collectFunctionsToPerform();
+    void performFunctions();
 
     // Used for "perform Function"
-    std::vector<std::function<void()>> _functionsToPerform;
+    // Other threads push functions to a lock-free queue, the cocos2d thread moves them to '_functionsToPerform'
+    // ordered by priority. '_performMutex' is only used by the consumer side.
+    struct PerformFunctionNode;
+    std::atomic<PerformFunctionNode*> _performQueueTail;
+    PerformFunctionNode* _performQueueHead = nullptr;
+    std::map<int, std::deque<std::function<void()>>, std::greater<int>> _functionsToPerform;
+    std::atomic<unsigned int> _functionsToPerformCount;
     std::mutex _performMutex;
+    float _performTimeBudget = 0.0f;
+    PerformFunctionStats _performStats;
 };
 
 // end of base group
@@ -46,9 +46,11 @@ namespace cocos2d {
 #define DEFAULT_STRETCH_STEP (2)
 
 static ThreadPool *__defaultThreadPool = nullptr;
+static std::mutex __defaultThreadPoolMutex;
 
 ThreadPool *ThreadPool::getDefaultThreadPool()
 {
+    std::lock_guard<std::mutex> lk(__defaultThreadPoolMutex);
     if (__defaultThreadPool == nullptr)
     {
         __defaultThreadPool = newCachedThreadPool(DEFAULT_THREAD_POOL_MIN_NUM,
@@ -62,6 +64,7 @@ ThreadPool *ThreadPool::getDefaultThreadPool()
 
 void ThreadPool::destroyDefaultThreadPool()
 {
+    std::lock_guard<std::mutex> lk(__defaultThreadPoolMutex);
     delete __defaultThreadPool;
     __defaultThreadPool = nullptr;
 }
@@ -249,6 +252,7 @@ void ThreadPool::pushTask(const std::function<void(int)>& runnable,
 {
     if (!_isFixedSize)
     {
+        std::lock_guard<std::mutex> resizeLock(_resizeMutex);
         _idleThreadNumMutex.lock();
         int idleNum = _idleThreadNum;
         _idleThreadNumMutex.unlock();
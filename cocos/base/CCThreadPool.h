@@ -94,7 +94,7 @@ public:
     /* Pushs a task to thread pool
      *  @param runnable The callback of the task executed in sub thread
      *  @param type The task type, it's TASK_TYPE_DEFAULT if this argument isn't assigned
-     *  @note This function has to be invoked in cocos thread
+     *  @note This function may be invoked from any thread
      */
     void pushTask(const std::function<void(int /*threadId*/)>& runnable, TaskType type = TaskType::DEFAULT);
 
@@ -221,6 +221,9 @@ private:
     std::mutex _mutex;
     std::condition_variable _cv;
 
+    // guards shrinking and stretching of the pool, tasks may be pushed from any thread
+    std::mutex _resizeMutex;
+
     int _minThreadNum;
     int _maxThreadNum;
     int _initedThreadNum;
@@ -506,6 +506,15 @@ struct ZipEntryInfo
     uLong uncompressed_size;
 };
 
+// Location of a file in the mapped archive, read from the central directory
+struct ZipIndexedEntry
+{
+    uLong localHeaderOffset;
+    uLong compressedSize;
+    uLong uncompressedSize;
+    unsigned short method;
+};
+
 class ZipFilePrivate
 {
 public:
@@ -514,8 +523,62 @@ public:
     // std::unordered_map is faster if available on the platform
     typedef std::unordered_map<std::string, struct ZipEntryInfo> FileListContainer;
     FileListContainer fileList;
+
+    // Empty if the archive can't be mapped or indexed, e.g. zip64 and encrypted archives.
+    std::shared_ptr<const MappedFile> archive;
+    std::unordered_map<std::string, ZipIndexedEntry> indexedFiles;
 };
 
+namespace
+{
+    #define ZIP_LOCAL_HEADER_SIGNATURE 0x04034b50
+    #define ZIP_LOCAL_HEADER_SIZE 30
+    #define ZIP_CENTRAL_HEADER_SIGNATURE 0x02014b50
+    #define ZIP_CENTRAL_HEADER_SIZE 46
+    #define ZIP_END_OF_CENTRAL_DIR_SIGNATURE 0x06054b50
+    #define ZIP_END_OF_CENTRAL_DIR_SIZE 22
+    #define ZIP_METHOD_STORED 0
+    #define ZIP_METHOD_DEFLATED 8
+    // Size of the decompressed chunks passed to ZipFile::readFile
+    #define ZIP_READ_CHUNK_SIZE (256 * 1024)
+
+    inline uint16_t readUInt16(const unsigned char* p)
+    {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    inline uint32_t readUInt32(const unsigned char* p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    // Returns the compressed data of an indexed file in the mapped archive, or nullptr if it isn't indexed.
+    const unsigned char* findIndexedData(const ZipFilePrivate* zipData, const std::string &fileName, const ZipIndexedEntry** entry)
+    {
+        if (!zipData->archive)
+            return nullptr;
+
+        auto it = zipData->indexedFiles.find(fileName);
+        if (it == zipData->indexedFiles.end())
+            return nullptr;
+
+        const unsigned char* bytes = zipData->archive->getBytes();
+        const size_t size = (size_t)zipData->archive->getSize();
+
+        // The local header may have a different extra field from the central directory.
+        const unsigned char* header = bytes + it->second.localHeaderOffset;
+        if (readUInt32(header) != ZIP_LOCAL_HEADER_SIGNATURE)
+            return nullptr;
+
+        size_t dataOffset = it->second.localHeaderOffset + ZIP_LOCAL_HEADER_SIZE + readUInt16(header + 26) + readUInt16(header + 28);
+        if (dataOffset + it->second.compressedSize > size)
+            return nullptr;
+
+        *entry = &it->second;
+        return bytes + dataOffset;
+    }
+}
+
 ZipFile *ZipFile::createWithBuffer(const void* buffer, uLong size)
 {
     ZipFile *zip = new (std::nothrow) ZipFile();
@@ -540,9 +603,141 @@ ZipFile::ZipFile(const std::string &zipFile, const std::string &filter)
         std::lock_guard<std::mutex> lock(_readMutex);
         _data->zipFile = unzOpen(FileUtils::getInstance()->getSuitableFOpen(zipFile).c_str());
     }
+    if (_data->zipFile)
+    {
+        // Only mapped archives are indexed, the others are read by unzip instead of loading them whole.
+        auto archive = FileUtils::getInstance()->mapFile(zipFile);
+        if (archive && archive->isMapped())
+        {
+            indexArchive(archive);
+        }
+    }
     setFilter(filter);
 }
 
+void ZipFile::indexArchive(const std::shared_ptr<const MappedFile>& archive)
+{
+    if (!archive || archive->isNull())
+        return;
+
+    const unsigned char* bytes = archive->getBytes();
+    const size_t size = (size_t)archive->getSize();
+    if (size < ZIP_END_OF_CENTRAL_DIR_SIZE)
+        return;
+
+    // The end of central directory record is followed by a comment of at most 64KB.
+    size_t eocd = size - ZIP_END_OF_CENTRAL_DIR_SIZE;
+    size_t minEocd = eocd > 0xffff ? eocd - 0xffff : 0;
+    while (readUInt32(bytes + eocd) != ZIP_END_OF_CENTRAL_DIR_SIGNATURE)
+    {
+        if (eocd == minEocd)
+            return;
+        --eocd;
+    }
+
+    uLong count = readUInt16(bytes + eocd + 10);
+    uLong offset = readUInt32(bytes + eocd + 16);
+    // zip64 archives are left to unzip
+    if (count == 0xffff || offset == 0xffffffff)
+        return;
+
+    std::unordered_map<std::string, ZipIndexedEntry> indexedFiles;
+    indexedFiles.reserve(count);
+    for (uLong i = 0; i < count; ++i)
+    {
+        if (offset + ZIP_CENTRAL_HEADER_SIZE > eocd || readUInt32(bytes + offset) != ZIP_CENTRAL_HEADER_SIGNATURE)
+            return;
+
+        const unsigned char* header = bytes + offset;
+        uint16_t flags = readUInt16(header + 8);
+        uint16_t nameLength = readUInt16(header + 28);
+        uint16_t extraLength = readUInt16(header + 30);
+        uint16_t commentLength = readUInt16(header + 32);
+        if (offset + ZIP_CENTRAL_HEADER_SIZE + nameLength > eocd)
+            return;
+
+        ZipIndexedEntry entry;
+        entry.method = readUInt16(header + 10);
+        entry.compressedSize = readUInt32(header + 20);
+        entry.uncompressedSize = readUInt32(header + 24);
+        entry.localHeaderOffset = readUInt32(header + 42);
+
+        // Encrypted files and other methods are read by unzip.
+        bool supported = (flags & 1) == 0
+            && (entry.method == ZIP_METHOD_STORED || entry.method == ZIP_METHOD_DEFLATED)
+            && entry.compressedSize != 0xffffffff && entry.uncompressedSize != 0xffffffff
+            && entry.localHeaderOffset + ZIP_LOCAL_HEADER_SIZE <= size;
+        if (supported)
+        {
+            indexedFiles.emplace(std::string((const char*)header + ZIP_CENTRAL_HEADER_SIZE, nameLength), entry);
+        }
+
+        offset += ZIP_CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+    }
+
+    _data->archive = archive;
+    _data->indexedFiles.swap(indexedFiles);
+}
+
+bool ZipFile::readIndexedFile(const std::string &fileName, ResizableBuffer* buffer, std::shared_ptr<const MappedFile>* mapped) const
+{
+    const ZipIndexedEntry* indexedEntry = nullptr;
+    const unsigned char* data = findIndexedData(_data, fileName, &indexedEntry);
+    if (!data)
+        return false;
+
+    const ZipIndexedEntry& entry = *indexedEntry;
+    if (entry.method == ZIP_METHOD_STORED)
+    {
+        if (mapped)
+        {
+            // The slice keeps the whole archive mapped.
+            auto archive = _data->archive;
+            *mapped = std::make_shared<MappedFile>(data, (ssize_t)entry.uncompressedSize, [archive](){});
+        }
+        else
+        {
+            buffer->resize(entry.uncompressedSize);
+            if (entry.uncompressedSize > 0)
+                memcpy(buffer->buffer(), data, entry.uncompressedSize);
+        }
+        return true;
+    }
+
+    Data inflated;
+    ResizableBufferAdapter<Data> inflatedBuffer(&inflated);
+    if (!buffer)
+        buffer = &inflatedBuffer;
+
+    buffer->resize(entry.uncompressedSize);
+
+    // Raw deflate stream, every call has its own stream so it needs no lock.
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        return false;
+
+    stream.next_in = (Bytef*)data;
+    stream.avail_in = (uInt)entry.compressedSize;
+    stream.next_out = (Bytef*)buffer->buffer();
+    stream.avail_out = (uInt)entry.uncompressedSize;
+    int err = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+
+    if (err != Z_STREAM_END || stream.total_out != entry.uncompressedSize)
+    {
+        CCLOG("ZipFile: failed to inflate %s, error: %d", fileName.c_str(), err);
+        buffer->resize(0);
+        return false;
+    }
+
+    if (mapped)
+    {
+        *mapped = std::make_shared<MappedFile>(std::move(inflated));
+    }
+    return true;
+}
+
 ZipFile::~ZipFile()
 {
     if (_data && _data->zipFile)
@@ -623,6 +818,20 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
     {
         CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
+        CC_BREAK_IF(!fileExists(fileName));
+
+        Data data;
+        ResizableBufferAdapter<Data> dataBuffer(&data);
+        if (readIndexedFile(fileName, &dataBuffer, nullptr))
+        {
+            ssize_t dataSize = 0;
+            buffer = data.takeBuffer(&dataSize);
+            if (size)
+            {
+                *size = dataSize;
+            }
+            break;
+        }
 
         std::lock_guard<std::mutex> lock(_readMutex);
         ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
@@ -657,6 +866,13 @@ bool ZipFile::getFileData(const std::string &fileName, ResizableBuffer* buffer)
     {
         CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
+        CC_BREAK_IF(!fileExists(fileName));
+
+        if (readIndexedFile(fileName, buffer, nullptr))
+        {
+            res = true;
+            break;
+        }
 
         std::lock_guard<std::mutex> lock(_readMutex);
         ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
@@ -680,6 +896,113 @@ bool ZipFile::getFileData(const std::string &fileName, ResizableBuffer* buffer)
     return res;
 }
 
+std::shared_ptr<const MappedFile> ZipFile::getMappedFile(const std::string &fileName)
+{
+    if (!_data->zipFile || fileName.empty() || !fileExists(fileName))
+        return nullptr;
+
+    std::shared_ptr<const MappedFile> mapped;
+    if (readIndexedFile(fileName, nullptr, &mapped))
+        return mapped;
+
+    Data data;
+    ResizableBufferAdapter<Data> dataBuffer(&data);
+    if (!getFileData(fileName, &dataBuffer))
+        return nullptr;
+
+    return std::make_shared<MappedFile>(std::move(data));
+}
+
+bool ZipFile::readFile(const std::string &fileName, const std::function<bool(const unsigned char* chunk, size_t size)> &callback)
+{
+    if (!_data->zipFile || fileName.empty() || !fileExists(fileName))
+        return false;
+
+    const ZipIndexedEntry* entry = nullptr;
+    const unsigned char* data = findIndexedData(_data, fileName, &entry);
+    if (data && entry->method == ZIP_METHOD_STORED)
+    {
+        return entry->uncompressedSize == 0 || callback(data, entry->uncompressedSize);
+    }
+
+    std::unique_ptr<unsigned char[]> chunk(new (std::nothrow) unsigned char[ZIP_READ_CHUNK_SIZE]);
+    if (!chunk)
+        return false;
+
+    if (data)
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+            return false;
+
+        stream.next_in = (Bytef*)data;
+        stream.avail_in = (uInt)entry->compressedSize;
+        int err = Z_OK;
+        bool aborted = false;
+        do
+        {
+            stream.next_out = chunk.get();
+            stream.avail_out = ZIP_READ_CHUNK_SIZE;
+            err = inflate(&stream, Z_NO_FLUSH);
+            size_t produced = ZIP_READ_CHUNK_SIZE - stream.avail_out;
+            if (produced > 0 && !callback(chunk.get(), produced))
+            {
+                aborted = true;
+                break;
+            }
+        } while (err == Z_OK);
+        inflateEnd(&stream);
+
+        if (aborted)
+            return false;
+        if (err != Z_STREAM_END || stream.total_out != entry->uncompressedSize)
+        {
+            CCLOG("ZipFile: failed to inflate %s, error: %d", fileName.c_str(), err);
+            return false;
+        }
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(_readMutex);
+    ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
+    if (it == _data->fileList.end())
+        return false;
+
+    ZipEntryInfo fileInfo = it->second;
+    if (unzGoToFilePos(_data->zipFile, &fileInfo.pos) != UNZ_OK || unzOpenCurrentFile(_data->zipFile) != UNZ_OK)
+        return false;
+
+    int read = 0;
+    while ((read = unzReadCurrentFile(_data->zipFile, chunk.get(), ZIP_READ_CHUNK_SIZE)) > 0)
+    {
+        if (!callback(chunk.get(), (size_t)read))
+        {
+            read = -1;
+            break;
+        }
+    }
+    unzCloseCurrentFile(_data->zipFile);
+    return read == 0;
+}
+
+unsigned long ZipFile::getFileSize(const std::string &fileName) const
+{
+    auto it = _data->fileList.find(fileName);
+    return it != _data->fileList.end() ? it->second.uncompressed_size : 0;
+}
+
+std::vector<std::string> ZipFile::listFiles() const
+{
+    std::vector<std::string> files;
+    files.reserve(_data->fileList.size());
+    for (const auto& file : _data->fileList)
+    {
+        files.push_back(file.first);
+    }
+    return files;
+}
+
 std::string ZipFile::getFirstFilename()
 {
     {
@@ -726,6 +1049,9 @@ bool ZipFile::initWithBuffer(const void *buffer, uLong size)
     }
     if (!_data->zipFile) return false;
 
+    // The buffer is owned by the caller and outlives this instance.
+    indexArchive(std::make_shared<MappedFile>((const unsigned char*)buffer, (ssize_t)size, [](){}));
+
     setFilter(emptyFilename);
     return true;
 }
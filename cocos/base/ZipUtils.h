@@ -31,6 +31,8 @@ THE SOFTWARE.
 #include "base/ccMacros.h"
 #include "platform/CCFileUtils.h"
 #include <string>
+#include <vector>
+#include <functional>
 #include <mutex>
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
@@ -217,6 +219,10 @@ typedef struct unz_file_info_s unz_file_info;
     * It will cache the file list of a particular zip file with positions inside an archive,
     * so it would be much faster to read some particular files or to check their existence.
     *
+    * When the archive can be memory-mapped, its central directory is also indexed,
+    * then stored files are read as slices of the mapping and deflated ones are inflated without locking,
+    * so multiple threads can read files from the same archive in parallel.
+    *
     * @since v2.0.5
     */
     class CC_DLL ZipFile
@@ -274,6 +280,35 @@ typedef struct unz_file_info_s unz_file_info;
         */
         bool getFileData(const std::string &fileName, ResizableBuffer* buffer);
 
+        /**
+        * Get resource file data from a zip file without copying it when possible.
+        * Stored files refer to the mapped archive directly, the others are decompressed into memory.
+        * @param fileName File name
+        * @return The file data, or nullptr if the file can't be read.
+        */
+        std::shared_ptr<const MappedFile> getMappedFile(const std::string &fileName);
+
+        /**
+        * Decompress a file of the zip file chunk by chunk, so that big files never have to fit in memory.
+        * Like getMappedFile, indexed files are read without locking and can be read from several threads.
+        * @param fileName File name
+        * @param callback Receives the decompressed chunks in order, returns false to stop reading.
+        * @return True if the whole file has been passed to callback.
+        */
+        bool readFile(const std::string &fileName, const std::function<bool(const unsigned char* chunk, size_t size)> &callback);
+
+        /**
+        * Get the uncompressed size of a file in the zip file.
+        * @param fileName File name
+        * @return The file size, or 0 if the file doesn't exist.
+        */
+        unsigned long getFileSize(const std::string &fileName) const;
+
+        /**
+        * Get the names of all accessible files, directory entries included.
+        */
+        std::vector<std::string> listFiles() const;
+
         std::string getFirstFilename();
         std::string getNextFilename();
 
@@ -286,6 +321,11 @@ typedef struct unz_file_info_s unz_file_info;
         bool initWithBuffer(const void *buffer, unsigned long size);
         int getCurrentFileInfo(std::string *filename, unz_file_info *info);
 
+        // Indexes the central directory of the mapped archive
+        void indexArchive(const std::shared_ptr<const MappedFile>& archive);
+        // Reads a file from the mapped archive, returns false if it has to be read by unzip
+        bool readIndexedFile(const std::string &fileName, ResizableBuffer* buffer, std::shared_ptr<const MappedFile>* mapped) const;
+
         /** Internal data like zip file pointer / file list array and so on */
         ZipFilePrivate *_data;
         std::mutex _readMutex;
@@ -26,6 +26,7 @@
 
 #include "base/astc.h"
 #include "platform/CCImage.h"
+#include <string.h>
 
 static const unsigned int MAGIC = 0x5CA1AB13;
 static const astc_byte ASTC_HEADER_SIZE_X_BEGIN = 7;
@@ -64,3 +65,624 @@ int astcGetHeight(const astc_byte* pHeader) {
     int ysize = pHeader[ASTC_HEADER_SIZE_Y_BEGIN] + (pHeader[ASTC_HEADER_SIZE_Y_BEGIN + 1] * 256) + (pHeader[ASTC_HEADER_SIZE_Y_BEGIN + 2] * 65536);
     return ysize;
 }
+
+int astcGetBlockWidth(const astc_byte* pHeader) {
+    return pHeader[ASTC_HEADER_MAGIC];
+}
+
+int astcGetBlockHeight(const astc_byte* pHeader) {
+    return pHeader[ASTC_HEADER_MAGIC + 1];
+}
+
+// Software decoder of the LDR profile, it follows the block decoding of the
+// Khronos Data Format Specification. Values are decoded to 16 bits and the
+// top 8 bits are kept, like the decode_unorm8 mode of the GPU.
+
+#define ASTC_MAX_WEIGHTS 64
+#define ASTC_MAX_TEXELS 144
+#define ASTC_MAX_COLOR_VALUES 18
+
+namespace {
+    // integer sequence encoding of each quantization level, from 2 to 256 levels
+    const astc_byte ISE_BITS[21]   = { 1, 0, 2, 0, 1, 3, 1, 2, 4, 2, 3, 5, 3, 4, 6, 4, 5, 7, 5, 6, 8 };
+    const astc_byte ISE_TRITS[21]  = { 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0 };
+    const astc_byte ISE_QUINTS[21] = { 0, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0 };
+    // weights use the first 12 levels, color endpoints need at least 6 levels
+    const int QUANT_6 = 4;
+    const int QUANT_256 = 20;
+
+    struct Bits {
+        uint64_t lo;
+        uint64_t hi;
+
+        // bits from end on are read as zero
+        uint32_t read(int offset, int count, int end = 128) const {
+            if (count <= 0 || offset >= end) return 0;
+            if (offset + count > end) count = end - offset;
+            uint64_t v;
+            if (offset >= 64) {
+                v = hi >> (offset - 64);
+            } else {
+                v = lo >> offset;
+                if (offset > 0) v |= hi << (64 - offset);
+            }
+            return (uint32_t)(v & ((1ull << count) - 1));
+        }
+    };
+
+    uint64_t reverse64(uint64_t v) {
+        v = ((v >> 1) & 0x5555555555555555ull) | ((v & 0x5555555555555555ull) << 1);
+        v = ((v >> 2) & 0x3333333333333333ull) | ((v & 0x3333333333333333ull) << 2);
+        v = ((v >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((v & 0x0F0F0F0F0F0F0F0Full) << 4);
+        v = ((v >> 8) & 0x00FF00FF00FF00FFull) | ((v & 0x00FF00FF00FF00FFull) << 8);
+        v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+        return (v >> 32) | (v << 32);
+    }
+
+    int iseBitCount(int count, int quant) {
+        return count * ISE_BITS[quant] +
+               (ISE_TRITS[quant] ? (8 * count + 4) / 5 : 0) +
+               (ISE_QUINTS[quant] ? (7 * count + 2) / 3 : 0);
+    }
+
+    void decodeTrits(int T, int t[5]) {
+        int C;
+        if (((T >> 2) & 7) == 7) {
+            C = (((T >> 5) & 7) << 2) | (T & 3);
+            t[4] = 2;
+            t[3] = 2;
+        } else {
+            C = T & 0x1F;
+            if (((T >> 5) & 3) == 3) {
+                t[4] = 2;
+                t[3] = (T >> 7) & 1;
+            } else {
+                t[4] = (T >> 7) & 1;
+                t[3] = (T >> 5) & 3;
+            }
+        }
+        if ((C & 3) == 3) {
+            t[2] = 2;
+            t[1] = (C >> 4) & 1;
+            t[0] = ((C >> 2) & 2) | ((C >> 2) & 1 & ~(C >> 3));
+        } else if (((C >> 2) & 3) == 3) {
+            t[2] = 2;
+            t[1] = 2;
+            t[0] = C & 3;
+        } else {
+            t[2] = (C >> 4) & 1;
+            t[1] = (C >> 2) & 3;
+            t[0] = (C & 2) | (C & 1 & ~(C >> 1));
+        }
+    }
+
+    void decodeQuints(int Q, int q[3]) {
+        if (((Q >> 1) & 3) == 3 && ((Q >> 5) & 3) == 0) {
+            int low = Q & 1;
+            q[2] = (low << 2) | ((((Q >> 4) & 1) & ~low) << 1) | (((Q >> 3) & 1) & ~low);
+            q[1] = 4;
+            q[0] = 4;
+        } else {
+            int C;
+            if (((Q >> 1) & 3) == 3) {
+                q[2] = 4;
+                C = (((Q >> 3) & 3) << 3) | ((~(Q >> 5) & 3) << 1) | (Q & 1);
+            } else {
+                q[2] = (Q >> 5) & 3;
+                C = Q & 0x1F;
+            }
+            if ((C & 7) == 5) {
+                q[1] = 4;
+                q[0] = (C >> 3) & 3;
+            } else {
+                q[1] = (C >> 3) & 3;
+                q[0] = C & 7;
+            }
+        }
+    }
+
+    // values are stored as (trit or quint << bits) | bits
+    void decodeISE(const Bits& bits, int offset, int count, int quant, int* values) {
+        const int n = ISE_BITS[quant];
+        const int end = offset + iseBitCount(count, quant);
+        if (ISE_TRITS[quant]) {
+            for (int i = 0; i < count; i += 5) {
+                int m[5];
+                int T = 0;
+                m[0] = bits.read(offset, n, end); offset += n;
+                T |= bits.read(offset, 2, end); offset += 2;
+                m[1] = bits.read(offset, n, end); offset += n;
+                T |= bits.read(offset, 2, end) << 2; offset += 2;
+                m[2] = bits.read(offset, n, end); offset += n;
+                T |= bits.read(offset, 1, end) << 4; offset += 1;
+                m[3] = bits.read(offset, n, end); offset += n;
+                T |= bits.read(offset, 2, end) << 5; offset += 2;
+                m[4] = bits.read(offset, n, end); offset += n;
+                T |= bits.read(offset, 1, end) << 7; offset += 1;
+                int t[5];
+                decodeTrits(T, t);
+                for (int j = 0; j < 5 && i + j < count; ++j) {
+                    values[i + j] = (t[j] << n) | m[j];
+                }
+            }
+        } else if (ISE_QUINTS[quant]) {
+            for (int i = 0; i < count; i += 3) {
+                int m[3];
+                int Q = 0;
+                m[0] = bits.read(offset, n, end); offset += n;
+                Q |= bits.read(offset, 3, end); offset += 3;
+                m[1] = bits.read(offset, n, end); offset += n;
+                Q |= bits.read(offset, 2, end) << 3; offset += 2;
+                m[2] = bits.read(offset, n, end); offset += n;
+                Q |= bits.read(offset, 2, end) << 5; offset += 2;
+                int q[3];
+                decodeQuints(Q, q);
+                for (int j = 0; j < 3 && i + j < count; ++j) {
+                    values[i + j] = (q[j] << n) | m[j];
+                }
+            }
+        } else {
+            for (int i = 0; i < count; ++i) {
+                values[i] = bits.read(offset, n, end);
+                offset += n;
+            }
+        }
+    }
+
+    int replicateBits(int value, int bits, int target) {
+        int result = 0;
+        int shift = target;
+        while (shift > 0) {
+            shift -= bits;
+            result |= shift >= 0 ? value << shift : value >> -shift;
+        }
+        return result;
+    }
+
+    // to 0..255
+    int unquantizeColor(int value, int quant) {
+        const int n = ISE_BITS[quant];
+        if (!ISE_TRITS[quant] && !ISE_QUINTS[quant]) {
+            return replicateBits(value, n, 8);
+        }
+        const int m = value & ((1 << n) - 1);
+        const int D = value >> n;
+        const int A = (m & 1) ? 0x1FF : 0;
+        const int b = (m >> 1) & 1, c = (m >> 2) & 1, d = (m >> 3) & 1, e = (m >> 4) & 1, f = (m >> 5) & 1;
+        int B = 0, C = 0;
+        if (ISE_TRITS[quant]) {
+            switch (n) {
+                case 1: C = 204; break;
+                case 2: C = 93; B = (b << 8) | (b << 4) | (b << 2) | (b << 1); break;
+                case 3: C = 44; B = (c << 8) | (b << 7) | (c << 3) | (b << 2) | (c << 1) | b; break;
+                case 4: C = 22; B = (d << 8) | (c << 7) | (b << 6) | (d << 2) | (c << 1) | b; break;
+                case 5: C = 11; B = (e << 8) | (d << 7) | (c << 6) | (b << 5) | (e << 1) | d; break;
+                case 6: C = 5; B = (f << 8) | (e << 7) | (d << 6) | (c << 5) | (b << 4) | f; break;
+            }
+        } else {
+            switch (n) {
+                case 1: C = 113; break;
+                case 2: C = 54; B = (b << 8) | (b << 3) | (b << 2); break;
+                case 3: C = 26; B = (c << 8) | (b << 7) | (c << 2) | (b << 1) | c; break;
+                case 4: C = 13; B = (d << 8) | (c << 7) | (b << 6) | (d << 1) | c; break;
+                case 5: C = 6; B = (e << 8) | (d << 7) | (c << 6) | (b << 5) | e; break;
+            }
+        }
+        int T = (D * C + B) ^ A;
+        return (A & 0x80) | (T >> 2);
+    }
+
+    // to 0..64
+    int unquantizeWeight(int value, int quant) {
+        const int n = ISE_BITS[quant];
+        int T;
+        if (!ISE_TRITS[quant] && !ISE_QUINTS[quant]) {
+            T = replicateBits(value, n, 6);
+        } else if (n == 0) {
+            static const int TRITS[3] = { 0, 32, 63 };
+            static const int QUINTS[5] = { 0, 16, 32, 47, 63 };
+            T = ISE_TRITS[quant] ? TRITS[value] : QUINTS[value];
+        } else {
+            const int m = value & ((1 << n) - 1);
+            const int D = value >> n;
+            const int A = (m & 1) ? 0x7F : 0;
+            const int b = (m >> 1) & 1, c = (m >> 2) & 1;
+            int B = 0, C = 0;
+            if (ISE_TRITS[quant]) {
+                switch (n) {
+                    case 1: C = 50; break;
+                    case 2: C = 23; B = (b << 6) | (b << 2) | b; break;
+                    case 3: C = 11; B = (c << 6) | (b << 5) | (c << 1) | b; break;
+                }
+            } else {
+                switch (n) {
+                    case 1: C = 28; break;
+                    case 2: C = 13; B = (b << 6) | (b << 1); break;
+                }
+            }
+            T = (D * C + B) ^ A;
+            T = (A & 0x20) | (T >> 2);
+        }
+        return T > 32 ? T + 1 : T;
+    }
+
+    bool decodeBlockMode(int mode, int& gridWidth, int& gridHeight, bool& dualPlane, int& quant) {
+        int R = (mode >> 4) & 1;
+        int H = (mode >> 9) & 1;
+        int D = (mode >> 10) & 1;
+        const int A = (mode >> 5) & 3;
+        if ((mode & 3) != 0) {
+            R |= (mode & 3) << 1;
+            int B = (mode >> 7) & 3;
+            switch ((mode >> 2) & 3) {
+                case 0: gridWidth = B + 4; gridHeight = A + 2; break;
+                case 1: gridWidth = B + 8; gridHeight = A + 2; break;
+                case 2: gridWidth = A + 2; gridHeight = B + 8; break;
+                default:
+                    B &= 1;
+                    if (mode & 0x100) {
+                        gridWidth = B + 2;
+                        gridHeight = A + 2;
+                    } else {
+                        gridWidth = A + 2;
+                        gridHeight = B + 6;
+                    }
+                    break;
+            }
+        } else {
+            R |= ((mode >> 2) & 3) << 1;
+            if (((mode >> 2) & 3) == 0) return false;
+            const int B = (mode >> 9) & 3;
+            switch ((mode >> 7) & 3) {
+                case 0: gridWidth = 12; gridHeight = A + 2; break;
+                case 1: gridWidth = A + 2; gridHeight = 12; break;
+                case 2:
+                    gridWidth = A + 6;
+                    gridHeight = B + 6;
+                    D = 0;
+                    H = 0;
+                    break;
+                default:
+                    if (A == 0) {
+                        gridWidth = 6;
+                        gridHeight = 10;
+                    } else if (A == 1) {
+                        gridWidth = 10;
+                        gridHeight = 6;
+                    } else {
+                        return false;
+                    }
+                    break;
+            }
+        }
+        dualPlane = D != 0;
+        quant = (R - 2) + 6 * H;
+        return true;
+    }
+
+    uint32_t hash52(uint32_t p) {
+        p ^= p >> 15;
+        p -= p << 17;
+        p += p << 7;
+        p += p << 4;
+        p ^= p >> 5;
+        p += p << 16;
+        p ^= p >> 7;
+        p ^= p >> 3;
+        p ^= p << 6;
+        p ^= p >> 17;
+        return p;
+    }
+
+    // partition of each texel, from the hash of the partition index
+    struct PartitionHash {
+        uint32_t rnum;
+        int partitions;
+        int shift;
+        uint8_t seeds[8];
+
+        PartitionHash(int seed, int partitions, bool smallBlock)
+        : partitions(partitions)
+        , shift(smallBlock ? 1 : 0) {
+            seed += (partitions - 1) * 1024;
+            rnum = hash52((uint32_t)seed);
+            int sh1, sh2;
+            if (seed & 1) {
+                sh1 = (seed & 2) ? 4 : 5;
+                sh2 = partitions == 3 ? 6 : 5;
+            } else {
+                sh1 = partitions == 3 ? 6 : 5;
+                sh2 = (seed & 2) ? 4 : 5;
+            }
+            for (int i = 0; i < 8; ++i) {
+                int s = (rnum >> (i * 4)) & 0xF;
+                seeds[i] = (uint8_t)((s * s) >> ((i & 1) ? sh2 : sh1));
+            }
+        }
+
+        // the z terms of 3D blocks are left out
+        int select(int x, int y) const {
+            x <<= shift;
+            y <<= shift;
+            int a = (seeds[0] * x + seeds[1] * y + (rnum >> 14)) & 0x3F;
+            int b = (seeds[2] * x + seeds[3] * y + (rnum >> 10)) & 0x3F;
+            int c = (seeds[4] * x + seeds[5] * y + (rnum >> 6)) & 0x3F;
+            int d = (seeds[6] * x + seeds[7] * y + (rnum >> 2)) & 0x3F;
+            if (partitions < 4) d = 0;
+            if (partitions < 3) c = 0;
+            if (a >= b && a >= c && a >= d) return 0;
+            if (b >= c && b >= d) return 1;
+            if (c >= d) return 2;
+            return 3;
+        }
+    };
+
+    int clampColor(int v) {
+        return v < 0 ? 0 : (v > 255 ? 255 : v);
+    }
+
+    void bitTransferSigned(int& a, int& b) {
+        b >>= 1;
+        b |= a & 0x80;
+        a >>= 1;
+        a &= 0x3F;
+        if (a & 0x20) a -= 0x40;
+    }
+
+    void setColor(int* e, int r, int g, int b, int a) {
+        e[0] = clampColor(r);
+        e[1] = clampColor(g);
+        e[2] = clampColor(b);
+        e[3] = clampColor(a);
+    }
+
+    void setBlueContracted(int* e, int r, int g, int b, int a) {
+        setColor(e, (r + b) >> 1, (g + b) >> 1, b, a);
+    }
+
+    // returns false for HDR modes
+    bool decodeEndpoints(int mode, int* v, int* e0, int* e1) {
+        switch (mode) {
+            case 0:
+                setColor(e0, v[0], v[0], v[0], 0xFF);
+                setColor(e1, v[1], v[1], v[1], 0xFF);
+                return true;
+            case 1: {
+                int l0 = (v[0] >> 2) | (v[1] & 0xC0);
+                int l1 = l0 + (v[1] & 0x3F);
+                setColor(e0, l0, l0, l0, 0xFF);
+                setColor(e1, l1, l1, l1, 0xFF);
+                return true;
+            }
+            case 4:
+                setColor(e0, v[0], v[0], v[0], v[2]);
+                setColor(e1, v[1], v[1], v[1], v[3]);
+                return true;
+            case 5:
+                bitTransferSigned(v[1], v[0]);
+                bitTransferSigned(v[3], v[2]);
+                setColor(e0, v[0], v[0], v[0], v[2]);
+                setColor(e1, v[0] + v[1], v[0] + v[1], v[0] + v[1], v[2] + v[3]);
+                return true;
+            case 6:
+                setColor(e0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, 0xFF);
+                setColor(e1, v[0], v[1], v[2], 0xFF);
+                return true;
+            case 8:
+            case 12: {
+                const int a0 = mode == 12 ? v[6] : 0xFF;
+                const int a1 = mode == 12 ? v[7] : 0xFF;
+                if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4]) {
+                    setColor(e0, v[0], v[2], v[4], a0);
+                    setColor(e1, v[1], v[3], v[5], a1);
+                } else {
+                    setBlueContracted(e0, v[1], v[3], v[5], a1);
+                    setBlueContracted(e1, v[0], v[2], v[4], a0);
+                }
+                return true;
+            }
+            case 9:
+            case 13: {
+                bitTransferSigned(v[1], v[0]);
+                bitTransferSigned(v[3], v[2]);
+                bitTransferSigned(v[5], v[4]);
+                int a0 = 0xFF, a1 = 0xFF;
+                if (mode == 13) {
+                    bitTransferSigned(v[7], v[6]);
+                    a0 = v[6];
+                    a1 = v[6] + v[7];
+                }
+                if (v[1] + v[3] + v[5] >= 0) {
+                    setColor(e0, v[0], v[2], v[4], a0);
+                    setColor(e1, v[0] + v[1], v[2] + v[3], v[4] + v[5], a1);
+                } else {
+                    setBlueContracted(e0, v[0] + v[1], v[2] + v[3], v[4] + v[5], a1);
+                    setBlueContracted(e1, v[0], v[2], v[4], a0);
+                }
+                return true;
+            }
+            case 10:
+                setColor(e0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, v[4]);
+                setColor(e1, v[0], v[1], v[2], v[5]);
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    void fillColor(astc_byte* out, int texels, int r, int g, int b, int a) {
+        for (int i = 0; i < texels; ++i, out += 4) {
+            out[0] = (astc_byte)r;
+            out[1] = (astc_byte)g;
+            out[2] = (astc_byte)b;
+            out[3] = (astc_byte)a;
+        }
+    }
+
+    void fillError(astc_byte* out, int texels) {
+        fillColor(out, texels, 0xFF, 0, 0xFF, 0xFF);
+    }
+
+    // writes blockWidth * blockHeight RGBA pixels to out
+    void decodeBlock(const astc_byte* in, int blockWidth, int blockHeight, astc_byte* out) {
+        const int texels = blockWidth * blockHeight;
+        Bits bits = { 0, 0 };
+        for (int i = 0; i < 8; ++i) {
+            bits.lo |= (uint64_t)in[i] << (i * 8);
+            bits.hi |= (uint64_t)in[i + 8] << (i * 8);
+        }
+
+        const int blockMode = bits.read(0, 11);
+        if ((blockMode & 0x1FF) == 0x1FC) {
+            // void extent, a constant color block
+            if (blockMode & 0x200) {
+                fillError(out, texels);
+            } else {
+                fillColor(out, texels, bits.read(72, 8), bits.read(88, 8), bits.read(104, 8), bits.read(120, 8));
+            }
+            return;
+        }
+
+        int gridWidth, gridHeight, weightQuant;
+        bool dualPlane;
+        if (!decodeBlockMode(blockMode, gridWidth, gridHeight, dualPlane, weightQuant) ||
+            gridWidth > blockWidth || gridHeight > blockHeight) {
+            fillError(out, texels);
+            return;
+        }
+        const int planes = dualPlane ? 2 : 1;
+        const int weightCount = gridWidth * gridHeight * planes;
+        const int weightBits = iseBitCount(weightCount, weightQuant);
+        const int partitions = bits.read(11, 2) + 1;
+        if (weightCount > ASTC_MAX_WEIGHTS || weightBits < 24 || weightBits > 96 || (dualPlane && partitions == 4)) {
+            fillError(out, texels);
+            return;
+        }
+
+        int modes[4];
+        int partitionIndex = 0;
+        int colorStart = 17;
+        int colorEnd = 128 - weightBits;
+        if (partitions == 1) {
+            modes[0] = bits.read(13, 4);
+        } else {
+            partitionIndex = bits.read(13, 10);
+            colorStart = 29;
+            int encoded = bits.read(23, 6);
+            if ((encoded & 3) == 0) {
+                for (int i = 0; i < partitions; ++i) {
+                    modes[i] = encoded >> 2;
+                }
+            } else {
+                // the rest of the modes is stored below the weights
+                const int extraBits = 3 * partitions - 4;
+                colorEnd -= extraBits;
+                encoded |= bits.read(colorEnd, extraBits) << 6;
+                const int baseClass = (encoded & 3) - 1;
+                int offset = 2;
+                for (int i = 0; i < partitions; ++i, ++offset) {
+                    modes[i] = (baseClass + ((encoded >> offset) & 1)) << 2;
+                }
+                for (int i = 0; i < partitions; ++i, offset += 2) {
+                    modes[i] |= (encoded >> offset) & 3;
+                }
+            }
+        }
+        int planeComponent = -1;
+        if (dualPlane) {
+            colorEnd -= 2;
+            planeComponent = bits.read(colorEnd, 2);
+        }
+
+        int colorCount = 0;
+        for (int i = 0; i < partitions; ++i) {
+            colorCount += ((modes[i] >> 2) + 1) * 2;
+        }
+        int colorQuant = QUANT_256;
+        while (colorQuant >= QUANT_6 && iseBitCount(colorCount, colorQuant) > colorEnd - colorStart) {
+            --colorQuant;
+        }
+        if (colorCount > ASTC_MAX_COLOR_VALUES || colorQuant < QUANT_6) {
+            fillError(out, texels);
+            return;
+        }
+
+        int colors[ASTC_MAX_COLOR_VALUES];
+        decodeISE(bits, colorStart, colorCount, colorQuant, colors);
+        int endpoints[4][2][4];
+        int* v = colors;
+        for (int i = 0; i < partitions; ++i) {
+            for (int j = 0; j < ((modes[i] >> 2) + 1) * 2; ++j) {
+                v[j] = unquantizeColor(v[j], colorQuant);
+            }
+            if (!decodeEndpoints(modes[i], v, endpoints[i][0], endpoints[i][1])) {
+                fillError(out, texels);
+                return;
+            }
+            v += ((modes[i] >> 2) + 1) * 2;
+        }
+
+        // weights are stored from the top bit down
+        const Bits reversed = { reverse64(bits.hi), reverse64(bits.lo) };
+        int values[ASTC_MAX_WEIGHTS];
+        decodeISE(reversed, 0, weightCount, weightQuant, values);
+        // padded, texels on the last row and column read one past the grid with a zero factor
+        int grid[2][ASTC_MAX_WEIGHTS + 16] = {};
+        for (int i = 0; i < weightCount; ++i) {
+            grid[i % planes][i / planes] = unquantizeWeight(values[i], weightQuant);
+        }
+
+        const int ds = (1024 + blockWidth / 2) / (blockWidth - 1);
+        const int dt = (1024 + blockHeight / 2) / (blockHeight - 1);
+        const PartitionHash hash(partitionIndex, partitions, texels < 31);
+        for (int t = 0; t < blockHeight; ++t) {
+            const int gt = (dt * t * (gridHeight - 1) + 32) >> 6;
+            const int jt = gt >> 4, ft = gt & 0xF;
+            for (int s = 0; s < blockWidth; ++s, out += 4) {
+                const int gs = (ds * s * (gridWidth - 1) + 32) >> 6;
+                const int js = gs >> 4, fs = gs & 0xF;
+                const int w11 = (fs * ft + 8) >> 4;
+                const int w10 = ft - w11;
+                const int w01 = fs - w11;
+                const int w00 = 16 - fs - ft + w11;
+                const int v0 = js + jt * gridWidth;
+                int weights[2] = { 0, 0 };
+                for (int p = 0; p < planes; ++p) {
+                    const int* w = grid[p] + v0;
+                    weights[p] = (w[0] * w00 + w[1] * w01 + w[gridWidth] * w10 + w[gridWidth + 1] * w11 + 8) >> 4;
+                }
+
+                const int partition = partitions > 1 ? hash.select(s, t) : 0;
+                const int* e0 = endpoints[partition][0];
+                const int* e1 = endpoints[partition][1];
+                for (int c = 0; c < 4; ++c) {
+                    const int w = c == planeComponent ? weights[1] : weights[0];
+                    const int c0 = e0[c] * 257, c1 = e1[c] * 257;
+                    out[c] = (astc_byte)(((c0 * (64 - w) + c1 * w + 32) >> 6) >> 8);
+                }
+            }
+        }
+    }
+}
+
+int astcDecodeImage(const astc_byte* pIn, astc_byte* pOut, int width, int height,
+                    int blockWidth, int blockHeight, int stride) {
+    if (blockWidth < 4 || blockWidth > 12 || blockHeight < 4 || blockHeight > 12) {
+        return -1;
+    }
+    astc_byte block[ASTC_MAX_TEXELS * 4];
+    const int blockStride = blockWidth * 4;
+    for (int y = 0; y < height; y += blockHeight) {
+        const int rows = height - y < blockHeight ? height - y : blockHeight;
+        for (int x = 0; x < width; x += blockWidth) {
+            decodeBlock(pIn, blockWidth, blockHeight, block);
+            pIn += ASTC_ENCODED_BLOCK_SIZE;
+            const int columns = width - x < blockWidth ? width - x : blockWidth;
+            astc_byte* dst = pOut + (size_t)y * stride + x * 4;
+            for (int r = 0; r < rows; ++r) {
+                memcpy(dst + (size_t)r * stride, block + r * blockStride, columns * 4);
+            }
+        }
+    }
+    return 0;
+}
@@ -50,4 +50,24 @@ int astcGetWidth(const astc_byte* pHeader);
 
 int astcGetHeight(const astc_byte* pHeader);
 
+// Size of an encoded block, in bytes
+
+#define ASTC_ENCODED_BLOCK_SIZE 16
+
+// Read the block width and height from a ASTC header
+
+int astcGetBlockWidth(const astc_byte* pHeader);
+
+int astcGetBlockHeight(const astc_byte* pHeader);
+
+// Decode an entire image of 2D blocks to RGBA8888.
+// pIn - pointer to encoded blocks, row by row.
+// pOut - pointer to the image data. Will be written such that
+//        pixel (x,y) is at pOut + 4 * x + stride * y.
+// Only the LDR profile is decoded, HDR and invalid blocks are magenta.
+// returns non-zero if the block size isn't a 2D one.
+
+int astcDecodeImage(const astc_byte* pIn, astc_byte* pOut, int width, int height,
+                    int blockWidth, int blockHeight, int stride);
+
 #endif
@@ -421,6 +421,86 @@ THE SOFTWARE.
 # define CC_ENABLE_CACHE_TTF_FONT_TEXTURE 1
 #endif 
 
+/** @def CC_ENABLE_TTF_LABEL_ASYNC_GLYPH
+ * If enabled, TTF label glyphs are rasterized on worker threads. Labels show the glyphs
+ * that are already in the atlas and are laid out again when the missing ones land.
+ */
+#ifndef CC_ENABLE_TTF_LABEL_ASYNC_GLYPH
+# define CC_ENABLE_TTF_LABEL_ASYNC_GLYPH 1
+#endif
+
+/** @def CC_ENABLE_TTF_LABEL_SHARED_SDF
+ * If enabled, labels with outline or bold style share one distance field atlas per font.
+ * Glyphs are rasterized once at CC_TTF_LABEL_SDF_FONT_SIZE and scaled down to the label size,
+ * labels larger than CC_TTF_LABEL_SDF_FONT_SIZE are rasterized at their own size.
+ * The distance field only reaches 8 pixels out of a glyph, labels whose outline would be
+ * wider than that in the shared atlas get an atlas of their own size instead.
+ */
+#ifndef CC_ENABLE_TTF_LABEL_SHARED_SDF
+# define CC_ENABLE_TTF_LABEL_SHARED_SDF 1
+#endif
+
+#ifndef CC_TTF_LABEL_SDF_FONT_SIZE
+# define CC_TTF_LABEL_SDF_FONT_SIZE 48
+#endif
+
+/** @def CC_ENABLE_TEXTURE_MIPMAP_STREAMING
+ * If enabled, mipmaps of RGB8/RGBA8 textures are generated on a worker thread instead of
+ * with glGenerateMipmap. The base level is shown at once without mipmap filtering, and the
+ * generated chain is uploaded from the smallest level over the next frames.
+ */
+#ifndef CC_ENABLE_TEXTURE_MIPMAP_STREAMING
+# define CC_ENABLE_TEXTURE_MIPMAP_STREAMING 0
+#endif
+
+/** @def CC_TEXTURE_MIPMAP_KAISER_FILTER
+ * Mipmaps are filtered with a Kaiser windowed sinc if enabled, and with a 2x2 box otherwise.
+ */
+#ifndef CC_TEXTURE_MIPMAP_KAISER_FILTER
+# define CC_TEXTURE_MIPMAP_KAISER_FILTER 0
+#endif
+
+/** @def CC_ENABLE_WEBSOCKET_BATCH_DISPATCH
+ * If enabled, websocket events are pushed to a lock-free queue by the websocket thread and
+ * dispatched together in the cocos thread, instead of posting one function per event.
+ */
+#ifndef CC_ENABLE_WEBSOCKET_BATCH_DISPATCH
+# define CC_ENABLE_WEBSOCKET_BATCH_DISPATCH 0
+#endif
+
+/** @def CC_ENABLE_WEBSOCKET_PERMESSAGE_DEFLATE
+ * If enabled, websocket connections offer the permessage-deflate extension to servers.
+ * CC_WEBSOCKET_DEFLATE_WINDOW_BITS (9 ~ 15) limits the window used to compress our messages,
+ * and CC_WEBSOCKET_DEFLATE_MEM_LEVEL (1 ~ 9) is the zlib memory level of the compressor.
+ */
+#ifndef CC_ENABLE_WEBSOCKET_PERMESSAGE_DEFLATE
+# define CC_ENABLE_WEBSOCKET_PERMESSAGE_DEFLATE 1
+#endif
+
+#ifndef CC_WEBSOCKET_DEFLATE_WINDOW_BITS
+# define CC_WEBSOCKET_DEFLATE_WINDOW_BITS 15
+#endif
+
+#ifndef CC_WEBSOCKET_DEFLATE_MEM_LEVEL
+# define CC_WEBSOCKET_DEFLATE_MEM_LEVEL 8
+#endif
+
+/** @def CC_FILEUTILS_MMAP_MIN_SIZE
+ * Files smaller than it are read into memory by FileUtils::getMappedFile instead of being mapped,
+ * since mapping costs more than reading for a few pages.
+ */
+#ifndef CC_FILEUTILS_MMAP_MIN_SIZE
+# define CC_FILEUTILS_MMAP_MIN_SIZE (16 * 1024)
+#endif
+
+/** @def CC_ENABLE_SPINE_DATA_CACHE
+ * If enabled, spine skeleton data is written to a cache file in the writable path the first time
+ * it's loaded, and later runs map the cache instead of parsing the json or binary file again.
+ */
+#ifndef CC_ENABLE_SPINE_DATA_CACHE
+# define CC_ENABLE_SPINE_DATA_CACHE 1
+#endif
+
 /** @def CC_IOS_FORCE_DISABLE_JIT
  * If enabled, --jitless flag will be add to V8
  */
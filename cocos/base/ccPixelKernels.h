@@ -0,0 +1,244 @@
+/****************************************************************************
+Copyright (c) 2020 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "base/ccMacros.h"
+
+#ifndef CC_PIXEL_KERNELS_DISABLE_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CC_PIXEL_KERNELS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define CC_PIXEL_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+NS_CC_BEGIN
+
+/**
+ * Pixel loops of image loading and texture upload. The SIMD path is chosen at compile time
+ * and gives the same bytes as the scalar one. Source and destination may be the same buffer.
+ */
+namespace PixelKernels {
+
+    /** RGBA8888 premultiply rounding down, c * (a + 1) >> 8, as CC_RGB_PREMULTIPLY_ALPHA. */
+    inline void premultiplyRGBA8888(const uint8_t *src, uint8_t *dst, size_t pixels)
+    {
+        size_t i = 0;
+#if CC_PIXEL_KERNELS_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+        // alpha is multiplied by 256 and kept
+        const __m128i alphaScale = _mm_setr_epi16(0, 0, 0, 256, 0, 0, 0, 256);
+        for (; i + 4 <= pixels; i += 4)
+        {
+            __m128i p = _mm_loadu_si128((const __m128i *)(src + i * 4));
+            __m128i lo = _mm_unpacklo_epi8(p, zero);
+            __m128i hi = _mm_unpackhi_epi8(p, zero);
+            __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            alo = _mm_or_si128(_mm_and_si128(_mm_add_epi16(alo, one), colorMask), alphaScale);
+            ahi = _mm_or_si128(_mm_and_si128(_mm_add_epi16(ahi, one), colorMask), alphaScale);
+            lo = _mm_srli_epi16(_mm_mullo_epi16(lo, alo), 8);
+            hi = _mm_srli_epi16(_mm_mullo_epi16(hi, ahi), 8);
+            _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_packus_epi16(lo, hi));
+        }
+#elif CC_PIXEL_KERNELS_NEON
+        for (; i + 8 <= pixels; i += 8)
+        {
+            uint8x8x4_t p = vld4_u8(src + i * 4);
+            uint16x8_t a = vaddl_u8(p.val[3], vdup_n_u8(1));
+            p.val[0] = vshrn_n_u16(vmulq_u16(vmovl_u8(p.val[0]), a), 8);
+            p.val[1] = vshrn_n_u16(vmulq_u16(vmovl_u8(p.val[1]), a), 8);
+            p.val[2] = vshrn_n_u16(vmulq_u16(vmovl_u8(p.val[2]), a), 8);
+            vst4_u8(dst + i * 4, p);
+        }
+#endif
+        for (; i < pixels; i++)
+        {
+            const uint8_t *s = src + i * 4;
+            uint8_t *d = dst + i * 4;
+            unsigned a = s[3] + 1;
+            d[0] = (uint8_t)((s[0] * a) >> 8);
+            d[1] = (uint8_t)((s[1] * a) >> 8);
+            d[2] = (uint8_t)((s[2] * a) >> 8);
+            d[3] = s[3];
+        }
+    }
+
+    /** RGBA8888 premultiply rounding up, (c * a + 254) / 255, as WebGL unpack premultiply. */
+    inline void premultiplyRGBA8888Rounded(const uint8_t *src, uint8_t *dst, size_t pixels)
+    {
+        size_t i = 0;
+        // t / 255 is (t + 1 + (t >> 8)) >> 8 for t below 65535
+#if CC_PIXEL_KERNELS_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i bias = _mm_set1_epi16(254);
+        const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+        // alpha is multiplied by 255 and kept
+        const __m128i alphaScale = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+        for (; i + 4 <= pixels; i += 4)
+        {
+            __m128i p = _mm_loadu_si128((const __m128i *)(src + i * 4));
+            __m128i lo = _mm_unpacklo_epi8(p, zero);
+            __m128i hi = _mm_unpackhi_epi8(p, zero);
+            __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            alo = _mm_or_si128(_mm_and_si128(alo, colorMask), alphaScale);
+            ahi = _mm_or_si128(_mm_and_si128(ahi, colorMask), alphaScale);
+            lo = _mm_add_epi16(_mm_mullo_epi16(lo, alo), bias);
+            hi = _mm_add_epi16(_mm_mullo_epi16(hi, ahi), bias);
+            lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, one), _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, one), _mm_srli_epi16(hi, 8)), 8);
+            _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_packus_epi16(lo, hi));
+        }
+#elif CC_PIXEL_KERNELS_NEON
+        const uint16x8_t one = vdupq_n_u16(1);
+        const uint16x8_t bias = vdupq_n_u16(254);
+        for (; i + 8 <= pixels; i += 8)
+        {
+            uint8x8x4_t p = vld4_u8(src + i * 4);
+            for (int c = 0; c < 3; c++)
+            {
+                uint16x8_t t = vmlal_u8(bias, p.val[c], p.val[3]);
+                p.val[c] = vshrn_n_u16(vaddq_u16(vsraq_n_u16(t, t, 8), one), 8);
+            }
+            vst4_u8(dst + i * 4, p);
+        }
+#endif
+        for (; i < pixels; i++)
+        {
+            const uint8_t *s = src + i * 4;
+            uint8_t *d = dst + i * 4;
+            unsigned a = s[3];
+            d[0] = (uint8_t)((s[0] * a + 254) / 255);
+            d[1] = (uint8_t)((s[1] * a + 254) / 255);
+            d[2] = (uint8_t)((s[2] * a + 254) / 255);
+            d[3] = s[3];
+        }
+    }
+
+    /**
+     * Halves an 8 bit per channel image with a 2x2 box filter, (a + b + c + d + 2) >> 2.
+     * A dimension of 1 is kept, dst is max(1, width / 2) x max(1, height / 2).
+     */
+    inline void downsampleBox(const uint8_t *src, uint32_t width, uint32_t height, uint32_t channels, uint8_t *dst)
+    {
+        const uint32_t dstWidth = width > 1 ? width / 2 : 1;
+        const uint32_t dstHeight = height > 1 ? height / 2 : 1;
+        const size_t srcStride = (size_t)width * channels;
+        for (uint32_t y = 0; y < dstHeight; y++)
+        {
+            const uint8_t *r0 = src + (size_t)(y * 2) * srcStride;
+            const uint8_t *r1 = height > 1 ? r0 + srcStride : r0;
+            uint8_t *d = dst + (size_t)y * dstWidth * channels;
+            uint32_t x = 0;
+            if (width > 1 && channels == 4)
+            {
+#if CC_PIXEL_KERNELS_SSE2
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i two = _mm_set1_epi16(2);
+                for (; x + 2 <= dstWidth; x += 2)
+                {
+                    __m128i a = _mm_loadu_si128((const __m128i *)(r0 + x * 8));
+                    __m128i b = _mm_loadu_si128((const __m128i *)(r1 + x * 8));
+                    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                    // add the neighbouring pixel, 4 channels apart
+                    lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+                    hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+                    __m128i sum = _mm_unpacklo_epi64(lo, hi);
+                    sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+                    _mm_storel_epi64((__m128i *)(d + x * 4), _mm_packus_epi16(sum, sum));
+                }
+#elif CC_PIXEL_KERNELS_NEON
+                for (; x + 8 <= dstWidth; x += 8)
+                {
+                    uint8x16x4_t a = vld4q_u8(r0 + x * 8);
+                    uint8x16x4_t b = vld4q_u8(r1 + x * 8);
+                    uint8x8x4_t out;
+                    for (int c = 0; c < 4; c++)
+                    {
+                        uint16x8_t sum = vpadalq_u8(vpaddlq_u8(a.val[c]), b.val[c]);
+                        out.val[c] = vrshrn_n_u16(sum, 2);
+                    }
+                    vst4_u8(d + x * 4, out);
+                }
+#endif
+            }
+            for (; x < dstWidth; x++)
+            {
+                const uint32_t x0 = x * 2 * channels;
+                const uint32_t x1 = width > 1 ? x0 + channels : x0;
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    d[x * channels + c] = (uint8_t)((r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    /** Flips rows of an image upside down in place. */
+    inline void flipRows(uint8_t *pixels, size_t bytesPerRow, size_t rows)
+    {
+        if (!pixels || rows < 2) return;
+        for (size_t top = 0, bottom = rows - 1; top < bottom; top++, bottom--)
+        {
+            uint8_t *t = pixels + top * bytesPerRow;
+            uint8_t *b = pixels + bottom * bytesPerRow;
+            size_t i = 0;
+#if CC_PIXEL_KERNELS_SSE2
+            for (; i + 16 <= bytesPerRow; i += 16)
+            {
+                __m128i vt = _mm_loadu_si128((const __m128i *)(t + i));
+                __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+                _mm_storeu_si128((__m128i *)(t + i), vb);
+                _mm_storeu_si128((__m128i *)(b + i), vt);
+            }
+#elif CC_PIXEL_KERNELS_NEON
+            for (; i + 16 <= bytesPerRow; i += 16)
+            {
+                uint8x16_t vt = vld1q_u8(t + i);
+                uint8x16_t vb = vld1q_u8(b + i);
+                vst1q_u8(t + i, vb);
+                vst1q_u8(b + i, vt);
+            }
+#endif
+            for (; i < bytesPerRow; i++)
+            {
+                uint8_t tmp = t[i];
+                t[i] = b[i];
+                b[i] = tmp;
+            }
+        }
+    }
+}
+
+NS_CC_END
@@ -25,6 +25,7 @@
  ****************************************************************************/
 
 #include "base/etc2.h"
+#include "base/etc1.h"
 #include <stdint.h>
 #include <string.h>
 
@@ -77,3 +78,229 @@ etc2_uint32 etc2_pkm_get_format(const uint8_t* pHeader) {
     return readBEUint16(pHeader + ETC2_PKM_FORMAT_OFFSET);
 }
 
+
+// ETC2 RGB8 and RGBA8 EAC decoding. Individual and differential blocks are ETC1 blocks,
+// the overflowing differential ones select the T, H and planar modes of ETC2.
+
+static const int kDistanceTable[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int kAlphaModifierTable[16][8] = {
+    { -3, -6, -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5, -8, -13, 1, 4, 7, 12 },
+    { -2, -4, -6, -13, 1, 3, 5, 12 },
+    { -3, -6, -8, -12, 2, 5, 7, 11 },
+    { -3, -7, -9, -11, 2, 6, 8, 10 },
+    { -4, -7, -8, -11, 3, 6, 7, 10 },
+    { -3, -5, -8, -11, 2, 4, 7, 10 },
+    { -2, -6, -8, -10, 1, 5, 7, 9 },
+    { -2, -5, -8, -10, 1, 4, 7, 9 },
+    { -2, -4, -8, -10, 1, 3, 7, 9 },
+    { -2, -5, -7, -10, 1, 4, 6, 9 },
+    { -3, -4, -7, -10, 2, 3, 6, 9 },
+    { -1, -2, -3, -10, 0, 1, 2, 9 },
+    { -4, -6, -8, -9, 3, 5, 7, 8 },
+    { -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+static inline etc2_byte clamp255(int x) {
+    return (etc2_byte) (x < 0 ? 0 : (x > 255 ? 255 : x));
+}
+
+static inline int extend4To8(int x) {
+    return (x << 4) | x;
+}
+
+static inline int extend6To8(int x) {
+    return (x << 2) | (x >> 4);
+}
+
+static inline int extend7To8(int x) {
+    return (x << 1) | (x >> 6);
+}
+
+// sign extend a 3 bit differential
+static inline int signed3(int x) {
+    return ((x & 7) ^ 4) - 4;
+}
+
+// paints pixels with 4 colors picked by the 2 bit indices of T and H modes
+static void decode_paint_block(const etc2_byte* pIn, const int paint[4][3], etc2_byte* pOut) {
+    etc2_uint32 low = (pIn[4] << 24) | (pIn[5] << 16) | (pIn[6] << 8) | pIn[7];
+    for (int x = 0; x < 4; x++) {
+        for (int y = 0; y < 4; y++) {
+            int k = y + (x * 4);
+            int index = ((low >> k) & 1) | ((low >> (k + 15)) & 2);
+            etc2_byte* q = pOut + 4 * (x + 4 * y);
+            q[0] = (etc2_byte) paint[index][0];
+            q[1] = (etc2_byte) paint[index][1];
+            q[2] = (etc2_byte) paint[index][2];
+        }
+    }
+}
+
+static void decode_t_block(const etc2_byte* pIn, etc2_byte* pOut) {
+    int c1[3], c2[3];
+    c1[0] = extend4To8((((pIn[0] >> 3) & 0x3) << 2) | (pIn[0] & 0x3));
+    c1[1] = extend4To8(pIn[1] >> 4);
+    c1[2] = extend4To8(pIn[1] & 0xf);
+    c2[0] = extend4To8(pIn[2] >> 4);
+    c2[1] = extend4To8(pIn[2] & 0xf);
+    c2[2] = extend4To8(pIn[3] >> 4);
+    int d = kDistanceTable[(((pIn[3] >> 2) & 0x3) << 1) | (pIn[3] & 0x1)];
+    int paint[4][3];
+    for (int i = 0; i < 3; i++) {
+        paint[0][i] = c1[i];
+        paint[1][i] = clamp255(c2[i] + d);
+        paint[2][i] = c2[i];
+        paint[3][i] = clamp255(c2[i] - d);
+    }
+    decode_paint_block(pIn, paint, pOut);
+}
+
+static void decode_h_block(const etc2_byte* pIn, etc2_byte* pOut) {
+    int r1 = (pIn[0] >> 3) & 0xf;
+    int g1 = ((pIn[0] & 0x7) << 1) | ((pIn[1] >> 4) & 0x1);
+    int b1 = (pIn[1] & 0x8) | ((pIn[1] & 0x3) << 1) | (pIn[2] >> 7);
+    int r2 = (pIn[2] >> 3) & 0xf;
+    int g2 = ((pIn[2] & 0x7) << 1) | (pIn[3] >> 7);
+    int b2 = (pIn[3] >> 3) & 0xf;
+    int index = (pIn[3] & 0x4) | ((pIn[3] & 0x1) << 1);
+    if (((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2)) {
+        index |= 1;
+    }
+    int d = kDistanceTable[index];
+    int c1[3] = { extend4To8(r1), extend4To8(g1), extend4To8(b1) };
+    int c2[3] = { extend4To8(r2), extend4To8(g2), extend4To8(b2) };
+    int paint[4][3];
+    for (int i = 0; i < 3; i++) {
+        paint[0][i] = clamp255(c1[i] + d);
+        paint[1][i] = clamp255(c1[i] - d);
+        paint[2][i] = clamp255(c2[i] + d);
+        paint[3][i] = clamp255(c2[i] - d);
+    }
+    decode_paint_block(pIn, paint, pOut);
+}
+
+static void decode_planar_block(const etc2_byte* pIn, etc2_byte* pOut) {
+    int o[3], h[3], v[3];
+    o[0] = extend6To8((pIn[0] >> 1) & 0x3f);
+    o[1] = extend7To8(((pIn[0] & 0x1) << 6) | ((pIn[1] >> 1) & 0x3f));
+    o[2] = extend6To8(((pIn[1] & 0x1) << 5) | (pIn[2] & 0x18) | ((pIn[2] & 0x3) << 1) | (pIn[3] >> 7));
+    h[0] = extend6To8(((pIn[3] >> 1) & 0x3e) | (pIn[3] & 0x1));
+    h[1] = extend7To8(pIn[4] >> 1);
+    h[2] = extend6To8(((pIn[4] & 0x1) << 5) | (pIn[5] >> 3));
+    v[0] = extend6To8(((pIn[5] & 0x7) << 3) | (pIn[6] >> 5));
+    v[1] = extend7To8(((pIn[6] & 0x1f) << 2) | (pIn[7] >> 6));
+    v[2] = extend6To8(pIn[7] & 0x3f);
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            etc2_byte* q = pOut + 4 * (x + 4 * y);
+            for (int i = 0; i < 3; i++) {
+                q[i] = clamp255((x * (h[i] - o[i]) + y * (v[i] - o[i]) + 4 * o[i] + 2) >> 2);
+            }
+        }
+    }
+}
+
+static void decode_color_block(const etc2_byte* pIn, etc2_byte* pOut) {
+    if (pIn[3] & 2) {
+        int r = (pIn[0] >> 3) + signed3(pIn[0]);
+        int g = (pIn[1] >> 3) + signed3(pIn[1]);
+        int b = (pIn[2] >> 3) + signed3(pIn[2]);
+        if (r < 0 || r > 31) {
+            decode_t_block(pIn, pOut);
+            return;
+        }
+        if (g < 0 || g > 31) {
+            decode_h_block(pIn, pOut);
+            return;
+        }
+        if (b < 0 || b > 31) {
+            decode_planar_block(pIn, pOut);
+            return;
+        }
+    }
+    etc1_byte rgb[ETC1_DECODED_BLOCK_SIZE];
+    etc1_decode_block(pIn, rgb);
+    for (int i = 0; i < 16; i++) {
+        pOut[i * 4] = rgb[i * 3];
+        pOut[i * 4 + 1] = rgb[i * 3 + 1];
+        pOut[i * 4 + 2] = rgb[i * 3 + 2];
+    }
+}
+
+static void decode_alpha_block(const etc2_byte* pIn, etc2_byte* pOut) {
+    int base = pIn[0];
+    int multiplier = pIn[1] >> 4;
+    const int* table = kAlphaModifierTable[pIn[1] & 0xf];
+    uint64_t bits = 0;
+    for (int i = 2; i < 8; i++) {
+        bits = (bits << 8) | pIn[i];
+    }
+    for (int x = 0; x < 4; x++) {
+        for (int y = 0; y < 4; y++) {
+            // first pixel in the most significant bits
+            int k = 45 - 3 * (y + x * 4);
+            int index = (int) ((bits >> k) & 0x7);
+            pOut[4 * (x + 4 * y) + 3] = clamp255(base + table[index] * multiplier);
+        }
+    }
+}
+
+void etc2_decode_block(const etc2_byte* pIn, etc2_uint32 format, etc2_byte* pOut) {
+    if (format == ETC2_RGBA_NO_MIPMAPS) {
+        decode_color_block(pIn + 8, pOut);
+        decode_alpha_block(pIn, pOut);
+    } else {
+        decode_color_block(pIn, pOut);
+        for (int i = 0; i < 16; i++) {
+            pOut[i * 4 + 3] = 255;
+        }
+    }
+}
+
+int etc2_decode_image(const etc2_byte* pIn, etc2_byte* pOut,
+        etc2_uint32 width, etc2_uint32 height, etc2_uint32 format,
+        etc2_uint32 pixelSize, etc2_uint32 stride) {
+    if (pixelSize < 3 || pixelSize > 4) {
+        return -1;
+    }
+    if (format != ETC2_RGB_NO_MIPMAPS && format != ETC2_RGBA_NO_MIPMAPS) {
+        return -1;
+    }
+    const etc2_uint32 blockSize = format == ETC2_RGBA_NO_MIPMAPS ? ETC2_RGBA_ENCODED_BLOCK_SIZE : ETC2_RGB_ENCODED_BLOCK_SIZE;
+    etc2_byte block[64];
+
+    etc2_uint32 encodedWidth = (width + 3) & ~3;
+    etc2_uint32 encodedHeight = (height + 3) & ~3;
+
+    for (etc2_uint32 y = 0; y < encodedHeight; y += 4) {
+        etc2_uint32 yEnd = height - y;
+        if (yEnd > 4) {
+            yEnd = 4;
+        }
+        for (etc2_uint32 x = 0; x < encodedWidth; x += 4) {
+            etc2_uint32 xEnd = width - x;
+            if (xEnd > 4) {
+                xEnd = 4;
+            }
+            etc2_decode_block(pIn, format, block);
+            pIn += blockSize;
+            for (etc2_uint32 cy = 0; cy < yEnd; cy++) {
+                const etc2_byte* q = block + (cy * 4) * 4;
+                etc2_byte* p = pOut + pixelSize * x + stride * (y + cy);
+                if (pixelSize == 4) {
+                    memcpy(p, q, xEnd * 4);
+                } else {
+                    for (etc2_uint32 cx = 0; cx < xEnd; cx++, q += 4) {
+                        *p++ = q[0];
+                        *p++ = q[1];
+                        *p++ = q[2];
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
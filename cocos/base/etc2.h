@@ -67,6 +67,28 @@ etc2_uint32 etc2_pkm_get_height(const etc2_byte* pHeader);
 
 etc2_uint32 etc2_pkm_get_format(const etc2_byte* pHeader);
 
+// Size of an encoded block of ETC2 RGB8 / RGBA8 EAC, in bytes.
+
+#define ETC2_RGB_ENCODED_BLOCK_SIZE 8
+#define ETC2_RGBA_ENCODED_BLOCK_SIZE 16
+
+// Decode a block. format is ETC2_RGB_NO_MIPMAPS or ETC2_RGBA_NO_MIPMAPS.
+// Output is a 4 x 4 square of 4-byte pixels in form R, G, B, A, opaque for RGB blocks.
+
+void etc2_decode_block(const etc2_byte* pIn, etc2_uint32 format, etc2_byte* pOut);
+
+// Decode an entire image.
+// pIn - pointer to encoded data.
+// pOut - pointer to the image data. Will be written such that
+//        pixel (x,y) is at pIn + pixelSize * x + stride * y. Must be
+//        large enough to store entire image.
+// pixelSize can be 3 (RGB) or 4 (RGBA), alpha of RGBA8 EAC blocks is dropped for 3.
+// returns non-zero if there is an error.
+
+int etc2_decode_image(const etc2_byte* pIn, etc2_byte* pOut,
+        etc2_uint32 width, etc2_uint32 height, etc2_uint32 format,
+        etc2_uint32 pixelSize, etc2_uint32 stride);
+
 #ifdef __cplusplus
 }
 #endif
@@ -89,6 +89,7 @@ spine/VertexAttachment.cpp \
 spine/VertexEffect.cpp \
 spine-creator-support/AttachmentVertices.cpp \
 spine-creator-support/SkeletonAnimation.cpp \
+spine-creator-support/SkeletonDataCache.cpp \
 spine-creator-support/SkeletonDataMgr.cpp \
 spine-creator-support/SkeletonRenderer.cpp \
 spine-creator-support/spine-cocos2dx.cpp \
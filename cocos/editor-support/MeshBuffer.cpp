@@ -25,6 +25,7 @@
 #include "MeshBuffer.h"
 #include "base/CCGLUtils.h"
 #include "renderer/gfx/DeviceGraphics.h"
+#include "MiddlewareManager.h"
 
 using namespace cocos2d;
 using namespace cocos2d::renderer;
@@ -46,6 +47,8 @@ MeshBuffer::MeshBuffer(int vertexFormat, size_t indexSize, size_t vertexSize)
     _ib.setMaxSize(INIT_INDEX_BUFFER_SIZE);
     _vb.setFullCallback([this]
     {
+        // Jobs may still write into the reserved range of current buffer.
+        MiddlewareManager::getInstance()->flushRenderJobs();
         uploadVB();
         uploadIB();
         _vb.reset();
@@ -23,8 +23,13 @@
  ****************************************************************************/
 #include "MiddlewareManager.h"
 #include "base/CCGLUtils.h"
+#include "base/CCThreadPool.h"
 #include "scripting/js-bindings/jswrapper/SeApi.h"
 #include <algorithm>
+#include <thread>
+
+// max worker thread count used by parallel render jobs
+#define MAX_RENDER_JOB_THREAD 4
 
 MIDDLEWARE_BEGIN
     
@@ -37,6 +42,9 @@ MiddlewareManager::MiddlewareManager()
 
 MiddlewareManager::~MiddlewareManager()
 {
+    flushRenderJobs();
+    CC_SAFE_DELETE(_threadPool);
+    
     for (auto it : _mbMap)
     {
         auto buffer = it.second;
@@ -146,6 +154,8 @@ void MiddlewareManager::render(float dt)
     
     isRendering = false;
     
+    flushRenderJobs();
+    
     for (auto it : _mbMap)
     {
         auto buffer = it.second;
@@ -167,6 +177,77 @@ void MiddlewareManager::render(float dt)
     }
 }
 
+void MiddlewareManager::pushRenderJob(const renderJob& job, const renderJob& finish)
+{
+    _renderJobs.push_back(job);
+    _finishJobs.push_back(finish);
+}
+
+void MiddlewareManager::flushRenderJobs()
+{
+    if (_renderJobs.empty()) return;
+    
+    // Swap out, so finish callback may push new jobs safely.
+    std::vector<renderJob> renderJobs;
+    std::vector<renderJob> finishJobs;
+    renderJobs.swap(_renderJobs);
+    finishJobs.swap(_finishJobs);
+    std::size_t jobCount = renderJobs.size();
+    
+    if (_parallelRender && jobCount > 1 && !_threadPool)
+    {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        int threadNum = hardwareThreads > 1 ? (int)hardwareThreads - 1 : 0;
+        threadNum = std::min(threadNum, MAX_RENDER_JOB_THREAD);
+        if (threadNum > 0)
+        {
+            _threadPool = ThreadPool::newFixedThreadPool(threadNum);
+        }
+    }
+    
+    if (_parallelRender && jobCount > 1 && _threadPool)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_jobMutex);
+            _pendingJobCount = jobCount - 1;
+        }
+        
+        // Main thread takes the first job, others go to worker threads.
+        for (std::size_t i = 1; i < jobCount; i++)
+        {
+            auto& job = renderJobs[i];
+            _threadPool->pushTask([this, &job](int /*tid*/)
+            {
+                job();
+                std::lock_guard<std::mutex> lock(_jobMutex);
+                if (--_pendingJobCount == 0)
+                {
+                    _jobCondition.notify_one();
+                }
+            });
+        }
+        renderJobs[0]();
+        
+        std::unique_lock<std::mutex> lock(_jobMutex);
+        _jobCondition.wait(lock, [this] { return _pendingJobCount == 0; });
+    }
+    else
+    {
+        for (auto& job : renderJobs)
+        {
+            job();
+        }
+    }
+    
+    for (auto& finish : finishJobs)
+    {
+        if (finish)
+        {
+            finish();
+        }
+    }
+}
+
 void MiddlewareManager::addTimer(IMiddleware* editor)
 {
     auto it0 = std::find(_updateList.begin(), _updateList.end(), editor);
@@ -26,9 +26,16 @@
 #include "MeshBuffer.h"
 #include <map>
 #include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
 #include "base/CCRef.h"
 #include "MiddlewareMacro.h"
 
+namespace cocos2d {
+    class ThreadPool;
+}
+
 MIDDLEWARE_BEGIN
 
 /**
@@ -100,6 +107,37 @@ public:
     
     MeshBuffer* getMeshBuffer(int format);
     
+    typedef std::function<void()> renderJob;
+    /**
+     * @brief Push a job which may run on worker thread during render.
+     * Job must only touch data owned by itself, such as a range it has
+     * reserved in mesh buffer, and finish will be called in main thread
+     * after all pushed jobs are done, in the order they were pushed.
+     * @param[in] job Thread safe part of middleware render.
+     * @param[in] finish Main thread part, may be nullptr.
+     */
+    void pushRenderJob(const renderJob& job, const renderJob& finish);
+    
+    /**
+     * @brief Run all pending render jobs and wait until they are finished.
+     * Called automatically before mesh buffer upload or switch.
+     */
+    void flushRenderJobs();
+    
+    /**
+     * @brief Enable or disable running render jobs on worker threads.
+     * If disabled, jobs are run one by one in main thread.
+     */
+    void setParallelRender(bool enabled)
+    {
+        _parallelRender = enabled;
+    }
+    
+    bool isParallelRender() const
+    {
+        return _parallelRender;
+    }
+    
     MiddlewareManager();
     ~MiddlewareManager();
     
@@ -113,6 +151,14 @@ private:
     std::vector<IMiddleware*> _removeList;
     std::map<int, MeshBuffer*> _mbMap;
     
+    std::vector<renderJob> _renderJobs;
+    std::vector<renderJob> _finishJobs;
+    bool _parallelRender = true;
+    cocos2d::ThreadPool* _threadPool = nullptr;
+    std::mutex _jobMutex;
+    std::condition_variable _jobCondition;
+    std::size_t _pendingJobCount = 0;
+    
     static MiddlewareManager* _instance;
 };
 MIDDLEWARE_END
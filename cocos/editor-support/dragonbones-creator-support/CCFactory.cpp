@@ -109,10 +109,14 @@ DragonBonesData* CCFactory::loadDragonBonesData(const std::string& filePath, con
         }
         else
         {
-            cocos2d::Data cocos2dData;
-            cocos2d::FileUtils::getInstance()->getContents(fullpath, &cocos2dData);
-            const auto binary = (unsigned char*)malloc(sizeof(unsigned char)* cocos2dData.getSize());
-            memcpy(binary, cocos2dData.getBytes(), cocos2dData.getSize());
+            // The binary is kept by DragonBonesData, it's copied from the mapped file only once.
+            auto file = cocos2d::FileUtils::getInstance()->getMappedFile(fullpath);
+            if (!file)
+            {
+                return nullptr;
+            }
+            const auto binary = (unsigned char*)malloc(sizeof(unsigned char)* file->getSize());
+            memcpy(binary, file->getBytes(), file->getSize());
             const auto data = parseDragonBonesData((char*)binary, name, scale);
 
             return data;
@@ -139,10 +143,14 @@ DragonBonesData* CCFactory::parseDragonBonesDataByPath(const std::string& filePa
         const auto fullpath = cocos2d::FileUtils::getInstance()->fullPathForFilename(filePath);
         if (cocos2d::FileUtils::getInstance()->isFileExist(filePath))
         {
-            cocos2d::Data cocos2dData;
-            cocos2d::FileUtils::getInstance()->getContents(fullpath, &cocos2dData);
-            const auto binary = (unsigned char*)malloc(sizeof(unsigned char)* cocos2dData.getSize());
-            memcpy(binary, cocos2dData.getBytes(), cocos2dData.getSize());
+            // The binary is kept by DragonBonesData, it's copied from the mapped file only once.
+            auto file = cocos2d::FileUtils::getInstance()->getMappedFile(fullpath);
+            if (!file)
+            {
+                return nullptr;
+            }
+            const auto binary = (unsigned char*)malloc(sizeof(unsigned char)* file->getSize());
+            memcpy(binary, file->getBytes(), file->getSize());
             
             return parseDragonBonesData((char*)binary, name, scale);
         }
@@ -4,16 +4,31 @@ DRAGONBONES_NAMESPACE_BEGIN
 std::vector<BaseObject*> BaseObject::__allDragonBonesObjects;
 unsigned BaseObject::_hashCode = 0;
 unsigned BaseObject::_defaultMaxCount = 3000;
-std::map<std::size_t, unsigned> BaseObject::_maxCountMap;
-std::map<std::size_t, std::vector<BaseObject*>> BaseObject::_poolsMap;
+std::size_t BaseObject::_typeIndexCount = 0;
+std::vector<unsigned> BaseObject::_maxCounts;
+std::vector<std::vector<BaseObject*>> BaseObject::_pools;
 BaseObject::RecycleOrDestroyCallback BaseObject::_recycleOrDestroyCallback = nullptr;
 
+std::size_t BaseObject::generateTypeIndex()
+{
+    return ++_typeIndexCount;
+}
+
+void BaseObject::_ensurePool(std::size_t classType)
+{
+    if (classType >= _pools.size())
+    {
+        _pools.resize(classType + 1);
+        _maxCounts.resize(classType + 1, _defaultMaxCount);
+    }
+}
+
 void BaseObject::_returnObject(BaseObject* object)
 {
     const auto classType = object->getClassTypeIndex();
-    const auto maxCountIterator = _maxCountMap.find(classType);
-    const auto maxCount = maxCountIterator != _maxCountMap.end() ? maxCountIterator->second : _defaultMaxCount;
-    auto& pool = _poolsMap[classType];
+    _ensurePool(classType);
+    const auto maxCount = _maxCounts[classType];
+    auto& pool = _pools[classType];
     // If script engine gc,then alway push object into pool,not immediately delete
     // Because object will be referenced more then one place possibly,if delete it immediately,will
     // crash.
@@ -50,43 +65,37 @@ void BaseObject::setMaxCount(std::size_t classType, unsigned maxCount)
 {
     if (classType > 0)
     {
-        const auto iterator = _poolsMap.find(classType);
-        if (iterator != _poolsMap.end())
+        _ensurePool(classType);
+        auto& pool = _pools[classType];
+        if (pool.size() > (size_t)maxCount)
         {
-            auto& pool = iterator->second;
-            if (pool.size() > (size_t)maxCount)
+            for (auto i = (size_t)maxCount, l = pool.size(); i < l; ++i)
             {
-                for (auto i = (size_t)maxCount, l = pool.size(); i < l; ++i)
-                {
-                    delete pool[i];
-                }
-
-                pool.resize(maxCount);
+                delete pool[i];
             }
+
+            pool.resize(maxCount);
         }
 
-        _maxCountMap[classType] = maxCount;
+        _maxCounts[classType] = maxCount;
     }
     else
     {
         _defaultMaxCount = maxCount;
-        for (auto& pair : _poolsMap)
+        for (std::size_t i = 0, l = _pools.size(); i < l; ++i)
         {
-            auto& pool = pair.second;
+            auto& pool = _pools[i];
             if (pool.size() > (size_t)maxCount)
             {
-                for (auto i = (size_t)maxCount, l = pool.size(); i < l; ++i)
+                for (auto j = (size_t)maxCount, k = pool.size(); j < k; ++j)
                 {
-                    delete pool[i];
+                    delete pool[j];
                 }
 
                 pool.resize(maxCount);
             }
 
-            if (_maxCountMap.find(pair.first) != _maxCountMap.end())
-            {
-                _maxCountMap[pair.first] = maxCount;
-            }
+            _maxCounts[i] = maxCount;
         }
     }
 }
@@ -94,10 +103,9 @@ void BaseObject::clearPool(std::size_t classType)
 {
     if (classType > 0)
     {
-        const auto iterator = _poolsMap.find(classType);
-        if (iterator != _poolsMap.end())
+        if (classType < _pools.size())
         {
-            auto& pool = iterator->second;
+            auto& pool = _pools[classType];
             if (!pool.empty())
             {
                 for (auto object : pool)
@@ -111,9 +119,8 @@ void BaseObject::clearPool(std::size_t classType)
     }
     else
     {
-        for (auto& pair : _poolsMap)
+        for (auto& pool : _pools)
         {
-            auto& pool = pair.second;
             if (!pool.empty())
             {
                 for (auto object : pool)
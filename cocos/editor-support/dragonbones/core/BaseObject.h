@@ -46,13 +46,20 @@ public:
 private:
     static unsigned _hashCode;
     static unsigned _defaultMaxCount;
-    static std::map<std::size_t, unsigned> _maxCountMap;
-    static std::map<std::size_t, std::vector<BaseObject*>> _poolsMap;
+    static std::size_t _typeIndexCount;
+    // Indexed by class type index, which is dense and starts from 1.
+    static std::vector<unsigned> _maxCounts;
+    static std::vector<std::vector<BaseObject*>> _pools;
     static void _returnObject(BaseObject *object);
+    static void _ensurePool(std::size_t classTypeIndex);
 
     static RecycleOrDestroyCallback _recycleOrDestroyCallback;
 public:
     static void setObjectRecycleOrDestroyCallback(const RecycleOrDestroyCallback& cb);
+    /**
+     * - Generate a small unique index for a class, used to index the object pools.
+     */
+    static std::size_t generateTypeIndex();
     /**
      * - Set the maximum cache count of the specify object pool.
      * @param objectConstructor - The specify class. (Set all object pools max cache count if not set)
@@ -97,10 +104,9 @@ public:
     static T* borrowObject() 
     {
         const auto classTypeIndex = T::getTypeIndex();
-        const auto iterator = _poolsMap.find(classTypeIndex);
-        if (iterator != _poolsMap.end())
+        if (classTypeIndex < _pools.size())
         {
-            auto& pool = iterator->second;
+            auto& pool = _pools[classTypeIndex];
             if (!pool.empty())
             {
                 const auto object = static_cast<T*>(pool.back());
@@ -55,7 +55,7 @@ public:\
 public:\
     static std::size_t getTypeIndex()\
     {\
-        static const auto typeIndex = typeid(CLASS).hash_code();\
+        static const auto typeIndex = BaseObject::generateTypeIndex();\
         return typeIndex;\
     }\
     virtual std::size_t getClassTypeIndex() const override\
@@ -67,7 +67,7 @@ public:\
 public:\
     static std::size_t getTypeIndex()\
     {\
-        static const auto typeIndex = typeid(CLASS).hash_code();\
+        static const auto typeIndex = BaseObject::generateTypeIndex();\
         return typeIndex;\
     }\
     virtual std::size_t getClassTypeIndex() const override\
@@ -85,7 +85,7 @@ private:\
 public:\
     static std::size_t getTypeIndex()\
     {\
-        static const auto typeIndex = typeid(CLASS).hash_code();\
+        static const auto typeIndex = BaseObject::generateTypeIndex();\
         return typeIndex;\
     }\
     virtual std::size_t getClassTypeIndex() const override\
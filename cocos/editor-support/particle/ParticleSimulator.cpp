@@ -246,9 +246,6 @@ void ParticleSimulator::render(float dt)
     middleware::IOBuffer& ib = mb->getIB();
     
     cocos2d::Vec3 pos;
-    cocos2d::Vec3 tpa;
-    cocos2d::Vec3 tpb;
-    cocos2d::Vec3 tpc;
     Quaternion tempQuat;
     Vec3 tempEuler;
     
@@ -317,14 +314,44 @@ void ParticleSimulator::render(float dt)
         }
     }
     
+    // Reserve a disjoint range of mesh buffer for every alive particle, so
+    // simulation and vertex writing can run on worker thread.
+    std::size_t particleSize = _particles.size();
+    std::size_t vbBytes = particleSize * 4 * sizeof(middleware::V2F_T2F_C4B);
+    std::size_t ibBytes = particleSize * 6 * sizeof(unsigned short);
+    vb.checkSpace(vbBytes, true);
+    ib.checkSpace(ibBytes, true);
+    std::size_t vbPos = vb.getCurPos();
+    std::size_t ibPos = ib.getCurPos();
+    vb.move((int)vbBytes);
+    ib.move((int)ibBytes);
+    
+    uint32_t indexStart = (uint32_t)ibPos / sizeof(unsigned short);
+    assembler->updateIABuffer(0, mb->getGLVB(), mb->getGLIB());
+    
+    mgr->pushRenderJob([this, dt, &vb, &ib, vbPos, ibPos]
+    {
+        simulate(dt, vb, ib, vbPos, ibPos);
+    }, [this, assembler, indexStart]
+    {
+        finishRender(assembler, indexStart);
+    });
+}
+
+void ParticleSimulator::simulate(float dt, middleware::IOBuffer& vb, middleware::IOBuffer& ib, std::size_t vbPos, std::size_t ibPos)
+{
+    // Buffer may be reallocated while reserving, so get address when job run.
+    auto vertices = (middleware::V2F_T2F_C4B*)(vb.getBuffer() + vbPos);
+    auto indices = (unsigned short*)(ib.getBuffer() + ibPos);
+    
     // Used to reduce memory allocation / creation within the loop
+    cocos2d::Vec3 tpa;
+    cocos2d::Vec3 tpb;
+    cocos2d::Vec3 tpc;
     std::size_t particleIdx = 0;
     std::size_t particleSize = _particles.size();
-    vb.checkSpace(particleSize * 4 * sizeof (middleware::V2F_T2F_C4B));
-    ib.checkSpace(particleSize * 6 * sizeof (unsigned short));
-    std::size_t vbOffset = vb.getCurPos() / sizeof (middleware::V2F_T2F_C4B);
-    uint32_t indexStart = (uint32_t)ib.getCurPos()/sizeof(unsigned short);
-    uint32_t indexCount = 0;
+    std::size_t vbOffset = vbPos / sizeof (middleware::V2F_T2F_C4B);
+    _indexCount = 0;
     
     while (particleIdx < particleSize)
     {
@@ -427,67 +454,77 @@ void ParticleSimulator::render(float dt)
             
             auto rad = -CC_DEGREES_TO_RADIANS(particle.rotation);
             auto cr = cos(rad), sr = sin(rad);
-            uint32_t tempColor = (((GLuint)particle.color.a << 24) & 0xff000000) +
-                                 (((GLuint)particle.color.b << 16) & 0x00ff0000) +
-                                 (((GLuint)particle.color.g << 8)  & 0x0000ff00) +
-                                 (((GLuint)particle.color.r)       & 0x000000ff);
+            cocos2d::Color4B tempColor((GLubyte)color.r, (GLubyte)color.g, (GLubyte)color.b, (GLubyte)color.a);
+            
             // bl
-            vb.writeFloat32(x1 * cr - y1 * sr + x);
-            vb.writeFloat32(x1 * sr + y1 * cr + y);
-            vb.writeFloat32(_uv[0]);
-            vb.writeFloat32(_uv[1]);
-            vb.writeUint32(tempColor);
+            vertices->vertex.x = x1 * cr - y1 * sr + x;
+            vertices->vertex.y = x1 * sr + y1 * cr + y;
+            vertices->texCoord.u = _uv[0];
+            vertices->texCoord.v = _uv[1];
+            vertices->color = tempColor;
+            vertices++;
             
             // br
-            vb.writeFloat32(x2 * cr - y1 * sr + x);
-            vb.writeFloat32(x2 * sr + y1 * cr + y);
-            vb.writeFloat32(_uv[2]);
-            vb.writeFloat32(_uv[3]);
-            vb.writeUint32(tempColor);
+            vertices->vertex.x = x2 * cr - y1 * sr + x;
+            vertices->vertex.y = x2 * sr + y1 * cr + y;
+            vertices->texCoord.u = _uv[2];
+            vertices->texCoord.v = _uv[3];
+            vertices->color = tempColor;
+            vertices++;
             
             // tl
-            vb.writeFloat32(x1 * cr - y2 * sr + x);
-            vb.writeFloat32(x1 * sr + y2 * cr + y);
-            vb.writeFloat32(_uv[4]);
-            vb.writeFloat32(_uv[5]);
-            vb.writeUint32(tempColor);
+            vertices->vertex.x = x1 * cr - y2 * sr + x;
+            vertices->vertex.y = x1 * sr + y2 * cr + y;
+            vertices->texCoord.u = _uv[4];
+            vertices->texCoord.v = _uv[5];
+            vertices->color = tempColor;
+            vertices++;
             
             // tr
-            vb.writeFloat32(x2 * cr - y2 * sr + x);
-            vb.writeFloat32(x2 * sr + y2 * cr + y);
-            vb.writeFloat32(_uv[6]);
-            vb.writeFloat32(_uv[7]);
-            vb.writeUint32(tempColor);
+            vertices->vertex.x = x2 * cr - y2 * sr + x;
+            vertices->vertex.y = x2 * sr + y2 * cr + y;
+            vertices->texCoord.u = _uv[6];
+            vertices->texCoord.v = _uv[7];
+            vertices->color = tempColor;
+            vertices++;
             
-            ib.writeUint16(vbOffset);
-            ib.writeUint16(vbOffset + 1);
-            ib.writeUint16(vbOffset + 2);
-            ib.writeUint16(vbOffset + 1);
-            ib.writeUint16(vbOffset + 3);
-            ib.writeUint16(vbOffset + 2);
+            *indices++ = vbOffset;
+            *indices++ = vbOffset + 1;
+            *indices++ = vbOffset + 2;
+            *indices++ = vbOffset + 1;
+            *indices++ = vbOffset + 3;
+            *indices++ = vbOffset + 2;
             
             vbOffset += 4;
-            indexCount += 6;
+            _indexCount += 6;
             
             // update particle counter
             ++particleIdx;
         }
         else
         {
-            // life < 0
+            // life < 0, particle pool is shared, so put it back in main thread
             auto deadParticle = _particles[particleIdx];
             if (particleIdx != particleSize - 1)
             {
                 _particles[particleIdx] = _particles[particleSize - 1];
             }
-            _pool.put(deadParticle);
+            _deadParticles.push_back(deadParticle);
             particleSize--;
             _particles.resize(particleSize);
         }
     }
+}
+
+void ParticleSimulator::finishRender(renderer::CustomAssembler* assembler, uint32_t indexStart)
+{
+    for (auto particle : _deadParticles)
+    {
+        _pool.put(particle);
+    }
+    _deadParticles.clear();
     
-    assembler->updateIABuffer(0, mb->getGLVB(), mb->getGLIB());
-    assembler->updateIARange(0, indexStart, indexCount);
+    assembler->updateIARange(0, indexStart, _indexCount);
     
     if (_particles.size() == 0 && !_active  && !_readyToPlay)
     {
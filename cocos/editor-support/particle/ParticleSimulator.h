@@ -32,6 +32,12 @@
 #include "MiddlewareManager.h"
 #include "scripting/js-bindings/jswrapper/SeApi.h"
 
+namespace cocos2d {
+    namespace renderer {
+        class CustomAssembler;
+    }
+}
+
 NS_CC_BEGIN
 
 struct Particle {
@@ -229,7 +235,14 @@ public:
     }
     
 private:
+    // Simulate particles and write vertices into reserved range, may run in worker thread.
+    void simulate(float dt, cocos2d::middleware::IOBuffer& vb, cocos2d::middleware::IOBuffer& ib, std::size_t vbPos, std::size_t ibPos);
+    // Update assembler and recycle dead particles, must run in main thread.
+    void finishRender(cocos2d::renderer::CustomAssembler* assembler, uint32_t indexStart);
+    
     std::vector<Particle*>          _particles;
+    std::vector<Particle*>          _deadParticles;
+    uint32_t                        _indexCount = 0;
     bool                            _active = false;
     bool                            _readyToPlay = true;
     bool                            _finished = false;
@@ -0,0 +1,1344 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated January 1, 2020. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2020, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include "SkeletonDataCache.h"
+#include "platform/CCFileUtils.h"
+#include <string.h>
+#include <unordered_map>
+
+using namespace spine;
+
+namespace {
+    const uint32_t CACHE_MAGIC = 0x43445053; // "SPDC"
+    const uint32_t CACHE_VERSION = 1;
+    const uint32_t CACHE_BYTE_ORDER = 0x01020304;
+    // arrays are aligned to it from the start of the blob, mapped files start on a page
+    const size_t CACHE_ALIGNMENT = 8;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t sizeOfSizeT;
+        uint64_t sourceHash;
+        uint64_t size;
+        // of the bytes after the header
+        uint64_t checksum;
+    };
+
+    // FNV-1a over 8 byte words, it's only meant to tell contents apart
+    uint64_t hashBytes(const unsigned char* bytes, size_t size, uint64_t hash = 14695981039346656037ULL) {
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, bytes + i, sizeof(word));
+            hash = (hash ^ word) * 1099511628211ULL;
+        }
+        for (; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    enum CachedAttachmentType {
+        ATTACHMENT_REGION,
+        ATTACHMENT_BOUNDING_BOX,
+        ATTACHMENT_MESH,
+        ATTACHMENT_LINKED_MESH,
+        ATTACHMENT_PATH,
+        ATTACHMENT_POINT,
+        ATTACHMENT_CLIPPING
+    };
+
+    enum CachedTimelineType {
+        TIMELINE_ATTACHMENT,
+        TIMELINE_COLOR,
+        TIMELINE_TWO_COLOR,
+        TIMELINE_ROTATE,
+        TIMELINE_TRANSLATE,
+        TIMELINE_SCALE,
+        TIMELINE_SHEAR,
+        TIMELINE_IK_CONSTRAINT,
+        TIMELINE_TRANSFORM_CONSTRAINT,
+        TIMELINE_PATH_POSITION,
+        TIMELINE_PATH_SPACING,
+        TIMELINE_PATH_MIX,
+        TIMELINE_DEFORM,
+        TIMELINE_DRAW_ORDER,
+        TIMELINE_EVENT
+    };
+
+    enum CachedConstraintType {
+        CONSTRAINT_IK,
+        CONSTRAINT_TRANSFORM,
+        CONSTRAINT_PATH
+    };
+
+    // array stored in the blob
+    template<typename T>
+    struct ArrayRef {
+        T* data = nullptr;
+        size_t count = 0;
+
+        void apply(Vector<T>& vector) const {
+            if (count > 0) vector.setExternalBuffer(data, count);
+        }
+    };
+
+    struct VertexData {
+        int worldVerticesLength = 0;
+        ArrayRef<size_t> bones;
+        ArrayRef<float> vertices;
+
+        void apply(VertexAttachment* attachment) const {
+            attachment->setWorldVerticesLength(worldVerticesLength);
+            bones.apply(attachment->getBones());
+            vertices.apply(attachment->getVertices());
+        }
+    };
+
+    template<typename T, typename U>
+    int indexOf(Vector<T*>& items, const U* item) {
+        for (size_t i = 0, n = items.size(); i < n; ++i) {
+            if (items[i] == item) return (int)i;
+        }
+        return -1;
+    }
+
+    // linked meshes share the arrays of their parent in the blob instead of copying them
+    template<typename T>
+    void shareArray(Vector<T>& vector, Vector<T>& parent) {
+        if (parent.isExternalBuffer()) {
+            vector.setExternalBuffer(parent.buffer(), parent.size());
+        } else {
+            vector.clearAndAddAll(parent);
+        }
+    }
+}
+
+struct SkeletonDataCache::Output {
+    std::vector<unsigned char>& blob;
+    std::unordered_map<Attachment*, int> attachmentIndices;
+
+    explicit Output(std::vector<unsigned char>& inBlob) : blob(inBlob) {}
+
+    void write(const void* data, size_t size) {
+        if (size == 0) return;
+        const unsigned char* bytes = (const unsigned char*)data;
+        blob.insert(blob.end(), bytes, bytes + size);
+    }
+
+    void writeInt(int value) { write(&value, sizeof(value)); }
+    void writeFloat(float value) { write(&value, sizeof(value)); }
+    void writeBoolean(bool value) { writeInt(value ? 1 : 0); }
+
+    void writeString(const String& value) {
+        writeInt((int)value.length());
+        if (value.length() > 0) write(value.buffer(), value.length() + 1);
+    }
+
+    void writeColor(const Color& color) {
+        writeFloat(color.r);
+        writeFloat(color.g);
+        writeFloat(color.b);
+        writeFloat(color.a);
+    }
+
+    template<typename T>
+    void writeArray(Vector<T>& vector) {
+        writeInt((int)vector.size());
+        blob.resize((blob.size() + CACHE_ALIGNMENT - 1) & ~(CACHE_ALIGNMENT - 1), 0);
+        write(vector.buffer(), vector.size() * sizeof(T));
+    }
+
+    int attachmentIndex(Attachment* attachment) const {
+        auto it = attachmentIndices.find(attachment);
+        return it != attachmentIndices.end() ? it->second : -1;
+    }
+};
+
+// A read past the end or an invalid index marks the input as failed and returns zeros or null,
+// the reader checks it before dereferencing what it read.
+struct SkeletonDataCache::Input {
+    const unsigned char* begin;
+    const unsigned char* cursor;
+    const unsigned char* end;
+    bool failed = false;
+
+    Input(const unsigned char* blob, size_t size) : begin(blob), cursor(blob), end(blob + size) {}
+
+    void read(void* data, size_t size) {
+        if (failed || (size_t)(end - cursor) < size) {
+            failed = true;
+            memset(data, 0, size);
+            return;
+        }
+        memcpy(data, cursor, size);
+        cursor += size;
+    }
+
+    int readInt() { int value; read(&value, sizeof(value)); return value; }
+    float readFloat() { float value; read(&value, sizeof(value)); return value; }
+    bool readBoolean() { return readInt() != 0; }
+
+    // index in [0, count), or -1 when 'optional'
+    int readIndex(size_t count, bool optional = false) {
+        int index = readInt();
+        if (optional && index == -1) return index;
+        if (index < 0 || (size_t)index >= count) {
+            failed = true;
+            return optional ? -1 : 0;
+        }
+        return index;
+    }
+
+    // every item takes at least 4 bytes, which bounds what is allocated for a corrupted count
+    size_t readCount() {
+        int count = readInt();
+        if (count < 0 || (size_t)count > (size_t)(end - cursor) / 4) {
+            failed = true;
+            return 0;
+        }
+        return (size_t)count;
+    }
+
+    template<typename T>
+    T* readElement(Vector<T*>& items) {
+        int index = readIndex(items.size());
+        return failed ? nullptr : items[index];
+    }
+
+    String readString() {
+        int length = readInt();
+        if (length <= 0) {
+            if (length < 0) failed = true;
+            return String();
+        }
+        if (failed || (size_t)(end - cursor) <= (size_t)length || cursor[length] != '\0') {
+            failed = true;
+            return String();
+        }
+        String value((const char*)cursor);
+        cursor += length + 1;
+        return value;
+    }
+
+    template<typename T>
+    T readEnum(T last) {
+        int value = readInt();
+        if (value < 0 || value > (int)last) {
+            failed = true;
+            return static_cast<T>(0);
+        }
+        return static_cast<T>(value);
+    }
+
+    // the spine constructors assert names aren't empty
+    String readName() {
+        String value = readString();
+        if (value.length() == 0) failed = true;
+        return value;
+    }
+
+    void readColor(Color& color) {
+        color.r = readFloat();
+        color.g = readFloat();
+        color.b = readFloat();
+        color.a = readFloat();
+    }
+
+    template<typename T>
+    ArrayRef<T> readArray() {
+        ArrayRef<T> array;
+        int count = readInt();
+        size_t offset = ((size_t)(cursor - begin) + CACHE_ALIGNMENT - 1) & ~(CACHE_ALIGNMENT - 1);
+        size_t size = (size_t)(end - begin);
+        if (failed || count < 0 || offset > size || (size - offset) / sizeof(T) < (size_t)count) {
+            failed = true;
+            return array;
+        }
+        // the blob is read-only, the vectors it's set to copy it out before modifying it
+        array.data = (T*)(begin + offset);
+        array.count = (size_t)count;
+        cursor = begin + offset + array.count * sizeof(T);
+        return array;
+    }
+
+    // the bones and vertices are walked without checks when posing, so they must match the world vertices
+    VertexData readVertices(size_t bonesCount) {
+        VertexData data;
+        data.worldVerticesLength = readInt();
+        data.bones = readArray<size_t>();
+        data.vertices = readArray<float>();
+        if (failed || data.worldVerticesLength < 0 || data.worldVerticesLength % 2 != 0) {
+            failed = true;
+            return data;
+        }
+        if (data.bones.count == 0) {
+            if (data.vertices.count != (size_t)data.worldVerticesLength) failed = true;
+            return data;
+        }
+        // per vertex, the count of its bones followed by their indices, and x, y and weight per bone
+        size_t vertexCount = 0;
+        size_t weightsCount = 0;
+        for (size_t i = 0; i < data.bones.count && !failed; ++vertexCount) {
+            size_t n = data.bones.data[i++];
+            if (n > data.bones.count - i) {
+                failed = true;
+                break;
+            }
+            for (size_t end = i + n; i < end; ++i) {
+                if (data.bones.data[i] >= bonesCount) failed = true;
+            }
+            weightsCount += n;
+        }
+        if (vertexCount * 2 != (size_t)data.worldVerticesLength || data.vertices.count != weightsCount * 3) failed = true;
+        return data;
+    }
+
+    // returns the frame count, 0 if the frames aren't 'entries' values each
+    size_t readFrames(Vector<float>& frames, size_t entries) {
+        ArrayRef<float> array = readArray<float>();
+        if (failed || array.count == 0 || array.count % entries != 0) {
+            failed = true;
+            return 0;
+        }
+        array.apply(frames);
+        return array.count / entries;
+    }
+};
+
+SkeletonDataCache::SkeletonDataCache(AttachmentLoader* attachmentLoader)
+: _attachmentLoader(attachmentLoader)
+{
+}
+
+uint64_t SkeletonDataCache::hashSource(const unsigned char* source, size_t size, float scale) {
+    uint64_t hash = hashBytes(source, size);
+    return hashBytes((const unsigned char*)&scale, sizeof(scale), hash);
+}
+
+bool SkeletonDataCache::writeSkeletonData(SkeletonData* skeletonData, uint64_t sourceHash, std::vector<unsigned char>& blob) {
+    _error.clear();
+    blob.clear();
+    blob.resize(sizeof(CacheHeader), 0);
+    Output output(blob);
+
+    output.writeString(skeletonData->_hash);
+    output.writeString(skeletonData->_version);
+    output.writeFloat(skeletonData->_x);
+    output.writeFloat(skeletonData->_y);
+    output.writeFloat(skeletonData->_width);
+    output.writeFloat(skeletonData->_height);
+    output.writeFloat(skeletonData->_fps);
+    output.writeString(skeletonData->_imagesPath);
+    output.writeString(skeletonData->_audioPath);
+
+    // Bones.
+    output.writeInt((int)skeletonData->_bones.size());
+    for (size_t i = 0, n = skeletonData->_bones.size(); i < n; ++i) {
+        BoneData* data = skeletonData->_bones[i];
+        output.writeString(data->_name);
+        output.writeInt(data->_parent ? data->_parent->_index : -1);
+        output.writeFloat(data->_length);
+        output.writeFloat(data->_x);
+        output.writeFloat(data->_y);
+        output.writeFloat(data->_rotation);
+        output.writeFloat(data->_scaleX);
+        output.writeFloat(data->_scaleY);
+        output.writeFloat(data->_shearX);
+        output.writeFloat(data->_shearY);
+        output.writeInt((int)data->_transformMode);
+        output.writeBoolean(data->_skinRequired);
+    }
+
+    // Slots.
+    output.writeInt((int)skeletonData->_slots.size());
+    for (size_t i = 0, n = skeletonData->_slots.size(); i < n; ++i) {
+        SlotData* data = skeletonData->_slots[i];
+        output.writeString(data->_name);
+        output.writeInt(data->_boneData.getIndex());
+        output.writeColor(data->_color);
+        output.writeColor(data->_darkColor);
+        output.writeBoolean(data->_hasDarkColor);
+        output.writeString(data->_attachmentName);
+        output.writeInt((int)data->_blendMode);
+    }
+
+    // IK constraints.
+    output.writeInt((int)skeletonData->_ikConstraints.size());
+    for (size_t i = 0, n = skeletonData->_ikConstraints.size(); i < n; ++i) {
+        IkConstraintData* data = skeletonData->_ikConstraints[i];
+        output.writeString(data->getName());
+        output.writeInt((int)data->getOrder());
+        output.writeBoolean(data->isSkinRequired());
+        output.writeInt((int)data->_bones.size());
+        for (size_t ii = 0; ii < data->_bones.size(); ++ii) output.writeInt(data->_bones[ii]->getIndex());
+        output.writeInt(data->_target->getIndex());
+        output.writeFloat(data->_mix);
+        output.writeFloat(data->_softness);
+        output.writeInt(data->_bendDirection);
+        output.writeBoolean(data->_compress);
+        output.writeBoolean(data->_stretch);
+        output.writeBoolean(data->_uniform);
+    }
+
+    // Transform constraints.
+    output.writeInt((int)skeletonData->_transformConstraints.size());
+    for (size_t i = 0, n = skeletonData->_transformConstraints.size(); i < n; ++i) {
+        TransformConstraintData* data = skeletonData->_transformConstraints[i];
+        output.writeString(data->getName());
+        output.writeInt((int)data->getOrder());
+        output.writeBoolean(data->isSkinRequired());
+        output.writeInt((int)data->_bones.size());
+        for (size_t ii = 0; ii < data->_bones.size(); ++ii) output.writeInt(data->_bones[ii]->getIndex());
+        output.writeInt(data->_target->getIndex());
+        output.writeBoolean(data->_local);
+        output.writeBoolean(data->_relative);
+        output.writeFloat(data->_offsetRotation);
+        output.writeFloat(data->_offsetX);
+        output.writeFloat(data->_offsetY);
+        output.writeFloat(data->_offsetScaleX);
+        output.writeFloat(data->_offsetScaleY);
+        output.writeFloat(data->_offsetShearY);
+        output.writeFloat(data->_rotateMix);
+        output.writeFloat(data->_translateMix);
+        output.writeFloat(data->_scaleMix);
+        output.writeFloat(data->_shearMix);
+    }
+
+    // Path constraints.
+    output.writeInt((int)skeletonData->_pathConstraints.size());
+    for (size_t i = 0, n = skeletonData->_pathConstraints.size(); i < n; ++i) {
+        PathConstraintData* data = skeletonData->_pathConstraints[i];
+        output.writeString(data->getName());
+        output.writeInt((int)data->getOrder());
+        output.writeBoolean(data->isSkinRequired());
+        output.writeInt((int)data->_bones.size());
+        for (size_t ii = 0; ii < data->_bones.size(); ++ii) output.writeInt(data->_bones[ii]->getIndex());
+        output.writeInt(data->_target->getIndex());
+        output.writeInt((int)data->_positionMode);
+        output.writeInt((int)data->_spacingMode);
+        output.writeInt((int)data->_rotateMode);
+        output.writeFloat(data->_offsetRotation);
+        output.writeFloat(data->_position);
+        output.writeFloat(data->_spacing);
+        output.writeFloat(data->_rotateMix);
+        output.writeFloat(data->_translateMix);
+    }
+
+    // Skins, the linked meshes are written after all the attachments they may refer to.
+    Vector<MeshAttachment*> linkedMeshes;
+    output.writeInt(indexOf(skeletonData->_skins, skeletonData->_defaultSkin));
+    output.writeInt((int)skeletonData->_skins.size());
+    for (size_t i = 0, n = skeletonData->_skins.size(); i < n; ++i) {
+        Skin* skin = skeletonData->_skins[i];
+        output.writeString(skin->getName());
+
+        Vector<BoneData*>& bones = skin->getBones();
+        output.writeInt((int)bones.size());
+        for (size_t ii = 0; ii < bones.size(); ++ii) output.writeInt(bones[ii]->getIndex());
+
+        Vector<ConstraintData*>& constraints = skin->getConstraints();
+        output.writeInt((int)constraints.size());
+        for (size_t ii = 0; ii < constraints.size(); ++ii) {
+            ConstraintData* constraint = constraints[ii];
+            int index;
+            if ((index = indexOf(skeletonData->_ikConstraints, constraint)) >= 0) {
+                output.writeInt(CONSTRAINT_IK);
+            } else if ((index = indexOf(skeletonData->_transformConstraints, constraint)) >= 0) {
+                output.writeInt(CONSTRAINT_TRANSFORM);
+            } else if ((index = indexOf(skeletonData->_pathConstraints, constraint)) >= 0) {
+                output.writeInt(CONSTRAINT_PATH);
+            } else {
+                _error = "Skin constraint not found: " + std::string(constraint->getName().buffer());
+                return false;
+            }
+            output.writeInt(index);
+        }
+
+        size_t countOffset = blob.size();
+        int count = 0;
+        output.writeInt(0);
+        Skin::AttachmentMap::Entries entries = skin->getAttachments();
+        while (entries.hasNext()) {
+            Skin::AttachmentMap::Entry& entry = entries.next();
+            output.writeInt((int)entry._slotIndex);
+            output.writeString(entry._name);
+            if (!writeAttachment(output, entry._attachment)) return false;
+            output.attachmentIndices[entry._attachment] = (int)output.attachmentIndices.size();
+            if (entry._attachment->getRTTI().isExactly(MeshAttachment::rtti)) {
+                MeshAttachment* mesh = static_cast<MeshAttachment*>(entry._attachment);
+                if (mesh->_parentMesh) linkedMeshes.add(mesh);
+            }
+            ++count;
+        }
+        memcpy(&blob[countOffset], &count, sizeof(count));
+    }
+
+    output.writeInt((int)linkedMeshes.size());
+    for (size_t i = 0, n = linkedMeshes.size(); i < n; ++i) {
+        MeshAttachment* mesh = linkedMeshes[i];
+        int parentIndex = output.attachmentIndex(mesh->_parentMesh);
+        if (parentIndex < 0) {
+            _error = "Parent mesh not found: " + std::string(mesh->getName().buffer());
+            return false;
+        }
+        output.writeInt(output.attachmentIndex(mesh));
+        output.writeInt(parentIndex);
+        output.writeBoolean(mesh->_deformAttachment == mesh->_parentMesh);
+    }
+
+    // Events.
+    output.writeInt((int)skeletonData->_events.size());
+    for (size_t i = 0, n = skeletonData->_events.size(); i < n; ++i) {
+        EventData* data = skeletonData->_events[i];
+        output.writeString(data->_name);
+        output.writeInt(data->_intValue);
+        output.writeFloat(data->_floatValue);
+        output.writeString(data->_stringValue);
+        output.writeString(data->_audioPath);
+        output.writeFloat(data->_volume);
+        output.writeFloat(data->_balance);
+    }
+
+    // Animations.
+    output.writeInt((int)skeletonData->_animations.size());
+    for (size_t i = 0, n = skeletonData->_animations.size(); i < n; ++i) {
+        if (!writeAnimation(output, skeletonData, skeletonData->_animations[i])) return false;
+    }
+
+    CacheHeader header;
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.byteOrder = CACHE_BYTE_ORDER;
+    header.sizeOfSizeT = sizeof(size_t);
+    header.sourceHash = sourceHash;
+    header.size = blob.size();
+    header.checksum = hashBytes(blob.data() + sizeof(header), blob.size() - sizeof(header));
+    memcpy(blob.data(), &header, sizeof(header));
+    return true;
+}
+
+void SkeletonDataCache::writeVertices(Output& output, VertexAttachment* attachment) {
+    output.writeInt((int)attachment->_worldVerticesLength);
+    output.writeArray(attachment->_bones);
+    output.writeArray(attachment->_vertices);
+}
+
+bool SkeletonDataCache::writeAttachment(Output& output, Attachment* attachment) {
+    output.writeString(attachment->getName());
+
+    const RTTI& rtti = attachment->getRTTI();
+    if (rtti.isExactly(RegionAttachment::rtti)) {
+        RegionAttachment* region = static_cast<RegionAttachment*>(attachment);
+        output.writeInt(ATTACHMENT_REGION);
+        output.writeString(region->_path);
+        output.writeFloat(region->_rotation);
+        output.writeFloat(region->_x);
+        output.writeFloat(region->_y);
+        output.writeFloat(region->_scaleX);
+        output.writeFloat(region->_scaleY);
+        output.writeFloat(region->_width);
+        output.writeFloat(region->_height);
+        output.writeColor(region->_color);
+    } else if (rtti.isExactly(BoundingBoxAttachment::rtti)) {
+        output.writeInt(ATTACHMENT_BOUNDING_BOX);
+        writeVertices(output, static_cast<VertexAttachment*>(attachment));
+    } else if (rtti.isExactly(MeshAttachment::rtti)) {
+        MeshAttachment* mesh = static_cast<MeshAttachment*>(attachment);
+        if (mesh->_parentMesh) {
+            // the vertices are the parent's, they're copied when it's resolved
+            output.writeInt(ATTACHMENT_LINKED_MESH);
+            output.writeString(mesh->_path);
+            output.writeColor(mesh->_color);
+            output.writeFloat(mesh->_width);
+            output.writeFloat(mesh->_height);
+        } else {
+            output.writeInt(ATTACHMENT_MESH);
+            output.writeString(mesh->_path);
+            output.writeColor(mesh->_color);
+            writeVertices(output, mesh);
+            output.writeArray(mesh->_regionUVs);
+            output.writeArray(mesh->_triangles);
+            output.writeInt(mesh->_hullLength);
+            output.writeArray(mesh->_edges);
+            output.writeFloat(mesh->_width);
+            output.writeFloat(mesh->_height);
+        }
+    } else if (rtti.isExactly(PathAttachment::rtti)) {
+        PathAttachment* path = static_cast<PathAttachment*>(attachment);
+        output.writeInt(ATTACHMENT_PATH);
+        output.writeBoolean(path->_closed);
+        output.writeBoolean(path->_constantSpeed);
+        writeVertices(output, path);
+        output.writeArray(path->_lengths);
+    } else if (rtti.isExactly(PointAttachment::rtti)) {
+        PointAttachment* point = static_cast<PointAttachment*>(attachment);
+        output.writeInt(ATTACHMENT_POINT);
+        output.writeFloat(point->_x);
+        output.writeFloat(point->_y);
+        output.writeFloat(point->_rotation);
+    } else if (rtti.isExactly(ClippingAttachment::rtti)) {
+        ClippingAttachment* clip = static_cast<ClippingAttachment*>(attachment);
+        output.writeInt(ATTACHMENT_CLIPPING);
+        output.writeInt(clip->_endSlot ? clip->_endSlot->getIndex() : -1);
+        writeVertices(output, clip);
+    } else {
+        _error = "Unknown attachment type: " + std::string(attachment->getName().buffer());
+        return false;
+    }
+    return true;
+}
+
+void SkeletonDataCache::writeCurves(Output& output, CurveTimeline* timeline, Vector<float>& frames) {
+    output.writeArray(frames);
+    output.writeArray(timeline->_curves);
+}
+
+bool SkeletonDataCache::writeAnimation(Output& output, SkeletonData* skeletonData, Animation* animation) {
+    Vector<Timeline*>& timelines = animation->getTimelines();
+    output.writeString(animation->getName());
+    output.writeFloat(animation->getDuration());
+    output.writeInt((int)timelines.size());
+    for (size_t i = 0, n = timelines.size(); i < n; ++i) {
+        Timeline* base = timelines[i];
+        const RTTI& rtti = base->getRTTI();
+        if (rtti.isExactly(AttachmentTimeline::rtti)) {
+            AttachmentTimeline* timeline = static_cast<AttachmentTimeline*>(base);
+            output.writeInt(TIMELINE_ATTACHMENT);
+            output.writeInt((int)timeline->_slotIndex);
+            output.writeArray(timeline->_frames);
+            for (size_t ii = 0; ii < timeline->_attachmentNames.size(); ++ii) output.writeString(timeline->_attachmentNames[ii]);
+        } else if (rtti.isExactly(ColorTimeline::rtti)) {
+            ColorTimeline* timeline = static_cast<ColorTimeline*>(base);
+            output.writeInt(TIMELINE_COLOR);
+            output.writeInt(timeline->_slotIndex);
+            writeCurves(output, timeline, timeline->_frames);
+        } else if (rtti.isExactly(TwoColorTimeline::rtti)) {
+            TwoColorTimeline* timeline = static_cast<TwoColorTimeline*>(base);
+            output.writeInt(TIMELINE_TWO_COLOR);
+            output.writeInt(timeline->_slotIndex);
+            writeCurves(output, timeline, timeline->_frames);
+        } else if (rtti.isExactly(RotateTimeline::rtti)) {
+            RotateTimeline* timeline = static_cast<RotateTimeline*>(base);
+            output.writeInt(TIMELINE_ROTATE);
+            output.writeInt(timeline->_boneIndex);
+            writeCurves(output, timeline, timeline->_frames);
+        } else if (rtti.isExactly(TranslateTimeline::rtti) || rtti.isExactly(ScaleTimeline::rtti) || rtti.isExactly(ShearTimeline::rtti)) {
+            TranslateTimeline* timeline = static_cast<TranslateTimeline*>(base);
+            output.writeInt(rtti.isExactly(ScaleTimeline::rtti) ? TIMELINE_SCALE : rtti.isExactly(ShearTimeline::rtti) ? TIMELINE_SHEAR : TIMELINE_TRANSLATE);
+            output.writeInt(timeline->_boneIndex);
+            writeCurves(output, timeline, timeline->_frames);
+        } else if (rtti.isExactly(IkConstraintTimeline::rtti)) {
+            IkConstraintTimeline* timeline = static_cast<IkConstraintTimeline*>(base);
+            output.writeInt(TIMELINE_IK_CONSTRAINT);
+            output.writeInt(timeline->_ikConstraintIndex);
+            writeCurves(output, timeline, timeline->_frames);
+        } else if (rtti.isExactly(TransformConstraintTimeline::rtti)) {
+            TransformConstraintTimeline* timeline = static_cast<TransformConstraintTimeline*>(base);
+            output.writeInt(TIMELINE_TRANSFORM_CONSTRAINT);
+            output.writeInt(timeline->_transformConstraintIndex);
+            writeCurves(output, timeline, timeline->_frames);
+        } else if (rtti.isExactly(PathConstraintPositionTimeline::rtti) || rtti.isExactly(PathConstraintSpacingTimeline::rtti)) {
+            PathConstraintPositionTimeline* timeline = static_cast<PathConstraintPositionTimeline*>(base);
+            output.writeInt(rtti.isExactly(PathConstraintSpacingTimeline::rtti) ? TIMELINE_PATH_SPACING : TIMELINE_PATH_POSITION);
+            output.writeInt(timeline->_pathConstraintIndex);
+            writeCurves(output, timeline, timeline->_frames);
+        } else if (rtti.isExactly(PathConstraintMixTimeline::rtti)) {
+            PathConstraintMixTimeline* timeline = static_cast<PathConstraintMixTimeline*>(base);
+            output.writeInt(TIMELINE_PATH_MIX);
+            output.writeInt(timeline->_pathConstraintIndex);
+            writeCurves(output, timeline, timeline->_frames);
+        } else if (rtti.isExactly(DeformTimeline::rtti)) {
+            DeformTimeline* timeline = static_cast<DeformTimeline*>(base);
+            int attachmentIndex = output.attachmentIndex(timeline->_attachment);
+            if (attachmentIndex < 0) {
+                _error = "Deform attachment not found: " + std::string(animation->getName().buffer());
+                return false;
+            }
+            output.writeInt(TIMELINE_DEFORM);
+            output.writeInt(timeline->_slotIndex);
+            output.writeInt(attachmentIndex);
+            writeCurves(output, timeline, timeline->_frames);
+            for (size_t ii = 0; ii < timeline->_frameVertices.size(); ++ii) output.writeArray(timeline->_frameVertices[ii]);
+        } else if (rtti.isExactly(DrawOrderTimeline::rtti)) {
+            DrawOrderTimeline* timeline = static_cast<DrawOrderTimeline*>(base);
+            output.writeInt(TIMELINE_DRAW_ORDER);
+            output.writeArray(timeline->_frames);
+            for (size_t ii = 0; ii < timeline->_drawOrders.size(); ++ii) output.writeArray(timeline->_drawOrders[ii]);
+        } else if (rtti.isExactly(EventTimeline::rtti)) {
+            EventTimeline* timeline = static_cast<EventTimeline*>(base);
+            output.writeInt(TIMELINE_EVENT);
+            output.writeArray(timeline->_frames);
+            for (size_t ii = 0; ii < timeline->_events.size(); ++ii) {
+                Event* event = timeline->_events[ii];
+                output.writeInt(indexOf(skeletonData->_events, &event->_data));
+                output.writeInt(event->_intValue);
+                output.writeFloat(event->_floatValue);
+                output.writeString(event->_stringValue);
+                output.writeFloat(event->_volume);
+                output.writeFloat(event->_balance);
+            }
+        } else {
+            _error = "Unknown timeline type in animation: " + std::string(animation->getName().buffer());
+            return false;
+        }
+    }
+    return true;
+}
+
+SkeletonData* SkeletonDataCache::readSkeletonData(const unsigned char* blob, size_t size, uint64_t sourceHash) {
+    _error.clear();
+    _attachments.clear();
+
+    CacheHeader header;
+    if (size < sizeof(header)) {
+        _error = "Skeleton data cache is truncated.";
+        return nullptr;
+    }
+    memcpy(&header, blob, sizeof(header));
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.byteOrder != CACHE_BYTE_ORDER || header.sizeOfSizeT != sizeof(size_t)) {
+        _error = "Skeleton data cache has another format.";
+        return nullptr;
+    }
+    if (header.sourceHash != sourceHash) {
+        _error = "Skeleton data cache is out of date.";
+        return nullptr;
+    }
+    if (header.size != size) {
+        _error = "Skeleton data cache is truncated.";
+        return nullptr;
+    }
+    if (header.checksum != hashBytes(blob + sizeof(header), size - sizeof(header))) {
+        _error = "Skeleton data cache is corrupted.";
+        return nullptr;
+    }
+
+    Input input(blob, size);
+    input.cursor += sizeof(header);
+
+    SkeletonData* skeletonData = new (__FILE__, __LINE__) SkeletonData();
+    skeletonData->_hash = input.readString();
+    skeletonData->_version = input.readString();
+    skeletonData->_x = input.readFloat();
+    skeletonData->_y = input.readFloat();
+    skeletonData->_width = input.readFloat();
+    skeletonData->_height = input.readFloat();
+    skeletonData->_fps = input.readFloat();
+    skeletonData->_imagesPath = input.readString();
+    skeletonData->_audioPath = input.readString();
+
+    // Bones.
+    size_t bonesCount = input.readCount();
+    skeletonData->_bones.setSize(bonesCount, nullptr);
+    for (size_t i = 0; i < bonesCount; ++i) {
+        String name = input.readName();
+        int parentIndex = input.readIndex(i, true);
+        if (input.failed) return setError(skeletonData);
+        BoneData* data = new (__FILE__, __LINE__) BoneData((int)i, name, parentIndex < 0 ? nullptr : skeletonData->_bones[parentIndex]);
+        skeletonData->_bones[i] = data;
+        data->_length = input.readFloat();
+        data->_x = input.readFloat();
+        data->_y = input.readFloat();
+        data->_rotation = input.readFloat();
+        data->_scaleX = input.readFloat();
+        data->_scaleY = input.readFloat();
+        data->_shearX = input.readFloat();
+        data->_shearY = input.readFloat();
+        data->_transformMode = input.readEnum(TransformMode_NoScaleOrReflection);
+        data->_skinRequired = input.readBoolean();
+    }
+
+    // Slots.
+    size_t slotsCount = input.readCount();
+    skeletonData->_slots.setSize(slotsCount, nullptr);
+    for (size_t i = 0; i < slotsCount; ++i) {
+        String name = input.readName();
+        BoneData* boneData = input.readElement(skeletonData->_bones);
+        if (!boneData) return setError(skeletonData);
+        SlotData* data = new (__FILE__, __LINE__) SlotData((int)i, name, *boneData);
+        skeletonData->_slots[i] = data;
+        input.readColor(data->_color);
+        input.readColor(data->_darkColor);
+        data->_hasDarkColor = input.readBoolean();
+        data->_attachmentName = input.readString();
+        data->_blendMode = input.readEnum(BlendMode_Screen);
+    }
+
+    // IK constraints.
+    size_t ikConstraintsCount = input.readCount();
+    skeletonData->_ikConstraints.setSize(ikConstraintsCount, nullptr);
+    for (size_t i = 0; i < ikConstraintsCount; ++i) {
+        String name = input.readName();
+        if (input.failed) return setError(skeletonData);
+        IkConstraintData* data = new (__FILE__, __LINE__) IkConstraintData(name);
+        skeletonData->_ikConstraints[i] = data;
+        data->setOrder((size_t)input.readInt());
+        data->setSkinRequired(input.readBoolean());
+        size_t count = input.readCount();
+        data->_bones.setSize(count, nullptr);
+        for (size_t ii = 0; ii < count; ++ii) data->_bones[ii] = input.readElement(skeletonData->_bones);
+        data->_target = input.readElement(skeletonData->_bones);
+        data->_mix = input.readFloat();
+        data->_softness = input.readFloat();
+        data->_bendDirection = input.readInt();
+        data->_compress = input.readBoolean();
+        data->_stretch = input.readBoolean();
+        data->_uniform = input.readBoolean();
+    }
+
+    // Transform constraints.
+    size_t transformConstraintsCount = input.readCount();
+    skeletonData->_transformConstraints.setSize(transformConstraintsCount, nullptr);
+    for (size_t i = 0; i < transformConstraintsCount; ++i) {
+        String name = input.readName();
+        if (input.failed) return setError(skeletonData);
+        TransformConstraintData* data = new (__FILE__, __LINE__) TransformConstraintData(name);
+        skeletonData->_transformConstraints[i] = data;
+        data->setOrder((size_t)input.readInt());
+        data->setSkinRequired(input.readBoolean());
+        size_t count = input.readCount();
+        data->_bones.setSize(count, nullptr);
+        for (size_t ii = 0; ii < count; ++ii) data->_bones[ii] = input.readElement(skeletonData->_bones);
+        data->_target = input.readElement(skeletonData->_bones);
+        data->_local = input.readBoolean();
+        data->_relative = input.readBoolean();
+        data->_offsetRotation = input.readFloat();
+        data->_offsetX = input.readFloat();
+        data->_offsetY = input.readFloat();
+        data->_offsetScaleX = input.readFloat();
+        data->_offsetScaleY = input.readFloat();
+        data->_offsetShearY = input.readFloat();
+        data->_rotateMix = input.readFloat();
+        data->_translateMix = input.readFloat();
+        data->_scaleMix = input.readFloat();
+        data->_shearMix = input.readFloat();
+    }
+
+    // Path constraints.
+    size_t pathConstraintsCount = input.readCount();
+    skeletonData->_pathConstraints.setSize(pathConstraintsCount, nullptr);
+    for (size_t i = 0; i < pathConstraintsCount; ++i) {
+        String name = input.readName();
+        if (input.failed) return setError(skeletonData);
+        PathConstraintData* data = new (__FILE__, __LINE__) PathConstraintData(name);
+        skeletonData->_pathConstraints[i] = data;
+        data->setOrder((size_t)input.readInt());
+        data->setSkinRequired(input.readBoolean());
+        size_t count = input.readCount();
+        data->_bones.setSize(count, nullptr);
+        for (size_t ii = 0; ii < count; ++ii) data->_bones[ii] = input.readElement(skeletonData->_bones);
+        data->_target = input.readElement(skeletonData->_slots);
+        data->_positionMode = input.readEnum(PositionMode_Percent);
+        data->_spacingMode = input.readEnum(SpacingMode_Percent);
+        data->_rotateMode = input.readEnum(RotateMode_ChainScale);
+        data->_offsetRotation = input.readFloat();
+        data->_position = input.readFloat();
+        data->_spacing = input.readFloat();
+        data->_rotateMix = input.readFloat();
+        data->_translateMix = input.readFloat();
+    }
+    if (input.failed) return setError(skeletonData);
+
+    // Skins.
+    int defaultSkinIndex = input.readInt();
+    size_t skinsCount = input.readCount();
+    for (size_t i = 0; i < skinsCount; ++i) {
+        String name = input.readName();
+        if (input.failed) return setError(skeletonData);
+        Skin* skin = new (__FILE__, __LINE__) Skin(name);
+        skeletonData->_skins.add(skin);
+
+        for (size_t ii = 0, n = input.readCount(); ii < n; ++ii) {
+            BoneData* bone = input.readElement(skeletonData->_bones);
+            if (bone) skin->getBones().add(bone);
+        }
+
+        for (size_t ii = 0, n = input.readCount(); ii < n; ++ii) {
+            ConstraintData* constraint = nullptr;
+            switch (input.readInt()) {
+                case CONSTRAINT_IK: constraint = input.readElement(skeletonData->_ikConstraints); break;
+                case CONSTRAINT_TRANSFORM: constraint = input.readElement(skeletonData->_transformConstraints); break;
+                case CONSTRAINT_PATH: constraint = input.readElement(skeletonData->_pathConstraints); break;
+                default: input.failed = true; break;
+            }
+            if (constraint) skin->getConstraints().add(constraint);
+        }
+
+        for (size_t ii = 0, n = input.readCount(); ii < n; ++ii) {
+            int slotIndex = input.readIndex(skeletonData->_slots.size());
+            String name = input.readName();
+            Attachment* attachment = readAttachment(input, skeletonData, skin);
+            if (input.failed) return setError(skeletonData);
+            // attachments without a region in the atlas are skipped like the json and binary loaders do
+            _attachments.push_back(attachment);
+            if (attachment) skin->setAttachment((size_t)slotIndex, name, attachment);
+        }
+    }
+    if (defaultSkinIndex >= (int)skeletonData->_skins.size()) input.failed = true;
+    if (defaultSkinIndex >= 0 && !input.failed) skeletonData->_defaultSkin = skeletonData->_skins[defaultSkinIndex];
+
+    // Linked meshes.
+    for (size_t i = 0, n = input.readCount(); i < n; ++i) {
+        int meshIndex = input.readIndex(_attachments.size());
+        int parentIndex = input.readIndex(_attachments.size());
+        bool inheritDeform = input.readBoolean();
+        if (input.failed) return setError(skeletonData);
+
+        Attachment* mesh = _attachments[meshIndex];
+        Attachment* parent = _attachments[parentIndex];
+        if (!mesh) continue;
+        if (!parent || !mesh->getRTTI().isExactly(MeshAttachment::rtti) || !parent->getRTTI().isExactly(MeshAttachment::rtti)) {
+            return setError(skeletonData, "Parent mesh not found in skeleton data cache.");
+        }
+        MeshAttachment* linkedMesh = static_cast<MeshAttachment*>(mesh);
+        MeshAttachment* parentMesh = static_cast<MeshAttachment*>(parent);
+        linkedMesh->_deformAttachment = inheritDeform ? static_cast<VertexAttachment*>(parentMesh) : linkedMesh;
+        // what MeshAttachment::setParentMesh does
+        linkedMesh->_parentMesh = parentMesh;
+        shareArray(linkedMesh->_bones, parentMesh->_bones);
+        shareArray(linkedMesh->_vertices, parentMesh->_vertices);
+        linkedMesh->_worldVerticesLength = parentMesh->_worldVerticesLength;
+        shareArray(linkedMesh->_regionUVs, parentMesh->_regionUVs);
+        shareArray(linkedMesh->_triangles, parentMesh->_triangles);
+        linkedMesh->_hullLength = parentMesh->_hullLength;
+        shareArray(linkedMesh->_edges, parentMesh->_edges);
+        linkedMesh->_width = parentMesh->_width;
+        linkedMesh->_height = parentMesh->_height;
+        linkedMesh->updateUVs();
+        _attachmentLoader->configureAttachment(linkedMesh);
+    }
+
+    // Events.
+    size_t eventsCount = input.readCount();
+    skeletonData->_events.setSize(eventsCount, nullptr);
+    for (size_t i = 0; i < eventsCount; ++i) {
+        String name = input.readName();
+        if (input.failed) return setError(skeletonData);
+        EventData* data = new (__FILE__, __LINE__) EventData(name);
+        skeletonData->_events[i] = data;
+        data->_intValue = input.readInt();
+        data->_floatValue = input.readFloat();
+        data->_stringValue = input.readString();
+        data->_audioPath = input.readString();
+        data->_volume = input.readFloat();
+        data->_balance = input.readFloat();
+    }
+
+    // Animations.
+    size_t animationsCount = input.readCount();
+    skeletonData->_animations.setSize(animationsCount, nullptr);
+    for (size_t i = 0; i < animationsCount; ++i) {
+        Animation* animation = readAnimation(input, skeletonData);
+        if (!animation) return setError(skeletonData);
+        skeletonData->_animations[i] = animation;
+    }
+
+    if (input.failed || input.cursor != input.end) return setError(skeletonData);
+    _attachments.clear();
+    return skeletonData;
+}
+
+SkeletonData* SkeletonDataCache::setError(SkeletonData* skeletonData, const char* error) {
+    delete skeletonData;
+    _attachments.clear();
+    _error = error;
+    return nullptr;
+}
+
+Attachment* SkeletonDataCache::readAttachment(Input& input, SkeletonData* skeletonData, Skin* skin) {
+    String name = input.readName();
+    int type = input.readInt();
+    if (input.failed) return nullptr;
+
+    // everything is read before the attachment is created, so the input is consumed if the loader skips it
+    switch (type) {
+        case ATTACHMENT_REGION: {
+            String path = input.readString();
+            float rotation = input.readFloat();
+            float x = input.readFloat();
+            float y = input.readFloat();
+            float scaleX = input.readFloat();
+            float scaleY = input.readFloat();
+            float width = input.readFloat();
+            float height = input.readFloat();
+            Color color;
+            input.readColor(color);
+            if (input.failed) return nullptr;
+
+            RegionAttachment* region = _attachmentLoader->newRegionAttachment(*skin, name, path);
+            if (!region) return nullptr;
+            region->_path = path;
+            region->_rotation = rotation;
+            region->_x = x;
+            region->_y = y;
+            region->_scaleX = scaleX;
+            region->_scaleY = scaleY;
+            region->_width = width;
+            region->_height = height;
+            region->_color = color;
+            region->updateOffset();
+            _attachmentLoader->configureAttachment(region);
+            return region;
+        }
+        case ATTACHMENT_BOUNDING_BOX: {
+            VertexData vertices = input.readVertices(skeletonData->_bones.size());
+            if (input.failed) return nullptr;
+
+            BoundingBoxAttachment* box = _attachmentLoader->newBoundingBoxAttachment(*skin, name);
+            if (!box) return nullptr;
+            vertices.apply(box);
+            _attachmentLoader->configureAttachment(box);
+            return box;
+        }
+        case ATTACHMENT_MESH: {
+            String path = input.readString();
+            Color color;
+            input.readColor(color);
+            VertexData vertices = input.readVertices(skeletonData->_bones.size());
+            ArrayRef<float> regionUVs = input.readArray<float>();
+            ArrayRef<unsigned short> triangles = input.readArray<unsigned short>();
+            int hullLength = input.readInt();
+            ArrayRef<unsigned short> edges = input.readArray<unsigned short>();
+            float width = input.readFloat();
+            float height = input.readFloat();
+            // the uvs are computed and rendered per world vertex
+            if (regionUVs.count != (size_t)vertices.worldVerticesLength || triangles.count % 3 != 0) input.failed = true;
+            for (size_t i = 0; i < triangles.count && !input.failed; ++i) {
+                if (triangles.data[i] * 2 >= vertices.worldVerticesLength) input.failed = true;
+            }
+            if (input.failed) return nullptr;
+
+            MeshAttachment* mesh = _attachmentLoader->newMeshAttachment(*skin, name, path);
+            if (!mesh) return nullptr;
+            mesh->_path = path;
+            mesh->_color = color;
+            vertices.apply(mesh);
+            regionUVs.apply(mesh->_regionUVs);
+            triangles.apply(mesh->_triangles);
+            mesh->updateUVs();
+            mesh->_hullLength = hullLength;
+            edges.apply(mesh->_edges);
+            mesh->_width = width;
+            mesh->_height = height;
+            _attachmentLoader->configureAttachment(mesh);
+            return mesh;
+        }
+        case ATTACHMENT_LINKED_MESH: {
+            String path = input.readString();
+            Color color;
+            input.readColor(color);
+            float width = input.readFloat();
+            float height = input.readFloat();
+            if (input.failed) return nullptr;
+
+            // configured once its parent is set
+            MeshAttachment* mesh = _attachmentLoader->newMeshAttachment(*skin, name, path);
+            if (!mesh) return nullptr;
+            mesh->_path = path;
+            mesh->_color = color;
+            mesh->_width = width;
+            mesh->_height = height;
+            return mesh;
+        }
+        case ATTACHMENT_PATH: {
+            bool closed = input.readBoolean();
+            bool constantSpeed = input.readBoolean();
+            VertexData vertices = input.readVertices(skeletonData->_bones.size());
+            ArrayRef<float> lengths = input.readArray<float>();
+            // a length per curve of 3 vertices
+            if (lengths.count * 6 != (size_t)vertices.worldVerticesLength) input.failed = true;
+            if (input.failed) return nullptr;
+
+            PathAttachment* path = _attachmentLoader->newPathAttachment(*skin, name);
+            if (!path) return nullptr;
+            path->_closed = closed;
+            path->_constantSpeed = constantSpeed;
+            vertices.apply(path);
+            lengths.apply(path->_lengths);
+            _attachmentLoader->configureAttachment(path);
+            return path;
+        }
+        case ATTACHMENT_POINT: {
+            float x = input.readFloat();
+            float y = input.readFloat();
+            float rotation = input.readFloat();
+            if (input.failed) return nullptr;
+
+            PointAttachment* point = _attachmentLoader->newPointAttachment(*skin, name);
+            if (!point) return nullptr;
+            point->_x = x;
+            point->_y = y;
+            point->_rotation = rotation;
+            _attachmentLoader->configureAttachment(point);
+            return point;
+        }
+        case ATTACHMENT_CLIPPING: {
+            int endSlotIndex = input.readIndex(skeletonData->_slots.size(), true);
+            VertexData vertices = input.readVertices(skeletonData->_bones.size());
+            if (input.failed) return nullptr;
+
+            ClippingAttachment* clip = _attachmentLoader->newClippingAttachment(*skin, name);
+            if (!clip) return nullptr;
+            clip->_endSlot = endSlotIndex < 0 ? nullptr : skeletonData->_slots[endSlotIndex];
+            vertices.apply(clip);
+            _attachmentLoader->configureAttachment(clip);
+            return clip;
+        }
+        default:
+            input.failed = true;
+            return nullptr;
+    }
+}
+
+size_t SkeletonDataCache::readCurves(Input& input, CurveTimeline* timeline, Vector<float>& frames, size_t entries) {
+    size_t frameCount = input.readFrames(frames, entries);
+    ArrayRef<float> curves = input.readArray<float>();
+    if (input.failed || curves.count != (frameCount - 1) * CurveTimeline::BEZIER_SIZE) {
+        input.failed = true;
+        return 0;
+    }
+    curves.apply(timeline->_curves);
+    return frameCount;
+}
+
+Animation* SkeletonDataCache::readAnimation(Input& input, SkeletonData* skeletonData) {
+    String name = input.readName();
+    float duration = input.readFloat();
+    size_t timelinesCount = input.readCount();
+    size_t slotsCount = skeletonData->_slots.size();
+    size_t bonesCount = skeletonData->_bones.size();
+
+    // the timelines are created for one frame and their frames are set to the blob
+    Vector<Timeline*> timelines;
+    timelines.ensureCapacity(timelinesCount);
+    for (size_t i = 0; i < timelinesCount && !input.failed; ++i) {
+        int type = input.readInt();
+        switch (type) {
+            case TIMELINE_ATTACHMENT: {
+                AttachmentTimeline* timeline = new (__FILE__, __LINE__) AttachmentTimeline(1);
+                timelines.add(timeline);
+                timeline->_slotIndex = (size_t)input.readIndex(slotsCount);
+                size_t frameCount = input.readFrames(timeline->_frames, 1);
+                timeline->_attachmentNames.setSize(frameCount, String());
+                for (size_t ii = 0; ii < frameCount; ++ii) timeline->_attachmentNames[ii] = input.readString();
+                break;
+            }
+            case TIMELINE_COLOR: {
+                ColorTimeline* timeline = new (__FILE__, __LINE__) ColorTimeline(1);
+                timelines.add(timeline);
+                timeline->_slotIndex = input.readIndex(slotsCount);
+                readCurves(input, timeline, timeline->_frames, ColorTimeline::ENTRIES);
+                break;
+            }
+            case TIMELINE_TWO_COLOR: {
+                TwoColorTimeline* timeline = new (__FILE__, __LINE__) TwoColorTimeline(1);
+                timelines.add(timeline);
+                timeline->_slotIndex = input.readIndex(slotsCount);
+                readCurves(input, timeline, timeline->_frames, TwoColorTimeline::ENTRIES);
+                break;
+            }
+            case TIMELINE_ROTATE: {
+                RotateTimeline* timeline = new (__FILE__, __LINE__) RotateTimeline(1);
+                timelines.add(timeline);
+                timeline->_boneIndex = input.readIndex(bonesCount);
+                readCurves(input, timeline, timeline->_frames, RotateTimeline::ENTRIES);
+                break;
+            }
+            case TIMELINE_TRANSLATE:
+            case TIMELINE_SCALE:
+            case TIMELINE_SHEAR: {
+                TranslateTimeline* timeline;
+                if (type == TIMELINE_SCALE) {
+                    timeline = new (__FILE__, __LINE__) ScaleTimeline(1);
+                } else if (type == TIMELINE_SHEAR) {
+                    timeline = new (__FILE__, __LINE__) ShearTimeline(1);
+                } else {
+                    timeline = new (__FILE__, __LINE__) TranslateTimeline(1);
+                }
+                timelines.add(timeline);
+                timeline->_boneIndex = input.readIndex(bonesCount);
+                readCurves(input, timeline, timeline->_frames, TranslateTimeline::ENTRIES);
+                break;
+            }
+            case TIMELINE_IK_CONSTRAINT: {
+                IkConstraintTimeline* timeline = new (__FILE__, __LINE__) IkConstraintTimeline(1);
+                timelines.add(timeline);
+                timeline->_ikConstraintIndex = input.readIndex(skeletonData->_ikConstraints.size());
+                readCurves(input, timeline, timeline->_frames, IkConstraintTimeline::ENTRIES);
+                break;
+            }
+            case TIMELINE_TRANSFORM_CONSTRAINT: {
+                TransformConstraintTimeline* timeline = new (__FILE__, __LINE__) TransformConstraintTimeline(1);
+                timelines.add(timeline);
+                timeline->_transformConstraintIndex = input.readIndex(skeletonData->_transformConstraints.size());
+                readCurves(input, timeline, timeline->_frames, TransformConstraintTimeline::ENTRIES);
+                break;
+            }
+            case TIMELINE_PATH_POSITION:
+            case TIMELINE_PATH_SPACING: {
+                PathConstraintPositionTimeline* timeline;
+                if (type == TIMELINE_PATH_SPACING) {
+                    timeline = new (__FILE__, __LINE__) PathConstraintSpacingTimeline(1);
+                } else {
+                    timeline = new (__FILE__, __LINE__) PathConstraintPositionTimeline(1);
+                }
+                timelines.add(timeline);
+                timeline->_pathConstraintIndex = input.readIndex(skeletonData->_pathConstraints.size());
+                readCurves(input, timeline, timeline->_frames, PathConstraintPositionTimeline::ENTRIES);
+                break;
+            }
+            case TIMELINE_PATH_MIX: {
+                PathConstraintMixTimeline* timeline = new (__FILE__, __LINE__) PathConstraintMixTimeline(1);
+                timelines.add(timeline);
+                timeline->_pathConstraintIndex = input.readIndex(skeletonData->_pathConstraints.size());
+                readCurves(input, timeline, timeline->_frames, PathConstraintMixTimeline::ENTRIES);
+                break;
+            }
+            case TIMELINE_DEFORM: {
+                DeformTimeline* timeline = new (__FILE__, __LINE__) DeformTimeline(1);
+                timelines.add(timeline);
+                timeline->_slotIndex = input.readIndex(slotsCount);
+                int attachmentIndex = input.readIndex(_attachments.size());
+                Attachment* attachment = input.failed ? nullptr : _attachments[attachmentIndex];
+                if (!attachment || !attachment->getRTTI().instanceOf(VertexAttachment::rtti)) {
+                    input.failed = true;
+                    break;
+                }
+                timeline->_attachment = static_cast<VertexAttachment*>(attachment);
+                size_t frameCount = readCurves(input, timeline, timeline->_frames, 1);
+                // the deform is applied to the vertices, or per bone weight when the attachment is weighted
+                VertexAttachment* vertexAttachment = timeline->_attachment;
+                size_t deformLength = vertexAttachment->_bones.size() == 0 ? vertexAttachment->_vertices.size() : vertexAttachment->_vertices.size() / 3 * 2;
+                timeline->_frameVertices.setSize(frameCount, Vector<float>());
+                for (size_t ii = 0; ii < frameCount; ++ii) {
+                    input.readArray<float>().apply(timeline->_frameVertices[ii]);
+                    if (timeline->_frameVertices[ii].size() != deformLength) input.failed = true;
+                }
+                break;
+            }
+            case TIMELINE_DRAW_ORDER: {
+                DrawOrderTimeline* timeline = new (__FILE__, __LINE__) DrawOrderTimeline(1);
+                timelines.add(timeline);
+                size_t frameCount = input.readFrames(timeline->_frames, 1);
+                timeline->_drawOrders.setSize(frameCount, Vector<int>());
+                for (size_t ii = 0; ii < frameCount; ++ii) {
+                    Vector<int>& drawOrder = timeline->_drawOrders[ii];
+                    input.readArray<int>().apply(drawOrder);
+                    // an empty draw order is the setup pose one
+                    if (drawOrder.size() != 0 && drawOrder.size() != slotsCount) input.failed = true;
+                    for (size_t iii = 0; iii < drawOrder.size() && !input.failed; ++iii) {
+                        if (drawOrder[iii] < 0 || (size_t)drawOrder[iii] >= slotsCount) input.failed = true;
+                    }
+                }
+                break;
+            }
+            case TIMELINE_EVENT: {
+                EventTimeline* timeline = new (__FILE__, __LINE__) EventTimeline(1);
+                timelines.add(timeline);
+                size_t frameCount = input.readFrames(timeline->_frames, 1);
+                timeline->_events.setSize(frameCount, nullptr);
+                for (size_t ii = 0; ii < frameCount; ++ii) {
+                    EventData* data = input.readElement(skeletonData->_events);
+                    if (!data) break;
+                    Event* event = new (__FILE__, __LINE__) Event(timeline->_frames[ii], *data);
+                    timeline->_events[ii] = event;
+                    event->_intValue = input.readInt();
+                    event->_floatValue = input.readFloat();
+                    event->_stringValue = input.readString();
+                    event->_volume = input.readFloat();
+                    event->_balance = input.readFloat();
+                }
+                break;
+            }
+            default:
+                input.failed = true;
+                break;
+        }
+    }
+
+    if (input.failed) {
+        ContainerUtil::cleanUpVectorOfPointers(timelines);
+        return nullptr;
+    }
+    return new (__FILE__, __LINE__) Animation(name, timelines, duration);
+}
+
+std::string SkeletonDataCache::getCachePath(const std::string& uuid) {
+    std::string name = uuid;
+    for (auto& c : name) {
+        if (!isalnum((unsigned char)c) && c != '-' && c != '_') c = '_';
+    }
+    return cocos2d::FileUtils::getInstance()->getWritablePath() + "spine-cache/" + name + ".bin";
+}
+
+SkeletonData* SkeletonDataCache::readSkeletonDataFile(const std::string& uuid, uint64_t sourceHash, std::shared_ptr<const cocos2d::MappedFile>& file) {
+    auto fileUtils = cocos2d::FileUtils::getInstance();
+    std::string path = getCachePath(uuid);
+    file = fileUtils->isFileExist(path) ? fileUtils->getMappedFile(path) : nullptr;
+    if (!file || file->isNull()) {
+        file = nullptr;
+        _error = "No skeleton data cache.";
+        return nullptr;
+    }
+
+    SkeletonData* skeletonData = readSkeletonData(file->getBytes(), (size_t)file->getSize(), sourceHash);
+    if (!skeletonData) file = nullptr;
+    return skeletonData;
+}
+
+bool SkeletonDataCache::writeSkeletonDataFile(const std::string& uuid, uint64_t sourceHash, SkeletonData* skeletonData) {
+    std::vector<unsigned char> blob;
+    if (!writeSkeletonData(skeletonData, sourceHash, blob)) return false;
+
+    auto fileUtils = cocos2d::FileUtils::getInstance();
+    std::string path = getCachePath(uuid);
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!fileUtils->isDirectoryExist(directory) && !fileUtils->createDirectory(directory)) {
+        _error = "Unable to create directory: " + directory;
+        return false;
+    }
+
+    // written aside and renamed, so a partly written cache is never read
+    std::string tempPath = path + ".tmp";
+    cocos2d::Data data;
+    data.copy(blob.data(), (ssize_t)blob.size());
+    if (!fileUtils->writeDataToFile(data, tempPath)) {
+        _error = "Unable to write skeleton data cache: " + tempPath;
+        return false;
+    }
+    if (fileUtils->isFileExist(path)) fileUtils->removeFile(path);
+    if (!fileUtils->renameFile(tempPath, path)) {
+        fileUtils->removeFile(tempPath);
+        _error = "Unable to write skeleton data cache: " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,89 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated January 1, 2020. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2020, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#pragma once
+
+#include "spine/spine.h"
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cocos2d {
+class MappedFile;
+}
+
+namespace spine {
+
+/**
+ * Native cache of skeleton data, written the first time the data is parsed from json or binary.
+ * The cache is one contiguous blob without pointers, the float, index and size arrays of meshes,
+ * paths and timelines point into it instead of being copied, so it must outlive the data read from it.
+ */
+class SkeletonDataCache {
+public:
+    explicit SkeletonDataCache(AttachmentLoader* attachmentLoader);
+
+    // the hash a cache is written with, it's only read back for the same source and scale
+    static uint64_t hashSource(const unsigned char* source, size_t size, float scale);
+
+    SkeletonData* readSkeletonData(const unsigned char* blob, size_t size, uint64_t sourceHash);
+    bool writeSkeletonData(SkeletonData* skeletonData, uint64_t sourceHash, std::vector<unsigned char>& blob);
+
+    // the cache files are in the writable path, the file is kept alive by the caller
+    static std::string getCachePath(const std::string& uuid);
+    SkeletonData* readSkeletonDataFile(const std::string& uuid, uint64_t sourceHash, std::shared_ptr<const cocos2d::MappedFile>& file);
+    bool writeSkeletonDataFile(const std::string& uuid, uint64_t sourceHash, SkeletonData* skeletonData);
+
+    const std::string& getError() const { return _error; }
+
+private:
+    struct Input;
+    struct Output;
+
+    void writeVertices(Output& output, VertexAttachment* attachment);
+    bool writeAttachment(Output& output, Attachment* attachment);
+    bool writeAnimation(Output& output, SkeletonData* skeletonData, Animation* animation);
+    void writeCurves(Output& output, CurveTimeline* timeline, Vector<float>& frames);
+
+    // deletes the partly read data
+    SkeletonData* setError(SkeletonData* skeletonData, const char* error = "Skeleton data cache is corrupted.");
+    // returns null if the loader skips the attachment, or if the input failed
+    Attachment* readAttachment(Input& input, SkeletonData* skeletonData, Skin* skin);
+    Animation* readAnimation(Input& input, SkeletonData* skeletonData);
+    // returns the frame count, 0 if the input failed
+    size_t readCurves(Input& input, CurveTimeline* timeline, Vector<float>& frames, size_t entries);
+
+    AttachmentLoader* _attachmentLoader;
+    std::string _error;
+    // attachments in the order they're written, linked meshes and deform timelines refer to them by index
+    std::vector<Attachment*> _attachments;
+};
+
+}
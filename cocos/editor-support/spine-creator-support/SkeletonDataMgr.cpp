@@ -28,6 +28,8 @@
  *****************************************************************************/
 
 #include "SkeletonDataMgr.h"
+#include "spine-cocos2dx.h"
+#include "platform/CCFileUtils.h"
 #include <algorithm>
 #include <vector>
 
@@ -54,11 +56,19 @@ public:
             delete attachmentLoader;
             attachmentLoader = nullptr;
         }
+
+        if (arena) {
+            delete arena;
+            arena = nullptr;
+        }
     }
 
     SkeletonData *data = nullptr;
     Atlas *atlas = nullptr;
     AttachmentLoader *attachmentLoader = nullptr;
+    SpineArena *arena = nullptr;
+    // the arrays of the data point into it
+    std::shared_ptr<const cocos2d::MappedFile> cacheFile;
     std::vector<int> texturesIndex;
 };
 
@@ -71,7 +81,7 @@ bool SkeletonDataMgr::hasSkeletonData (const std::string& uuid) {
     return it != _dataMap.end();
 }
 
-void SkeletonDataMgr::setSkeletonData (const std::string& uuid, SkeletonData* data, Atlas* atlas, AttachmentLoader* attachmentLoader, const std::vector<int>& texturesIndex) {
+void SkeletonDataMgr::setSkeletonData (const std::string& uuid, SkeletonData* data, Atlas* atlas, AttachmentLoader* attachmentLoader, const std::vector<int>& texturesIndex, SpineArena* arena, std::shared_ptr<const cocos2d::MappedFile> cacheFile) {
     auto it = _dataMap.find(uuid);
     if (it != _dataMap.end()) {
         releaseByUUID(uuid);
@@ -81,6 +91,8 @@ void SkeletonDataMgr::setSkeletonData (const std::string& uuid, SkeletonData* da
     info->atlas = atlas;
     info->attachmentLoader = attachmentLoader;
     info->texturesIndex = texturesIndex;
+    info->arena = arena;
+    info->cacheFile = cacheFile;
     _dataMap[uuid] = info;
 }
 
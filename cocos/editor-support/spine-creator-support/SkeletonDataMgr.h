@@ -36,10 +36,16 @@
 #include "spine/spine.h"
 #include <vector>
 #include <functional>
+#include <memory>
+
+namespace cocos2d {
+class MappedFile;
+}
 
 namespace spine {
 
 class SkeletonDataInfo;
+class SpineArena;
 
 /**
  * Cache skeleton data.
@@ -66,7 +72,9 @@ public:
         _destroyCallback = NULL;
     }
     bool hasSkeletonData (const std::string& uuid);
-    void setSkeletonData (const std::string& uuid, SkeletonData* data, Atlas* atlas, AttachmentLoader* attachmentLoader, const std::vector<int>& texturesIndex);
+    // the arena the data was loaded into is deleted after the data, atlas and attachment loader,
+    // and the cache file the data was read from is released after them
+    void setSkeletonData (const std::string& uuid, SkeletonData* data, Atlas* atlas, AttachmentLoader* attachmentLoader, const std::vector<int>& texturesIndex, SpineArena* arena = nullptr, std::shared_ptr<const cocos2d::MappedFile> cacheFile = nullptr);
     SkeletonData* retainByUUID (const std::string& uuid);
     void releaseByUUID (const std::string& uuid);
     
@@ -39,6 +39,7 @@
 #include "SkeletonDataMgr.h"
 #include "renderer/gfx/Texture.h"
 #include "spine-creator-support/AttachUtil.h"
+#include "spine/VertexKernels.h"
 
 USING_NS_CC;
 USING_NS_MW;
@@ -300,6 +301,11 @@ void SkeletonRenderer::render (float deltaTime) {
     // verex size in floats with two color
     int vs2 = vbs2 / sizeof(float);
     const cocos2d::Mat4& nodeWorldMat = _nodeProxy->getWorldMatrix();
+    // 2D affine part of the node world matrix, laid out as a spine bone matrix.
+    const float worldMatrix2D[6] = {
+        nodeWorldMat.m[0], nodeWorldMat.m[4], nodeWorldMat.m[12],
+        nodeWorldMat.m[1], nodeWorldMat.m[5], nodeWorldMat.m[13]
+    };
     
 	int vbSize = 0;
     int ibSize = 0;
@@ -599,10 +605,14 @@ void SkeletonRenderer::render (float deltaTime) {
         }
         darkColor.a = _premultipliedAlpha ? 255 : 0;
         
+        // Pack colors once, so the per vertex fill is a single 32 bit store.
+        cocos2d::Color4B vertexColor((GLubyte)color.r, (GLubyte)color.g, (GLubyte)color.b, (GLubyte)color.a);
+        cocos2d::Color4B vertexDarkColor((GLubyte)darkColor.r, (GLubyte)darkColor.g, (GLubyte)darkColor.b, (GLubyte)darkColor.a);
+        
         // One color tint logic
         if (!_useTint) {
-            // Cliping logic
-            if (_clipper->isClipping()) {
+            // Cliping logic, skipped when the whole attachment lies inside the clipping area
+            if (_clipper->isClipping() && !_clipper->containsVertices((float*)&triangles.verts[0].vertex, triangles.vertCount, vs1)) {
                 _clipper->clipTriangles((float*)&triangles.verts[0].vertex, triangles.indices, triangles.indexCount, (float*)&triangles.verts[0].texCoord, vs1);
                 
                 if (_clipper->getClippedTriangles().size() == 0) {
@@ -652,10 +662,7 @@ void SkeletonRenderer::render (float deltaTime) {
                         vertex->vertex.y = verts[vv + 1];
                         vertex->texCoord.u = uvs[vv];
                         vertex->texCoord.v = uvs[vv + 1];
-                        vertex->color.r = (GLubyte)color.r;
-                        vertex->color.g = (GLubyte)color.g;
-                        vertex->color.b = (GLubyte)color.b;
-                        vertex->color.a = (GLubyte)color.a;
+                        vertex->color = vertexColor;
                     }
                 }
             // No cliping logic
@@ -681,17 +688,14 @@ void SkeletonRenderer::render (float deltaTime) {
                 } else {
                     for (int v = 0, vn = triangles.vertCount; v < vn; ++v) {
                         V2F_T2F_C4B* vertex = triangles.verts + v;
-                        vertex->color.r = (GLubyte)color.r;
-                        vertex->color.g = (GLubyte)color.g;
-                        vertex->color.b = (GLubyte)color.b;
-                        vertex->color.a = (GLubyte)color.a;
+                        vertex->color = vertexColor;
                     }
                 }
             }
         }
         // Two color tint logic
         else {
-            if (_clipper->isClipping()) {
+            if (_clipper->isClipping() && !_clipper->containsVertices((float*)&trianglesTwoColor.verts[0].vertex, trianglesTwoColor.vertCount, vs2)) {
                 _clipper->clipTriangles((float*)&trianglesTwoColor.verts[0].vertex, trianglesTwoColor.indices, trianglesTwoColor.indexCount, (float*)&trianglesTwoColor.verts[0].texCoord, vs2);
                 
                 if (_clipper->getClippedTriangles().size() == 0) {
@@ -706,6 +710,7 @@ void SkeletonRenderer::render (float deltaTime) {
                 
                 trianglesTwoColor.indexCount = (int)_clipper->getClippedTriangles().size();
                 ibSize = trianglesTwoColor.indexCount * sizeof(unsigned short);
+                ib.checkSpace(ibSize, true);
                 trianglesTwoColor.indices = (unsigned short*)ib.getCurBuffer();
                 memcpy(trianglesTwoColor.indices, _clipper->getClippedTriangles().buffer(), sizeof(unsigned short) * _clipper->getClippedTriangles().size());
                 
@@ -748,14 +753,8 @@ void SkeletonRenderer::render (float deltaTime) {
                         vertex->vertex.y = verts[vv + 1];
                         vertex->texCoord.u = uvs[vv];
                         vertex->texCoord.v = uvs[vv + 1];
-                        vertex->color.r = (GLubyte)color.r;
-                        vertex->color.g = (GLubyte)color.g;
-                        vertex->color.b = (GLubyte)color.b;
-                        vertex->color.a = (GLubyte)color.a;
-                        vertex->color2.r = (GLubyte)darkColor.r;
-                        vertex->color2.g = (GLubyte)darkColor.g;
-                        vertex->color2.b = (GLubyte)darkColor.b;
-                        vertex->color2.a = (GLubyte)darkColor.a;
+                        vertex->color = vertexColor;
+                        vertex->color2 = vertexDarkColor;
                     }
                 }
             } else {
@@ -788,14 +787,8 @@ void SkeletonRenderer::render (float deltaTime) {
                 } else {
                     for (int v = 0, vn = trianglesTwoColor.vertCount; v < vn; ++v) {
                         V2F_T2F_C4B_C4B* vertex = trianglesTwoColor.verts + v;
-                        vertex->color.r = (GLubyte)color.r;
-                        vertex->color.g = (GLubyte)color.g;
-                        vertex->color.b = (GLubyte)color.b;
-                        vertex->color.a = (GLubyte)color.a;
-                        vertex->color2.r = (GLubyte)darkColor.r;
-                        vertex->color2.g = (GLubyte)darkColor.g;
-                        vertex->color2.b = (GLubyte)darkColor.b;
-                        vertex->color2.a = (GLubyte)darkColor.a;
+                        vertex->color = vertexColor;
+                        vertex->color2 = vertexDarkColor;
                     }
                 }
             }
@@ -817,17 +810,8 @@ void SkeletonRenderer::render (float deltaTime) {
             }
             
             if (_batch) {
-                uint8_t* vbBuffer = vb.getCurBuffer();
-                cocos2d::Vec3* point = nullptr;
-                float tempZ = 0.0f;
-                for (int ii = 0, nn = vbSize; ii < nn; ii += vbs)
-                {
-                    point = (cocos2d::Vec3*)(vbBuffer + ii);
-                    tempZ = point->z;
-                    point->z = 0;
-                    nodeWorldMat.transformPoint(point);
-                    point->z = tempZ;
-                }
+                float* vbBuffer = (float*)vb.getCurBuffer();
+                VertexKernels::transformPoints(vbBuffer, vbs / sizeof(float), vbBuffer, vbs / sizeof(float), vbSize / vbs, worldMatrix2D);
             }
             
             if (vertexOffset > 0) {
@@ -32,6 +32,22 @@
 #include "middleware-adapter.h"
 #include "base/CCData.h"
 #include "platform/CCFileUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+// block header size, keeps 16 bytes alignment of malloc
+#define SPINE_BLOCK_HEADER_SIZE 16
+// size class step of pooled blocks
+#define SPINE_SIZE_CLASS_STEP 16
+// count of size classes, blocks larger than STEP * COUNT bytes are not pooled
+#define SPINE_SIZE_CLASS_COUNT 16
+// max free blocks kept per size class and thread
+#define SPINE_MAX_POOLED_BLOCKS 4096
+// size class of blocks carved from a SpineArena
+#define SPINE_ARENA_SIZE_CLASS 0xffffffff
+// chunk size of SpineArena, blocks larger than a quarter of it get a chunk of their own
+#define SPINE_ARENA_CHUNK_SIZE (64 * 1024)
 
 namespace spine {
     static CustomTextureLoader _customTextureLoader = nullptr;
@@ -146,18 +162,253 @@ void Cocos2dTextureLoader::unload(void* texture) {
     }
 }
 
-Cocos2dExtension::Cocos2dExtension() : DefaultSpineExtension() { }
+namespace {
+    // Every block starts with a header, the size class of pooled block is sizeClass + 1,
+    // 0 means block is allocated by malloc directly, SPINE_ARENA_SIZE_CLASS by an arena.
+    struct BlockHeader {
+        uint32_t size;
+        uint32_t sizeClass;
+        SpineArena::Chunk* chunk;
+    };
+    static_assert(sizeof(BlockHeader) <= SPINE_BLOCK_HEADER_SIZE, "spine block header is too large");
+    
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    
+    struct SizeClassPool {
+        FreeBlock* heads[SPINE_SIZE_CLASS_COUNT] = {};
+        size_t counts[SPINE_SIZE_CLASS_COUNT] = {};
+        
+        ~SizeClassPool();
+    };
+    
+    // Plain flag, still valid while thread local pool is destroyed at thread exit.
+    thread_local bool t_poolDestroyed = false;
+    thread_local SizeClassPool t_pool;
+    thread_local SpineArena* t_arena = nullptr;
+    
+    SizeClassPool::~SizeClassPool() {
+        t_poolDestroyed = true;
+        for (int i = 0; i < SPINE_SIZE_CLASS_COUNT; ++i) {
+            FreeBlock* block = heads[i];
+            while (block) {
+                FreeBlock* next = block->next;
+                ::free(block);
+                block = next;
+            }
+            heads[i] = nullptr;
+            counts[i] = 0;
+        }
+    }
+    
+    std::atomic<size_t> s_arenaBytes(0);
+    
+    inline BlockHeader* headerOf(void* mem) {
+        return (BlockHeader*)((uint8_t*)mem - SPINE_BLOCK_HEADER_SIZE);
+    }
+    
+    inline void* memOf(BlockHeader* header) {
+        return (uint8_t*)header + SPINE_BLOCK_HEADER_SIZE;
+    }
+    
+    inline size_t roundUp(size_t size) {
+        return (size + SPINE_SIZE_CLASS_STEP - 1) / SPINE_SIZE_CLASS_STEP * SPINE_SIZE_CLASS_STEP;
+    }
+    
+    inline size_t capacityOf(BlockHeader* header) {
+        if (header->sizeClass == SPINE_ARENA_SIZE_CLASS) return roundUp(header->size);
+        return header->sizeClass > 0 ? header->sizeClass * SPINE_SIZE_CLASS_STEP : header->size;
+    }
+}
+
+struct SpineArena::Chunk {
+    Chunk* next;
+    size_t capacity;
+    size_t used;
+    // blocks of the chunk not freed yet, they may be freed by other threads
+    std::atomic<size_t> liveCount;
+    
+    uint8_t* data() {
+        return (uint8_t*)this + roundUp(sizeof(Chunk));
+    }
+};
+
+SpineArena::SpineArena() { }
+
+SpineArena::~SpineArena() {
+    Chunk* chunk = _chunks;
+    while (chunk) {
+        Chunk* next = chunk->next;
+        chunk->~Chunk();
+        ::free(chunk);
+        chunk = next;
+    }
+    s_arenaBytes -= _reservedBytes;
+}
+
+void* SpineArena::alloc(size_t size) {
+    size_t blockSize = SPINE_BLOCK_HEADER_SIZE + roundUp(size);
+    // large blocks get a chunk of their own, so they don't waste the rest of the current one
+    bool dedicated = blockSize > SPINE_ARENA_CHUNK_SIZE / 4;
+    Chunk* chunk = dedicated ? nullptr : _current;
+    if (!chunk || chunk->used + blockSize > chunk->capacity) {
+        size_t capacity = dedicated ? blockSize : SPINE_ARENA_CHUNK_SIZE;
+        size_t bytes = roundUp(sizeof(Chunk)) + capacity;
+        void* mem = ::malloc(bytes);
+        if (!mem) return nullptr;
+        chunk = new (mem) Chunk();
+        chunk->capacity = capacity;
+        chunk->used = 0;
+        chunk->liveCount = 0;
+        chunk->next = _chunks;
+        _chunks = chunk;
+        if (!dedicated) _current = chunk;
+        _reservedBytes += bytes;
+        s_arenaBytes += bytes;
+    }
+    
+    BlockHeader* header = (BlockHeader*)(chunk->data() + chunk->used);
+    chunk->used += blockSize;
+    chunk->liveCount++;
+    header->sizeClass = SPINE_ARENA_SIZE_CLASS;
+    header->chunk = chunk;
+    return header;
+}
+
+void SpineArena::trim() {
+    Chunk** link = &_chunks;
+    while (*link) {
+        Chunk* chunk = *link;
+        if (chunk != _current && chunk->liveCount == 0) {
+            *link = chunk->next;
+            size_t bytes = roundUp(sizeof(Chunk)) + chunk->capacity;
+            _reservedBytes -= bytes;
+            s_arenaBytes -= bytes;
+            chunk->~Chunk();
+            ::free(chunk);
+        } else {
+            link = &chunk->next;
+        }
+    }
+}
+
+SpineArenaScope::SpineArenaScope(SpineArena* arena) : _arena(arena), _previous(t_arena) {
+    t_arena = arena;
+}
+
+SpineArenaScope::~SpineArenaScope() {
+    t_arena = _previous;
+    if (_arena) _arena->trim();
+}
+
+Cocos2dExtension::Cocos2dExtension() : DefaultSpineExtension(), _liveBytes(0), _liveCount(0), _allocCount(0), _pooledAllocCount(0) { }
     
 Cocos2dExtension::~Cocos2dExtension() { }
 
+void* Cocos2dExtension::allocBlock(size_t size) {
+    if (size == 0) return nullptr;
+    
+    BlockHeader* header = nullptr;
+    size_t sizeClass = (size + SPINE_SIZE_CLASS_STEP - 1) / SPINE_SIZE_CLASS_STEP;
+    if (t_arena) {
+        header = (BlockHeader*)t_arena->alloc(size);
+        sizeClass = SPINE_ARENA_SIZE_CLASS;
+    } else if (sizeClass <= SPINE_SIZE_CLASS_COUNT) {
+        if (!t_poolDestroyed) {
+            auto& pool = t_pool;
+            FreeBlock* block = pool.heads[sizeClass - 1];
+            if (block) {
+                pool.heads[sizeClass - 1] = block->next;
+                pool.counts[sizeClass - 1]--;
+                header = (BlockHeader*)block;
+                _pooledAllocCount++;
+            }
+        }
+        if (!header) {
+            header = (BlockHeader*)::malloc(SPINE_BLOCK_HEADER_SIZE + sizeClass * SPINE_SIZE_CLASS_STEP);
+        }
+    } else {
+        sizeClass = 0;
+        header = (BlockHeader*)::malloc(SPINE_BLOCK_HEADER_SIZE + size);
+    }
+    if (!header) return nullptr;
+    
+    header->size = (uint32_t)size;
+    header->sizeClass = (uint32_t)sizeClass;
+    _liveBytes += size;
+    _liveCount++;
+    _allocCount++;
+    return memOf(header);
+}
+
+void Cocos2dExtension::freeBlock(void* mem) {
+    if (!mem) return;
+    
+    BlockHeader* header = headerOf(mem);
+    _liveBytes -= header->size;
+    _liveCount--;
+    
+    size_t sizeClass = header->sizeClass;
+    if (sizeClass == SPINE_ARENA_SIZE_CLASS) {
+        // the memory goes back with its chunk
+        header->chunk->liveCount--;
+        return;
+    }
+    if (sizeClass > 0 && !t_poolDestroyed) {
+        auto& pool = t_pool;
+        if (pool.counts[sizeClass - 1] < SPINE_MAX_POOLED_BLOCKS) {
+            FreeBlock* block = (FreeBlock*)header;
+            block->next = pool.heads[sizeClass - 1];
+            pool.heads[sizeClass - 1] = block;
+            pool.counts[sizeClass - 1]++;
+            return;
+        }
+    }
+    ::free(header);
+}
+
+void *Cocos2dExtension::_alloc(size_t size, const char *file, int line) {
+    return allocBlock(size);
+}
+
+void *Cocos2dExtension::_calloc(size_t size, const char *file, int line) {
+    void *ptr = allocBlock(size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+void *Cocos2dExtension::_realloc(void *ptr, size_t size, const char *file, int line) {
+    if (size == 0) return nullptr;
+    if (ptr == nullptr) return allocBlock(size);
+    
+    BlockHeader* header = headerOf(ptr);
+    if (header->sizeClass > 0 && size <= capacityOf(header)) {
+        _liveBytes += size;
+        _liveBytes -= header->size;
+        header->size = (uint32_t)size;
+        return ptr;
+    }
+    
+    void* mem = allocBlock(size);
+    if (mem) {
+        memcpy(mem, ptr, std::min(size, (size_t)header->size));
+        freeBlock(ptr);
+    }
+    return mem;
+}
+
 char *Cocos2dExtension::_readFile(const spine::String &path, int *length) {
     *length = 0;
-    Data data = FileUtils::getInstance()->getDataFromFile(FileUtils::getInstance()->fullPathForFilename(path.buffer()));
-    if (data.isNull()) return 0;
+    auto file = FileUtils::getInstance()->getMappedFile(FileUtils::getInstance()->fullPathForFilename(path.buffer()));
+    if (!file || file->isNull()) return 0;
 
-    char *ret = (char*)malloc(sizeof(unsigned char) * data.getSize());
-    memcpy(ret, (char*)data.getBytes(), data.getSize());
-    *length = (int)data.getSize();
+    // Spine frees file content with SpineExtension::free, so it must come from the same allocator.
+    char *ret = SpineExtension::alloc<char>(file->getSize(), __FILE__, __LINE__);
+    memcpy(ret, (const char*)file->getBytes(), file->getSize());
+    *length = (int)file->getSize();
     return ret;
 }
 
@@ -167,5 +418,17 @@ SpineExtension *spine::getDefaultExtension () {
 
 void Cocos2dExtension::_free(void *mem, const char *file, int line) {
     _spineObjectDisposeCallback(mem);
-    DefaultSpineExtension::_free(mem, file, line);
+    freeBlock(mem);
+}
+
+SpineAllocatorStats Cocos2dExtension::getAllocatorStats() {
+    SpineAllocatorStats stats;
+    stats.liveBytes = _liveBytes;
+    stats.liveCount = _liveCount;
+    stats.allocCount = _allocCount;
+    stats.pooledAllocCount = _pooledAllocCount;
+    stats.frameAllocCount = stats.allocCount - _lastAllocCount;
+    stats.arenaBytes = s_arenaBytes;
+    _lastAllocCount = stats.allocCount;
+    return stats;
 }
@@ -37,6 +37,7 @@
 #include "spine-creator-support/SkeletonCacheAnimation.h"
 #include "spine-creator-support/AttachUtil.h"
 #include "middleware-adapter.h"
+#include <atomic>
 
 namespace spine {
     typedef cocos2d::middleware::Texture2D* (*CustomTextureLoader)(const char* path);
@@ -61,15 +62,89 @@ namespace spine {
         virtual void unload(void* texture);
     };
     
+    struct SpineAllocatorStats {
+        // bytes requested by spine and not freed yet
+        size_t liveBytes = 0;
+        // allocations not freed yet
+        size_t liveCount = 0;
+        // allocations since startup
+        size_t allocCount = 0;
+        // allocations served from size class pools since startup
+        size_t pooledAllocCount = 0;
+        // allocations since the previous call of getAllocatorStats
+        size_t frameAllocCount = 0;
+        // bytes of chunks held by skeleton data arenas
+        size_t arenaBytes = 0;
+    };
+    
+    /**
+     * Memory of one SkeletonData. While a SpineArenaScope of the arena is open, spine allocations
+     * of that thread are carved from its chunks, and they are all released with the arena.
+     * Delete the arena after the skeleton data, atlas and attachment loader loaded in its scope.
+     */
+    class SpineArena {
+    public:
+        SpineArena();
+        ~SpineArena();
+        
+        // bytes of the chunks the arena holds
+        size_t getReservedBytes() const { return _reservedBytes; }
+        
+        struct Chunk;
+    private:
+        void *alloc(size_t size);
+        // releases the chunks whose blocks were all freed, e.g. the json document of the loader
+        void trim();
+        
+        Chunk *_chunks = nullptr;
+        Chunk *_current = nullptr;
+        size_t _reservedBytes = 0;
+        
+        friend class Cocos2dExtension;
+        friend class SpineArenaScope;
+    };
+    
+    /**
+     * Routes the spine allocations of the current thread to an arena until the scope ends.
+     */
+    class SpineArenaScope {
+    public:
+        explicit SpineArenaScope(SpineArena *arena);
+        ~SpineArenaScope();
+    private:
+        SpineArena *_arena;
+        SpineArena *_previous;
+    };
+    
+    /**
+     * Spine allocator of the engine. Small blocks come from per thread size class
+     * pools, so animating a skeleton in steady state does not touch malloc, and
+     * skeleton data is loaded into a SpineArena of its own.
+     */
     class Cocos2dExtension: public DefaultSpineExtension {
     public:
         Cocos2dExtension();
         
         virtual ~Cocos2dExtension();
         
+        virtual void *_alloc(size_t size, const char *file, int line);
+        virtual void *_calloc(size_t size, const char *file, int line);
+        virtual void *_realloc(void *ptr, size_t size, const char *file, int line);
         virtual void _free(void *mem, const char *file, int line);
+        
+        // poll it once per frame, frameAllocCount counts from the previous call
+        SpineAllocatorStats getAllocatorStats();
     protected:
         virtual char *_readFile(const String &path, int *length);
+    private:
+        void *allocBlock(size_t size);
+        void freeBlock(void *mem);
+        
+        std::atomic<size_t> _liveBytes;
+        std::atomic<size_t> _liveCount;
+        std::atomic<size_t> _allocCount;
+        std::atomic<size_t> _pooledAllocCount;
+        size_t _lastAllocCount = 0;
     };
     
     typedef void (*SpineObjectDisposeCallback)(void*);
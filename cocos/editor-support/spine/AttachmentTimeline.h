@@ -44,6 +44,7 @@ namespace spine {
 
 	class SP_API AttachmentTimeline : public Timeline {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		RTTI_DECL
@@ -36,10 +36,32 @@
 #include <spine/BoneData.h>
 #include <spine/Skeleton.h>
 
+#include <stddef.h>
+
 using namespace spine;
 
 RTTI_IMPL(Bone, Updatable)
 
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+namespace spine {
+// getWorldMatrix() and the vertex kernels read the world transform as one float array.
+constexpr bool hasContiguousWorldMatrix() {
+	return offsetof(Bone, _b) == offsetof(Bone, _a) + sizeof(float) &&
+		offsetof(Bone, _worldX) == offsetof(Bone, _a) + 2 * sizeof(float) &&
+		offsetof(Bone, _c) == offsetof(Bone, _a) + 3 * sizeof(float) &&
+		offsetof(Bone, _d) == offsetof(Bone, _a) + 4 * sizeof(float) &&
+		offsetof(Bone, _worldY) == offsetof(Bone, _a) + 5 * sizeof(float);
+}
+}
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+static_assert(hasContiguousWorldMatrix(), "Bone world matrix must be contiguous");
+
 bool Bone::yDown = false;
 
 void Bone::setYDown(bool inValue) {
@@ -208,6 +208,11 @@ public:
 
 	void setWorldY(float inValue);
 
+	/// The world transform as six contiguous floats: a, b, worldX, c, d, worldY.
+	inline const float *getWorldMatrix() const {
+		return &_a;
+	}
+
 	float getWorldRotationX();
 
 	float getWorldRotationY();
@@ -245,6 +250,8 @@ private:
 	///
 	/// Some information is ambiguous in the world transform, such as -1,-1 scale versus 180 rotation.
 	void updateAppliedTransform();
+
+	friend constexpr bool hasContiguousWorldMatrix();
 };
 }
 
@@ -37,6 +37,7 @@
 namespace spine {
 class SP_API BoneData : public SpineObject {
 	friend class SkeletonBinary;
+	friend class SkeletonDataCache;
 
 	friend class SkeletonJson;
 
@@ -37,6 +37,7 @@ namespace spine {
 
 	class SP_API ClippingAttachment : public VertexAttachment {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		friend class SkeletonClipping;
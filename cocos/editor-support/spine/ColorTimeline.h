@@ -35,6 +35,7 @@
 namespace spine {
 class SP_API ColorTimeline : public CurveTimeline {
 	friend class SkeletonBinary;
+	friend class SkeletonDataCache;
 
 	friend class SkeletonJson;
 
@@ -36,6 +36,8 @@
 namespace spine {
 	/// Base class for frames that use an interpolation bezier curve.
 	class SP_API CurveTimeline : public Timeline {
+		friend class SkeletonDataCache;
+
 		RTTI_DECL
 
 	public:
@@ -37,6 +37,7 @@ namespace spine {
 
 	class SP_API DeformTimeline : public CurveTimeline {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		RTTI_DECL
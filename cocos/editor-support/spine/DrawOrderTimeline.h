@@ -35,6 +35,7 @@
 namespace spine {
 	class SP_API DrawOrderTimeline : public Timeline {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		RTTI_DECL
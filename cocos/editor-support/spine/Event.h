@@ -39,6 +39,7 @@ class EventData;
 /// Stores the current pose values for an Event.
 class SP_API Event : public SpineObject {
 	friend class SkeletonBinary;
+	friend class SkeletonDataCache;
 
 	friend class SkeletonJson;
 
@@ -37,6 +37,7 @@ namespace spine {
 /// Stores the setup pose values for an Event.
 class SP_API EventData : public SpineObject {
 	friend class SkeletonBinary;
+	friend class SkeletonDataCache;
 
 	friend class SkeletonJson;
 
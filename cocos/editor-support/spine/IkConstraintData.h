@@ -40,6 +40,7 @@ namespace spine {
 
 	class SP_API IkConstraintData : public ConstraintData {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 		friend class IkConstraint;
 		friend class Skeleton;
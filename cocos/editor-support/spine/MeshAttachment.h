@@ -39,6 +39,7 @@ namespace spine {
 	/// Attachment that displays a texture region using a mesh.
 	class SP_API MeshAttachment : public VertexAttachment, public HasRendererObject {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 		friend class AtlasAttachmentLoader;
 
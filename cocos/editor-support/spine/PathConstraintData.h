@@ -44,6 +44,7 @@ namespace spine {
 
 	class SP_API PathConstraintData : public ConstraintData {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		friend class PathConstraint;
@@ -43,6 +43,7 @@ namespace spine {
 	///
 	class SP_API PointAttachment : public Attachment {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		RTTI_DECL
@@ -44,6 +44,7 @@ namespace spine {
 	/// Attachment that displays a texture region.
 	class SP_API RegionAttachment : public Attachment, public HasRendererObject {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 		friend class AtlasAttachmentLoader;
 
@@ -35,6 +35,7 @@
 namespace spine {
 	class SP_API RotateTimeline : public CurveTimeline {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 		friend class AnimationState;
 
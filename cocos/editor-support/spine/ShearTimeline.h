@@ -35,6 +35,7 @@
 namespace spine {
 	class SP_API ShearTimeline : public TranslateTimeline {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		RTTI_DECL
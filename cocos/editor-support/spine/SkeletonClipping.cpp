@@ -36,9 +36,11 @@
 #include <spine/Slot.h>
 #include <spine/ClippingAttachment.h>
 
+#include <float.h>
+
 using namespace spine;
 
-SkeletonClipping::SkeletonClipping() : _clipAttachment(NULL) {
+SkeletonClipping::SkeletonClipping() : _clipAttachment(NULL), _clippingPolygons(NULL), _clipMinX(0), _clipMinY(0), _clipMaxX(0), _clipMaxY(0) {
 	_clipOutput.ensureCapacity(128);
 	_clippedVertices.ensureCapacity(128);
 	_clippedTriangles.ensureCapacity(128);
@@ -58,14 +60,42 @@ size_t SkeletonClipping::clipStart(Slot &slot, ClippingAttachment *clip) {
 	makeClockwise(_clippingPolygon);
 	_clippingPolygons = &_triangulator.decompose(_clippingPolygon, _triangulator.triangulate(_clippingPolygon));
 
+	_clippingPolygonBounds.setSize(_clippingPolygons->size() * 4, 0);
+	_clipMinX = _clipMinY = FLT_MAX;
+	_clipMaxX = _clipMaxY = -FLT_MAX;
+	size_t maxPolygonLength = 0;
 	for (size_t i = 0; i < _clippingPolygons->size(); ++i) {
 		Vector<float> *polygonP = (*_clippingPolygons)[i];
 		Vector<float> &polygon = *polygonP;
 		makeClockwise(polygon);
 		polygon.add(polygon[0]);
 		polygon.add(polygon[1]);
+
+		float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+		for (size_t ii = 0, nn = polygon.size(); ii < nn; ii += 2) {
+			float x = polygon[ii], y = polygon[ii + 1];
+			minX = MathUtil::min(minX, x);
+			minY = MathUtil::min(minY, y);
+			maxX = MathUtil::max(maxX, x);
+			maxY = MathUtil::max(maxY, y);
+		}
+		_clippingPolygonBounds[i * 4] = minX;
+		_clippingPolygonBounds[i * 4 + 1] = minY;
+		_clippingPolygonBounds[i * 4 + 2] = maxX;
+		_clippingPolygonBounds[i * 4 + 3] = maxY;
+		_clipMinX = MathUtil::min(_clipMinX, minX);
+		_clipMinY = MathUtil::min(_clipMinY, minY);
+		_clipMaxX = MathUtil::max(_clipMaxX, maxX);
+		_clipMaxY = MathUtil::max(_clipMaxY, maxY);
+		maxPolygonLength = MathUtil::max(maxPolygonLength, polygon.size());
 	}
 
+	// Clipping a triangle against a convex polygon adds at most one vertex per edge, so reserving
+	// that much up front keeps clip from reallocating in the common case.
+	size_t clipCapacity = maxPolygonLength + 8;
+	_scratch.ensureCapacity(clipCapacity);
+	_clipOutput.ensureCapacity(clipCapacity);
+
 	return (*_clippingPolygons).size();
 }
 
@@ -84,6 +114,7 @@ void SkeletonClipping::clipEnd() {
 	_clippedUVs.clear();
 	_clippedTriangles.clear();
 	_clippingPolygon.clear();
+	_clippingPolygonBounds.clear();
 }
 
 void SkeletonClipping::clipTriangles(Vector<float> &vertices, Vector<unsigned short> &triangles, Vector<float> &uvs, size_t stride) {
@@ -104,6 +135,14 @@ void SkeletonClipping::clipTriangles(float *vertices, unsigned short *triangles,
 	_clippedUVs.clear();
 	clippedTriangles.clear();
 
+	// Unclipped triangles emit 3 vertices per 3 indices, which is the common size of the output.
+	clippedVertices.ensureCapacity(trianglesLength * 2);
+	_clippedUVs.ensureCapacity(trianglesLength * 2);
+	clippedTriangles.ensureCapacity(trianglesLength);
+
+	float clipMinX = _clipMinX, clipMinY = _clipMinY, clipMaxX = _clipMaxX, clipMaxY = _clipMaxY;
+	float *bounds = _clippingPolygonBounds.buffer();
+
 	size_t i = 0;
 	continue_outer:
 	for (; i < trianglesLength; i += 3) {
@@ -119,9 +158,22 @@ void SkeletonClipping::clipTriangles(float *vertices, unsigned short *triangles,
 		float x3 = vertices[vertexOffset], y3 = vertices[vertexOffset + 1];
 		float u3 = uvs[vertexOffset], v3 = uvs[vertexOffset + 1];
 
+		// Triangles outside of the clipping area bounds produce no output.
+		float minX = MathUtil::min(x1, MathUtil::min(x2, x3)), maxX = MathUtil::max(x1, MathUtil::max(x2, x3));
+		float minY = MathUtil::min(y1, MathUtil::min(y2, y3)), maxY = MathUtil::max(y1, MathUtil::max(y2, y3));
+		if (maxX < clipMinX || minX > clipMaxX || maxY < clipMinY || minY > clipMaxY) continue;
+
 		for (size_t p = 0; p < polygonsCount; p++) {
+			float *polygonBounds = bounds + p * 4;
+			if (maxX < polygonBounds[0] || minX > polygonBounds[2] || maxY < polygonBounds[1] || minY > polygonBounds[3]) continue;
+
 			size_t s = clippedVertices.size();
-			if (clip(x1, y1, x2, y2, x3, y3, &(*polygons[p]), &clipOutput)) {
+			Vector<float> *polygon = polygons[p];
+			// A triangle inside a convex polygon is emitted unchanged, which is what clip would report after
+			// running every edge. Testing the vertices directly avoids building the clip output.
+			bool contained = minX > polygonBounds[0] && maxX < polygonBounds[2] && minY > polygonBounds[1] && maxY < polygonBounds[3] &&
+				inside(x1, y1, polygon) && inside(x2, y2, polygon) && inside(x3, y3, polygon);
+			if (!contained && clip(x1, y1, x2, y2, x3, y3, polygon, &clipOutput)) {
 				size_t clipOutputLength = clipOutput.size();
 				if (clipOutputLength == 0) continue;
 				float d0 = y2 - y3, d1 = x3 - x2, d2 = x1 - x3, d4 = y3 - y1;
@@ -187,6 +239,31 @@ bool SkeletonClipping::isClipping() {
 	return _clipAttachment != NULL;
 }
 
+bool SkeletonClipping::containsVertices(const float *vertices, size_t verticesCount, size_t stride) {
+	if (_clipAttachment == NULL || verticesCount == 0) return false;
+
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	for (size_t i = 0, v = 0; i < verticesCount; ++i, v += stride) {
+		minX = MathUtil::min(minX, vertices[v]);
+		minY = MathUtil::min(minY, vertices[v + 1]);
+		maxX = MathUtil::max(maxX, vertices[v]);
+		maxY = MathUtil::max(maxY, vertices[v + 1]);
+	}
+
+	Vector<Vector<float> *> &polygons = *_clippingPolygons;
+	for (size_t p = 0, n = polygons.size(); p < n; ++p) {
+		float *polygonBounds = _clippingPolygonBounds.buffer() + p * 4;
+		if (minX <= polygonBounds[0] || maxX >= polygonBounds[2] || minY <= polygonBounds[1] || maxY >= polygonBounds[3]) continue;
+
+		size_t i = 0;
+		for (size_t v = 0; i < verticesCount; ++i, v += stride) {
+			if (!inside(vertices[v], vertices[v + 1], polygons[p])) break;
+		}
+		if (i == verticesCount) return true;
+	}
+	return false;
+}
+
 Vector<float> &SkeletonClipping::getClippedVertices() {
 	return _clippedVertices;
 }
@@ -301,6 +378,17 @@ bool SkeletonClipping::clip(float x1, float y1, float x2, float y2, float x3, fl
 	return clipped;
 }
 
+bool SkeletonClipping::inside(float x, float y, Vector<float> *clippingArea) {
+	Vector<float> &clippingVertices = *clippingArea;
+	for (size_t i = 0, n = clippingArea->size() - 2; i < n; i += 2) {
+		float edgeX = clippingVertices[i], edgeY = clippingVertices[i + 1];
+		float edgeX2 = clippingVertices[i + 2], edgeY2 = clippingVertices[i + 3];
+		float deltaX = edgeX - edgeX2, deltaY = edgeY - edgeY2;
+		if (!(deltaX * (y - edgeY2) - deltaY * (x - edgeX2) > 0)) return false;
+	}
+	return true;
+}
+
 void SkeletonClipping::makeClockwise(Vector<float> &polygon) {
 	size_t verticeslength = polygon.size();
 
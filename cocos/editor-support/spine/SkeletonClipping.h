@@ -53,6 +53,10 @@ namespace spine {
 
 		bool isClipping();
 
+		/// Returns true if all vertices lie strictly inside one convex part of the clipping area. Any triangles built
+		/// from such vertices are not changed by clipTriangles, so the caller may skip clipping altogether.
+		bool containsVertices(const float* vertices, size_t verticesCount, size_t stride);
+
 		Vector<float>& getClippedVertices();
 		Vector<unsigned short>& getClippedTriangles();
 		Vector<float>& getClippedUVs();
@@ -67,11 +71,17 @@ namespace spine {
 		Vector<float> _scratch;
 		ClippingAttachment* _clipAttachment;
 		Vector< Vector<float>* > *_clippingPolygons;
+		/// Bounds of each convex clipping polygon, as minX, minY, maxX, maxY.
+		Vector<float> _clippingPolygonBounds;
+		float _clipMinX, _clipMinY, _clipMaxX, _clipMaxY;
 
 		/** Clips the input triangle against the convex, clockwise clipping area. If the triangle lies entirely within the clipping
 		  * area, false is returned. The clipping area must duplicate the first vertex at the end of the vertices list. */
 		bool clip(float x1, float y1, float x2, float y2, float x3, float y3, Vector<float>* clippingArea, Vector<float>* output);
 
+		/** Returns true if the point lies strictly inside the convex clipping area, using the same edge test as clip. */
+		static bool inside(float x, float y, Vector<float>* clippingArea);
+
 		static void makeClockwise(Vector<float>& polygon);
 	};
 }
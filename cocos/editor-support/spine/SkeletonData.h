@@ -53,6 +53,7 @@ class PathConstraintData;
 /// Stores the setup pose and all of the stateless data for a skeleton.
 class SP_API SkeletonData : public SpineObject {
 	friend class SkeletonBinary;
+	friend class SkeletonDataCache;
 
 	friend class SkeletonJson;
 
@@ -40,6 +40,7 @@ class BoneData;
 
 class SP_API SlotData : public SpineObject {
 	friend class SkeletonBinary;
+	friend class SkeletonDataCache;
 
 	friend class SkeletonJson;
 
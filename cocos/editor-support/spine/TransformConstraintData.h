@@ -40,6 +40,7 @@ namespace spine {
 
 	class SP_API TransformConstraintData : public ConstraintData {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		friend class TransformConstraint;
@@ -39,6 +39,7 @@ namespace spine {
 
 	class SP_API TranslateTimeline : public CurveTimeline {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		RTTI_DECL
@@ -36,6 +36,7 @@ namespace spine {
 
 	class SP_API TwoColorTimeline : public CurveTimeline {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 
 		RTTI_DECL
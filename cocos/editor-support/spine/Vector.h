@@ -39,10 +39,10 @@ namespace spine {
 template<typename T>
 class SP_API Vector : public SpineObject {
 public:
-	Vector() : _size(0), _capacity(0), _buffer(NULL) {
+	Vector() : _size(0), _capacity(0), _buffer(NULL), _external(false) {
 	}
 
-	Vector(const Vector &inVector) : _size(inVector._size), _capacity(inVector._capacity), _buffer(NULL) {
+	Vector(const Vector &inVector) : _size(inVector._size), _capacity(inVector._capacity), _buffer(NULL), _external(false) {
 		if (_capacity > 0) {
 			_buffer = allocate(_capacity);
 			for (size_t i = 0; i < _size; ++i) {
@@ -74,6 +74,7 @@ public:
 
 	inline void setSize(size_t newSize, const T &defaultValue) {
 		assert(newSize >= 0);
+		if (_external) ownBuffer();
 		size_t oldSize = _size;
 		_size = newSize;
 		if (_capacity < newSize) {
@@ -90,11 +91,13 @@ public:
 
 	inline void ensureCapacity(size_t newCapacity = 0) {
 		if (_capacity >= newCapacity) return;
+		if (_external) ownBuffer();
 		_capacity = newCapacity;
 		_buffer = SpineExtension::realloc<T>(_buffer, newCapacity, __FILE__, __LINE__);
 	}
 
 	inline void add(const T &inValue) {
+		if (_external) ownBuffer();
 		if (_size == _capacity) {
 			// inValue might reference an element in this buffer
 			// When we reallocate, the reference becomes invalid.
@@ -124,6 +127,7 @@ public:
 
 	inline void removeAt(size_t inIndex) {
 		assert(inIndex < _size);
+		if (_external) ownBuffer();
 
 		--_size;
 
@@ -186,10 +190,36 @@ public:
 		return _buffer;
 	}
 
+	// Uses memory owned by someone else as the storage, e.g. a mapped cache file
+	// that may be read-only. Only for plain types: the elements are copied into
+	// an own buffer before the vector is resized, and must not be written through
+	// operator[] or buffer() while external.
+	inline void setExternalBuffer(T *buffer, size_t size) {
+		clear();
+		deallocate(_buffer);
+		_buffer = buffer;
+		_size = _capacity = size;
+		_external = true;
+	}
+
+	inline bool isExternalBuffer() const {
+		return _external;
+	}
+
 private:
 	size_t _size;
 	size_t _capacity;
 	T *_buffer;
+	bool _external;
+
+	inline void ownBuffer() {
+		T *buffer = _capacity > 0 ? allocate(_capacity) : NULL;
+		for (size_t i = 0; i < _size; ++i) {
+			construct(buffer + i, _buffer[i]);
+		}
+		_buffer = buffer;
+		_external = false;
+	}
 
 	inline T *allocate(size_t n) {
 		assert(n > 0);
@@ -202,7 +232,7 @@ private:
 	}
 
 	inline void deallocate(T *buffer) {
-		if (_buffer) {
+		if (_buffer && !_external) {
 			SpineExtension::free(buffer, __FILE__, __LINE__);
 		}
 	}
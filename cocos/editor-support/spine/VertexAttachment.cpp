@@ -37,6 +37,7 @@
 
 #include <spine/Bone.h>
 #include <spine/Skeleton.h>
+#include <spine/VertexKernels.h>
 
 using namespace spine;
 
@@ -61,7 +62,8 @@ void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t cou
 }
 
 void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t count, float *worldVertices, size_t offset, size_t stride) {
-	count = offset + (count >> 1) * stride;
+	size_t vertexCount = count >> 1;
+	count = offset + vertexCount * stride;
 	Skeleton &skeleton = slot._bone._skeleton;
 	Vector<float> *deformArray = &slot.getDeform();
 	Vector<float> *vertices = &_vertices;
@@ -70,15 +72,7 @@ void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t cou
 		if (deformArray->size() > 0) vertices = deformArray;
 
 		Bone &bone = slot._bone;
-		float x = bone._worldX;
-		float y = bone._worldY;
-		float a = bone._a, b = bone._b, c = bone._c, d = bone._d;
-		for (size_t vv = start, w = offset; w < count; vv += 2, w += stride) {
-			float vx = (*vertices)[vv];
-			float vy = (*vertices)[vv + 1];
-			worldVertices[w] = vx * a + vy * b + x;
-			worldVertices[w + 1] = vx * c + vy * d + y;
-		}
+		VertexKernels::transformPoints(vertices->buffer() + start, 2, worldVertices + offset, stride, vertexCount, bone.getWorldMatrix());
 		return;
 	}
 
@@ -90,41 +84,9 @@ void VertexAttachment::computeWorldVertices(Slot &slot, size_t start, size_t cou
 	}
 
 	Vector<Bone *> &skeletonBones = skeleton.getBones();
-	if (deformArray->size() == 0) {
-		for (size_t w = offset, b = skip * 3; w < count; w += stride) {
-			float wx = 0, wy = 0;
-			int n = bones[v++];
-			n += v;
-			for (; v < n; v++, b += 3) {
-				Bone *boneP = skeletonBones[bones[v]];
-				Bone &bone = *boneP;
-				float vx = (*vertices)[b];
-				float vy = (*vertices)[b + 1];
-				float weight = (*vertices)[b + 2];
-				wx += (vx * bone._a + vy * bone._b + bone._worldX) * weight;
-				wy += (vx * bone._c + vy * bone._d + bone._worldY) * weight;
-			}
-			worldVertices[w] = wx;
-			worldVertices[w + 1] = wy;
-		}
-	} else {
-		for (size_t w = offset, b = skip * 3, f = skip << 1; w < count; w += stride) {
-			float wx = 0, wy = 0;
-			int n = bones[v++];
-			n += v;
-			for (; v < n; v++, b += 3, f += 2) {
-				Bone *boneP = skeletonBones[bones[v]];
-				Bone &bone = *boneP;
-				float vx = (*vertices)[b] + (*deformArray)[f];
-				float vy = (*vertices)[b + 1] + (*deformArray)[f + 1];
-				float weight = (*vertices)[b + 2];
-				wx += (vx * bone._a + vy * bone._b + bone._worldX) * weight;
-				wy += (vx * bone._c + vy * bone._d + bone._worldY) * weight;
-			}
-			worldVertices[w] = wx;
-			worldVertices[w + 1] = wy;
-		}
-	}
+	const float *deform = deformArray->size() == 0 ? NULL : deformArray->buffer() + (skip << 1);
+	VertexKernels::skinVertices(bones.buffer() + v, vertices->buffer() + skip * 3, deform, worldVertices, offset, count, stride,
+		[&skeletonBones](size_t index) -> const float * { return skeletonBones[index]->getWorldMatrix(); });
 }
 
 int VertexAttachment::getId() {
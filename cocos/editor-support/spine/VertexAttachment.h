@@ -40,6 +40,7 @@ namespace spine {
 	/// An attachment with vertices that are transformed by one or more bones and can be deformed by a slot's vertices.
 	class SP_API VertexAttachment : public Attachment {
 		friend class SkeletonBinary;
+		friend class SkeletonDataCache;
 		friend class SkeletonJson;
 		friend class DeformTimeline;
 
@@ -0,0 +1,162 @@
+/******************************************************************************
+ * Spine Runtimes License Agreement
+ * Last updated January 1, 2020. Replaces all prior versions.
+ *
+ * Copyright (c) 2013-2020, Esoteric Software LLC
+ *
+ * Integration of the Spine Runtimes into software or otherwise creating
+ * derivative works of the Spine Runtimes is permitted under the terms and
+ * conditions of Section 2 of the Spine Editor License Agreement:
+ * http://esotericsoftware.com/spine-editor-license
+ *
+ * Otherwise, it is permitted to integrate the Spine Runtimes into software
+ * or otherwise create derivative works of the Spine Runtimes (collectively,
+ * "Products"), provided that each user of the Products must obtain their own
+ * Spine Editor license and redistribution of the Products in any form must
+ * include this license and copyright notice.
+ *
+ * THE SPINE RUNTIMES ARE PROVIDED BY ESOTERIC SOFTWARE LLC "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL ESOTERIC SOFTWARE LLC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES,
+ * BUSINESS INTERRUPTION, OR LOSS OF USE, DATA, OR PROFITS) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THE SPINE RUNTIMES, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#ifndef Spine_VertexKernels_h
+#define Spine_VertexKernels_h
+
+#include <stddef.h>
+
+#ifndef SPINE_DISABLE_SIMD
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SPINE_USE_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define SPINE_USE_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace spine {
+/// Vertex kernels shared by VertexAttachment and the renderers.
+///
+/// A bone matrix is passed as a pointer to six contiguous floats laid out as
+/// a, b, worldX, c, d, worldY, which is how Bone stores its world transform.
+namespace VertexKernels {
+
+/// Transforms count 2D points by an affine matrix. src and dst are read and written
+/// at the given strides (in floats), so the transform may be done in place.
+inline void transformPoints(const float *src, size_t srcStride, float *dst, size_t dstStride, size_t count, const float *m) {
+	size_t i = 0;
+#if defined(SPINE_USE_SSE)
+	const __m128 col0 = _mm_setr_ps(m[0], m[3], m[0], m[3]);
+	const __m128 col1 = _mm_setr_ps(m[1], m[4], m[1], m[4]);
+	const __m128 trans = _mm_setr_ps(m[2], m[5], m[2], m[5]);
+	for (; i + 2 <= count; i += 2, src += srcStride << 1, dst += dstStride << 1) {
+		__m128 p = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *) src);
+		p = _mm_loadh_pi(p, (const __m64 *) (src + srcStride));
+		__m128 xx = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+		__m128 yy = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+		__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, col0), _mm_mul_ps(yy, col1)), trans);
+		_mm_storel_pi((__m64 *) dst, r);
+		_mm_storeh_pi((__m64 *) (dst + dstStride), r);
+	}
+#elif defined(SPINE_USE_NEON)
+	const float col0Data[2] = {m[0], m[3]};
+	const float col1Data[2] = {m[1], m[4]};
+	const float transData[2] = {m[2], m[5]};
+	const float32x2_t col0 = vld1_f32(col0Data);
+	const float32x2_t col1 = vld1_f32(col1Data);
+	const float32x2_t trans = vld1_f32(transData);
+	for (; i < count; ++i, src += srcStride, dst += dstStride) {
+		float32x2_t p = vld1_f32(src);
+		float32x2_t r = vmla_lane_f32(trans, col0, p, 0);
+		r = vmla_lane_f32(r, col1, p, 1);
+		vst1_f32(dst, r);
+	}
+#endif
+	for (; i < count; ++i, src += srcStride, dst += dstStride) {
+		float x = src[0], y = src[1];
+		dst[0] = x * m[0] + y * m[1] + m[2];
+		dst[1] = x * m[3] + y * m[4] + m[5];
+	}
+}
+
+/// Computes weighted world vertices. bones holds, per output vertex, the bone count followed by
+/// that many skeleton bone indices; vertices holds x, y, weight per bone influence and deform,
+/// when not NULL, holds the x, y offset per bone influence. matrixOf maps a skeleton bone index
+/// to its bone matrix.
+template<typename MatrixOf>
+inline void skinVertices(const size_t *bones, const float *vertices, const float *deform, float *worldVertices, size_t offset, size_t count, size_t stride, MatrixOf matrixOf) {
+	for (size_t w = offset; w < count; w += stride) {
+		size_t n = *bones++;
+		const size_t *end = bones + n;
+#if defined(SPINE_USE_SSE)
+		// Lanes are arranged so that acc0 sums to x and acc1 sums to y without touching
+		// memory outside of the six matrix floats.
+		__m128 acc0 = _mm_setzero_ps();
+		__m128 acc1 = _mm_setzero_ps();
+		for (; bones < end; ++bones, vertices += 3) {
+			const float *m = matrixOf(*bones);
+			float vx = vertices[0], vy = vertices[1];
+			if (deform) {
+				vx += deform[0];
+				vy += deform[1];
+				deform += 2;
+			}
+			__m128 p0 = _mm_mul_ps(_mm_setr_ps(vx, vy, 1, 0), _mm_set1_ps(vertices[2]));
+			__m128 p1 = _mm_shuffle_ps(p0, p0, _MM_SHUFFLE(2, 1, 0, 3));
+			acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(m), p0));
+			acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(m + 2), p1));
+		}
+		__m128 s = _mm_add_ps(_mm_unpacklo_ps(acc0, acc1), _mm_unpackhi_ps(acc0, acc1));
+		s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+		_mm_storel_pi((__m64 *) (worldVertices + w), s);
+#elif defined(SPINE_USE_NEON)
+		float32x4_t acc0 = vdupq_n_f32(0);
+		float32x4_t acc1 = vdupq_n_f32(0);
+		for (; bones < end; ++bones, vertices += 3) {
+			const float *m = matrixOf(*bones);
+			float vx = vertices[0], vy = vertices[1];
+			if (deform) {
+				vx += deform[0];
+				vy += deform[1];
+				deform += 2;
+			}
+			const float p0Data[4] = {vx, vy, 1, 0};
+			const float p1Data[4] = {0, vx, vy, 1};
+			float32x4_t weight = vdupq_n_f32(vertices[2]);
+			acc0 = vmlaq_f32(acc0, vld1q_f32(m), vmulq_f32(vld1q_f32(p0Data), weight));
+			acc1 = vmlaq_f32(acc1, vld1q_f32(m + 2), vmulq_f32(vld1q_f32(p1Data), weight));
+		}
+		float32x2_t s0 = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+		float32x2_t s1 = vadd_f32(vget_low_f32(acc1), vget_high_f32(acc1));
+		vst1_f32(worldVertices + w, vpadd_f32(s0, s1));
+#else
+		float wx = 0, wy = 0;
+		for (; bones < end; ++bones, vertices += 3) {
+			const float *m = matrixOf(*bones);
+			float vx = vertices[0], vy = vertices[1];
+			if (deform) {
+				vx += deform[0];
+				vy += deform[1];
+				deform += 2;
+			}
+			float weight = vertices[2];
+			wx += (vx * m[0] + vy * m[1] + m[2]) * weight;
+			wy += (vx * m[3] + vy * m[4] + m[5]) * weight;
+		}
+		worldVertices[w] = wx;
+		worldVertices[w + 1] = wy;
+#endif
+	}
+}
+}
+}
+
+#endif /* Spine_VertexKernels_h */
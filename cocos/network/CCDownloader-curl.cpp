@@ -27,6 +27,9 @@
 #include <set>
 #include <curl/curl.h>
 #include <deque>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 
 #include "base/CCScheduler.h"
 #include "platform/CCFileUtils.h"
@@ -42,9 +45,42 @@
 #define CC_CURL_POLL_TIMEOUT_MS 50
 #endif
 
+// curl_multi_poll and curl_multi_wakeup are available since 7.68.0
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define CC_DOWNLOADER_MULTI_WAKEUP 1
+#endif
+
+// segments are at least this size, so the remains of a file aren't split further
+#define DOWNLOADER_MIN_SEGMENT_SIZE (1024 * 1024)
+// a failed segment is requested again from its last received byte
+#define DOWNLOADER_SEGMENT_MAX_RETRIES 3
+// interval of saving the received ranges of segmented tasks
+#define DOWNLOADER_SAVE_INTERVAL_MS 1000
+// suffix of the file keeping the validator and the received ranges of a task, next to its temp file
+#define DOWNLOADER_SEGMENTS_SUFFIX ".segments"
+
+// adaptive concurrency
+#define DOWNLOADER_INITIAL_CONNECTIONS 4
+#define DOWNLOADER_MIN_CONNECTIONS 2
+#define DOWNLOADER_MAX_CONNECTIONS 16
+#define DOWNLOADER_MIN_SAMPLE_MS 1000
+// new connections need a few round trips to ramp up before their throughput counts
+#define DOWNLOADER_SAMPLE_RTTS 8
+// throughput changes under this ratio are considered as noise
+#define DOWNLOADER_THROUGHPUT_TOLERANCE 0.1
+
 namespace cocos2d { namespace network {
     using namespace std;
 
+    static int seekFile(FILE* fp, int64_t offset)
+    {
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+        return _fseeki64(fp, offset, SEEK_SET);
+#else
+        return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+    }
+
 ////////////////////////////////////////////////////////////////////////////////
 //  Implementation DownloadTaskCURL
 
@@ -58,6 +94,15 @@ namespace cocos2d { namespace network {
     public:
         int serialId;
 
+        // a byte range of the file downloaded by its own connection
+        struct Segment
+        {
+            int64_t begin;
+            int64_t offset;     // next byte to receive
+            int64_t end;        // exclusive
+            int retries;
+        };
+
         DownloadTaskCURL()
         : serialId(_sSerialId++)
         , _fp(nullptr)
@@ -192,6 +237,130 @@ namespace cocos2d { namespace network {
             return ret;
         }
 
+        size_t writeSegmentProc(int index, unsigned char *buffer, size_t size, size_t count)
+        {
+            lock_guard<mutex> lock(_mutex);
+            Segment& segment = _segments[index];
+            size_t ret = size * count;
+            if (ret > (size_t)(segment.end - segment.offset) || 0 != seekFile(_fp, segment.offset))
+            {
+                return 0;
+            }
+            ret = fwrite(buffer, 1, ret, _fp);
+            segment.offset += ret;
+            _bytesReceived += ret;
+            _totalBytesReceived += ret;
+            return ret;
+        }
+
+        // Splits the rest of the file into segments, or restores the ones saved by a previous download of the same file.
+        bool initSegmentsProc(uint32_t maxSegments)
+        {
+            lock_guard<mutex> lock(_mutex);
+            bool sequential = false;
+            if (false == _loadSegmentsInternal(&sequential))
+            {
+                // the file written so far is kept only if it's a sequential download of the same file
+                int64_t begin = _totalBytesReceived;
+                if (false == sequential || begin > _totalBytesExpected)
+                {
+                    begin = 0;
+                }
+                int64_t remain = _totalBytesExpected - begin;
+                int64_t count = std::max((int64_t)1, std::min((int64_t)maxSegments, remain / DOWNLOADER_MIN_SEGMENT_SIZE));
+                _segments.clear();
+                for (int64_t i = 0; i < count; ++i)
+                {
+                    Segment segment;
+                    segment.begin = segment.offset = begin + remain * i / count;
+                    segment.end = begin + remain * (i + 1) / count;
+                    segment.retries = 0;
+                    _segments.push_back(segment);
+                }
+                if (0 == begin)
+                {
+                    // truncate the data of another version
+                    _fp = freopen(FileUtils::getInstance()->getSuitableFOpen(_tempFileName).c_str(), "wb", _fp);
+                }
+            }
+
+            // segments write at their own offset, which isn't allowed in append mode
+            if (_fp)
+            {
+                _fp = freopen(FileUtils::getInstance()->getSuitableFOpen(_tempFileName).c_str(), "r+b", _fp);
+            }
+            if (nullptr == _fp)
+            {
+                _segments.clear();
+                _errCode = DownloadTask::ERROR_FILE_OP_FAILED;
+                _errCodeInternal = 0;
+                _errDescription = "Can't open file:";
+                _errDescription.append(_tempFileName);
+                return false;
+            }
+
+            _totalBytesReceived = _totalBytesExpected;
+            for (auto& segment : _segments)
+            {
+                _totalBytesReceived -= segment.end - segment.offset;
+            }
+            _saveSegmentsInternal();
+            return true;
+        }
+
+        // The temp file is resumed only if the validator saved when it was started names the same file, a file
+        // left by a segmented download or by another version of the file is downloaded again from the start.
+        bool prepareSequentialProc()
+        {
+            lock_guard<mutex> lock(_mutex);
+            if (nullptr == _fp)
+            {
+                return true;
+            }
+
+            auto util = FileUtils::getInstance();
+            if (_totalBytesReceived > 0 && false == _isSequentialInternal())
+            {
+                _totalBytesReceived = 0;
+            }
+            if (0 == _totalBytesReceived && util->getFileSize(_tempFileName) > 0)
+            {
+                _fp = freopen(util->getSuitableFOpen(_tempFileName).c_str(), "wb", _fp);
+                if (nullptr == _fp)
+                {
+                    _errCode = DownloadTask::ERROR_FILE_OP_FAILED;
+                    _errCodeInternal = 0;
+                    _errDescription = "Can't open file:";
+                    _errDescription.append(_tempFileName);
+                    return false;
+                }
+            }
+
+            // only a server accepting ranges lets a later download resume
+            if (_acceptRanges)
+            {
+                _saveSequentialInternal();
+            }
+            else
+            {
+                remove(util->getSuitableFOpen(_tempFileName + DOWNLOADER_SEGMENTS_SUFFIX).c_str());
+            }
+            return true;
+        }
+
+        void saveSegmentsProc()
+        {
+            lock_guard<mutex> lock(_mutex);
+            _saveSegmentsInternal();
+        }
+
+        void removeSegmentsProc()
+        {
+            lock_guard<mutex> lock(_mutex);
+            _segments.clear();
+            remove(FileUtils::getInstance()->getSuitableFOpen(_tempFileName + DOWNLOADER_SEGMENTS_SUFFIX).c_str());
+        }
+
     private:
         friend class DownloaderCURL;
 
@@ -202,6 +371,7 @@ namespace cocos2d { namespace network {
         bool    _acceptRanges;
         bool    _headerAchieved;
         int64_t _totalBytesExpected;
+        string  _validator;     // ETag or Last-Modified of the file, saved segments of another version are dropped
 
         string  _header;        // temp buffer for receive header string, only used in thread proc
 
@@ -220,6 +390,10 @@ namespace cocos2d { namespace network {
         vector<unsigned char> _buf;
         FILE*  _fp;
 
+        // segmented download, empty if the file is downloaded by one connection
+        vector<Segment> _segments;
+        int _activeSegments;    // segments transferring or waiting for a connection, only used in thread proc
+
         void _initInternal()
         {
             _acceptRanges = (false);
@@ -231,6 +405,123 @@ namespace cocos2d { namespace network {
             _errCodeInternal = (CURLE_OK);
             _header.resize(0);
             _header.reserve(384);   // pre alloc header string buffer
+            _validator.clear();
+            _segments.clear();
+            _activeSegments = 0;
+        }
+
+        // The first two lines of the sidecar are the size of the file with the count of segments,
+        // 0 for a sequential download, and the validator, which is empty if the server sent none.
+        bool _readSidecarHeaderInternal(FILE* fp, int* count)
+        {
+            char line[512];
+            long long total = 0;
+            bool ok = nullptr != fgets(line, sizeof(line), fp)
+                && 2 == sscanf(line, "%lld %d", &total, count)
+                && total == _totalBytesExpected && *count >= 0 && *count <= 1024;
+
+            ok = ok && nullptr != fgets(line, sizeof(line), fp);
+            if (ok)
+            {
+                size_t len = strlen(line);
+                while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+                {
+                    line[--len] = '\0';
+                }
+                ok = _validator == line;
+            }
+            return ok;
+        }
+
+        void _saveSequentialInternal()
+        {
+            FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(_tempFileName + DOWNLOADER_SEGMENTS_SUFFIX).c_str(), "wb");
+            if (nullptr == fp)
+            {
+                return;
+            }
+            fprintf(fp, "%lld 0\n%s\n", (long long)_totalBytesExpected, _validator.c_str());
+            fclose(fp);
+        }
+
+        // whether the temp file was started by a sequential download of the same file
+        bool _isSequentialInternal()
+        {
+            FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(_tempFileName + DOWNLOADER_SEGMENTS_SUFFIX).c_str(), "rb");
+            if (nullptr == fp)
+            {
+                return false;
+            }
+            int count = -1;
+            bool ok = _readSidecarHeaderInternal(fp, &count) && 0 == count;
+            fclose(fp);
+            return ok;
+        }
+
+        // The data is flushed first, so that the saved ranges never claim more than the file has.
+        void _saveSegmentsInternal()
+        {
+            if (_segments.empty() || nullptr == _fp || 0 != fflush(_fp))
+            {
+                return;
+            }
+            FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(_tempFileName + DOWNLOADER_SEGMENTS_SUFFIX).c_str(), "wb");
+            if (nullptr == fp)
+            {
+                return;
+            }
+            fprintf(fp, "%lld %d\n%s\n", (long long)_totalBytesExpected, (int)_segments.size(), _validator.c_str());
+            for (auto& segment : _segments)
+            {
+                fprintf(fp, "%lld %lld %lld\n", (long long)segment.begin, (long long)segment.offset, (long long)segment.end);
+            }
+            fclose(fp);
+        }
+
+        // The saved ranges are used only if they describe the same file and cover it without gaps,
+        // sequential is set if the temp file was started by a sequential download of the same file instead.
+        bool _loadSegmentsInternal(bool* sequential)
+        {
+            *sequential = false;
+            FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(_tempFileName + DOWNLOADER_SEGMENTS_SUFFIX).c_str(), "rb");
+            if (nullptr == fp)
+            {
+                return false;
+            }
+
+            // the received ranges must be in the file
+            int64_t fileSize = FileUtils::getInstance()->getFileSize(_tempFileName);
+            char line[512];
+            int count = -1;
+            bool ok = _readSidecarHeaderInternal(fp, &count);
+            if (ok && 0 == count)
+            {
+                *sequential = true;
+                ok = false;
+            }
+
+            vector<Segment> segments;
+            int64_t expectedBegin = -1;
+            for (int i = 0; ok && i < count; ++i)
+            {
+                long long begin = 0, offset = 0, end = 0;
+                ok = nullptr != fgets(line, sizeof(line), fp)
+                    && 3 == sscanf(line, "%lld %lld %lld", &begin, &offset, &end)
+                    && (expectedBegin < 0 || begin == expectedBegin)
+                    && begin <= offset && offset <= end
+                    && (offset == begin || offset <= fileSize);
+                Segment segment = {begin, offset, end, 0};
+                segments.push_back(segment);
+                expectedBegin = end;
+            }
+            fclose(fp);
+
+            if (false == ok || expectedBegin != _totalBytesExpected)
+            {
+                return false;
+            }
+            _segments.swap(segments);
+            return true;
         }
     };
     int DownloadTaskCURL::_sSerialId;
@@ -238,6 +529,89 @@ namespace cocos2d { namespace network {
 
     typedef pair< shared_ptr<const DownloadTask>, DownloadTaskCURL *> TaskWrapper;
 
+////////////////////////////////////////////////////////////////////////////////
+//  Implementation DownloadConcurrencyCURL
+    // Adapts the count of connections to the measured throughput by hill climbing:
+    // the limit keeps moving in one direction while the throughput improves, and turns back when it drops.
+    class DownloadConcurrencyCURL
+    {
+    public:
+        void init(uint32_t maxConnections, bool adaptive)
+        {
+            _adaptive = adaptive;
+            _max = maxConnections;
+            _limit = maxConnections;
+            if (_adaptive)
+            {
+                if (0 == _max)
+                {
+                    _max = DOWNLOADER_MAX_CONNECTIONS;
+                }
+                _limit = std::min(_max, (uint32_t)DOWNLOADER_INITIAL_CONNECTIONS);
+            }
+            _step = 1;
+            _bytes = 0;
+            _lastThroughput = 0;
+            _rtt = 0;
+            _sampleStart = chrono::steady_clock::now();
+        }
+
+        // 0 means unlimited
+        uint32_t getLimit() const { return _limit; }
+
+        void addBytes(size_t bytes) { _bytes += bytes; }
+
+        void addRttSample(double seconds)
+        {
+            _rtt = _rtt > 0 ? _rtt * 0.875 + seconds * 0.125 : seconds;
+        }
+
+        // limited: whether transfers were waiting for a connection, otherwise the limit isn't what bounds the throughput
+        void update(bool limited)
+        {
+            if (false == _adaptive)
+            {
+                return;
+            }
+
+            auto now = chrono::steady_clock::now();
+            double elapsed = chrono::duration<double>(now - _sampleStart).count();
+            double sampleDuration = std::max(DOWNLOADER_MIN_SAMPLE_MS / 1000.0, DOWNLOADER_SAMPLE_RTTS * _rtt);
+            if (elapsed < sampleDuration)
+            {
+                return;
+            }
+
+            double throughput = _bytes / elapsed;
+            if (limited)
+            {
+                if (_lastThroughput > 0 && throughput < _lastThroughput * (1 - DOWNLOADER_THROUGHPUT_TOLERANCE))
+                {
+                    _step = -_step;
+                }
+                if (_lastThroughput == 0 || std::abs(throughput - _lastThroughput) >= _lastThroughput * DOWNLOADER_THROUGHPUT_TOLERANCE)
+                {
+                    int64_t limit = (int64_t)_limit + _step;
+                    _limit = (uint32_t)std::max((int64_t)std::min(_max, (uint32_t)DOWNLOADER_MIN_CONNECTIONS), std::min((int64_t)_max, limit));
+                    DLLOG("    DownloadConcurrencyCURL: %.0f bytes/s, rtt %.3fs, %u connections", throughput, _rtt, _limit);
+                }
+            }
+            _lastThroughput = throughput;
+            _bytes = 0;
+            _sampleStart = now;
+        }
+
+    private:
+        bool _adaptive;
+        uint32_t _max;
+        uint32_t _limit;
+        int _step;
+        int64_t _bytes;
+        double _lastThroughput;
+        double _rtt;        // smoothed time to first byte in seconds
+        chrono::steady_clock::time_point _sampleStart;
+    };
+
 ////////////////////////////////////////////////////////////////////////////////
 //  Implementation DownloaderCURL::Impl
     // This class shared by DownloaderCURL and work thread.
@@ -247,7 +621,7 @@ namespace cocos2d { namespace network {
         DownloaderHints hints;
 
         Impl()
-//        : _thread(nullptr)
+        : _curlmHandle(nullptr)
         {
             DLLOG("Construct DownloaderCURL::Impl %p", this);
         }
@@ -263,6 +637,13 @@ namespace cocos2d { namespace network {
             {
                 lock_guard<mutex> lock(_requestMutex);
                 _requestQueue.push_back(make_pair(task, coTask));
+#if CC_DOWNLOADER_MULTI_WAKEUP
+                // wake up the work thread waiting for the running transfers
+                if (_curlmHandle)
+                {
+                    curl_multi_wakeup(_curlmHandle);
+                }
+#endif
             }
             else
             {
@@ -312,11 +693,21 @@ namespace cocos2d { namespace network {
         }
 
     private:
+        // A connection of a task, which requests its header, its whole content, or one of its segments.
+        struct Transfer
+        {
+            Impl* impl;
+            CURL* handle;
+            TaskWrapper wrapper;
+            int segment;            // index in DownloadTaskCURL::_segments, -1 if the transfer isn't a segment
+            bool rangeChecked;
+        };
+
         static size_t _outputHeaderCallbackProc(void *buffer, size_t size, size_t count, void *userdata)
         {
             int strLen = int(size * count);
             DLLOG("    _outputHeaderCallbackProc: %.*s", strLen, buffer);
-            DownloadTaskCURL& coTask = *((DownloadTaskCURL*)(userdata));
+            DownloadTaskCURL& coTask = *((Transfer*)(userdata))->wrapper.second;
             coTask._header.append((const char *)buffer, strLen);
             return strLen;
         }
@@ -324,19 +715,60 @@ namespace cocos2d { namespace network {
         static size_t _outputDataCallbackProc(void *buffer, size_t size, size_t count, void *userdata)
         {
 //            DLLOG("    _outputDataCallbackProc: size(%ld), count(%ld)", size, count);
-            DownloadTaskCURL *coTask = (DownloadTaskCURL*)userdata;
+            Transfer* transfer = (Transfer*)userdata;
+            DownloadTaskCURL *coTask = transfer->wrapper.second;
 
             // If your callback function returns CURL_WRITEFUNC_PAUSE it will cause this transfer to become paused.
-            return coTask->writeDataProc((unsigned char *)buffer, size, count);
+            size_t ret = 0;
+            if (transfer->segment < 0)
+            {
+                ret = coTask->writeDataProc((unsigned char *)buffer, size, count);
+            }
+            else
+            {
+                // a server ignoring the range would send the whole file to every segment
+                if (false == transfer->rangeChecked)
+                {
+                    long httpResponseCode = 0;
+                    curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &httpResponseCode);
+                    if (206 != httpResponseCode)
+                    {
+                        coTask->setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, CURLE_RANGE_ERROR, "Server doesn't support range requests");
+                        return 0;
+                    }
+                    transfer->rangeChecked = true;
+                }
+                ret = coTask->writeSegmentProc(transfer->segment, (unsigned char *)buffer, size, count);
+            }
+            transfer->impl->_concurrency.addBytes(ret);
+            return ret;
+        }
+
+        // Finds the value of a response header, the last one wins since every redirection has its own headers.
+        static string _findHeaderValueProc(const string& header, const string& name)
+        {
+            string lowerHeader = header;
+            transform(lowerHeader.begin(), lowerHeader.end(), lowerHeader.begin(), ::tolower);
+            size_t pos = lowerHeader.rfind("\n" + name + ":");
+            if (string::npos == pos)
+            {
+                return "";
+            }
+            pos += name.length() + 2;
+            size_t end = header.find_first_of("\r\n", pos);
+            string value = header.substr(pos, string::npos == end ? string::npos : end - pos);
+            value.erase(0, value.find_first_not_of(" \t"));
+            value.erase(value.find_last_not_of(" \t") + 1);
+            return value;
         }
 
         // this function designed call in work thread
         // the curl handle destroyed in _threadProc
         // handle inited for get header
-        void _initCurlHandleProc(CURL *handle, TaskWrapper& wrapper, bool forContent = false)
+        void _initCurlHandleProc(CURL *handle, Transfer* transfer, bool forContent = false)
         {
-            const DownloadTask& task = *wrapper.first;
-            const DownloadTaskCURL* coTask = wrapper.second;
+            const DownloadTask& task = *transfer->wrapper.first;
+            const DownloadTaskCURL* coTask = transfer->wrapper.second;
 
             // set url
             curl_easy_setopt(handle, CURLOPT_URL, task.requestURL.c_str());
@@ -350,19 +782,27 @@ namespace cocos2d { namespace network {
             {
                 curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, DownloaderCURL::Impl::_outputHeaderCallbackProc);
             }
-            curl_easy_setopt(handle, CURLOPT_WRITEDATA, coTask);
+            curl_easy_setopt(handle, CURLOPT_WRITEDATA, transfer);
 
             curl_easy_setopt(handle, CURLOPT_NOPROGRESS, true);
-//            curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, DownloaderCURL::Impl::_progressCallbackProc);
-//            curl_easy_setopt(handle, CURLOPT_XFERINFODATA, coTask);
+//            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, DownloaderCURL::Impl::_progressCallbackProc);
+//            curl_easy_setopt(curl, CURLOPT_XFERINFODATA, coTask);
 
             curl_easy_setopt(handle, CURLOPT_FAILONERROR, true);
             curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
 
             if (forContent)
             {
+                if (transfer->segment >= 0)
+                {
+                    // request the rest of the segment
+                    const DownloadTaskCURL::Segment& segment = coTask->_segments[transfer->segment];
+                    char range[64];
+                    sprintf(range, "%lld-%lld", (long long)segment.offset, (long long)segment.end - 1);
+                    curl_easy_setopt(handle, CURLOPT_RANGE, range);
+                }
                 /** if server acceptRanges and local has part of file, we continue to download **/
-                if (coTask->_acceptRanges && coTask->_totalBytesReceived > 0)
+                else if (coTask->_acceptRanges && coTask->_totalBytesReceived > 0)
                 {
                     curl_easy_setopt(handle, CURLOPT_RESUME_FROM_LARGE,(curl_off_t)coTask->_totalBytesReceived);
                 }
@@ -431,7 +871,9 @@ namespace cocos2d { namespace network {
                     break;
                 }
 
-                bool acceptRanges = (string::npos != coTask._header.find("Accept-Ranges")) ? true : false;
+                // header names are lower case in HTTP/2
+                string acceptRangesValue = _findHeaderValueProc(coTask._header, "accept-ranges");
+                bool acceptRanges = acceptRangesValue.length() && acceptRangesValue != "none";
 
                 // get current file size
                 int64_t fileSize = 0;
@@ -444,6 +886,11 @@ namespace cocos2d { namespace network {
                 lock_guard<mutex> lock(coTask._mutex);
                 coTask._totalBytesExpected = (int64_t)contentLen;
                 coTask._acceptRanges = acceptRanges;
+                coTask._validator = _findHeaderValueProc(coTask._header, "etag");
+                if (coTask._validator.empty())
+                {
+                    coTask._validator = _findHeaderValueProc(coTask._header, "last-modified");
+                }
                 if (acceptRanges && fileSize > 0)
                 {
                     coTask._totalBytesReceived = fileSize;
@@ -458,19 +905,154 @@ namespace cocos2d { namespace network {
             return coTask._headerAchieved;
         }
 
+        // big files of servers accepting ranges are downloaded by several connections
+        bool _shouldSegmentProc(const DownloadTaskCURL& coTask) const
+        {
+            return hints.segmentThresholdInBytes > 0
+                && hints.countOfMaxSegmentsPerTask > 1
+                && coTask._acceptRanges
+                && coTask._fp
+                && coTask._totalBytesExpected >= (int64_t)hints.segmentThresholdInBytes;
+        }
+
+        bool _startTransferProc(CURLM *curlmHandle, TaskWrapper& wrapper, int segment)
+        {
+            // create curl handle from task and add into curl multi handle
+            CURL* curlHandle = curl_easy_init();
+            if (nullptr == curlHandle)
+            {
+                wrapper.second->setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, 0, "Alloc curl handle failed.");
+                return false;
+            }
+
+            unique_ptr<Transfer> transfer(new Transfer);
+            transfer->impl = this;
+            transfer->handle = curlHandle;
+            transfer->wrapper = wrapper;
+            transfer->segment = segment;
+            transfer->rangeChecked = false;
+
+            // init curl handle for get header info, or for the content of a segment
+            _initCurlHandleProc(curlHandle, transfer.get(), segment >= 0);
+
+            // add curl handle to process list
+            CURLMcode mcode = curl_multi_add_handle(curlmHandle, curlHandle);
+            if (CURLM_OK != mcode)
+            {
+                wrapper.second->setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, mcode, curl_multi_strerror(mcode));
+                curl_easy_cleanup(curlHandle);
+                return false;
+            }
+
+            DLLOG("    _threadProc task create curl handle:%p segment:%d", curlHandle, segment);
+            _transfers[curlHandle] = move(transfer);
+            return true;
+        }
+
+        void _finishTaskProc(TaskWrapper& wrapper)
+        {
+            // remove from _processSet
+            {
+                lock_guard<mutex> lock(_processMutex);
+                if (_processSet.end() != _processSet.find(wrapper)) {
+                    _processSet.erase(wrapper);
+                }
+            }
+
+            // add to finishedQueue
+            {
+                lock_guard<mutex> lock(_finishedMutex);
+                _finishedQueue.push_back(wrapper);
+            }
+        }
+
+        // stop the other segments of a failed task, the received ranges are kept to resume later
+        void _abortSegmentsProc(CURLM *curlmHandle, DownloadTaskCURL* coTask)
+        {
+            for (auto it = _transfers.begin(); it != _transfers.end();)
+            {
+                if (it->second->wrapper.second == coTask)
+                {
+                    curl_multi_remove_handle(curlmHandle, it->first);
+                    curl_easy_cleanup(it->first);
+                    it = _transfers.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            _pendingSegments.erase(remove_if(_pendingSegments.begin(), _pendingSegments.end(), [coTask](const pair<TaskWrapper, int>& pending) {
+                return pending.first.second == coTask;
+            }), _pendingSegments.end());
+            coTask->_activeSegments = 0;
+            coTask->saveSegmentsProc();
+        }
+
+        void _onSegmentDoneProc(CURLM *curlmHandle, CURL *curlHandle, CURLcode errCode)
+        {
+            Transfer* transfer = _transfers[curlHandle].get();
+            TaskWrapper wrapper = transfer->wrapper;
+            DownloadTaskCURL& coTask = *wrapper.second;
+            DownloadTaskCURL::Segment& segment = coTask._segments[transfer->segment];
+
+            bool failed = DownloadTask::ERROR_NO_ERROR != coTask._errCode;
+            if (false == failed && CURLE_OK != errCode)
+            {
+                // request the rest of the segment again
+                if (segment.retries < DOWNLOADER_SEGMENT_MAX_RETRIES)
+                {
+                    ++segment.retries;
+                    DLLOG("    _threadProc retry segment %d of task %d, error: %d", transfer->segment, coTask.serialId, errCode);
+                    curl_easy_reset(curlHandle);
+                    transfer->rangeChecked = false;
+                    _initCurlHandleProc(curlHandle, transfer, true);
+                    if (CURLM_OK == curl_multi_add_handle(curlmHandle, curlHandle))
+                    {
+                        return;
+                    }
+                }
+                coTask.setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, errCode, curl_easy_strerror(errCode));
+                failed = true;
+            }
+            else if (false == failed && segment.offset != segment.end)
+            {
+                coTask.setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, CURLE_PARTIAL_FILE, "Segment is incomplete.");
+                failed = true;
+            }
+
+            curl_easy_cleanup(curlHandle);
+            _transfers.erase(curlHandle);
+            --coTask._activeSegments;
+
+            if (failed)
+            {
+                _abortSegmentsProc(curlmHandle, &coTask);
+                _finishTaskProc(wrapper);
+            }
+            else if (0 == coTask._activeSegments)
+            {
+                coTask.removeSegmentsProc();
+                _finishTaskProc(wrapper);
+            }
+        }
+
         void _threadProc()
         {
             DLLOG("++++DownloaderCURL::Impl::_threadProc begin %p", this);
             // the holder prevent DownloaderCURL::Impl class instance be destruct in main thread
             auto holder = this->shared_from_this();
             auto thisThreadId = this_thread::get_id();
-            uint32_t countOfMaxProcessingTasks = this->hints.countOfMaxProcessingTasks;
             // init curl content
             CURLM* curlmHandle = curl_multi_init();
-            unordered_map<CURL*, TaskWrapper> coTaskMap;
+            {
+                lock_guard<mutex> lock(_requestMutex);
+                _curlmHandle = curlmHandle;
+            }
+            _concurrency.init(this->hints.countOfMaxProcessingTasks, this->hints.adaptiveConcurrency);
+            auto lastSaveTime = chrono::steady_clock::now();
             int runningHandles = 0;
             CURLMcode mcode = CURLM_OK;
-            int rc = 0;                 // select return code
 
             do
             {
@@ -486,54 +1068,20 @@ namespace cocos2d { namespace network {
 
                 if (runningHandles)
                 {
-                    // get timeout setting from multi-handle
-                    long timeoutMS = -1;
-                    curl_multi_timeout(curlmHandle, &timeoutMS);
-
-                    if(timeoutMS < 0)
-                    {
-                        timeoutMS = 1000;
-                    }
-
-                    /* get file descriptors from the transfers */
-                    fd_set fdread;
-                    fd_set fdwrite;
-                    fd_set fdexcep;
-                    int maxfd = -1;
-
-                    FD_ZERO(&fdread);
-                    FD_ZERO(&fdwrite);
-                    FD_ZERO(&fdexcep);
-
-                    mcode = curl_multi_fdset(curlmHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
+                    // wait until a transfer can progress, a new task is added or curl timeout expires
+#if CC_DOWNLOADER_MULTI_WAKEUP
+                    mcode = curl_multi_poll(curlmHandle, nullptr, 0, DOWNLOADER_SAVE_INTERVAL_MS, nullptr);
+#else
+                    mcode = curl_multi_wait(curlmHandle, nullptr, 0, CC_CURL_POLL_TIMEOUT_MS, nullptr);
+#endif
                     if (CURLM_OK != mcode)
                     {
+                        DLLOG("    _threadProc: wait return unexpect code: %d", mcode);
                         break;
                     }
-
-                    // do wait action
-                    if(maxfd == -1)
-                    {
-                        this_thread::sleep_for(chrono::milliseconds(CC_CURL_POLL_TIMEOUT_MS));
-                        rc = 0;
-                    }
-                    else
-                    {
-                        struct timeval timeout;
-
-                        timeout.tv_sec = timeoutMS / 1000;
-                        timeout.tv_usec = (timeoutMS % 1000) * 1000;
-
-                        rc = select(maxfd+1, &fdread, &fdwrite, &fdexcep, &timeout);
-                    }
-
-                    if (rc < 0)
-                    {
-                        DLLOG("    _threadProc: select return unexpect code: %d", rc);
-                    }
                 }
 
-                if (coTaskMap.size())
+                if (_transfers.size())
                 {
                     mcode = CURLM_CALL_MULTI_PERFORM;
                     while(CURLM_CALL_MULTI_PERFORM == mcode)
@@ -554,10 +1102,32 @@ namespace cocos2d { namespace network {
                             CURL *curlHandle = m->easy_handle;
                             CURLcode errCode = m->data.result;
 
-                            TaskWrapper wrapper = coTaskMap[curlHandle];
-
                             // remove from multi-handle
                             curl_multi_remove_handle(curlmHandle, curlHandle);
+
+                            // time to first byte of the request, which is about a round trip
+                            double pretransferTime = 0, starttransferTime = 0;
+                            if (CURLE_OK == errCode
+                                && CURLE_OK == curl_easy_getinfo(curlHandle, CURLINFO_PRETRANSFER_TIME, &pretransferTime)
+                                && CURLE_OK == curl_easy_getinfo(curlHandle, CURLINFO_STARTTRANSFER_TIME, &starttransferTime)
+                                && starttransferTime > pretransferTime)
+                            {
+                                _concurrency.addRttSample(starttransferTime - pretransferTime);
+                            }
+
+                            auto found = _transfers.find(curlHandle);
+                            if (_transfers.end() == found)
+                            {
+                                continue;
+                            }
+                            Transfer* transfer = found->second.get();
+                            if (transfer->segment >= 0)
+                            {
+                                _onSegmentDoneProc(curlmHandle, curlHandle, errCode);
+                                continue;
+                            }
+
+                            TaskWrapper wrapper = transfer->wrapper;
                             bool reinited = false;
                             do
                             {
@@ -581,6 +1151,34 @@ namespace cocos2d { namespace network {
                                     break;
                                 }
 
+                                // big file, download the segments which aren't complete
+                                if (_shouldSegmentProc(*wrapper.second))
+                                {
+                                    if (false == wrapper.second->initSegmentsProc(hints.countOfMaxSegmentsPerTask))
+                                    {
+                                        break;
+                                    }
+                                    auto& segments = wrapper.second->_segments;
+                                    for (int i = 0; i < (int)segments.size(); ++i)
+                                    {
+                                        if (segments[i].offset < segments[i].end)
+                                        {
+                                            _pendingSegments.push_back(make_pair(wrapper, i));
+                                            ++wrapper.second->_activeSegments;
+                                        }
+                                    }
+                                    if (0 == wrapper.second->_activeSegments)
+                                    {
+                                        wrapper.second->removeSegmentsProc();
+                                    }
+                                    break;
+                                }
+
+                                if (false == wrapper.second->prepareSequentialProc())
+                                {
+                                    break;
+                                }
+
                                 // after get header info success
                                 // wrapper.second->_totalBytesReceived inited by local file size
                                 // if the local file size equal with the content size from header, the file has downloaded finish
@@ -593,7 +1191,7 @@ namespace cocos2d { namespace network {
                                 }
                                 // reinit curl handle for download content
                                 curl_easy_reset(curlHandle);
-                                _initCurlHandleProc(curlHandle, wrapper, true);
+                                _initCurlHandleProc(curlHandle, transfer, true);
                                 mcode = curl_multi_add_handle(curlmHandle, curlHandle);
                                 if (CURLM_OK != mcode)
                                 {
@@ -610,30 +1208,58 @@ namespace cocos2d { namespace network {
                             curl_easy_cleanup(curlHandle);
                             DLLOG("    _threadProc task clean cur handle :%p with errCode:%d",  curlHandle, errCode);
 
-                           // remove from coTaskMap
-                            coTaskMap.erase(curlHandle);
-
-                            // remove from _processSet
-                            {
-                                lock_guard<mutex> lock(_processMutex);
-                                if (_processSet.end() != _processSet.find(wrapper)) {
-                                    _processSet.erase(wrapper);
-                                }
-                            }
+                            // remove from _transfers
+                            _transfers.erase(curlHandle);
 
-                            // add to finishedQueue
+                            // the segments finish the task
+                            if (wrapper.second->_activeSegments)
                             {
-                                lock_guard<mutex> lock(_finishedMutex);
-                                _finishedQueue.push_back(wrapper);
+                                continue;
                             }
+                            _finishTaskProc(wrapper);
                         }
                     } while(m);
                 }
 
-                // process tasks in _requestList
-                auto size = coTaskMap.size();
-                while (0 == countOfMaxProcessingTasks || size < countOfMaxProcessingTasks)
+                // save the received ranges, so that segmented tasks can resume after the app exits
+                auto now = chrono::steady_clock::now();
+                if (now - lastSaveTime >= chrono::milliseconds(DOWNLOADER_SAVE_INTERVAL_MS))
                 {
+                    lastSaveTime = now;
+                    vector<TaskWrapper> tasks;
+                    getProcessTasks(tasks);
+                    for (auto& wrapper : tasks)
+                    {
+                        if (wrapper.second->_activeSegments)
+                        {
+                            wrapper.second->saveSegmentsProc();
+                        }
+                    }
+                }
+
+                bool hasRequests = false;
+                {
+                    lock_guard<mutex> lock(_requestMutex);
+                    hasRequests = _requestQueue.size() > 0;
+                }
+                _concurrency.update(_pendingSegments.size() || hasRequests);
+
+                // process pending segments first, then tasks in _requestList
+                uint32_t countOfMaxConnections = _concurrency.getLimit();
+                while (0 == countOfMaxConnections || _transfers.size() < countOfMaxConnections)
+                {
+                    if (_pendingSegments.size())
+                    {
+                        auto pending = _pendingSegments.front();
+                        _pendingSegments.pop_front();
+                        if (false == _startTransferProc(curlmHandle, pending.first, pending.second))
+                        {
+                            _abortSegmentsProc(curlmHandle, pending.first.second);
+                            _finishTaskProc(pending.first);
+                        }
+                        continue;
+                    }
+
                     // get task wrapper from request queue
                     TaskWrapper wrapper;
                     {
@@ -653,37 +1279,29 @@ namespace cocos2d { namespace network {
 
                     wrapper.second->initProc();
 
-                    // create curl handle from task and add into curl multi handle
-                    CURL* curlHandle = curl_easy_init();
-
-                    if (nullptr == curlHandle)
+                    if (false == _startTransferProc(curlmHandle, wrapper, -1))
                     {
-                        wrapper.second->setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, 0, "Alloc curl handle failed.");
                         lock_guard<mutex> lock(_finishedMutex);
                         _finishedQueue.push_back(wrapper);
                         continue;
                     }
 
-                    // init curl handle for get header info
-                    _initCurlHandleProc(curlHandle, wrapper);
-
-                    // add curl handle to process list
-                    mcode = curl_multi_add_handle(curlmHandle, curlHandle);
-                    if (CURLM_OK != mcode)
-                    {
-                        wrapper.second->setErrorProc(DownloadTask::ERROR_IMPL_INTERNAL, mcode, curl_multi_strerror(mcode));
-                        lock_guard<mutex> lock(_finishedMutex);
-                        _finishedQueue.push_back(wrapper);
-                        continue;
-                    }
-
-                    DLLOG("    _threadProc task create curl handle:%p", curlHandle);
-                    coTaskMap[curlHandle] = wrapper;
                     lock_guard<mutex> lock(_processMutex);
                     _processSet.insert(wrapper);
                 }
-            } while (coTaskMap.size());
+            } while (_transfers.size());
 
+            {
+                lock_guard<mutex> lock(_requestMutex);
+                _curlmHandle = nullptr;
+            }
+            for (auto& transfer : _transfers)
+            {
+                curl_multi_remove_handle(curlmHandle, transfer.first);
+                curl_easy_cleanup(transfer.first);
+            }
+            _transfers.clear();
+            _pendingSegments.clear();
             curl_multi_cleanup(curlmHandle);
             this->stop();
             DLLOG("----DownloaderCURL::Impl::_threadProc end");
@@ -698,6 +1316,14 @@ namespace cocos2d { namespace network {
         mutex _requestMutex;
         mutex _processMutex;
         mutex _finishedMutex;
+
+        // multi handle of the work thread, guarded by _requestMutex
+        CURLM* _curlmHandle;
+
+        // only used in work thread
+        unordered_map<CURL*, unique_ptr<Transfer>> _transfers;
+        deque<pair<TaskWrapper, int>> _pendingSegments;
+        DownloadConcurrencyCURL _concurrency;
     };
 
 
@@ -834,7 +1460,8 @@ namespace cocos2d { namespace network {
                 coTask._fp = nullptr;
                 do
                 {
-                    if (0 == coTask._fileName.length())
+                    // keep the temp file of a failed task, so that the next download resumes from it
+                    if (0 == coTask._fileName.length() || DownloadTask::ERROR_NO_ERROR != coTask._errCode)
                     {
                         break;
                     }
@@ -858,6 +1485,7 @@ namespace cocos2d { namespace network {
                     {
                         // success, remove storage from set
                         DownloadTaskCURL::_sStoragePathSet.erase(coTask._tempFileName);
+                        remove(util->getSuitableFOpen(coTask._tempFileName + DOWNLOADER_SEGMENTS_SUFFIX).c_str());
                         break;
                     }
                     // failed
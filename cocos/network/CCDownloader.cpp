@@ -25,6 +25,7 @@
  ****************************************************************************/
 
 #include "network/CCDownloader.h"
+#include "platform/CCFileUtils.h"
 
 // include platform specific implement class
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
@@ -64,7 +65,10 @@ namespace cocos2d { namespace network {
         {
             6,
             45,
-            ".tmp"
+            ".tmp",
+            0,
+            0,
+            false
         };
         new(this)Downloader(hints);
     }
@@ -103,6 +107,8 @@ namespace cocos2d { namespace network {
             // success callback
             if (task.storagePath.length())
             {
+                // The file may have been looked up and cached as missing before it's downloaded.
+                FileUtils::getInstance()->purgeCachedMissingEntries(task.storagePath);
                 if (onFileTaskSuccess)
                 {
                     onFileTaskSuccess(task);
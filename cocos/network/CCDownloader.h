@@ -68,6 +68,15 @@ namespace cocos2d { namespace network {
         uint32_t countOfMaxProcessingTasks;
         uint32_t timeoutInSeconds;
         std::string tempFileNameSuffix;
+        // Files of at least this size are downloaded by several range requests in parallel, 0 disables it
+        // and is the default.
+        // The received ranges are saved next to the temp file, so an interrupted download resumes where it stopped.
+        uint32_t segmentThresholdInBytes;
+        // Max range requests of a file, each segment counts as a processing task.
+        uint32_t countOfMaxSegmentsPerTask;
+        // Whether the count of processing tasks adapts to the measured throughput and round trip time,
+        // countOfMaxProcessingTasks is then the upper limit.
+        bool adaptiveConcurrency;
     };
 
     class CC_DLL Downloader final
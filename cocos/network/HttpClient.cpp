@@ -27,6 +27,7 @@
 
 #include "network/HttpClient.h"
 #include <queue>
+#include <algorithm>
 #include <errno.h>
 #include <curl/curl.h>
 #include "platform/CCFileUtils.h"
@@ -42,6 +43,27 @@ typedef int int32_t;
 
 static HttpClient* _httpClient = nullptr; // pointer to singleton
 
+#define HTTP_CLIENT_MAX_CONCURRENT_REQUESTS 8
+// wait timeout of the network thread while requests are running, if curl can't be woken up
+#define HTTP_CLIENT_POLL_TIMEOUT_MS 20
+
+// curl_multi_poll and curl_multi_wakeup are available since 7.68.0
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define HTTP_CLIENT_MULTI_WAKEUP 1
+#endif
+
+static std::mutex _shareMutexes[CURL_LOCK_DATA_LAST];
+
+static void lockShareData(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* /*userptr*/)
+{
+    _shareMutexes[data].lock();
+}
+
+static void unlockShareData(CURL* /*handle*/, curl_lock_data data, void* /*userptr*/)
+{
+    _shareMutexes[data].unlock();
+}
+
 typedef size_t (*write_callback)(void *ptr, size_t size, size_t nmemb, void *stream);
 
 // Callback function used by libcurl for collect response data
@@ -71,69 +93,6 @@ static size_t writeHeaderData(void *ptr, size_t size, size_t nmemb, void *stream
 }
 
 
-static int processGetTask(HttpClient* client, HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-static int processPostTask(HttpClient* client, HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-static int processPutTask(HttpClient* client,  HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-static int processDeleteTask(HttpClient* client,  HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-// int processDownloadTask(HttpRequest *task, write_callback callback, void *stream, int32_t *errorCode);
-
-// Worker thread
-void HttpClient::networkThread()
-{
-    increaseThreadCount();
-
-    while (true)
-    {
-        HttpRequest *request;
-
-        // step 1: send http request if the requestQueue isn't empty
-        {
-            std::lock_guard<std::mutex> lock(_requestQueueMutex);
-            while (_requestQueue.empty())
-            {
-                _sleepCondition.wait(_requestQueueMutex);
-            }
-            request = _requestQueue.at(0);
-            _requestQueue.erase(0);
-        }
-
-        if (request == _requestSentinel) {
-            break;
-        }
-
-        // step 2: libcurl sync access
-        
-        // Create a HttpResponse object, the default setting is http access failed
-        HttpResponse *response = new (std::nothrow) HttpResponse(request);
-
-        processResponse(response, _responseMessage);
-
-
-        // add response packet into queue
-        _responseQueueMutex.lock();
-        _responseQueue.pushBack(response);
-        _responseQueueMutex.unlock();
-
-        _schedulerMutex.lock();
-        if (auto sche = _scheduler.lock())
-        {
-            sche->performFunctionInCocosThread(CC_CALLBACK_0(HttpClient::dispatchResponseCallbacks, this));
-        }
-        _schedulerMutex.unlock();
-    }
-    
-    // cleanup: if worker thread received quit signal, clean up un-completed request queue
-    _requestQueueMutex.lock();
-    _requestQueue.clear();
-    _requestQueueMutex.unlock();
-
-    _responseQueueMutex.lock();
-    _responseQueue.clear();
-    _responseQueueMutex.unlock();
-
-    decreaseThreadCountAndMayDeleteThis();
-}
-
 // Worker thread
 void HttpClient::networkThreadAlone(HttpRequest* request, HttpResponse* response)
 {
@@ -141,6 +100,7 @@ void HttpClient::networkThreadAlone(HttpRequest* request, HttpResponse* response
 
     char responseMessage[RESPONSE_BUFFER_SIZE] = { 0 };
     processResponse(response, responseMessage);
+    flushCookies();
 
     _schedulerMutex.lock();
     if (auto sche = _scheduler.lock())
@@ -199,6 +159,18 @@ static bool configureCURL(HttpClient* client, HttpRequest* request, CURL* handle
 
     curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
 
+    if (client->getShareHandle()) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, (CURLSH*)client->getShareHandle());
+    }
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    // HTTP/2 over TLS when the server supports it, requests to the same host are multiplexed
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072b00
+    // wait for a connection to multiplex on instead of opening a new one
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+#endif
+
     return true;
 }
 
@@ -256,11 +228,20 @@ public:
         }
         std::string cookieFilename = client->getCookieFilename();
         if (!cookieFilename.empty()) {
-            if (!setOption(CURLOPT_COOKIEFILE, cookieFilename.c_str())) {
-                return false;
+            if (client->getShareHandle()) {
+                // cookies live in the shared store, the client reads and writes the file once
+                client->loadCookies();
+                if (!setOption(CURLOPT_COOKIEFILE, "")) {
+                    return false;
+                }
             }
-            if (!setOption(CURLOPT_COOKIEJAR, cookieFilename.c_str())) {
-                return false;
+            else {
+                if (!setOption(CURLOPT_COOKIEFILE, cookieFilename.c_str())) {
+                    return false;
+                }
+                if (!setOption(CURLOPT_COOKIEJAR, cookieFilename.c_str())) {
+                    return false;
+                }
             }
         }
 
@@ -272,11 +253,22 @@ public:
         
     }
 
+    CURL* getHandle() const
+    {
+        return _curl;
+    }
+
     /// @param responseCode Null not allowed
     bool perform(long *responseCode)
     {
         if (CURLE_OK != curl_easy_perform(_curl))
             return false;
+        return getResponseCode(responseCode);
+    }
+
+    /// @param responseCode Null not allowed
+    bool getResponseCode(long *responseCode)
+    {
         CURLcode code = curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, responseCode);
         if (code != CURLE_OK || !(*responseCode >= 200 && *responseCode < 300)) {
             CCLOGERROR("Curl curl_easy_getinfo failed: %s", curl_easy_strerror(code));
@@ -288,60 +280,219 @@ public:
     }
 };
 
-//Process Get Request
-static int processGetTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
+// Sets up the curl handle of a GET, POST, PUT, HEAD or DELETE request
+static bool configureRequest(CURLRaii& curl, HttpClient* client, HttpRequest* request, HttpResponse* response, char* errorBuffer)
 {
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
-}
+    if (!curl.init(client, request, writeData, response->getResponseData(), writeHeaderData, response->getResponseHeader(), errorBuffer))
+        return false;
 
-//Process POST Request
-static int processPostTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
-{
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_POST, 1)
+    switch (request->getRequestType())
+    {
+    case HttpRequest::Type::GET: // HTTP GET
+        return curl.setOption(CURLOPT_FOLLOWLOCATION, true);
+
+    case HttpRequest::Type::POST: // HTTP POST
+        return curl.setOption(CURLOPT_POST, 1)
+            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
+            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize());
+
+    case HttpRequest::Type::PUT:
+        return curl.setOption(CURLOPT_CUSTOMREQUEST, "PUT")
+            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
+            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize());
+
+    case HttpRequest::Type::HEAD:
+        return curl.setOption(CURLOPT_NOBODY, "HEAD")
             && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
-            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize());
+
+    case HttpRequest::Type::DELETE:
+        return curl.setOption(CURLOPT_CUSTOMREQUEST, "DELETE")
+            && curl.setOption(CURLOPT_FOLLOWLOCATION, true);
+
+    default:
+        CCASSERT(false, "CCHttpClient: unknown request type, only GET, POST, PUT, HEAD or DELETE is supported");
+        return false;
+    }
 }
 
-//Process PUT Request
-static int processPutTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
+// write the result to HttpResponse
+static void setResponseResult(HttpResponse* response, bool succeed, long responseCode, char* errorBuffer)
 {
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_CUSTOMREQUEST, "PUT")
-            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
-            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    response->setResponseCode(responseCode);
+    response->setSucceed(succeed);
+    if (!succeed)
+    {
+        response->setErrorBuffer(errorBuffer);
+    }
 }
 
-static int processHeadTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
+// A request running on the network thread
+struct HttpTransfer
 {
+    explicit HttpTransfer(HttpRequest* request)
+    : response(new (std::nothrow) HttpResponse(request))
+    {
+        memset(errorBuffer, 0, sizeof(errorBuffer));
+    }
+
+    HttpResponse* response;
     CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_NOBODY, "HEAD")
-            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
-            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    char errorBuffer[HttpClient::RESPONSE_BUFFER_SIZE];
+};
+
+// Worker thread, runs up to getMaxConcurrentRequests() requests at the same time with curl multi
+void HttpClient::networkThread()
+{
+    increaseThreadCount();
+
+    CURLM* multi = curl_multi_init();
+#ifdef CURLPIPE_MULTIPLEX
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+    _requestQueueMutex.lock();
+    _multiHandle = multi;
+    _requestQueueMutex.unlock();
+
+    std::vector<HttpTransfer*> transfers;
+    std::vector<HttpRequest*> requests;
+    bool quit = false;
+
+    while (!quit)
+    {
+        // step 1: take requests from the queue while below the concurrency limit
+        size_t maxRequests = (size_t)std::max(1, getMaxConcurrentRequests());
+        requests.clear();
+        {
+            std::lock_guard<std::mutex> lock(_requestQueueMutex);
+            while (_requestQueue.empty() && transfers.empty())
+            {
+                _sleepCondition.wait(_requestQueueMutex);
+            }
+            while (!_requestQueue.empty())
+            {
+                // the sentinel is checked before the limit, it must quit even when all slots are busy
+                HttpRequest* request = _requestQueue.at(0);
+                if (request == _requestSentinel) {
+                    quit = true;
+                    break;
+                }
+                if (transfers.size() + requests.size() >= maxRequests) {
+                    break;
+                }
+                requests.push_back(request);
+                _requestQueue.erase(0);
+            }
+        }
+
+        if (quit) {
+            break;
+        }
+
+        // step 2: add them to the multi handle, the response is failed if curl can't be set up
+        for (auto request : requests)
+        {
+            auto transfer = new (std::nothrow) HttpTransfer(request);
+            CURL* handle = transfer->curl.getHandle();
+            if (configureRequest(transfer->curl, this, request, transfer->response, transfer->errorBuffer)
+                && transfer->curl.setOption(CURLOPT_PRIVATE, transfer)
+                && CURLM_OK == curl_multi_add_handle(multi, handle))
+            {
+                transfers.push_back(transfer);
+            }
+            else
+            {
+                setResponseResult(transfer->response, false, -1, transfer->errorBuffer);
+                addResponse(transfer->response);
+                delete transfer;
+            }
+        }
+
+        // step 3: libcurl async access
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        CURLMsg* msg = nullptr;
+        int pending = 0;
+        bool finished = false;
+        while ((msg = curl_multi_info_read(multi, &pending)))
+        {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+
+            CURL* handle = msg->easy_handle;
+            CURLcode result = msg->data.result;
+            char* privateData = nullptr;
+            curl_easy_getinfo(handle, CURLINFO_PRIVATE, &privateData);
+            auto transfer = reinterpret_cast<HttpTransfer*>(privateData);
+            curl_multi_remove_handle(multi, handle);
+
+            long responseCode = -1;
+            bool succeed = result == CURLE_OK && transfer->curl.getResponseCode(&responseCode);
+            setResponseResult(transfer->response, succeed, responseCode, transfer->errorBuffer);
+            addResponse(transfer->response);
+
+            transfers.erase(std::find(transfers.begin(), transfers.end(), transfer));
+            delete transfer;
+            finished = true;
+        }
+
+        if (finished) {
+            flushCookies();
+        }
+
+        // step 4: sleep until a socket is ready or a request is sent
+        if (!transfers.empty())
+        {
+#if HTTP_CLIENT_MULTI_WAKEUP
+            curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+#else
+            curl_multi_wait(multi, nullptr, 0, HTTP_CLIENT_POLL_TIMEOUT_MS, nullptr);
+#endif
+        }
+    }
+
+    // cleanup: if worker thread received quit signal, abort the running requests
+    for (auto transfer : transfers)
+    {
+        curl_multi_remove_handle(multi, transfer->curl.getHandle());
+        HttpRequest* request = transfer->response->getHttpRequest();
+        transfer->response->release();
+        request->release();
+        delete transfer;
+    }
+
+    _requestQueueMutex.lock();
+    _multiHandle = nullptr;
+    _requestQueueMutex.unlock();
+    curl_multi_cleanup(multi);
+    
+    // and clean up un-completed request queue
+    _requestQueueMutex.lock();
+    _requestQueue.clear();
+    _requestQueueMutex.unlock();
+
+    _responseQueueMutex.lock();
+    _responseQueue.clear();
+    _responseQueueMutex.unlock();
+
+    decreaseThreadCountAndMayDeleteThis();
 }
 
-//Process DELETE Request
-static int processDeleteTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
+// add response packet into queue and dispatch it in the cocos thread
+void HttpClient::addResponse(HttpResponse* response)
 {
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_CUSTOMREQUEST, "DELETE")
-            && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    _responseQueueMutex.lock();
+    _responseQueue.pushBack(response);
+    _responseQueueMutex.unlock();
+
+    _schedulerMutex.lock();
+    if (auto sche = _scheduler.lock())
+    {
+        sche->performFunctionInCocosThread(CC_CALLBACK_0(HttpClient::dispatchResponseCallbacks, this));
+    }
+    _schedulerMutex.unlock();
 }
 
 // HttpClient implementation
@@ -377,7 +528,14 @@ void HttpClient::destroyInstance()
     thiz->_schedulerMutex.unlock();
 
     thiz->_requestQueueMutex.lock();
-    thiz->_requestQueue.pushBack(thiz->_requestSentinel);
+    // the sentinel goes first, running requests are aborted
+    thiz->_requestQueue.insert(0, thiz->_requestSentinel);
+#if HTTP_CLIENT_MULTI_WAKEUP
+    if (thiz->_multiHandle)
+    {
+        curl_multi_wakeup((CURLM*)thiz->_multiHandle);
+    }
+#endif
     thiz->_requestQueueMutex.unlock();
 
     thiz->_sleepCondition.notify_one();
@@ -397,6 +555,40 @@ void HttpClient::enableCookies(const char* cookieFile)
     {
         _cookieFilename = (FileUtils::getInstance()->getWritablePath() + "cookieFile.txt");
     }
+    _cookiesLoaded = false;
+}
+
+void HttpClient::loadCookies()
+{
+    std::lock_guard<std::mutex> lock(_cookieFileMutex);
+    if (_cookiesLoaded || _cookieFilename.empty() || !_shareHandle)
+        return;
+
+    CURL* handle = curl_easy_init();
+    if (handle)
+    {
+        curl_easy_setopt(handle, CURLOPT_SHARE, (CURLSH*)_shareHandle);
+        curl_easy_setopt(handle, CURLOPT_COOKIEFILE, _cookieFilename.c_str());
+        curl_easy_setopt(handle, CURLOPT_COOKIELIST, "RELOAD");
+        curl_easy_cleanup(handle);
+    }
+    _cookiesLoaded = true;
+}
+
+void HttpClient::flushCookies()
+{
+    std::lock_guard<std::mutex> lock(_cookieFileMutex);
+    if (!_cookiesLoaded)
+        return;
+
+    // a handle with a cookie jar writes the whole shared store to it when cleaned up
+    CURL* handle = curl_easy_init();
+    if (handle)
+    {
+        curl_easy_setopt(handle, CURLOPT_SHARE, (CURLSH*)_shareHandle);
+        curl_easy_setopt(handle, CURLOPT_COOKIEJAR, _cookieFilename.c_str());
+        curl_easy_cleanup(handle);
+    }
 }
     
 void HttpClient::setSSLVerification(const std::string& caFile)
@@ -410,6 +602,10 @@ HttpClient::HttpClient()
 , _timeoutForConnect(30)
 , _timeoutForRead(60)
 , _threadCount(0)
+, _maxConcurrentRequests(HTTP_CLIENT_MAX_CONCURRENT_REQUESTS)
+, _multiHandle(nullptr)
+, _shareHandle(nullptr)
+, _cookiesLoaded(false)
 , _cookie(nullptr)
 , _requestSentinel(new HttpRequest())
 {
@@ -417,11 +613,29 @@ HttpClient::HttpClient()
     memset(_responseMessage, 0, RESPONSE_BUFFER_SIZE * sizeof(char));
     _scheduler = Application::getInstance()->getScheduler();
     increaseThreadCount();
+
+    CURLSH* share = curl_share_init();
+    if (share)
+    {
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShareData);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShareData);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
+#if LIBCURL_VERSION_NUM >= 0x073900
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+    }
+    _shareHandle = share;
 }
 
 HttpClient::~HttpClient()
 {
     CC_SAFE_RELEASE(_requestSentinel);
+    if (_shareHandle)
+    {
+        curl_share_cleanup((CURLSH*)_shareHandle);
+    }
     CCLOG("HttpClient destructor");
 }
 
@@ -458,7 +672,19 @@ void HttpClient::send(HttpRequest* request)
     request->retain();
 
     _requestQueueMutex.lock();
-    _requestQueue.pushBack(request);
+    // keep the queue sorted by priority, in order of sending for the same priority
+    ssize_t index = _requestQueue.size();
+    while (index > 0 && _requestQueue.at(index - 1)->getPriority() < request->getPriority())
+    {
+        --index;
+    }
+    _requestQueue.insert(index, request);
+#if HTTP_CLIENT_MULTI_WAKEUP
+    if (_multiHandle)
+    {
+        curl_multi_wakeup((CURLM*)_multiHandle);
+    }
+#endif
     _requestQueueMutex.unlock();
 
     // Notify thread start to work
@@ -516,77 +742,13 @@ void HttpClient::processResponse(HttpResponse* response, char* responseMessage)
 {
     auto request = response->getHttpRequest();
     long responseCode = -1;
-    int retValue = 0;
 
     // Process the request -> get response packet
-    switch (request->getRequestType())
-    {
-    case HttpRequest::Type::GET: // HTTP GET
-        retValue = processGetTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    case HttpRequest::Type::POST: // HTTP POST
-        retValue = processPostTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    case HttpRequest::Type::PUT:
-        retValue = processPutTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-	case HttpRequest::Type::HEAD:
-		retValue = processHeadTask(this, request,
-			writeData,
-			response->getResponseData(),
-			&responseCode,
-			writeHeaderData,
-			response->getResponseHeader(),
-			responseMessage);
-		break;
-
-    case HttpRequest::Type::DELETE:
-        retValue = processDeleteTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    default:
-        CCASSERT(false, "CCHttpClient: unknown request type, only GET, POST, PUT, HEAD or DELETE is supported");
-        break;
-    }
+    CURLRaii curl;
+    bool succeed = configureRequest(curl, this, request, response, responseMessage)
+            && curl.perform(&responseCode);
 
-    // write data to HttpResponse
-    response->setResponseCode(responseCode);
-    if (retValue != 0)
-    {
-        response->setSucceed(false);
-        response->setErrorBuffer(responseMessage);
-    }
-    else
-    {
-        response->setSucceed(true);
-    }
+    setResponseResult(response, succeed, responseCode, responseMessage);
 }
 
 void HttpClient::increaseThreadCount()
@@ -613,6 +775,18 @@ void HttpClient::decreaseThreadCountAndMayDeleteThis()
     }
 }
 
+void HttpClient::setMaxConcurrentRequests(int value)
+{
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    _maxConcurrentRequests = value;
+}
+
+int HttpClient::getMaxConcurrentRequests()
+{
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    return _maxConcurrentRequests;
+}
+
 void HttpClient::setTimeoutForConnect(int value)
 {
     std::lock_guard<std::mutex> lock(_timeoutForConnectMutex);
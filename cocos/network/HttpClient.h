@@ -149,11 +149,39 @@ public:
      */
     CC_DEPRECATED_ATTRIBUTE int getTimeoutForRead();
 
+    /**
+     * Set the maximum number of requests which are sent at the same time.
+     * Requests to the same host share connections, and are multiplexed over HTTP/2 when the server supports it.
+     *
+     * @param value the maximum number of concurrent requests, the default is 8.
+     */
+    void setMaxConcurrentRequests(int value);
+
+    /**
+     * Get the maximum number of requests which are sent at the same time.
+     *
+     * @return int the maximum number of concurrent requests.
+     */
+    int getMaxConcurrentRequests();
+
     HttpCookie* getCookie() const {return _cookie; }
 
     std::mutex& getCookieFileMutex() {return _cookieFileMutex;}
 
     std::mutex& getSSLCaFileMutex() {return _sslCaFileMutex;}
+
+    void* getShareHandle() const {return _shareHandle;}
+
+    /**
+     * Reads the cookie file into the cookie store shared by all requests, only the first call
+     * after enableCookies() reads it.
+     */
+    void loadCookies();
+
+    /**
+     * Writes the shared cookie store to the cookie file.
+     */
+    void flushCookies();
 private:
     HttpClient();
     virtual ~HttpClient();
@@ -170,6 +198,7 @@ private:
     void dispatchResponseCallbacks();
 
     void processResponse(HttpResponse* response, char* responseMessage);
+    void addResponse(HttpResponse* response);
     void increaseThreadCount();
     void decreaseThreadCountAndMayDeleteThis();
 
@@ -185,6 +214,14 @@ private:
     int  _threadCount;
     std::mutex _threadCountMutex;
 
+    int _maxConcurrentRequests;
+    std::mutex _maxConcurrentRequestsMutex;
+
+    // curl multi handle of the network thread, guarded by _requestQueueMutex
+    void* _multiHandle;
+    // DNS, TLS session, connection cache and cookies shared by all requests
+    void* _shareHandle;
+
     std::weak_ptr<Scheduler> _scheduler;
     std::mutex _schedulerMutex;
 
@@ -196,6 +233,8 @@ private:
 
     std::string _cookieFilename;
     std::mutex _cookieFileMutex;
+    // whether the cookie file was read into the shared store, guarded by _cookieFileMutex
+    bool _cookiesLoaded;
 
     std::string _sslCaFilename;
     std::mutex _sslCaFileMutex;
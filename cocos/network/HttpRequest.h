@@ -91,6 +91,7 @@ public:
     , _callback(nullptr)
     , _userData(nullptr)
     , _timeoutInSeconds(10.0f)
+    , _priority(0)
     {
     }
 
@@ -285,6 +286,22 @@ public:
         return _timeoutInSeconds;
     }
 
+    /**
+     * Set the priority of the request, queued requests with a higher priority are sent first.
+     * Requests of the same priority are sent in order. The default is 0.
+     *
+     * @param priority the priority of the request
+     */
+    inline void setPriority(int priority)
+    {
+        _priority = priority;
+    }
+
+    inline int getPriority() const
+    {
+        return _priority;
+    }
+
 protected:
     // properties
     Type                        _requestType;    /// kHttpRequestGet, kHttpRequestPost or other enums
@@ -295,6 +312,7 @@ protected:
     void*                       _userData;      /// You can add your customed data here
     std::vector<std::string>    _headers;       /// custom http headers
     float _timeoutInSeconds;
+    int _priority;
 };
 
 }
@@ -43,6 +43,7 @@
 #include <vector>
 #include "network/WebSocket.h"
 #include "network/Uri.h"
+#include "base/ccConfig.h"
 #include "base/CCScheduler.h"
 #include "platform/CCFileUtils.h"
 #include "platform/CCStdC.h"
@@ -53,6 +54,9 @@
 
 #define WS_RX_BUFFER_SIZE (65536)
 #define WS_RESERVE_RECEIVE_BUFFER_SIZE (4096)
+// Upper bound of a single wait in the websocket thread. New messages wake it up by 'lws_cancel_service',
+// so this only decides how often libwebsockets gets a chance to check its internal timeouts.
+#define WS_SERVICE_TIMEOUT_MS (100)
 
 #define  LOG_TAG    "WebSocket.cpp"
 
@@ -220,7 +224,10 @@ private:
     cocos2d::network::WebSocket::State _readyState;
     std::mutex  _readyStateMutex;
     std::string _url;
-    std::vector<char> _receivedData;
+    // Fragments of the message being received, allocated by 'malloc' so that it could be handed over to delegate.
+    char* _receivedData;
+    size_t _receivedDataSize;
+    size_t _receivedDataCapacity;
 
     struct lws* _wsInstance;
     struct lws_protocols* _lwsProtocols;
@@ -278,6 +285,26 @@ static std::string getFileNameForPath(const std::string& filePath)
 
 static struct lws_protocols __defaultProtocols[2];
 
+#if CC_ENABLE_WEBSOCKET_PERMESSAGE_DEFLATE
+static const struct lws_extension __wsExtensions[] = {
+    {
+        "permessage-deflate",
+        lws_extension_callback_pm_deflate,
+        // client_no_context_takeover extension is not supported in the current version, it will cause connection fail
+        // It may be a bug of lib websocket build
+        //            "permessage-deflate; client_no_context_takeover; client_max_window_bits"
+        // Server may choose a smaller window for our messages, but not a larger one.
+        "permessage-deflate; client_max_window_bits=" QUOTEME(CC_WEBSOCKET_DEFLATE_WINDOW_BITS)
+    },
+    {
+        "deflate-frame",
+        lws_extension_callback_pm_deflate,
+        "deflate_frame"
+    },
+    { nullptr, nullptr, nullptr /* terminator */ }
+};
+#endif
+
 static lws_context_creation_info convertToContextCreationInfo(const struct lws_protocols* protocols, bool peerServerCert)
 {
     lws_context_creation_info info;
@@ -293,14 +320,13 @@ static lws_context_creation_info convertToContextCreationInfo(const struct lws_p
     info.port = CONTEXT_PORT_NO_LISTEN;
     info.protocols = protocols;
 
-    // IDEA: Disable 'permessage-deflate' extension temporarily because of issues:
+    // 'permessage-deflate' was disabled because of issues:
     // https://github.com/cocos2d/cocos2d-x/issues/16045, https://github.com/cocos2d/cocos2d-x/issues/15767
     // libwebsockets issue: https://github.com/warmcat/libwebsockets/issues/593
-    // Currently, we couldn't find out the exact reason.
-    // libwebsockets official said it's probably an issue of user code
-    // since 'libwebsockets' passed AutoBahn stressed Test.
-
-    //    info.extensions = exts;
+    // It could be disabled again by CC_ENABLE_WEBSOCKET_PERMESSAGE_DEFLATE if servers fail to inflate our messages.
+#if CC_ENABLE_WEBSOCKET_PERMESSAGE_DEFLATE
+    info.extensions = __wsExtensions;
+#endif
 
     info.gid = -1;
     info.uid = -1;
@@ -332,6 +358,70 @@ private:
 
 unsigned int WsMessage::__id = 0;
 
+#if CC_ENABLE_WEBSOCKET_BATCH_DISPATCH
+/**
+ *  @brief Unbounded lock-free queue of callbacks, pushed by websocket thread and popped by cocos thread.
+ */
+class WsCocosThreadQueue
+{
+public:
+    WsCocosThreadQueue()
+    : _dispatchPending(false)
+    {
+        _head = _tail = new (std::nothrow) Node();
+    }
+
+    ~WsCocosThreadQueue()
+    {
+        while (_head)
+        {
+            Node* next = _head->next.load(std::memory_order_relaxed);
+            delete _head;
+            _head = next;
+        }
+    }
+
+    // Invoked in websocket thread. Returns true if the queue needs to be dispatched.
+    bool push(const std::function<void()>& cb)
+    {
+        Node* node = new (std::nothrow) Node();
+        node->cb = cb;
+        _tail->next.store(node, std::memory_order_release);
+        _tail = node;
+        return !_dispatchPending.exchange(true, std::memory_order_acq_rel);
+    }
+
+    // Invoked in cocos thread, runs callbacks in the order they were pushed.
+    void dispatch()
+    {
+        // Reset the flag first, so callbacks pushed while dispatching will schedule another dispatch.
+        _dispatchPending.store(false, std::memory_order_release);
+
+        Node* next = nullptr;
+        while ((next = _head->next.load(std::memory_order_acquire)) != nullptr)
+        {
+            delete _head;
+            _head = next;
+            std::function<void()> cb = std::move(_head->cb);
+            _head->cb = nullptr;
+            cb();
+        }
+    }
+
+private:
+    struct Node
+    {
+        Node() : next(nullptr) {}
+        std::function<void()> cb;
+        std::atomic<Node*> next;
+    };
+
+    Node* _head; // Accessed in cocos thread only
+    Node* _tail; // Accessed in websocket thread only
+    std::atomic<bool> _dispatchPending;
+};
+#endif // CC_ENABLE_WEBSOCKET_BATCH_DISPATCH
+
 /**
  *  @brief Websocket thread helper, it's used for sending message between UI thread and websocket thread.
  */
@@ -352,7 +442,16 @@ public:
     // Sends message to Websocket thread. It's needs to be invoked in Cocos thread.
     void sendMessageToWebSocketThread(WsMessage *msg);
 
+    // Wakes up websocket thread if it's waiting for socket events.
+    void wakeUpWebSocketThread();
+
+    // Asks websocket thread to trigger the writable callback of a connection, to send data or close it.
+    void requestWritable(WebSocketImpl *ws);
+    // Invoked while a websocket instance is destroyed.
+    void cancelWritableRequest(WebSocketImpl *ws);
+
     size_t countBufferdBytes(const WebSocketImpl *ws);
+    bool hasPendingMessages(const WebSocketImpl *ws);
 
     // Waits the sub-thread (websocket thread) to exit,
     void joinWebSocketThread();
@@ -368,7 +467,15 @@ public:
     std::mutex   _subThreadWsMessageQueueMutex;
     std::thread* _subThreadInstance;
 private:
-    bool _needQuit;
+    std::atomic<bool> _needQuit;
+    // Whether '__wsContext' could be used by other threads.
+    bool _isContextReady;
+    std::mutex _contextMutex;
+    std::vector<WebSocketImpl*> _writableRequests;
+    std::mutex _writableRequestsMutex;
+#if CC_ENABLE_WEBSOCKET_BATCH_DISPATCH
+    std::shared_ptr<WsCocosThreadQueue> _cocosThreadQueue;
+#endif
 };
 
 // Wrapper for converting websocket callback from static function to member function of WebSocket class.
@@ -403,8 +510,12 @@ public:
 WsThreadHelper::WsThreadHelper()
 : _subThreadInstance(nullptr)
 , _needQuit(false)
+, _isContextReady(false)
 {
     _subThreadWsMessageQueue = new (std::nothrow) std::list<WsMessage*>();
+#if CC_ENABLE_WEBSOCKET_BATCH_DISPATCH
+    _cocosThreadQueue = std::make_shared<WsCocosThreadQueue>();
+#endif
 }
 
 WsThreadHelper::~WsThreadHelper()
@@ -424,6 +535,7 @@ bool WsThreadHelper::createWebSocketThread()
 void WsThreadHelper::quitWebSocketThread()
 {
     _needQuit = true;
+    wakeUpWebSocketThread();
 }
 
 void WsThreadHelper::onSubThreadLoop()
@@ -458,14 +570,24 @@ void WsThreadHelper::onSubThreadLoop()
         }
         __wsHelper->_subThreadWsMessageQueueMutex.unlock();
 
-        // The second parameter passed to 'lws_service' means the timeout in milliseconds while polling websocket events.
-        // The lower value the better, otherwise, it may trigger high CPU usage.
-        // We set 2ms in 'lws_service' then sleep 3ms to make lower CPU cost.
-        // Since messages are received in websocket thread and user code is in cocos thread, we need to post event to
-        // cocos thread and trigger user callbacks by 'Scheduler::performFunctionInCocosThread'. If game's fps is set
-        // to 60 (16.66ms), the latency will be (2ms + 3ms + 16.66ms + internet delay) > 21ms
-        lws_service(__wsContext, 2);
-        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+        // Connections only ask for writable callbacks while they have something to send or are closing.
+        {
+            std::lock_guard<std::mutex> lk(_writableRequestsMutex);
+            for (auto ws : _writableRequests)
+            {
+                if (ws->_wsInstance != nullptr)
+                {
+                    lws_callback_on_writable(ws->_wsInstance);
+                }
+            }
+            _writableRequests.clear();
+        }
+
+        // 'lws_service' blocks until there are socket events, or 'lws_cancel_service' is invoked
+        // by cocos thread after queueing a new message, so there is no need to poll or sleep here.
+        // Received messages are posted to cocos thread and the user callbacks are triggered
+        // at the end of the next frame.
+        lws_service(__wsContext, WS_SERVICE_TIMEOUT_MS);
     }
 }
 
@@ -483,10 +605,18 @@ void WsThreadHelper::onSubThreadStarted()
 
     lws_context_creation_info creationInfo = convertToContextCreationInfo(__defaultProtocols, true);
     __wsContext = lws_create_context(&creationInfo);
+
+    std::lock_guard<std::mutex> lk(_contextMutex);
+    _isContextReady = (__wsContext != nullptr);
 }
 
 void WsThreadHelper::onSubThreadEnded()
 {
+    {
+        std::lock_guard<std::mutex> lk(_contextMutex);
+        _isContextReady = false;
+    }
+
     if (__wsContext != nullptr)
     {
         lws_context_destroy(__wsContext);
@@ -510,13 +640,65 @@ void WsThreadHelper::wsThreadEntryFunc()
 
 void WsThreadHelper::sendMessageToCocosThread(const std::function<void()>& cb)
 {
+#if CC_ENABLE_WEBSOCKET_BATCH_DISPATCH
+    // Only the first message after a dispatch posts a function, the others are dispatched with it.
+    if (_cocosThreadQueue->push(cb))
+    {
+        std::shared_ptr<WsCocosThreadQueue> queue = _cocosThreadQueue;
+        cocos2d::Application::getInstance()->getScheduler()->performFunctionInCocosThread([queue](){
+            queue->dispatch();
+        });
+    }
+#else
     cocos2d::Application::getInstance()->getScheduler()->performFunctionInCocosThread(cb);
+#endif
 }
 
 void WsThreadHelper::sendMessageToWebSocketThread(WsMessage *msg)
 {
-    std::lock_guard<std::mutex> lk(_subThreadWsMessageQueueMutex);
-    _subThreadWsMessageQueue->push_back(msg);
+    // 'msg' may be released by websocket thread once it's in the queue.
+    const unsigned int what = msg->what;
+    WebSocketImpl* ws = (WebSocketImpl*)msg->user;
+    {
+        std::lock_guard<std::mutex> lk(_subThreadWsMessageQueueMutex);
+        _subThreadWsMessageQueue->push_back(msg);
+    }
+
+    if (what == WS_MSG_TO_SUBTHREAD_CREATE_CONNECTION)
+    {
+        wakeUpWebSocketThread();
+    }
+    else
+    {
+        requestWritable(ws);
+    }
+}
+
+void WsThreadHelper::wakeUpWebSocketThread()
+{
+    std::lock_guard<std::mutex> lk(_contextMutex);
+    if (_isContextReady)
+    {
+        lws_cancel_service(__wsContext);
+    }
+}
+
+void WsThreadHelper::requestWritable(WebSocketImpl *ws)
+{
+    {
+        std::lock_guard<std::mutex> lk(_writableRequestsMutex);
+        if (std::find(_writableRequests.begin(), _writableRequests.end(), ws) == _writableRequests.end())
+        {
+            _writableRequests.push_back(ws);
+        }
+    }
+    wakeUpWebSocketThread();
+}
+
+void WsThreadHelper::cancelWritableRequest(WebSocketImpl *ws)
+{
+    std::lock_guard<std::mutex> lk(_writableRequestsMutex);
+    _writableRequests.erase(std::remove(_writableRequests.begin(), _writableRequests.end(), ws), _writableRequests.end());
 }
 
 size_t WsThreadHelper::countBufferdBytes(const WebSocketImpl *ws)
@@ -533,6 +715,19 @@ size_t WsThreadHelper::countBufferdBytes(const WebSocketImpl *ws)
     return total;
 }
 
+bool WsThreadHelper::hasPendingMessages(const WebSocketImpl *ws)
+{
+    std::lock_guard<std::mutex> lk(_subThreadWsMessageQueueMutex);
+    for (auto msg : *_subThreadWsMessageQueue)
+    {
+        if (msg->user == ws)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 
 void WsThreadHelper::joinWebSocketThread()
 {
@@ -542,7 +737,9 @@ void WsThreadHelper::joinWebSocketThread()
     }
 }
 
-// Define a WebSocket frame
+// Define a WebSocket frame, it refers to a part of the sending data instead of copying it.
+// libwebsockets writes the frame header into LWS_PRE bytes before the payload, which is the reserved space
+// for the first frame, or the data of previous frames which were already sent.
 class WebSocketFrame
 {
 public:
@@ -555,22 +752,16 @@ public:
 
     bool init(unsigned char* buf, ssize_t len)
     {
-        if (buf == nullptr && len > 0)
+        if (buf == nullptr)
             return false;
 
-        if (!_data.empty())
+        if (_payload != nullptr)
         {
             LOGD("WebSocketFrame was initialized, should not init it again!\n");
             return false;
         }
 
-        _data.resize(LWS_PRE + len);
-        if (len > 0)
-        {
-            std::copy(buf, buf+len, _data.begin() + LWS_PRE);
-        }
-
-        _payload = _data.data() + LWS_PRE;
+        _payload = buf;
         _payloadLength = len;
         _frameLength = len;
         return true;
@@ -590,7 +781,6 @@ private:
     ssize_t _payloadLength;
 
     ssize_t _frameLength;
-    std::vector<unsigned char> _data;
 };
 
 //
@@ -616,14 +806,15 @@ void WebSocketImpl::closeAllConnections()
 WebSocketImpl::WebSocketImpl(cocos2d::network::WebSocket* ws)
 : _ws(ws)
 , _readyState(cocos2d::network::WebSocket::State::CONNECTING)
+, _receivedData(nullptr)
+, _receivedDataSize(0)
+, _receivedDataCapacity(0)
 , _wsInstance(nullptr)
 , _lwsProtocols(nullptr)
 , _isDestroyed(std::make_shared<std::atomic<bool>>(false))
 , _delegate(nullptr)
 , _closeState(CloseState::NONE)
 {
-    // reserve data buffer to avoid allocate memory frequently
-    _receivedData.reserve(WS_RESERVE_RECEIVE_BUFFER_SIZE);
     if (__websocketInstances == nullptr)
     {
         __websocketInstances = new (std::nothrow) std::vector<WebSocketImpl*>();
@@ -650,6 +841,11 @@ WebSocketImpl::~WebSocketImpl()
 
     std::lock_guard<std::mutex> lk(__instanceMutex);
 
+    if (__wsHelper != nullptr)
+    {
+        __wsHelper->cancelWritableRequest(this);
+    }
+
     if (__websocketInstances != nullptr)
     {
         auto iter = std::find(__websocketInstances->begin(), __websocketInstances->end(), this);
@@ -676,6 +872,7 @@ WebSocketImpl::~WebSocketImpl()
 // NOTE: Refer to the comment in constructor!!!
 //    cocos2d::Director::getInstance()->getEventDispatcher()->removeEventListener(_resetDirectorListener);
 
+    CC_SAFE_FREE(_receivedData);
     *_isDestroyed = true;
 }
 
@@ -765,10 +962,10 @@ void WebSocketImpl::send(const std::string& message)
     {
         // In main thread
         cocos2d::network::WebSocket::Data* data = new (std::nothrow) cocos2d::network::WebSocket::Data();
-        data->bytes = (char*)malloc(message.length() + 1);
+        // Reserve LWS_PRE bytes for libwebsockets to write frame header, so that frames could be sent in place.
+        data->bytes = (char*)malloc(LWS_PRE + message.length() + 1);
         // Make sure the last byte is '\0'
-        data->bytes[message.length()] = '\0';
-        strcpy(data->bytes, message.c_str());
+        memcpy(data->bytes + LWS_PRE, message.c_str(), message.length() + 1);
         data->len = static_cast<ssize_t>(message.length());
 
         WsMessage* msg = new (std::nothrow) WsMessage();
@@ -792,13 +989,13 @@ void WebSocketImpl::send(const unsigned char* binaryMsg, unsigned int len)
         if (len == 0)
         {
             // If data length is zero, allocate 1 byte for safe.
-            data->bytes = (char*)malloc(1);
-            data->bytes[0] = '\0';
+            data->bytes = (char*)malloc(LWS_PRE + 1);
+            data->bytes[LWS_PRE] = '\0';
         }
         else
         {
-            data->bytes = (char*)malloc(len);
-            memcpy((void*)data->bytes, (void*)binaryMsg, len);
+            data->bytes = (char*)malloc(LWS_PRE + len);
+            memcpy((void*)(data->bytes + LWS_PRE), (void*)binaryMsg, len);
         }
         data->len = len;
 
@@ -842,6 +1039,8 @@ void WebSocketImpl::close()
 
     {
         std::unique_lock<std::mutex> lkClose(_closeMutex);
+        // Request after locking, websocket thread can't notify before waiting starts.
+        __wsHelper->requestWritable(this);
         _closeCondition.wait(lkClose);
         _closeState = CloseState::SYNC_CLOSED;
     }
@@ -879,6 +1078,7 @@ void WebSocketImpl::closeAsync()
     }
 
     _readyState = cocos2d::network::WebSocket::State::CLOSING;
+    __wsHelper->requestWritable(this);
 }
 
 cocos2d::network::WebSocket::State WebSocketImpl::getReadyState() const
@@ -992,23 +1192,6 @@ void WebSocketImpl::onClientOpenConnectionRequest()
 {
     if (nullptr != __wsContext)
     {
-        static const struct lws_extension exts[] = {
-            {
-                "permessage-deflate",
-                lws_extension_callback_pm_deflate,
-                // client_no_context_takeover extension is not supported in the current version, it will cause connection fail
-                // It may be a bug of lib websocket build
-                //            "permessage-deflate; client_no_context_takeover; client_max_window_bits"
-                "permessage-deflate; client_max_window_bits"
-            },
-            {
-                "deflate-frame",
-                lws_extension_callback_pm_deflate,
-                "deflate_frame"
-            },
-            { nullptr, nullptr, nullptr /* terminator */ }
-        };
-
         _readyStateMutex.lock();
         _readyState = cocos2d::network::WebSocket::State::CONNECTING;
         _readyStateMutex.unlock();
@@ -1052,7 +1235,9 @@ void WebSocketImpl::onClientOpenConnectionRequest()
         connectInfo.protocol = _clientSupportedProtocols.empty() ? nullptr : _clientSupportedProtocols.c_str();
         connectInfo.ietf_version_or_minus_one = -1;
         connectInfo.userdata = this;
-        connectInfo.client_exts = exts;
+#if CC_ENABLE_WEBSOCKET_PERMESSAGE_DEFLATE
+        connectInfo.client_exts = __wsExtensions;
+#endif
         connectInfo.vhost = vhost;
 
         _wsInstance = lws_client_connect_via_info(&connectInfo);
@@ -1126,7 +1311,7 @@ int WebSocketImpl::onClientWritable()
             else
             {
                 frame = new (std::nothrow) WebSocketFrame();
-                bool success = frame && frame->init((unsigned char*)(data->bytes + data->issued), n);
+                bool success = frame && frame->init((unsigned char*)(data->bytes + LWS_PRE + data->issued), n);
                 if (success)
                 {
                     data->ext = frame;
@@ -1228,7 +1413,9 @@ int WebSocketImpl::onClientWritable()
 
     } while(false);
 
-    if (_wsInstance != nullptr)
+    // Keep writing while there are messages or fragments left, otherwise wait for
+    // websocket thread to be woken up by a new message.
+    if (_wsInstance != nullptr && (__wsHelper->hasPendingMessages(this) || getReadyState() == cocos2d::network::WebSocket::State::CLOSING))
     {
         lws_callback_on_writable(_wsInstance);
     }
@@ -1245,8 +1432,22 @@ int WebSocketImpl::onClientReceivedData(void* in, ssize_t len)
     {
         LOGD("Receiving data:index:%d, len=%d\n", packageIndex, (int)len);
 
-        unsigned char* inData = (unsigned char*)in;
-        _receivedData.insert(_receivedData.end(), inData, inData + len);
+        // Reserve one more byte for the '\0' of text messages
+        size_t requiredSize = _receivedDataSize + len + 1;
+        if (requiredSize > _receivedDataCapacity)
+        {
+            size_t capacity = std::max(requiredSize, std::max(_receivedDataCapacity * 2, (size_t)WS_RESERVE_RECEIVE_BUFFER_SIZE));
+            char* receivedData = (char*)realloc(_receivedData, capacity);
+            if (receivedData == nullptr)
+            {
+                LOGE("Out of memory while receiving data, len=%d\n", (int)requiredSize);
+                return -1;
+            }
+            _receivedData = receivedData;
+            _receivedDataCapacity = capacity;
+        }
+        memcpy(_receivedData + _receivedDataSize, in, len);
+        _receivedDataSize += len;
     }
     else
     {
@@ -1260,18 +1461,31 @@ int WebSocketImpl::onClientReceivedData(void* in, ssize_t len)
 
     if (remainingSize == 0 && isFinalFragment)
     {
-        std::vector<char>* frameData = new (std::nothrow) std::vector<char>(std::move(_receivedData));
-
-        // reset capacity of received data buffer
-        _receivedData.reserve(WS_RESERVE_RECEIVE_BUFFER_SIZE);
-
-        ssize_t frameSize = frameData->size();
+        // Hand over the received buffer, the next message starts with a new one.
+        ssize_t frameSize = _receivedDataSize;
+        char* frameData = _receivedData;
+        if (frameData == nullptr)
+        {
+            frameData = (char*)malloc(1);
+        }
+        else if (_receivedDataCapacity > _receivedDataSize + 1)
+        {
+            // Shrinking is done in place by most allocators, it avoids holding unused memory in ArrayBuffer.
+            char* shrunkData = (char*)realloc(frameData, _receivedDataSize + 1);
+            if (shrunkData != nullptr)
+            {
+                frameData = shrunkData;
+            }
+        }
+        _receivedData = nullptr;
+        _receivedDataSize = 0;
+        _receivedDataCapacity = 0;
 
         bool isBinary = (lws_frame_is_binary(_wsInstance) != 0);
 
         if (!isBinary)
         {
-            frameData->push_back('\0');
+            frameData[frameSize] = '\0';
         }
 
         std::shared_ptr<std::atomic<bool>> isDestroyed = _isDestroyed;
@@ -1281,8 +1495,9 @@ int WebSocketImpl::onClientReceivedData(void* in, ssize_t len)
 
             cocos2d::network::WebSocket::Data data;
             data.isBinary = isBinary;
-            data.bytes = (char*)frameData->data();
+            data.bytes = frameData;
             data.len = frameSize;
+            data.isBytesTransferable = true;
 
             if (*isDestroyed)
             {
@@ -1293,7 +1508,10 @@ int WebSocketImpl::onClientReceivedData(void* in, ssize_t len)
                 _delegate->onMessage(_ws, data);
             }
 
-            delete frameData;
+            if (data.isBytesTransferable)
+            {
+                free(frameData);
+            }
         });
     }
 
@@ -1311,6 +1529,11 @@ int WebSocketImpl::onConnectionOpened()
      */
     lws_callback_on_writable(_wsInstance);
 
+#if CC_ENABLE_WEBSOCKET_PERMESSAGE_DEFLATE
+    // Window bits are negotiated in handshake, memory level is only used by our compressor.
+    lws_set_extension_option(_wsInstance, "permessage-deflate", "mem_level", QUOTEME(CC_WEBSOCKET_DEFLATE_MEM_LEVEL));
+#endif
+
     {
         std::lock_guard<std::mutex> lk(_readyStateMutex);
         if (_readyState == cocos2d::network::WebSocket::State::CLOSING || _readyState == cocos2d::network::WebSocket::State::CLOSED)
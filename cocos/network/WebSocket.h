@@ -92,11 +92,14 @@ public:
      */
     struct Data
     {
-        Data():bytes(nullptr), len(0), issued(0), isBinary(false), ext(nullptr){}
+        Data():bytes(nullptr), len(0), issued(0), isBinary(false), ext(nullptr), isBytesTransferable(false){}
         char* bytes;
         ssize_t len, issued;
         bool isBinary;
         void* ext;
+        // If it's true, 'bytes' of a received message was allocated by 'malloc' and will be freed after 'onMessage'.
+        // Delegates could take over 'bytes' instead of copying it by setting it to false.
+        mutable bool isBytesTransferable;
         ssize_t getRemain() { return std::max((ssize_t)0, len - issued); }
     };
 
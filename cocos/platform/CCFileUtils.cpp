@@ -26,23 +26,26 @@ THE SOFTWARE.
 
 #include "platform/CCFileUtils.h"
 
+#include <algorithm>
 #include <stack>
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
+#include "base/ZipUtils.h"
 #include "platform/CCSAXParser.h"
 
 #include "tinyxml2/tinyxml2.h"
 #include "tinydir/tinydir.h"
 
-#ifdef MINIZIP_FROM_SYSTEM
-#include <minizip/unzip.h>
-#else // from our embedded sources
-#include "unzip/unzip.h"
-#endif
 #include <sys/stat.h>
 #include <regex>
 
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 NS_CC_BEGIN
 
 // Implement DictMaker
@@ -405,6 +408,10 @@ bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& ful
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+    {
+        purgeCachedMissingEntries(fullPath);
+    }
 
     delete doc;
     return ret;
@@ -445,6 +452,10 @@ bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::st
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+    {
+        purgeCachedMissingEntries(fullPath);
+    }
 
     delete doc;
     return ret;
@@ -562,9 +573,32 @@ void FileUtils::setDelegate(FileUtils *delegate)
     s_sharedFileUtils = delegate;
 }
 
+MappedFile::MappedFile(const unsigned char* bytes, ssize_t size, const std::function<void()>& release)
+    : _bytes(bytes)
+    , _size(size)
+    , _release(release)
+{
+}
+
+MappedFile::MappedFile(Data&& data)
+    : _data(std::move(data))
+{
+    _bytes = _data.getBytes();
+    _size = _data.getSize();
+}
+
+MappedFile::~MappedFile()
+{
+    if (_release)
+        _release();
+}
+
 FileUtils::FileUtils()
     : _writablePath("")
+    , _searchPathGeneration(0)
+    , _missingEpoch(0)
 {
+    updateSearchPathSnapshot();
 }
 
 FileUtils::~FileUtils()
@@ -602,6 +636,7 @@ bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath)
 
         fclose(fp);
 
+        fileutils->purgeCachedMissingEntries(fullPath);
         return true;
     } while (0);
 
@@ -612,12 +647,114 @@ bool FileUtils::init()
 {
     _searchPathArray.push_back(_defaultResRootPath);
     _searchResolutionsOrderArray.push_back("");
+    updateSearchPathSnapshot();
     return true;
 }
 
 void FileUtils::purgeCachedEntries()
 {
-    _fullPathCache.clear();
+    for (auto& shard : _fullPathCache)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(_directoryIndexMutex);
+    _directoryIndex.clear();
+}
+
+void FileUtils::purgeCachedMissingEntries()
+{
+    // Missing entries of older epochs are ignored, so they don't need to be erased here.
+    ++_missingEpoch;
+
+    {
+        std::lock_guard<std::mutex> lock(_directoryIndexMutex);
+        _directoryIndex.clear();
+    }
+
+    // Archives may have been replaced
+    std::lock_guard<std::mutex> lock(_zipFileCacheMutex);
+    _zipFileCache.clear();
+}
+
+void FileUtils::purgeCachedMissingEntries(const std::string& fullPath)
+{
+    ++_missingEpoch;
+
+    // Directories are indexed by search path + file path + resolution directory, paths with "./" aren't indexed.
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    // FileUtilsWin32::renameFile passes paths with backslashes
+    std::string directory = fullPath.substr(0, fullPath.find_last_of("/\\") + 1);
+    std::replace(directory.begin(), directory.end(), '\\', '/');
+#else
+    std::string directory = fullPath.substr(0, fullPath.find_last_of('/') + 1);
+#endif
+    {
+        std::lock_guard<std::mutex> lock(_directoryIndexMutex);
+        _directoryIndex.erase(directory);
+    }
+
+    // The archive may have been replaced
+    std::lock_guard<std::mutex> lock(_zipFileCacheMutex);
+    _zipFileCache.erase(fullPath);
+}
+
+std::unordered_map<std::string, std::string> FileUtils::getFullPathCache() const
+{
+    std::unordered_map<std::string, std::string> ret;
+    unsigned int generation = getSearchPathSnapshot()->generation;
+    for (auto& shard : _fullPathCache)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& e : shard.entries)
+        {
+            if (!e.second.fullPath.empty() && e.second.generation == generation)
+            {
+                ret.emplace(e.first, e.second.fullPath);
+            }
+        }
+    }
+    return ret;
+}
+
+void FileUtils::updateSearchPathSnapshot()
+{
+    auto snapshot = std::make_shared<SearchPathSnapshot>();
+    snapshot->searchPaths = _searchPathArray;
+    snapshot->resolutionsOrder = _searchResolutionsOrderArray;
+    for (const auto& searchPath : _searchPathArray)
+    {
+        auto iter = _searchArchives.find(searchPath);
+        snapshot->archives.push_back(iter != _searchArchives.end() ? iter->second : nullptr);
+    }
+    snapshot->filenameLookupDict = _filenameLookupDict;
+    snapshot->generation = ++_searchPathGeneration;
+    std::atomic_store(&_searchPathSnapshot, std::shared_ptr<const SearchPathSnapshot>(snapshot));
+
+    // Entries of older generations are ignored already, it just releases them.
+    purgeCachedEntries();
+}
+
+std::shared_ptr<const FileUtils::SearchPathSnapshot> FileUtils::getSearchPathSnapshot() const
+{
+    return std::atomic_load(&_searchPathSnapshot);
+}
+
+std::shared_ptr<ZipFile> FileUtils::findSearchArchive(const std::string& fullPath, std::string* entryName) const
+{
+    auto snapshot = getSearchPathSnapshot();
+    for (size_t i = 0, size = snapshot->archives.size(); i < size; ++i)
+    {
+        const auto& archive = snapshot->archives[i];
+        const auto& searchPath = snapshot->searchPaths[i];
+        if (archive && fullPath.compare(0, searchPath.length(), searchPath) == 0)
+        {
+            *entryName = fullPath.substr(searchPath.length());
+            return archive;
+        }
+    }
+    return nullptr;
 }
 
 std::string FileUtils::getStringFromFile(const std::string& filename)
@@ -646,6 +783,11 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     if (fullPath.empty())
         return Status::NotExists;
 
+    std::string entryName;
+    auto archive = fs->findSearchArchive(fullPath, &entryName);
+    if (archive)
+        return archive->getFileData(entryName, buffer) ? Status::OK : Status::ReadFailed;
+
     FILE *fp = fopen(fs->getSuitableFOpen(fullPath).c_str(), "rb");
     if (!fp)
         return Status::OpenFailed;
@@ -674,6 +816,69 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     return Status::OK;
 }
 
+std::shared_ptr<const MappedFile> FileUtils::getMappedFile(const std::string& filename)
+{
+    if (filename.empty())
+        return nullptr;
+
+    std::string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+        return nullptr;
+
+    std::string entryName;
+    auto archive = findSearchArchive(fullPath, &entryName);
+    if (archive)
+        return archive->getMappedFile(entryName);
+
+    auto mapped = mapFile(fullPath);
+    if (mapped)
+        return mapped;
+
+    Data data;
+    if (getContents(filename, &data) != Status::OK)
+        return nullptr;
+
+    return std::make_shared<MappedFile>(std::move(data));
+}
+
+std::shared_ptr<const MappedFile> FileUtils::mapFile(const std::string& filename)
+{
+    if (filename.empty())
+        return nullptr;
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+    std::string fullPath = fullPathForFilename(filename);
+    // Files in bundles or packages are read by getContents of the platform
+    if (fullPath.empty() || fullPath[0] != '/')
+        return nullptr;
+
+    int fd = open(getSuitableFOpen(fullPath).c_str(), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat statBuf;
+    if (fstat(fd, &statBuf) == 0 && statBuf.st_size >= CC_FILEUTILS_MMAP_MIN_SIZE)
+    {
+        size_t size = statBuf.st_size;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps the file referenced after the descriptor is closed.
+        close(fd);
+        if (mapped != MAP_FAILED)
+        {
+            return std::make_shared<MappedFile>((const unsigned char*)mapped, (ssize_t)size, [mapped, size](){
+                munmap(mapped, size);
+            });
+        }
+    }
+    else
+    {
+        close(fd);
+    }
+#endif
+
+    return nullptr;
+}
+
 unsigned char* FileUtils::getFileData(const std::string& filename, const char* mode, ssize_t *size)
 {
     CCASSERT(!filename.empty() && size != nullptr && mode != nullptr, "Invalid parameters.");
@@ -690,57 +895,42 @@ unsigned char* FileUtils::getFileData(const std::string& filename, const char* m
 
 unsigned char* FileUtils::getFileDataFromZip(const std::string& zipFilePath, const std::string& filename, ssize_t *size)
 {
-    unsigned char * buffer = nullptr;
-    unzFile file = nullptr;
     *size = 0;
+    if (zipFilePath.empty())
+        return nullptr;
 
-    do
+    // Archives are opened and indexed once instead of being scanned for every file.
+    std::shared_ptr<ZipFile> zipFile;
     {
-        CC_BREAK_IF(zipFilePath.empty());
-
-        file = unzOpen(FileUtils::getInstance()->getSuitableFOpen(zipFilePath).c_str());
-        CC_BREAK_IF(!file);
-
-        // IDEA: Other platforms should use upstream minizip like mingw-w64
-        #ifdef MINIZIP_FROM_SYSTEM
-        int ret = unzLocateFile(file, filename.c_str(), NULL);
-        #else
-        int ret = unzLocateFile(file, filename.c_str(), 1);
-        #endif
-        CC_BREAK_IF(UNZ_OK != ret);
-
-        char filePathA[260];
-        unz_file_info fileInfo;
-        ret = unzGetCurrentFileInfo(file, &fileInfo, filePathA, sizeof(filePathA), nullptr, 0, nullptr, 0);
-        CC_BREAK_IF(UNZ_OK != ret);
-
-        ret = unzOpenCurrentFile(file);
-        CC_BREAK_IF(UNZ_OK != ret);
-
-        buffer = (unsigned char*)malloc(fileInfo.uncompressed_size);
-        int CC_UNUSED readedSize = unzReadCurrentFile(file, buffer, static_cast<unsigned>(fileInfo.uncompressed_size));
-        CCASSERT(readedSize == 0 || readedSize == (int)fileInfo.uncompressed_size, "the file size is wrong");
-
-        *size = fileInfo.uncompressed_size;
-        unzCloseCurrentFile(file);
-    } while (0);
+        std::lock_guard<std::mutex> lock(_zipFileCacheMutex);
+        auto iter = _zipFileCache.find(zipFilePath);
+        if (iter != _zipFileCache.end())
+            zipFile = iter->second;
+    }
 
-    if (file)
+    if (!zipFile)
     {
-        unzClose(file);
+        zipFile = std::make_shared<ZipFile>(zipFilePath);
+        std::lock_guard<std::mutex> lock(_zipFileCacheMutex);
+        zipFile = _zipFileCache.emplace(zipFilePath, zipFile).first->second;
     }
 
-    return buffer;
+    return zipFile->getFileData(filename, size);
 }
 
 std::string FileUtils::getNewFilename(const std::string &filename) const
+{
+    return getNewFilename(filename, *getSearchPathSnapshot());
+}
+
+std::string FileUtils::getNewFilename(const std::string &filename, const SearchPathSnapshot& snapshot) const
 {
     std::string newFileName;
 
     // in Lookup Filename dictionary ?
-    auto iter = _filenameLookupDict.find(filename);
+    auto iter = snapshot.filenameLookupDict.find(filename);
 
-    if (iter == _filenameLookupDict.end())
+    if (iter == snapshot.filenameLookupDict.end())
     {
         newFileName = filename;
     }
@@ -772,6 +962,58 @@ std::string FileUtils::getPathForFilename(const std::string& filename, const std
     return path;
 }
 
+bool FileUtils::isFileInDirectoryIndex(const std::string& filename, const std::string& resolutionDirectory, const std::string& searchPath) const
+{
+    std::string file = filename;
+    std::string directory = searchPath;
+    size_t pos = filename.find_last_of("/");
+    if (pos != std::string::npos)
+    {
+        directory += filename.substr(0, pos+1);
+        file = filename.substr(pos+1);
+    }
+    directory += resolutionDirectory;
+
+    // Relative segments are resolved by the file system, the listed directory may not be the same one.
+    if (file.empty() || directory.find("./") != std::string::npos)
+    {
+        return true;
+    }
+
+    std::shared_ptr<const std::unordered_set<std::string>> names;
+    {
+        std::lock_guard<std::mutex> lock(_directoryIndexMutex);
+        auto iter = _directoryIndex.find(directory);
+        if (iter != _directoryIndex.end())
+        {
+            if (!iter->second)
+            {
+                return true;
+            }
+            names = iter->second;
+        }
+    }
+
+    if (!names)
+    {
+        // Lists it without locking, another thread may list the same directory meanwhile which is harmless.
+        auto listed = std::make_shared<std::unordered_set<std::string>>();
+        if (getDirectoryFileNames(directory, listed.get()))
+        {
+            names = listed;
+        }
+
+        std::lock_guard<std::mutex> lock(_directoryIndexMutex);
+        _directoryIndex.emplace(directory, names);
+        if (!names)
+        {
+            return true;
+        }
+    }
+
+    return names->find(file) != names->end();
+}
+
 std::string FileUtils::fullPathForFilename(const std::string &filename) const
 {
     if (filename.empty())
@@ -784,33 +1026,73 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return normalizePath(filename);
     }
 
+    // Read before looking up, so results of the lookup are never newer than what they're tagged with.
+    auto snapshot = getSearchPathSnapshot();
+    unsigned int missingEpoch = _missingEpoch;
+    auto& shard = _fullPathCache[std::hash<std::string>()(filename) % FULL_PATH_CACHE_SHARD_COUNT];
+
     // Already Cached ?
-    auto cacheIter = _fullPathCache.find(filename);
-    if(cacheIter != _fullPathCache.end())
     {
-        return cacheIter->second;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto cacheIter = shard.entries.find(filename);
+        if (cacheIter != shard.entries.end() && cacheIter->second.generation == snapshot->generation)
+        {
+            const FullPathCacheEntry& entry = cacheIter->second;
+            if (!entry.fullPath.empty())
+            {
+                return entry.fullPath;
+            }
+            if (entry.missingEpoch == missingEpoch)
+            {
+                return "";
+            }
+        }
     }
 
     // Get the new file name.
-    const std::string newFilename( getNewFilename(filename) );
+    const std::string newFilename( getNewFilename(filename, *snapshot) );
 
     std::string fullpath;
 
-    for (const auto& searchIt : _searchPathArray)
+    for (size_t i = 0, size = snapshot->searchPaths.size(); i < size; ++i)
     {
-        for (const auto& resolutionIt : _searchResolutionsOrderArray)
+        const auto& searchIt = snapshot->searchPaths[i];
+        const auto& archive = snapshot->archives[i];
+        for (const auto& resolutionIt : snapshot->resolutionsOrder)
         {
-            fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            if (archive)
+            {
+                // file_path + resourceDirectory + file, looked up in the index of the archive
+                size_t pos = newFilename.find_last_of("/");
+                std::string entryName = (pos != std::string::npos) ? newFilename.substr(0, pos+1) : std::string();
+                entryName += resolutionIt;
+                entryName += (pos != std::string::npos) ? newFilename.substr(pos+1) : newFilename;
+                fullpath = archive->fileExists(entryName) ? searchIt + entryName : std::string();
+            }
+            else if (!isFileInDirectoryIndex(newFilename, resolutionIt, searchIt))
+            {
+                continue;
+            }
+            else
+            {
+                fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            }
 
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
-                _fullPathCache.insert(std::make_pair(filename, fullpath));
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.entries[filename] = { fullpath, snapshot->generation, missingEpoch };
                 return fullpath;
             }
         }
     }
 
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries[filename] = { std::string(), snapshot->generation, missingEpoch };
+    }
+
     if(isPopupNotify()){
         CCLOG("fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
     }
@@ -832,7 +1114,6 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
     }
 
     bool existDefault = false;
-    _fullPathCache.clear();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
     {
@@ -854,6 +1135,8 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
     {
         _searchResolutionsOrderArray.push_back("");
     }
+
+    updateSearchPathSnapshot();
 }
 
 void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool front)
@@ -867,6 +1150,8 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     } else {
         _searchResolutionsOrderArray.push_back(resOrder);
     }
+
+    updateSearchPathSnapshot();
 }
 
 const std::vector<std::string>& FileUtils::getSearchResolutionsOrder() const
@@ -898,7 +1183,6 @@ void FileUtils::setDefaultResourceRootPath(const std::string& path)
 {
     if (_defaultResRootPath != path)
     {
-        _fullPathCache.clear();
         _defaultResRootPath = path;
         if (!_defaultResRootPath.empty() && _defaultResRootPath[_defaultResRootPath.length()-1] != '/')
         {
@@ -915,7 +1199,6 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
     bool existDefaultRootPath = false;
     _originalSearchPaths = searchPaths;
 
-    _fullPathCache.clear();
     _searchPathArray.clear();
 
     for (const auto& path : _originalSearchPaths)
@@ -944,6 +1227,8 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
         //CCLOG("Default root path doesn't exist, adding it.");
         _searchPathArray.push_back(_defaultResRootPath);
     }
+
+    updateSearchPathSnapshot();
 }
 
 void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
@@ -964,12 +1249,61 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
         _originalSearchPaths.push_back(searchpath);
         _searchPathArray.push_back(path);
     }
+
+    updateSearchPathSnapshot();
+}
+
+bool FileUtils::addSearchArchive(const std::string& archivePath, const bool front)
+{
+    std::string fullPath = isAbsolutePath(archivePath) ? archivePath : fullPathForFilename(archivePath);
+    if (fullPath.empty())
+    {
+        CCLOG("addSearchArchive: %s isn't found", archivePath.c_str());
+        return false;
+    }
+
+    auto archive = std::make_shared<ZipFile>(fullPath);
+    if (archive->getFirstFilename().empty())
+    {
+        CCLOG("addSearchArchive: %s can't be opened", archivePath.c_str());
+        return false;
+    }
+
+    std::string path = fullPath + "/";
+    removeSearchArchive(archivePath);
+    _searchArchives[path] = archive;
+
+    // Added as an absolute path, so it's kept when search paths are updated by setDefaultResourceRootPath.
+    if (front) {
+        _originalSearchPaths.insert(_originalSearchPaths.begin(), path);
+        _searchPathArray.insert(_searchPathArray.begin(), path);
+    } else {
+        _originalSearchPaths.push_back(path);
+        _searchPathArray.push_back(path);
+    }
+
+    updateSearchPathSnapshot();
+    return true;
+}
+
+void FileUtils::removeSearchArchive(const std::string& archivePath)
+{
+    std::string fullPath = isAbsolutePath(archivePath) ? archivePath : fullPathForFilename(archivePath);
+    std::string path = fullPath + "/";
+    if (fullPath.empty() || _searchArchives.erase(path) == 0)
+    {
+        return;
+    }
+
+    _originalSearchPaths.erase(std::remove(_originalSearchPaths.begin(), _originalSearchPaths.end(), path), _originalSearchPaths.end());
+    _searchPathArray.erase(std::remove(_searchPathArray.begin(), _searchPathArray.end(), path), _searchPathArray.end());
+    updateSearchPathSnapshot();
 }
 
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
-    _fullPathCache.clear();
     _filenameLookupDict = filenameLookupDict;
+    updateSearchPathSnapshot();
 }
 
 void FileUtils::loadFilenameLookupDictionaryFromFile(const std::string &filename)
@@ -1009,10 +1343,57 @@ std::string FileUtils::getFullPathForDirectoryAndFilename(const std::string& dir
     return ret;
 }
 
+bool FileUtils::getDirectoryFileNames(const std::string& dirPath, std::unordered_set<std::string>* names) const
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    if (dirPath.empty() || dirPath[0] != '/')
+    {
+        return false;
+    }
+
+    tinydir_dir dir;
+    if (tinydir_open(&dir, dirPath.c_str()) == -1)
+    {
+        // The directory doesn't exist, nor do the files in it.
+        return !isDirectoryExistInternal(dirPath);
+    }
+
+    bool succeed = true;
+    while (dir.has_next)
+    {
+        tinydir_file file;
+        if (tinydir_readfile(&dir, &file) == -1)
+        {
+            succeed = false;
+            break;
+        }
+
+        // Directories are included, since opening them as files succeeds as well.
+        names->insert(file.name);
+
+        if (tinydir_next(&dir) == -1)
+        {
+            succeed = false;
+            break;
+        }
+    }
+    tinydir_close(&dir);
+    return succeed;
+#else
+    // Case insensitive file systems and bundles look files up in their own ways.
+    return false;
+#endif
+}
+
 bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
+        std::string entryName;
+        auto archive = findSearchArchive(filename, &entryName);
+        if (archive)
+            return archive->fileExists(entryName);
+
         return isFileExistInternal(normalizePath(filename));
     }
     else
@@ -1039,23 +1420,30 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
         return isDirectoryExistInternal(normalizePath(dirPath));
     }
 
+    auto snapshot = getSearchPathSnapshot();
+    auto& shard = _fullPathCache[std::hash<std::string>()(dirPath) % FULL_PATH_CACHE_SHARD_COUNT];
+
     // Already Cached ?
-    auto cacheIter = _fullPathCache.find(dirPath);
-    if( cacheIter != _fullPathCache.end() )
     {
-        return isDirectoryExistInternal(cacheIter->second);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto cacheIter = shard.entries.find(dirPath);
+        if (cacheIter != shard.entries.end() && cacheIter->second.generation == snapshot->generation && !cacheIter->second.fullPath.empty())
+        {
+            return isDirectoryExistInternal(cacheIter->second.fullPath);
+        }
     }
 
     std::string fullpath;
-    for (const auto& searchIt : _searchPathArray)
+    for (const auto& searchIt : snapshot->searchPaths)
     {
-        for (const auto& resolutionIt : _searchResolutionsOrderArray)
+        for (const auto& resolutionIt : snapshot->resolutionsOrder)
         {
             // searchPath + file_path + resourceDirectory
             fullpath = fullPathForFilename(searchIt + dirPath + resolutionIt);
             if (isDirectoryExistInternal(fullpath))
             {
-                _fullPathCache.insert(std::make_pair(dirPath, fullpath));
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.entries[dirPath] = { fullpath, snapshot->generation, _missingEpoch };
                 return true;
             }
         }
@@ -1318,6 +1706,8 @@ bool FileUtils::createDirectory(const std::string& path)
             closedir(dir);
         }
     }
+    // The new directory may have been cached as one which can't be listed
+    purgeCachedMissingEntries(path.back() == '/' ? path : path + "/");
     return true;
 }
 
@@ -1381,6 +1771,8 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
         CCLOGERROR("Fail to rename file %s to %s !Error code is %d", oldfullpath.c_str(), newfullpath.c_str(), errorCode);
         return false;
     }
+    purgeCachedMissingEntries(oldfullpath);
+    purgeCachedMissingEntries(newfullpath);
     return true;
 }
 
@@ -26,9 +26,14 @@ THE SOFTWARE.
 #ifndef __CC_FILEUTILS_H__
 #define __CC_FILEUTILS_H__
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
 
 #include "base/ccMacros.h"
@@ -115,6 +120,36 @@ public:
     }
 };
 
+class ZipFile;
+
+/**
+ * Read-only contents of a file, they're memory-mapped when possible and read into memory otherwise.
+ * It's shared by std::shared_ptr, and the contents stay valid until the last reference is released.
+ */
+class CC_DLL MappedFile
+{
+public:
+    /** Wraps mapped contents, 'release' unmaps them when the instance is destroyed. */
+    MappedFile(const unsigned char* bytes, ssize_t size, const std::function<void()>& release);
+    /** Wraps contents read into memory. */
+    explicit MappedFile(Data&& data);
+    ~MappedFile();
+
+    const unsigned char* getBytes() const { return _bytes; }
+    ssize_t getSize() const { return _size; }
+    bool isNull() const { return _bytes == nullptr || _size == 0; }
+    /** Whether the contents are referenced in place instead of being read into a Data. */
+    bool isMapped() const { return _release != nullptr; }
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(MappedFile);
+
+    const unsigned char* _bytes;
+    ssize_t _size;
+    std::function<void()> _release;
+    Data _data;
+};
+
 /** Helper class to handle file operations. */
 class CC_DLL FileUtils
 {
@@ -156,6 +191,19 @@ public:
      */
     virtual void purgeCachedEntries();
 
+    /**
+     *  Purges the cached results of files which were not found.
+     *  FileUtils does it when it writes or renames files, call it after creating files in other ways.
+     */
+    void purgeCachedMissingEntries();
+
+    /**
+     *  Like purgeCachedMissingEntries, but only forgets the listing of the directory containing the file
+     *  and the archive opened at its path, so the other directories don't have to be listed again.
+     *  @param fullPath The full path of the file which was created, written or renamed.
+     */
+    void purgeCachedMissingEntries(const std::string& fullPath);
+
     /**
      *  Gets string from a file.
      */
@@ -246,6 +294,26 @@ public:
     }
     virtual Status getContents(const std::string& filename, ResizableBuffer* buffer);
 
+    /**
+     *  Gets the read-only contents of a file without copying them when possible.
+     *  Large files on the file system (and uncompressed assets in apk on Android) are memory-mapped,
+     *  so they're paged in on demand and don't count twice in memory. Others are read by getContents.
+     *
+     *  @note The contents aren't null-terminated.
+     *  @param filename The resource file name which contains the path.
+     *  @return The contents, or nullptr if the file can't be read.
+     */
+    virtual std::shared_ptr<const MappedFile> getMappedFile(const std::string& filename);
+
+    /**
+     *  Memory-maps a file, unlike getMappedFile it never falls back to reading the file into memory.
+     *
+     *  @param filename The resource file name which contains the path.
+     *  @return The mapped contents, or nullptr if the file can't be mapped, e.g. on Win32,
+     *          for small files, compressed assets in apk or files in mounted archives.
+     */
+    virtual std::shared_ptr<const MappedFile> mapFile(const std::string& filename);
+
     /**
      *  Gets resource file data
      *
@@ -308,6 +376,8 @@ public:
 
      If the new file can't be found on the file system, it will return the parameter filename directly.
 
+     Both found and missing files are cached, and it's safe to call this method from any thread.
+
      This method was added to simplify multiplatform support. Whether you are using cocos2d-js or any cross-compilation toolchain like StellaSDK or Apportable,
      you might need to load different resources for a given file in the different platforms.
 
@@ -435,6 +505,22 @@ public:
       */
     void addSearchPath(const std::string & path, const bool front=false);
 
+    /**
+     * Mounts a zip archive as a search path, files in it are found by fullPathForFilename like files in a directory.
+     * The full path of such a file is the full path of the archive followed by '/' and its name in the archive,
+     * it can be read by getContents, getMappedFile and the methods based on them.
+     *
+     * @param archivePath The path of the archive, it's opened and indexed only once when it's mounted.
+     * @param front If true, the archive is searched before the other search paths.
+     * @return true if the archive is mounted.
+     */
+    bool addSearchArchive(const std::string& archivePath, const bool front=false);
+
+    /**
+     * Unmounts an archive mounted by addSearchArchive and removes it from the search paths.
+     */
+    void removeSearchArchive(const std::string& archivePath);
+
     /**
      *  Gets the array of search paths.
      *
@@ -651,8 +737,8 @@ public:
      */
     virtual long getFileSize(const std::string &filepath);
 
-    /** Returns the full path cache. */
-    const std::unordered_map<std::string, std::string>& getFullPathCache() const { return _fullPathCache; }
+    /** Returns a copy of the full path cache, files which were not found are not included. */
+    std::unordered_map<std::string, std::string> getFullPathCache() const;
 
     std::string normalizePath(const std::string& path) const;
     std::string getFileDir(const std::string& path) const;
@@ -718,6 +804,31 @@ protected:
      */
     virtual std::string getFullPathForDirectoryAndFilename(const std::string& directory, const std::string& filename) const;
 
+    /**
+     *  Lists the names of the files in a directory, it's used to index search paths.
+     *  Missing files are skipped without being looked up one by one when their directory is indexed.
+     *
+     *  @note Platforms with case insensitive file systems or bundle lookups shouldn't index directories.
+     *  @param dirPath The directory with absolute path.
+     *  @param names Output of the file names, subdirectories are not included.
+     *  @return false if the directory can't be indexed, then files in it are looked up one by one.
+     */
+    virtual bool getDirectoryFileNames(const std::string& dirPath, std::unordered_set<std::string>* names) const;
+
+    /**
+     *  Finds the mounted archive which contains a file.
+     *  @param fullPath The full path of the file.
+     *  @param[out] entryName The name of the file in the archive.
+     *  @return The archive, or nullptr if the file isn't in any mounted archive.
+     */
+    std::shared_ptr<ZipFile> findSearchArchive(const std::string& fullPath, std::string* entryName) const;
+
+    /**
+     *  Updates the search paths used by fullPathForFilename and invalidates the full path cache.
+     *  Call it after changing _searchPathArray, _searchResolutionsOrderArray or _filenameLookupDict.
+     */
+    void updateSearchPathSnapshot();
+
     /** Dictionary used to lookup filenames based on a key.
      *  It is used internally by the following methods:
      *
@@ -753,11 +864,58 @@ protected:
      */
     std::string _defaultResRootPath;
 
+    // Search paths and resolutions read by fullPathForFilename, they're replaced as a whole when changed,
+    // so other threads keep using the old ones without locking.
+    struct SearchPathSnapshot
+    {
+        std::vector<std::string> searchPaths;
+        std::vector<std::string> resolutionsOrder;
+        std::vector<std::shared_ptr<ZipFile>> archives;    // Archive of each search path, nullptr for directories
+        ValueMap filenameLookupDict;
+        unsigned int generation;
+    };
+
+    struct FullPathCacheEntry
+    {
+        std::string fullPath;       // Empty if the file wasn't found
+        unsigned int generation;    // Generation of the search paths
+        unsigned int missingEpoch;  // Files created since then may make a missing file found
+    };
+
+    struct FullPathCacheShard
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, FullPathCacheEntry> entries;
+    };
+
+    std::shared_ptr<const SearchPathSnapshot> getSearchPathSnapshot() const;
+    // getNewFilename with the lookup dictionary of a snapshot, so it matches the search paths looked up with it
+    virtual std::string getNewFilename(const std::string &filename, const SearchPathSnapshot& snapshot) const;
+    bool isFileInDirectoryIndex(const std::string& filename, const std::string& resolutionDirectory, const std::string& searchPath) const;
+
+    static const int FULL_PATH_CACHE_SHARD_COUNT = 16;
+
     /**
-     *  The full path cache. When a file is found, it will be added into this cache.
-     *  This variable is used for improving the performance of file search.
+     *  The full path cache. Found and missing files are added into this cache.
+     *  It's split into shards locked separately, so loader threads seldom wait for each other.
      */
-    mutable std::unordered_map<std::string, std::string> _fullPathCache;
+    mutable FullPathCacheShard _fullPathCache[FULL_PATH_CACHE_SHARD_COUNT];
+
+    // Always accessed by std::atomic_load / std::atomic_store
+    std::shared_ptr<const SearchPathSnapshot> _searchPathSnapshot;
+    std::atomic<unsigned int> _searchPathGeneration;
+    std::atomic<unsigned int> _missingEpoch;
+
+    // Search path -> archive mounted by addSearchArchive
+    std::unordered_map<std::string, std::shared_ptr<ZipFile>> _searchArchives;
+
+    // Archives opened by getFileDataFromZip, they're kept open until files are changed.
+    std::mutex _zipFileCacheMutex;
+    std::unordered_map<std::string, std::shared_ptr<ZipFile>> _zipFileCache;
+
+    // Directory path -> names of its files, nullptr if the directory can't be indexed
+    mutable std::mutex _directoryIndexMutex;
+    mutable std::unordered_map<std::string, std::shared_ptr<const std::unordered_set<std::string>>> _directoryIndex;
 
     /**
      * Writable path.
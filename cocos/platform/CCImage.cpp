@@ -95,11 +95,20 @@ extern "C"
 #include "platform/CCFileUtils.h"
 #include "base/CCConfiguration.h"
 #include "base/ZipUtils.h"
+#include "base/ccPixelKernels.h"
+#include "base/CCThreadPool.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "platform/android/CCFileUtils-android.h"
 #endif
 
 #include <map>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #define CC_GL_ATC_RGB_AMD                                          0x8C92
 #define CC_GL_ATC_RGBA_EXPLICIT_ALPHA_AMD                          0x8C93
@@ -501,6 +510,109 @@ namespace
         }
     }
 #endif //CC_USE_PNG
+
+    // same result as CC_RGB_PREMULTIPLY_ALPHA
+    void premultiplyRGBA8888(unsigned char *data, ssize_t pixels)
+    {
+        PixelKernels::premultiplyRGBA8888(data, data, pixels);
+    }
+
+    // expands a row of gray or RGB pixels to RGBA8888
+    void expandRowToRGBA8888(const unsigned char *src, unsigned char *dst, int width, int components)
+    {
+        if (components == 1)
+        {
+            for (int i = 0; i < width; i++, dst += 4)
+            {
+                dst[0] = dst[1] = dst[2] = src[i];
+                dst[3] = 255;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < width; i++, dst += 4, src += 3)
+            {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = 255;
+            }
+        }
+    }
+
+    #define BLOCK_DECODE_MAX_THREADS 4
+    // images with less block rows than this per thread are decoded on the calling thread
+    #define BLOCK_DECODE_MIN_BLOCK_ROWS 32
+
+    // Software fallback for ETC and ASTC textures the GPU can't sample. Block rows are split in bands,
+    // decodeBand(in, out, width, rows) decodes one band. Bands are taken by the calling thread
+    // and by tasks of the default thread pool, so the call never waits on a task that has not
+    // started yet.
+    template <typename DecodeBand>
+    bool decodeBlocks(const unsigned char *src, ssize_t srcLen, unsigned char *dst, int width, int height,
+                      int blockWidth, int blockHeight, int blockSize, int pixelSize, const DecodeBand &decodeBand)
+    {
+        const int blocksX = (width + blockWidth - 1) / blockWidth;
+        const int blocksY = (height + blockHeight - 1) / blockHeight;
+        const ssize_t blockRowBytes = (ssize_t)blocksX * blockSize;
+        if (srcLen < blockRowBytes * blocksY)
+        {
+            return false;
+        }
+
+        int threads = std::min((int)std::thread::hardware_concurrency(), BLOCK_DECODE_MAX_THREADS);
+        threads = std::max(1, std::min(threads, blocksY / BLOCK_DECODE_MIN_BLOCK_ROWS));
+        const int bandBlocks = (blocksY + threads - 1) / threads;
+        const int bands = (blocksY + bandBlocks - 1) / bandBlocks;
+        const size_t stride = (size_t)width * pixelSize;
+
+        // tasks may start after this call returned, they only touch the shared state then
+        struct Bands
+        {
+            std::atomic<int> next{0};
+            std::atomic<bool> failed{false};
+            int done = 0;
+            std::mutex mutex;
+            std::condition_variable cv;
+        };
+        auto state = std::make_shared<Bands>();
+
+        std::function<void()> decodeBands = [=, &decodeBand]() {
+            int band;
+            int decoded = 0;
+            while ((band = state->next++) < bands)
+            {
+                const int by = band * bandBlocks;
+                const int rows = std::min(height - by * blockHeight, bandBlocks * blockHeight);
+                if (decodeBand(src + by * blockRowBytes, dst + (size_t)by * blockHeight * stride, width, rows) != 0)
+                {
+                    state->failed = true;
+                }
+                decoded++;
+            }
+            if (decoded > 0)
+            {
+                std::lock_guard<std::mutex> lk(state->mutex);
+                state->done += decoded;
+                state->cv.notify_all();
+            }
+        };
+
+        for (int i = 1; i < bands; i++)
+        {
+            ThreadPool::getDefaultThreadPool()->pushTask([state, bands, decodeBands](int) {
+                if (state->next < bands)
+                {
+                    decodeBands();
+                }
+            });
+        }
+        decodeBands();
+
+        std::unique_lock<std::mutex> lk(state->mutex);
+        state->cv.wait(lk, [&]() { return state->done == bands; });
+        return !state->failed;
+    }
 }
 
 Image::PixelFormat getDevicePixelFormat(Image::PixelFormat format)
@@ -554,11 +666,11 @@ bool Image::initWithImageFile(const std::string& path)
 //    _filePath = FileUtils::getInstance()->fullPathForFilename(path);
     _filePath = path;
 
-    Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
+    auto file = FileUtils::getInstance()->getMappedFile(_filePath);
 
-    if (!data.isNull())
+    if (file && !file->isNull())
     {
-        ret = initWithImageData(data.getBytes(), data.getSize());
+        ret = initWithImageData(file->getBytes(), file->getSize());
     }
 
     return ret;
@@ -907,6 +1019,8 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
     /* libjpeg data structure for storing one row, that is, scanline of an image */
     JSAMPROW row_pointer[1] = {0};
     unsigned long location = 0;
+    // raw buffer kept volatile, longjmp skips destructors and may drop registers
+    unsigned char * volatile scanline = nullptr;
 
     bool ret = false;
     do
@@ -921,6 +1035,7 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
              * We need to clean up the JPEG object, close the input file, and return.
              */
             jpeg_destroy_decompress(&cinfo);
+            CC_SAFE_FREE(scanline);
             break;
         }
 
@@ -948,6 +1063,14 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
             cinfo.out_color_space = JCS_RGB;
             _renderFormat = Image::PixelFormat::RGB888;
         }
+#ifdef JCS_EXTENSIONS
+        // libjpeg-turbo writes RGBA itself
+        if (_expandToRGBA8888)
+        {
+            cinfo.out_color_space = JCS_EXT_RGBA;
+            _renderFormat = Image::PixelFormat::RGBA8888;
+        }
+#endif
 
         /* Start decompression jpeg here */
         jpeg_start_decompress( &cinfo );
@@ -958,17 +1081,42 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
         _height = cinfo.output_height;
         _hasPremultipliedAlpha = false;
 
-        _dataLen = cinfo.output_width*cinfo.output_height*cinfo.output_components;
+        // scan lines are expanded one by one when libjpeg can't write RGBA
+        const bool expandRows = _expandToRGBA8888 && cinfo.output_components != 4;
+        const int outputComponents = expandRows ? 4 : cinfo.output_components;
+        _dataLen = cinfo.output_width*cinfo.output_height*outputComponents;
         _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
-        CC_BREAK_IF(! _data);
+
+        if (expandRows)
+        {
+            scanline = static_cast<unsigned char*>(malloc(cinfo.output_width*cinfo.output_components));
+            _renderFormat = Image::PixelFormat::RGBA8888;
+        }
+
+        if (! _data || (expandRows && ! scanline))
+        {
+            // out of memory, release the decompressor the same way the error path does
+            jpeg_destroy_decompress(&cinfo);
+            CC_SAFE_FREE(scanline);
+            break;
+        }
 
         /* now actually read the jpeg into the raw buffer */
         /* read one scan line at a time */
         while (cinfo.output_scanline < cinfo.output_height)
         {
-            row_pointer[0] = _data + location;
-            location += cinfo.output_width*cinfo.output_components;
-            jpeg_read_scanlines(&cinfo, row_pointer, 1);
+            if (expandRows)
+            {
+                row_pointer[0] = scanline;
+                jpeg_read_scanlines(&cinfo, row_pointer, 1);
+                expandRowToRGBA8888(scanline, _data + location, cinfo.output_width, cinfo.output_components);
+            }
+            else
+            {
+                row_pointer[0] = _data + location;
+                jpeg_read_scanlines(&cinfo, row_pointer, 1);
+            }
+            location += cinfo.output_width*outputComponents;
         }
 
         /* When read image file with broken data, jpeg_finish_decompress() may cause error.
@@ -978,6 +1126,7 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
          */
         //jpeg_finish_decompress( &cinfo );
         jpeg_destroy_decompress( &cinfo );
+        CC_SAFE_FREE(scanline);
         /* wrap up decompression, destroy objects, free pointers and close open files */
         ret = true;
     } while (0);
@@ -1054,10 +1203,12 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
             bit_depth = 8;
             png_set_expand_gray_1_2_4_to_8(png_ptr);
         }
+        bool hasAlpha = (color_type & PNG_COLOR_MASK_ALPHA) != 0;
         // expand any tRNS chunk data into a full alpha channel
         if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
         {
             png_set_tRNS_to_alpha(png_ptr);
+            hasAlpha = true;
         }
         // reduce images with 16-bit samples to 8 bits
         if (bit_depth == 16)
@@ -1070,6 +1221,18 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
         {
             png_set_packing(png_ptr);
         }
+        if (_expandToRGBA8888)
+        {
+            if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
+            {
+                png_set_gray_to_rgb(png_ptr);
+            }
+            if (!hasAlpha)
+            {
+                png_set_add_alpha(png_ptr, 0xff, PNG_FILLER_AFTER);
+            }
+        }
+        const int passes = png_set_interlace_handling(png_ptr);
         // update info
         png_read_update_info(png_ptr, info_ptr);
         bit_depth = png_get_bit_depth(png_ptr, info_ptr);
@@ -1094,44 +1257,47 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
         }
 
         // read png data
-        png_size_t rowbytes;
-        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
-
-        rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+        png_size_t rowbytes = png_get_rowbytes(png_ptr, info_ptr);
 
         _dataLen = rowbytes * _height;
         _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
-        if (!_data)
+        CC_BREAK_IF(!_data);
+
+        // premultiplied alpha for RGBA8888, added alpha is opaque and left alone
+        const bool premultiply = PNG_PREMULTIPLIED_ALPHA_ENABLED && hasAlpha && color_type == PNG_COLOR_TYPE_RGB_ALPHA;
+        if (passes == 1)
         {
-            if (row_pointers != nullptr)
+            // rows are premultiplied while still in cache
+            for (int i = 0; i < _height; ++i)
             {
-                free(row_pointers);
+                png_bytep row = _data + i * rowbytes;
+                png_read_row(png_ptr, row, nullptr);
+                if (premultiply)
+                {
+                    premultiplyRGBA8888(row, _width);
+                }
             }
-            break;
         }
-
-        for (unsigned short i = 0; i < _height; ++i)
+        else
         {
-            row_pointers[i] = _data + i*rowbytes;
+            // interlaced images are complete after the last pass only
+            png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
+            CC_BREAK_IF(!row_pointers);
+            for (int i = 0; i < _height; ++i)
+            {
+                row_pointers[i] = _data + i*rowbytes;
+            }
+            png_read_image(png_ptr, row_pointers);
+            free(row_pointers);
+            if (premultiply)
+            {
+                premultiplyRGBA8888(_data, _width * _height);
+            }
         }
-        png_read_image(png_ptr, row_pointers);
 
         png_read_end(png_ptr, nullptr);
 
-        // premultiplied alpha for RGBA8888
-        if (PNG_PREMULTIPLIED_ALPHA_ENABLED && color_type == PNG_COLOR_TYPE_RGB_ALPHA)
-        {
-            premultipliedAlpha();
-        }
-        else
-        {
-            _hasPremultipliedAlpha = false;
-        }
-
-        if (row_pointers != nullptr)
-        {
-            free(row_pointers);
-        }
+        _hasPremultipliedAlpha = premultiply;
 
         ret = true;
     } while (0);
@@ -1665,11 +1831,23 @@ bool Image::initWithETCData(const unsigned char * data, ssize_t dataLen)
         return false;
     }
 
-    assert(Configuration::getInstance()->supportsETC());
     if (Configuration::getInstance()->supportsETC() == false)
     {
-        CCLOG("initWithETCData: ERROR: Unsupported ETC Compress texture on this device");
-        return false;
+        // decode to RGB888 on the CPU
+        _isCompressed = false;
+        _renderFormat = Image::PixelFormat::RGB888;
+        _dataLen = _width * _height * 3;
+        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        bool ok = decodeBlocks(static_cast<const unsigned char*>(data) + ETC_PKM_HEADER_SIZE, dataLen - ETC_PKM_HEADER_SIZE,
+                               _data, _width, _height, 4, 4, ETC1_ENCODED_BLOCK_SIZE, 3,
+                               [](const unsigned char* in, unsigned char* out, int width, int rows) {
+                                   return etc1_decode_image(in, out, width, rows, 3, width * 3);
+                               });
+        if (!ok)
+        {
+            CCLOG("initWithETCData: ERROR: Invalid ETC data");
+        }
+        return ok;
     }
 
     //old opengl version has no define for GL_ETC1_RGB8_OES, add macro to make compiler happy.
@@ -1703,14 +1881,29 @@ bool Image::initWithETC2Data(const unsigned char * data, ssize_t dataLen)
         return false;
     }
     
-    assert(Configuration::getInstance()->supportsETC2());
+    etc2_uint32 format = etc2_pkm_get_format(header);
     if (Configuration::getInstance()->supportsETC2() == false)
     {
-        CCLOG("initWithETC2Data: ERROR: Unsupported ETC2 Compress texture on this device");
-        return false;
+        // decode on the CPU, opaque textures stay RGB888 unless RGBA8888 output is requested
+        const bool hasAlpha = format == ETC2_RGBA_NO_MIPMAPS;
+        const int pixelSize = (hasAlpha || _expandToRGBA8888) ? 4 : 3;
+        _isCompressed = false;
+        _renderFormat = pixelSize == 4 ? Image::PixelFormat::RGBA8888 : Image::PixelFormat::RGB888;
+        _dataLen = _width * _height * pixelSize;
+        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        bool ok = decodeBlocks(static_cast<const unsigned char*>(data) + ETC2_PKM_HEADER_SIZE, dataLen - ETC2_PKM_HEADER_SIZE,
+                               _data, _width, _height, 4, 4,
+                               hasAlpha ? ETC2_RGBA_ENCODED_BLOCK_SIZE : ETC2_RGB_ENCODED_BLOCK_SIZE, pixelSize,
+                               [format, pixelSize](const unsigned char* in, unsigned char* out, int width, int rows) {
+                                   return etc2_decode_image(in, out, width, rows, format, pixelSize, width * pixelSize);
+                               });
+        if (!ok)
+        {
+            CCLOG("initWithETC2Data: ERROR: Invalid ETC2 data");
+        }
+        return ok;
     }
-    
-    etc2_uint32 format = etc2_pkm_get_format(header);
+
     if (format == ETC2_RGB_NO_MIPMAPS)
     {
         _renderFormat = Image::PixelFormat::ETC2_RGB;
@@ -1822,11 +2015,31 @@ bool Image::initWithASTCData(const unsigned char *data, ssize_t dataLen)
         return false;
     }
 
-    assert(Configuration::getInstance()->supportsASTC());
     if (Configuration::getInstance()->supportsASTC() == false)
     {
-        CCLOG("initWithASTCData: ERROR: Unsupported ASTC Compress texture on this device");
-        return false;
+        // decode 2D LDR blocks to RGBA8888 on the CPU
+        const int blockWidth = astcGetBlockWidth(header);
+        const int blockHeight = astcGetBlockHeight(header);
+        _isCompressed = false;
+        _renderFormat = Image::PixelFormat::RGBA8888;
+        _dataLen = _width * _height * 4;
+        _data = static_cast<unsigned char *>(malloc(_dataLen * sizeof(unsigned char)));
+        if (_data == nullptr)
+        {
+            CCLOG("initWithASTCData: ERROR : Image _data is null!");
+            return false;
+        }
+        bool ok = header[ASTC_HEADER_MAGIC + 2] == 1 &&
+                  decodeBlocks(static_cast<const unsigned char *>(data) + ASTC_HEADER_SIZE, dataLen - ASTC_HEADER_SIZE,
+                               _data, _width, _height, blockWidth, blockHeight, ASTC_ENCODED_BLOCK_SIZE, 4,
+                               [blockWidth, blockHeight](const unsigned char *in, unsigned char *out, int width, int rows) {
+                                   return astcDecodeImage(in, out, width, rows, blockWidth, blockHeight, width * 4);
+                               });
+        if (!ok)
+        {
+            CCLOG("initWithASTCData: ERROR: Invalid or 3D ASTC data");
+        }
+        return ok;
     }
     _renderFormat = getASTCFormat(header);
 
@@ -1951,8 +2164,10 @@ bool Image::initWithWebpData(const unsigned char * data, ssize_t dataLen)
         if (WebPGetFeatures(static_cast<const uint8_t*>(data), dataLen, &config.input) != VP8_STATUS_OK) break;
         if (config.input.width == 0 || config.input.height == 0) break;
         
-        config.output.colorspace = config.input.has_alpha?MODE_rgbA:MODE_RGB;
-        _renderFormat = config.input.has_alpha?Image::PixelFormat::RGBA8888:Image::PixelFormat::RGB888;
+        // opaque images are written with alpha too when RGBA8888 is wanted
+        const bool hasAlphaChannel = config.input.has_alpha || _expandToRGBA8888;
+        config.output.colorspace = config.input.has_alpha?MODE_rgbA:(hasAlphaChannel?MODE_RGBA:MODE_RGB);
+        _renderFormat = hasAlphaChannel?Image::PixelFormat::RGBA8888:Image::PixelFormat::RGB888;
         _width    = config.input.width;
         _height   = config.input.height;
         _isCompressed = false;
@@ -1960,11 +2175,11 @@ bool Image::initWithWebpData(const unsigned char * data, ssize_t dataLen)
         //we ask webp to give data with premultiplied alpha
         _hasPremultipliedAlpha = (config.input.has_alpha != 0);
         
-        _dataLen = _width * _height * (config.input.has_alpha?4:3);
+        _dataLen = _width * _height * (hasAlphaChannel?4:3);
         _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
         
         config.output.u.RGBA.rgba = static_cast<uint8_t*>(_data);
-        config.output.u.RGBA.stride = _width * (config.input.has_alpha?4:3);
+        config.output.u.RGBA.stride = _width * (hasAlphaChannel?4:3);
         config.output.u.RGBA.size = _dataLen;
         config.output.is_external_memory = 1;
         
@@ -2284,12 +2499,7 @@ void Image::premultipliedAlpha()
 {
     if (PNG_PREMULTIPLIED_ALPHA_ENABLED && _renderFormat == Image::PixelFormat::RGBA8888)
     {
-        unsigned int* fourBytes = (unsigned int*)_data;
-        for(int i = 0; i < _width * _height; i++)
-        {
-            unsigned char* p = _data + i * 4;
-            fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
-        }
+        premultiplyRGBA8888(_data, _width * _height);
 
         _hasPremultipliedAlpha = true;
     }
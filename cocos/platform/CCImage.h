@@ -236,6 +236,12 @@ public:
     */
     bool initWithImageData(const unsigned char * data, ssize_t dataLen);
 
+    /**
+     @brief Decodes PNG, JPEG and WebP images straight into RGBA8888 instead of their own layout,
+     so callers needing RGBA pixels don't convert them again. Must be set before loading.
+     */
+    void setExpandToRGBA8888(bool enabled) { _expandToRGBA8888 = enabled; }
+
     // @warning kFmtRawData only support RGBA8888
     bool initWithRawData(const unsigned char * data, ssize_t dataLen, int width, int height, int bitsPerComponent, bool preMulti = false);
 
@@ -307,6 +313,7 @@ protected:
     bool _hasPremultipliedAlpha;
     std::string _filePath;
     bool _isCompressed = false;
+    bool _expandToRGBA8888 = false;
 
 protected:
     // noncopyable
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "base/ZipUtils.h"
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #define  LOG_TAG    "CCFileUtils-android.cpp"
 #define  LOGD(...)  __android_log_print(ANDROID_LOG_DEBUG,LOG_TAG,__VA_ARGS__)
@@ -100,9 +101,9 @@ bool FileUtilsAndroid::init()
     return FileUtils::init();
 }
 
-std::string FileUtilsAndroid::getNewFilename(const std::string &filename) const
+std::string FileUtilsAndroid::getNewFilename(const std::string &filename, const SearchPathSnapshot& snapshot) const
 {
-    std::string newFileName = FileUtils::getNewFilename(filename);
+    std::string newFileName = FileUtils::getNewFilename(filename, snapshot);
     // ../xxx do not fix this path
     auto pos = newFileName.find("../");
     if (pos == std::string::npos || pos == 0)
@@ -243,6 +244,45 @@ bool FileUtilsAndroid::isDirectoryExistInternal(const std::string& dirPath_) con
     return false;
 }
 
+bool FileUtilsAndroid::getDirectoryFileNames(const std::string& dirPath, std::unordered_set<std::string>* names) const
+{
+    if (dirPath.empty() || dirPath[0] == '/')
+    {
+        return FileUtils::getDirectoryFileNames(dirPath, names);
+    }
+
+    // Files in obb files aren't listed by the asset manager.
+    if (obbfile || !FileUtilsAndroid::assetmanager)
+    {
+        return false;
+    }
+
+    std::string assetDir = dirPath;
+    if (assetDir.find(ASSETS_FOLDER_NAME) == 0)
+    {
+        assetDir.erase(0, strlen(ASSETS_FOLDER_NAME));
+    }
+    if (!assetDir.empty() && assetDir[assetDir.length() - 1] == '/')
+    {
+        assetDir.erase(assetDir.length() - 1);
+    }
+
+    // Only files are listed, which matches isFileExistInternal as opening directories in apk fails.
+    AAssetDir* aa = AAssetManager_openDir(FileUtilsAndroid::assetmanager, assetDir.c_str());
+    if (!aa)
+    {
+        return false;
+    }
+
+    const char* name = nullptr;
+    while ((name = AAssetDir_getNextFileName(aa)) != nullptr)
+    {
+        names->insert(name);
+    }
+    AAssetDir_close(aa);
+    return true;
+}
+
 bool FileUtilsAndroid::isAbsolutePath(const std::string& strPath) const
 {
     // On Android, there are two situations for full path.
@@ -265,10 +305,11 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
     if (fullPath.empty())
         return FileUtils::Status::NotExists;
 
-    if (fullPath[0] == '/')
+    // Files in mounted archives are read by FileUtils as well
+    std::string relativePath;
+    if (fullPath[0] == '/' || findSearchArchive(fullPath, &relativePath))
         return FileUtils::getContents(fullPath, buffer);
 
-    std::string relativePath;
     size_t position = fullPath.find(ASSETS_FOLDER_NAME);
     if (0 == position) {
         // "@assets/" is at the beginning of the path and we don't want it
@@ -309,6 +350,51 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
     return FileUtils::Status::OK;
 }
 
+std::shared_ptr<const MappedFile> FileUtilsAndroid::mapFile(const std::string& filename)
+{
+    if (filename.empty())
+        return nullptr;
+
+    std::string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+        return nullptr;
+
+    // Files in obb are compressed, and nothing can be mapped if the asset manager isn't ready.
+    std::string relativePath;
+    if (fullPath[0] == '/' || obbfile || nullptr == assetmanager || findSearchArchive(fullPath, &relativePath))
+        return FileUtils::mapFile(fullPath);
+
+    if (0 == fullPath.find(ASSETS_FOLDER_NAME)) {
+        relativePath = fullPath.substr(strlen(ASSETS_FOLDER_NAME));
+    } else {
+        relativePath = fullPath;
+    }
+
+    AAsset* asset = AAssetManager_open(assetmanager, relativePath.c_str(), AASSET_MODE_BUFFER);
+    if (nullptr == asset)
+        return nullptr;
+
+    // Only uncompressed assets are mapped from apk, they're the ones that have a file descriptor.
+    // Compressed ones would be inflated into memory by AAsset_getBuffer.
+    auto size = AAsset_getLength(asset);
+    off_t start = 0, length = 0;
+    int fd = size >= CC_FILEUTILS_MMAP_MIN_SIZE ? AAsset_openFileDescriptor(asset, &start, &length) : -1;
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    const void* buffer = fd >= 0 ? AAsset_getBuffer(asset) : nullptr;
+    if (buffer)
+    {
+        return std::make_shared<MappedFile>((const unsigned char*)buffer, (ssize_t)size, [asset](){
+            AAsset_close(asset);
+        });
+    }
+    AAsset_close(asset);
+
+    return nullptr;
+}
+
 std::string FileUtilsAndroid::getWritablePath() const
 {
     // Fix for Nexus 10 (Android 4.2 multi-user environment)
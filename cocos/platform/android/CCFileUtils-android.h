@@ -65,16 +65,21 @@ public:
     /* override functions */
     bool init() override;
 
-    virtual std::string getNewFilename(const std::string &filename) const override;
+    using FileUtils::getNewFilename;
 
     virtual FileUtils::Status getContents(const std::string& filename, ResizableBuffer* buffer) override;
+    virtual std::shared_ptr<const MappedFile> mapFile(const std::string& filename) override;
 
     virtual std::string getWritablePath() const override;
     virtual bool isAbsolutePath(const std::string& strPath) const override;
 
+protected:
+    virtual std::string getNewFilename(const std::string &filename, const SearchPathSnapshot& snapshot) const override;
+
 private:
     virtual bool isFileExistInternal(const std::string& strFilePath) const override;
     virtual bool isDirectoryExistInternal(const std::string& dirPath) const override;
+    virtual bool getDirectoryFileNames(const std::string& dirPath, std::unordered_set<std::string>* names) const override;
 
     static AAssetManager* assetmanager;
     static ZipFile* obbfile;
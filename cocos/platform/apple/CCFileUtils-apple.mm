@@ -391,7 +391,12 @@ bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& ful
 
     NSString *file = [NSString stringWithUTF8String:fullPath.c_str()];
     // do it atomically
-    return [nsDict writeToFile:file atomically:YES];
+    bool ret = [nsDict writeToFile:file atomically:YES];
+    if (ret)
+    {
+        purgeCachedMissingEntries(fullPath);
+    }
+    return ret;
 }
 
 void FileUtilsApple::valueMapCompact(ValueMap& valueMap)
@@ -457,6 +462,7 @@ bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::st
     }
 
     [array writeToFile:path atomically:YES];
+    purgeCachedMissingEntries(fullPath);
 
     return true;
 }
@@ -496,6 +502,11 @@ bool FileUtilsApple::createDirectory(const std::string& path)
     {
         CCLOGERROR("Fail to create directory \"%s\": %s", path.c_str(), [error.localizedDescription UTF8String]);
     }
+    else if (result)
+    {
+        // The new directory may have been cached as one which can't be listed
+        purgeCachedMissingEntries(path.back() == '/' ? path : path + "/");
+    }
     
     return result;
 }
@@ -171,6 +171,11 @@ FileUtils::Status FileUtilsWin32::getContents(const std::string& filename, Resiz
     // read the file from hardware
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+    // Files in mounted archives are read by FileUtils
+    std::string entryName;
+    if (findSearchArchive(fullPath, &entryName))
+        return FileUtils::getContents(fullPath, buffer);
+
     HANDLE fileHandle = ::CreateFile(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, NULL, nullptr);
     if (fileHandle == INVALID_HANDLE_VALUE)
         return FileUtils::Status::OpenFailed;
@@ -290,6 +295,8 @@ bool FileUtilsWin32::renameFile(const std::string &oldfullpath, const std::strin
 
     if (MoveFile(_wOld.c_str(), _wNew.c_str()))
     {
+        purgeCachedMissingEntries(oldfullpath);
+        purgeCachedMissingEntries(newfullpath);
         return true;
     }
     else
@@ -365,6 +372,8 @@ bool FileUtilsWin32::createDirectory(const std::string& dirPath)
                 }
             }
         }
+        // The new directory may have been cached as one which can't be listed
+        purgeCachedMissingEntries(dirPath.back() == '/' ? dirPath : dirPath + "/");
     }
     return true;
 }
@@ -35,6 +35,8 @@
 #include "platform/CCPlatformConfig.h"
 #include "base/CCGLUtils.h"
 
+#include <algorithm>
+
 RENDERER_BEGIN
 
 static_assert(sizeof(int) == sizeof(GLint), "ERROR: GLint isn't equal to int!");
@@ -55,6 +57,14 @@ namespace
     }
 
     static DeviceGraphics* __instance = nullptr;
+
+    // textures drawn within this many frames are never evicted
+    #define TEXTURE_EVICT_IDLE_FRAMES 60
+    // frames before an evicted texture is restored again after an attempt, doubled on every failure
+    #define TEXTURE_RESTORE_RETRY_FRAMES 30
+    #define TEXTURE_RESTORE_MAX_BACKOFF 5
+    // bytes of streamed mipmap levels uploaded per frame
+    #define TEXTURE_STREAMING_BYTES_PER_FRAME (1024 * 1024)
 } // namespace {
 
 void DeviceGraphics::destroy() {
@@ -588,6 +598,9 @@ DeviceGraphics::DeviceGraphics()
 
 DeviceGraphics::~DeviceGraphics()
 {
+    for (auto texture : _textures)
+        texture->_device = nullptr;
+
     RENDERER_SAFE_RELEASE(_frameBuffer);
     
     delete _currentState;
@@ -1094,9 +1107,39 @@ void DeviceGraphics::commitTextures()
     int curTextureSize = static_cast<int>(curTextureUnits.size());
     const auto& nextTextureUnits = _nextState->getTextureUnits();
     int capacity = static_cast<int>(nextTextureUnits.size());
+
+    // restore evicted textures before binding, uploading them rebinds texture unit 0
+    bool restored = false;
+    for (int i = 0; i < capacity; ++i)
+    {
+        auto texture = nextTextureUnits[i];
+        if (texture)
+        {
+            texture->_lastUsedFrame = _frameStamp;
+            // a texture stays evicted until its storage is uploaded again, which updates its bytes
+            if (texture->_evicted && _frameStamp >= texture->_restoreFrame)
+            {
+                uint32_t backoff = 0;
+                if (texture->restore())
+                {
+                    ++_textureStats.restores;
+                    texture->_restoreFailures = 0;
+                }
+                else
+                {
+                    backoff = std::min<uint32_t>(texture->_restoreFailures, TEXTURE_RESTORE_MAX_BACKOFF);
+                    ++texture->_restoreFailures;
+                }
+                // reloads may upload later, don't start another one every draw meanwhile
+                texture->_restoreFrame = _frameStamp + (TEXTURE_RESTORE_RETRY_FRAMES << backoff);
+                restored = true;
+            }
+        }
+    }
+
     for (int i = 0; i < capacity; ++i)
     {
-        if (i >= curTextureSize || curTextureUnits[i] != nextTextureUnits[i])
+        if (restored || i >= curTextureSize || curTextureUnits[i] != nextTextureUnits[i])
         {
             auto texture = nextTextureUnits[i];
             if (texture)
@@ -1109,6 +1152,111 @@ void DeviceGraphics::commitTextures()
     }
 }
 
+void DeviceGraphics::beginFrame()
+{
+    ++_frameStamp;
+    if (!_streamingTextures.empty())
+        streamTextures();
+    if (_textureBudget > 0 && _textureStats.bytes > _textureBudget)
+        evictTextures();
+}
+
+void DeviceGraphics::setTextureBytes(Texture* texture, uint32_t bytes)
+{
+    if (_textures.insert(texture).second)
+        ++_textureStats.textures;
+    else if (!texture->_evicted)
+        _textureStats.bytes -= texture->_bytes;
+
+    if (texture->_evicted)
+    {
+        texture->_evicted = false;
+        --_textureStats.evictedTextures;
+    }
+    texture->_bytes = bytes;
+    texture->_lastUsedFrame = _frameStamp;
+    _textureStats.bytes += bytes;
+}
+
+void DeviceGraphics::removeTexture(Texture* texture)
+{
+    if (_textures.erase(texture) == 0)
+        return;
+
+    --_textureStats.textures;
+    if (texture->_evicted)
+        --_textureStats.evictedTextures;
+    else
+        _textureStats.bytes -= texture->_bytes;
+}
+
+void DeviceGraphics::rebindTexture(Texture* texture)
+{
+    const auto& textureUnits = _currentState->getTextureUnits();
+    for (size_t i = 0, len = textureUnits.size(); i < len; ++i)
+    {
+        if (textureUnits[i] == texture)
+        {
+            GL_CHECK(glActiveTexture(GL_TEXTURE0 + (GLenum)i));
+            GL_CHECK(glBindTexture(texture->getTarget(), texture->getHandle()));
+        }
+    }
+}
+
+void DeviceGraphics::addStreamingTexture(Texture2D* texture)
+{
+    if (std::find(_streamingTextures.begin(), _streamingTextures.end(), texture) == _streamingTextures.end())
+        _streamingTextures.push_back(texture);
+}
+
+void DeviceGraphics::removeStreamingTexture(Texture2D* texture)
+{
+    auto iter = std::find(_streamingTextures.begin(), _streamingTextures.end(), texture);
+    if (iter != _streamingTextures.end())
+        _streamingTextures.erase(iter);
+}
+
+void DeviceGraphics::streamTextures()
+{
+    uint32_t budget = TEXTURE_STREAMING_BYTES_PER_FRAME;
+    for (auto iter = _streamingTextures.begin(); iter != _streamingTextures.end() && budget > 0;)
+    {
+        if ((*iter)->streamMipmap(budget))
+            iter = _streamingTextures.erase(iter);
+        else
+            ++iter;
+    }
+}
+
+void DeviceGraphics::evictTextures()
+{
+    std::vector<Texture*> candidates;
+    for (auto texture : _textures)
+    {
+        if (!texture->_evicted && texture->_bytes > 0 && texture->_lastUsedFrame + TEXTURE_EVICT_IDLE_FRAMES < _frameStamp)
+            candidates.push_back(texture);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Texture* a, const Texture* b) {
+        return a->_lastUsedFrame < b->_lastUsedFrame;
+    });
+
+    for (auto texture : candidates)
+    {
+        if (_textureStats.bytes <= _textureBudget)
+            break;
+
+        if (!texture->evict())
+            continue;
+
+        texture->_evicted = true;
+        texture->_restoreFrame = 0;
+        texture->_restoreFailures = 0;
+        ++_textureStats.evictedTextures;
+        ++_textureStats.evictions;
+        _textureStats.bytes -= texture->_bytes;
+    }
+}
+
 //
 // Uniform
 //
@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include "base/ccTypes.h"
 #include "base/CCRef.h"
 #include "math/Vec2.h"
@@ -45,6 +46,7 @@ class VertexBuffer;
 class IndexBuffer;
 class Program;
 class Texture;
+class Texture2D;
 
 /**
  * @addtogroup gfx
@@ -312,6 +314,33 @@ public:
     uint32_t getDrawCalls() const { return _drawCalls; };
     
     inline const Capacity& getCapacity() const { return _caps; }
+
+    /**
+     * Texture memory statistics
+     */
+    struct TextureStats
+    {
+        uint32_t textures = 0;
+        uint32_t evictedTextures = 0;
+        // estimated video memory of resident textures
+        size_t bytes = 0;
+        uint32_t evictions = 0;
+        uint32_t restores = 0;
+    };
+
+    /**
+     * Sets the texture memory budget in bytes, 0 means unlimited.
+     * When it is exceeded, least recently used textures which can be reloaded are evicted
+     * at the beginning of a frame and uploaded again the next time they are bound.
+     */
+    void setTextureBudget(size_t bytes) { _textureBudget = bytes; }
+    size_t getTextureBudget() const { return _textureBudget; }
+    const TextureStats& getTextureStats() const { return _textureStats; }
+
+    /**
+     * Advances the frame stamp of texture usage and applies the texture budget
+     */
+    void beginFrame();
     
 private:
     DeviceGraphics();
@@ -330,6 +359,15 @@ private:
     inline void commitVertexBuffer();
     inline void commitTextures();
 
+    void setTextureBytes(Texture* texture, uint32_t bytes);
+    void removeTexture(Texture* texture);
+    void evictTextures();
+    // binds the new handle of a texture to the units it is used by
+    void rebindTexture(Texture* texture);
+    void addStreamingTexture(Texture2D* texture);
+    void removeStreamingTexture(Texture2D* texture);
+    void streamTextures();
+
     int _vx;
     int _vy;
     int _vw;
@@ -354,8 +392,15 @@ private:
     
     State* _nextState;
     State* _currentState;
+
+    std::unordered_set<Texture*> _textures;
+    std::vector<Texture2D*> _streamingTextures;
+    TextureStats _textureStats;
+    size_t _textureBudget = 0;
+    uint32_t _frameStamp = 0;
     
     friend class IndexBuffer;
+    friend class Texture;
     friend class Texture2D;
 };
 
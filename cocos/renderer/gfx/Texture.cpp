@@ -23,6 +23,7 @@
  ****************************************************************************/
 
 #include "Texture.h"
+#include "DeviceGraphics.h"
 #include "platform/CCPlatformConfig.h"
 #include "base/CCGLUtils.h"
 
@@ -63,6 +64,9 @@ Texture::Texture()
 
 Texture::~Texture()
 {
+    if (_device)
+        _device->removeTexture(this);
+
     if (_glID == 0)
     {
         RENDERER_LOGE("Invalid texture: %p", this);
@@ -70,8 +74,6 @@ Texture::~Texture()
     }
 
     glDeleteTextures(1, &_glID);
-
-    //REFINE:    this._device._stats.tex -= this.bytes;
 }
 
 bool Texture::init(DeviceGraphics* device)
@@ -257,10 +257,28 @@ public:
     
     inline void setAlphaAtlas(bool value) { _useAlphaAtlas = value; }
     inline bool isAlphaAtlas() const { return _useAlphaAtlas; }
+
+    /**
+     * Gets the estimated video memory used by the texture, mipmaps included
+     */
+    inline uint32_t getBytes() const { return _bytes; }
+    /**
+     * Whether the texture storage was released by the texture memory budget
+     */
+    inline bool isEvicted() const { return _evicted; }
     
 protected:
     
     static GLenum glFilter(Filter filter, Filter mipFilter = Filter::NONE);
+
+    /**
+     * Releases the texture storage, returns false if the texture can't be restored later
+     */
+    virtual bool evict() { return false; }
+    /**
+     * Uploads an evicted texture again, called before it is bound
+     */
+    virtual bool restore() { return false; }
     
     static bool isPow2(int32_t v) {
         return !(v & (v - 1)) && (!!v);
@@ -292,6 +310,16 @@ protected:
     bool _compressed;
     
     bool _useAlphaAtlas = false;
+
+    // texture memory budget bookkeeping, see DeviceGraphics::setTextureBudget
+    uint32_t _bytes = 0;
+    uint32_t _lastUsedFrame = 0;
+    // an evicted texture isn't restored again before this frame
+    uint32_t _restoreFrame = 0;
+    uint8_t _restoreFailures = 0;
+    bool _evicted = false;
+
+    friend class DeviceGraphics;
 };
 
 // end of gfx group
@@ -27,9 +27,257 @@
 #include "GFXUtils.h"
 
 #include "base/CCGLUtils.h"
+#include "base/ccConfig.h"
+#include "base/ccPixelKernels.h"
+#include "base/CCThreadPool.h"
+#include "base/CCScheduler.h"
+#include "platform/CCApplication.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    // textures up to this size are cheaper to mipmap on the GPU than to stream
+    #define MIPMAP_STREAMING_MIN_SIZE 64
+
+    bool isSRGBFormat(GLenum format)
+    {
+#ifdef GL_SRGB_EXT
+        if (format == GL_SRGB_EXT)
+            return true;
+#endif
+#ifdef GL_SRGB_ALPHA_EXT
+        if (format == GL_SRGB_ALPHA_EXT)
+            return true;
+#endif
+#ifdef GL_SRGB8_ALPHA8
+        if (format == GL_SRGB8_ALPHA8)
+            return true;
+#endif
+        return false;
+    }
+
+    struct SRGBTable
+    {
+        float toLinear[256];
+
+        SRGBTable()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                float c = i / 255.0f;
+                toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+            }
+        }
+    };
+
+    inline float linearToSRGB(float c)
+    {
+        return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    // 2:1 Kaiser windowed sinc, taps at source offsets -2 .. 3 of an output pixel
+    struct KaiserWeights
+    {
+        float weights[6];
+
+        static double besselI0(double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 20; ++k)
+            {
+                term *= (x / (2 * k)) * (x / (2 * k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        KaiserWeights()
+        {
+            const double alpha = 4.0, radius = 1.5, pi = 3.14159265358979323846;
+            double total = 0;
+            for (int k = 0; k < 6; ++k)
+            {
+                // distance in output pixels
+                double t = (k - 2.5) / 2;
+                double sinc = sin(pi * t) / (pi * t);
+                double r = t / radius;
+                double window = besselI0(alpha * sqrt(1 - r * r)) / besselI0(alpha);
+                weights[k] = (float)(sinc * window);
+                total += weights[k];
+            }
+            for (int k = 0; k < 6; ++k)
+                weights[k] /= (float)total;
+        }
+    };
+
+    // dst[i] = sum of weights[k] * rows[k][i], four floats at a time where SIMD is available
+    void weightedSum(const float* const* rows, const float* weights, int taps, size_t count, float* dst)
+    {
+        size_t i = 0;
+#if CC_PIXEL_KERNELS_SSE2
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < taps; ++k)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+            _mm_storeu_ps(dst + i, sum);
+        }
+#elif CC_PIXEL_KERNELS_NEON
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t sum = vdupq_n_f32(0);
+            for (int k = 0; k < taps; ++k)
+                sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(rows[k] + i), weights[k]));
+            vst1q_f32(dst + i, sum);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            float sum = 0;
+            for (int k = 0; k < taps; ++k)
+                sum += weights[k] * rows[k][i];
+            dst[i] = sum;
+        }
+    }
+
+    // clamps to [0, 1] and rounds to 8 bits
+    void floatToUnorm8(const float* src, size_t count, uint8_t* dst)
+    {
+        size_t i = 0;
+#if CC_PIXEL_KERNELS_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), zero), one);
+            __m128i n = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+            n = _mm_packs_epi32(n, n);
+            int packed = _mm_cvtsi128_si32(_mm_packus_epi16(n, n));
+            memcpy(dst + i, &packed, 4);
+        }
+#elif CC_PIXEL_KERNELS_NEON
+        const float32x4_t zero = vdupq_n_f32(0);
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t v = vminq_f32(vmaxq_f32(vld1q_f32(src + i), zero), one);
+            uint16x4_t n = vmovn_u32(vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(v, 255.0f), half)));
+            uint8_t packed[8];
+            vst1_u8(packed, vmovn_u16(vcombine_u16(n, n)));
+            memcpy(dst + i, packed, 4);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            float v = std::min(std::max(src[i], 0.0f), 1.0f);
+            dst[i] = (uint8_t)(v * 255.0f + 0.5f);
+        }
+    }
+
+    // separable 2:1 filter in linear float, sRGB color channels are decoded first
+    void downsampleFiltered(const uint8_t* src, uint32_t width, uint32_t height, uint32_t channels,
+                            bool srgb, bool kaiser, uint8_t* dst)
+    {
+        static const SRGBTable srgbTable;
+        static const KaiserWeights kaiserWeights;
+        static const float boxWeights[2] = { 0.5f, 0.5f };
+
+        const float* weights = kaiser ? kaiserWeights.weights : boxWeights;
+        const int taps = kaiser ? 6 : 2;
+        const int first = kaiser ? -2 : 0;
+        const uint32_t dstWidth = width > 1 ? width / 2 : 1;
+        const uint32_t dstHeight = height > 1 ? height / 2 : 1;
+        const float* tapRows[6];
+
+        std::vector<float> in((size_t)width * height * channels);
+        for (size_t i = 0, len = in.size(); i < len; ++i)
+        {
+            bool color = srgb && (channels < 4 || i % channels < 3);
+            in[i] = color ? srgbTable.toLinear[src[i]] : src[i] / 255.0f;
+        }
+
+        // horizontal pass, an RGBA pixel is one vector of four floats
+        std::vector<float> rows((size_t)dstWidth * height * channels);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const float* row = in.data() + (size_t)y * width * channels;
+            float* out = rows.data() + (size_t)y * dstWidth * channels;
+            for (uint32_t x = 0; x < dstWidth; ++x)
+            {
+                for (int k = 0; k < taps; ++k)
+                {
+                    int sx = width > 1 ? (int)x * 2 + first + k : 0;
+                    sx = std::min(std::max(sx, 0), (int)width - 1);
+                    tapRows[k] = row + sx * channels;
+                }
+                weightedSum(tapRows, weights, taps, channels, out + x * channels);
+            }
+        }
+
+        // vertical pass over whole rows
+        const size_t stride = (size_t)dstWidth * channels;
+        std::vector<float> line(stride);
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+            for (int k = 0; k < taps; ++k)
+            {
+                int sy = height > 1 ? (int)y * 2 + first + k : 0;
+                sy = std::min(std::max(sy, 0), (int)height - 1);
+                tapRows[k] = rows.data() + sy * stride;
+            }
+            weightedSum(tapRows, weights, taps, stride, line.data());
+
+            uint8_t* out = dst + y * stride;
+            if (!srgb)
+            {
+                floatToUnorm8(line.data(), stride, out);
+                continue;
+            }
+            for (size_t i = 0; i < stride; ++i)
+            {
+                float sum = std::min(std::max(line[i], 0.0f), 1.0f);
+                if (channels < 4 || i % channels < 3)
+                    sum = linearToSRGB(sum);
+                out[i] = (uint8_t)(sum * 255.0f + 0.5f);
+            }
+        }
+    }
+
+} // namespace {
 
 RENDERER_BEGIN
 
+struct Texture2D::MipChain
+{
+    std::vector<std::vector<uint8_t>> levels;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t channels = 0;
+    bool srgb = false;
+
+    uint32_t levelWidth(size_t level) const { return std::max(width >> level, 1u); }
+    uint32_t levelHeight(size_t level) const { return std::max(height >> level, 1u); }
+
+    void generate()
+    {
+        for (size_t level = 1; levelWidth(level - 1) > 1 || levelHeight(level - 1) > 1; ++level)
+        {
+            const auto& src = levels[level - 1];
+            levels.emplace_back((size_t)levelWidth(level) * levelHeight(level) * channels);
+            auto& dst = levels.back();
+            if (srgb || CC_TEXTURE_MIPMAP_KAISER_FILTER)
+                downsampleFiltered(src.data(), levelWidth(level - 1), levelHeight(level - 1), channels, srgb, CC_TEXTURE_MIPMAP_KAISER_FILTER, dst.data());
+            else
+                cocos2d::PixelKernels::downsampleBox(src.data(), levelWidth(level - 1), levelHeight(level - 1), channels, dst.data());
+        }
+    }
+};
+
 Texture2D::Texture2D()
 {
 //    RENDERER_LOGD("Construct Texture2D: %p", this);
@@ -38,6 +286,7 @@ Texture2D::Texture2D()
 Texture2D::~Texture2D()
 {
 //    RENDERER_LOGD("Destruct Texture2D: %p", this);
+    stopMipmapStreaming();
 }
 
 bool Texture2D::init(DeviceGraphics* device, Options& options)
@@ -91,39 +340,234 @@ void Texture2D::update(const Options& options)
     if (!pot)
         genMipmap = false;
 
+    stopMipmapStreaming();
+    bool streaming = genMipmap && canStreamMipmap(options);
+
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, _glID));
-    if (!options.images.empty())
+    if (streaming)
+        generateMipmap(options);
+    else if (!options.images.empty())
         setMipmap(options.images, options.flipY, options.premultiplyAlpha);
 
-    setTexInfo();
+    // a streamed texture samples its base level only until the whole chain is uploaded
+    setTexInfo(!streaming);
 
-    if (genMipmap)
+    if (genMipmap && !streaming)
     {
         GL_CHECK(glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST));
         GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
     }
     _device->restoreTexture(0);
+    _device->setTextureBytes(this, computeBytes(options, genMipmap && !streaming));
 }
 
 void Texture2D::updateSubImage(const SubImageOption& option)
 {
+    // the streamed texture would replace this one and drop the update
+    bool streaming = stopMipmapStreaming();
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, _glID));
+    if (streaming)
+        generateMipmapOnGPU();
     setSubImage(option);
     _device->restoreTexture(0);
 }
 
 void Texture2D::updateImage(const ImageOption& option)
 {
+    bool streaming = stopMipmapStreaming();
     GL_CHECK(glActiveTexture(GL_TEXTURE0));
     GL_CHECK(glBindTexture(GL_TEXTURE_2D, _glID));
+    if (streaming)
+        generateMipmapOnGPU();
     setImage(option);
     _device->restoreTexture(0);
 }
 
+bool Texture2D::evict()
+{
+    if (!_reloadCallback)
+        return false;
+
+    stopMipmapStreaming();
+
+    // a new name drops the storage of every level, the texture keeps its handle object
+    GL_CHECK(glDeleteTextures(1, &_glID));
+    GL_CHECK(glGenTextures(1, &_glID));
+    return true;
+}
+
+bool Texture2D::restore()
+{
+    return _reloadCallback && _reloadCallback(this);
+}
+
 // Private methods:
 
+bool Texture2D::canStreamMipmap(const Options& options) const
+{
+#if CC_ENABLE_TEXTURE_MIPMAP_STREAMING
+    if (_compressed || _glType != GL_UNSIGNED_BYTE || (_glFormat != GL_RGBA && _glFormat != GL_RGB))
+        return false;
+    if (options.images.size() != 1 || std::max(_width, _height) <= MIPMAP_STREAMING_MIN_SIZE)
+        return false;
+
+    const auto& image = options.images[0];
+    const size_t channels = _glFormat == GL_RGBA ? 4 : 3;
+    return image.data && image.length >= (size_t)_width * _height * channels;
+#else
+    return false;
+#endif
+}
+
+void Texture2D::generateMipmap(const Options& options)
+{
+    auto chain = std::make_shared<MipChain>();
+    chain->width = _width;
+    chain->height = _height;
+    chain->channels = _glFormat == GL_RGBA ? 4 : 3;
+    chain->srgb = isSRGBFormat(_glInternalFormat);
+
+    // the image data belongs to the caller, copy it and apply the unpack flags once
+    const auto& image = options.images[0];
+    const size_t length = (size_t)_width * _height * chain->channels;
+    chain->levels.emplace_back(image.data, image.data + length);
+    GL_CHECK(ccPixelStorei(GL_UNPACK_FLIP_Y_WEBGL, options.flipY));
+    GL_CHECK(ccPixelStorei(GL_UNPACK_PREMULTIPLY_ALPHA_WEBGL, options.premultiplyAlpha));
+    ccFlipYOrPremultiptyAlphaIfNeeded(_glFormat, _width, _height, (uint32_t)length, chain->levels[0].data());
+
+    // the base level is shown until the chain is generated and streamed
+    uploadLevel(0, _width, _height, chain->levels[0].data());
+
+    uint32_t job = ++_mipmapJob;
+    _mipmapStreaming = true;
+    retain();
+    cocos2d::ThreadPool::getDefaultThreadPool()->pushTask([this, chain, job](int) {
+        chain->generate();
+        cocos2d::Application::getInstance()->getScheduler()->performFunctionInCocosThread([this, chain, job]() {
+            if (job == _mipmapJob)
+                onMipmapGenerated(chain);
+            release();
+        });
+    });
+}
+
+void Texture2D::onMipmapGenerated(const std::shared_ptr<MipChain>& chain)
+{
+    // the full chain goes to another texture from the smallest level, see streamMipmap
+    _mipChain = chain;
+    _streamingLevel = (int)chain->levels.size() - 1;
+    GL_CHECK(glGenTextures(1, &_streamingID));
+    _device->addStreamingTexture(this);
+}
+
+bool Texture2D::streamMipmap(uint32_t& budget)
+{
+    if (!_mipChain)
+        return true;
+
+    GL_CHECK(glActiveTexture(GL_TEXTURE0));
+    GL_CHECK(glBindTexture(GL_TEXTURE_2D, _streamingID));
+    bool uploaded = false;
+    uint32_t uploadedBytes = 0;
+    while (_streamingLevel >= 0)
+    {
+        const auto& data = _mipChain->levels[_streamingLevel];
+        uint32_t bytes = (uint32_t)data.size();
+        // at least one level per frame
+        if (bytes > budget && uploaded)
+            break;
+
+        uploadLevel(_streamingLevel, _mipChain->levelWidth(_streamingLevel), _mipChain->levelHeight(_streamingLevel), data.data());
+        budget = bytes > budget ? 0 : budget - bytes;
+        uploadedBytes += bytes;
+        uploaded = true;
+        --_streamingLevel;
+    }
+
+    // the base level stays resident next to the streamed levels until they replace it
+    uint32_t residentBytes = _bytes + uploadedBytes;
+    bool finished = _streamingLevel < 0;
+    if (finished)
+    {
+        setTexInfo();
+        GL_CHECK(glDeleteTextures(1, &_glID));
+        _glID = _streamingID;
+        _streamingID = 0;
+        _mipmapStreaming = false;
+
+        residentBytes = 0;
+        for (const auto& level : _mipChain->levels)
+            residentBytes += (uint32_t)level.size();
+        _mipChain.reset();
+    }
+
+    _device->restoreTexture(0);
+    _device->setTextureBytes(this, residentBytes);
+    if (finished)
+        _device->rebindTexture(this);
+    return finished;
+}
+
+bool Texture2D::stopMipmapStreaming()
+{
+    bool streaming = _mipmapStreaming;
+    _mipmapStreaming = false;
+    // a generation still running is dropped when it lands
+    ++_mipmapJob;
+    if (_streamingID != 0)
+    {
+        GL_CHECK(glDeleteTextures(1, &_streamingID));
+        _streamingID = 0;
+    }
+    _streamingLevel = -1;
+    if (_mipChain)
+    {
+        _mipChain.reset();
+        if (_device)
+            _device->removeStreamingTexture(this);
+    }
+    return streaming;
+}
+
+void Texture2D::generateMipmapOnGPU()
+{
+    // the base level is complete, the other levels come from the GPU as without streaming
+    setTexInfo();
+    GL_CHECK(glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST));
+    GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
+    uint32_t bytes = (uint32_t)_width * _height * _bpp / 8;
+    _device->setTextureBytes(this, bytes + bytes / 3);
+}
+
+void Texture2D::uploadLevel(int level, uint32_t width, uint32_t height, const uint8_t* data)
+{
+    GL_CHECK(ccPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GL_CHECK(ccPixelStorei(GL_UNPACK_FLIP_Y_WEBGL, false));
+    GL_CHECK(ccPixelStorei(GL_UNPACK_PREMULTIPLY_ALPHA_WEBGL, false));
+    GL_CHECK(glTexImage2D(GL_TEXTURE_2D, level, _glInternalFormat, width, height, 0, _glFormat, _glType, data));
+}
+
+uint32_t Texture2D::computeBytes(const Options& options, bool genMipmap) const
+{
+    uint32_t bytes = 0;
+    for (size_t i = 0, len = options.images.size(); i < len; ++i)
+    {
+        const auto& image = options.images[i];
+        if (_compressed || _bpp == 0)
+            bytes += (uint32_t)image.length;
+        else
+            bytes += std::max(_width >> i, 1) * std::max(_height >> i, 1) * _bpp / 8;
+    }
+
+    // a generated mipmap chain adds a third of the base level
+    if (genMipmap)
+        bytes += bytes / 3;
+    return bytes;
+}
+
+
 void Texture2D::setSubImage(const SubImageOption& option)
 {
     bool flipY = option.flipY;
@@ -260,7 +704,7 @@ void Texture2D::setMipmap(const std::vector<Image>& images, bool isFlipY, bool i
     }
 }
 
-void Texture2D::setTexInfo()
+void Texture2D::setTexInfo(bool mipmapped)
 {
     bool pot = isPow2(_width) && isPow2(_height);
 
@@ -272,7 +716,7 @@ void Texture2D::setTexInfo()
         _wrapT = WrapMode::CLAMP;
     }
 
-    Filter mipFilter = _hasMipmap ? _mipFilter : Filter::NONE;
+    Filter mipFilter = _hasMipmap && mipmapped ? _mipFilter : Filter::NONE;
     if (!pot && mipFilter != Filter::NONE)
     {
         RENDERER_LOGW("NPOT textures do not support mipmap filter");
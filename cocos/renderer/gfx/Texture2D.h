@@ -29,6 +29,9 @@
 
 #include "Texture.h"
 
+#include <functional>
+#include <memory>
+
 RENDERER_BEGIN
 
 /**
@@ -77,11 +80,47 @@ public:
      * @see Texture::ImageOption
      */
     void updateImage(const ImageOption& option);
+
+    /**
+     * The callback uploads the texture again with update(), return false if it can't.
+     * Only textures with a reload callback are evicted when the texture budget is exceeded.
+     * @see DeviceGraphics::setTextureBudget
+     */
+    typedef std::function<bool(Texture2D*)> ReloadCallback;
+    void setReloadCallback(const ReloadCallback& callback) { _reloadCallback = callback; }
+protected:
+    virtual bool evict() override;
+    virtual bool restore() override;
 private:
     void setSubImage(const SubImageOption& options);
     void setImage(const ImageOption& options);
     void setMipmap(const std::vector<Image>& images, bool isFlipY, bool isPremultiplyAlpha);
-    void setTexInfo();
+    // mipmapped is false while the levels above the base one aren't uploaded yet
+    void setTexInfo(bool mipmapped = true);
+    uint32_t computeBytes(const Options& options, bool genMipmap) const;
+
+    // mipmaps generated on a worker thread and uploaded from the smallest level
+    struct MipChain;
+    bool canStreamMipmap(const Options& options) const;
+    void generateMipmap(const Options& options);
+    void onMipmapGenerated(const std::shared_ptr<MipChain>& chain);
+    // uploads levels until the byte budget is spent, returns true when finished
+    bool streamMipmap(uint32_t& budget);
+    // returns true if the mipmaps were being generated or streamed
+    bool stopMipmapStreaming();
+    // the texture must be bound
+    void generateMipmapOnGPU();
+    void uploadLevel(int level, uint32_t width, uint32_t height, const uint8_t* data);
+
+    ReloadCallback _reloadCallback = nullptr;
+
+    std::shared_ptr<MipChain> _mipChain;
+    GLuint _streamingID = 0;
+    int _streamingLevel = -1;
+    uint32_t _mipmapJob = 0;
+    bool _mipmapStreaming = false;
+
+    friend class DeviceGraphics;
 };
 
 // end of gfx group
@@ -86,6 +86,7 @@ void ForwardRenderer::resetData()
 void ForwardRenderer::render(Scene* scene, float deltaTime)
 {
     resetData();
+    _device->beginFrame();
     
     
     _time[0] += deltaTime;
@@ -58,6 +58,16 @@ getTotalBytes : function (
     return 0;
 },
 
+/**
+ * @method getBytesPerSecond
+ * @return {double}
+ */
+getBytesPerSecond : function (
+)
+{
+    return 0;
+},
+
 /**
  * @method getCURLECode
  * @return {int}
@@ -458,6 +468,16 @@ getTotalBytes : function (
     return 0;
 },
 
+/**
+ * @method getBytesPerSecond
+ * @return {double}
+ */
+getBytesPerSecond : function (
+)
+{
+    return 0;
+},
+
 /**
  * @method setVerifyCallback
  * @param {function} arg0
@@ -96,6 +96,24 @@ static bool js_extension_EventAssetsManagerEx_getTotalBytes(se::State& s)
 }
 SE_BIND_FUNC(js_extension_EventAssetsManagerEx_getTotalBytes)
 
+static bool js_extension_EventAssetsManagerEx_getBytesPerSecond(se::State& s)
+{
+    cocos2d::extension::EventAssetsManagerEx* cobj = (cocos2d::extension::EventAssetsManagerEx*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_extension_EventAssetsManagerEx_getBytesPerSecond : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 0) {
+        double result = cobj->getBytesPerSecond();
+        ok &= double_to_seval(result, &s.rval());
+        SE_PRECONDITION2(ok, false, "js_extension_EventAssetsManagerEx_getBytesPerSecond : Error processing arguments");
+        return true;
+    }
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 0);
+    return false;
+}
+SE_BIND_FUNC(js_extension_EventAssetsManagerEx_getBytesPerSecond)
+
 static bool js_extension_EventAssetsManagerEx_getCURLECode(se::State& s)
 {
     cocos2d::extension::EventAssetsManagerEx* cobj = (cocos2d::extension::EventAssetsManagerEx*)s.nativeThisObject();
@@ -280,6 +298,7 @@ bool js_register_extension_EventAssetsManagerEx(se::Object* obj)
     cls->defineFunction("getTotalFiles", _SE(js_extension_EventAssetsManagerEx_getTotalFiles));
     cls->defineFunction("getAssetId", _SE(js_extension_EventAssetsManagerEx_getAssetId));
     cls->defineFunction("getTotalBytes", _SE(js_extension_EventAssetsManagerEx_getTotalBytes));
+    cls->defineFunction("getBytesPerSecond", _SE(js_extension_EventAssetsManagerEx_getBytesPerSecond));
     cls->defineFunction("getCURLECode", _SE(js_extension_EventAssetsManagerEx_getCURLECode));
     cls->defineFunction("getMessage", _SE(js_extension_EventAssetsManagerEx_getMessage));
     cls->defineFunction("getCURLMCode", _SE(js_extension_EventAssetsManagerEx_getCURLMCode));
@@ -955,6 +974,24 @@ static bool js_extension_AssetsManagerEx_getTotalBytes(se::State& s)
 }
 SE_BIND_FUNC(js_extension_AssetsManagerEx_getTotalBytes)
 
+static bool js_extension_AssetsManagerEx_getBytesPerSecond(se::State& s)
+{
+    cocos2d::extension::AssetsManagerEx* cobj = (cocos2d::extension::AssetsManagerEx*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_extension_AssetsManagerEx_getBytesPerSecond : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    CC_UNUSED bool ok = true;
+    if (argc == 0) {
+        double result = cobj->getBytesPerSecond();
+        ok &= double_to_seval(result, &s.rval());
+        SE_PRECONDITION2(ok, false, "js_extension_AssetsManagerEx_getBytesPerSecond : Error processing arguments");
+        return true;
+    }
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 0);
+    return false;
+}
+SE_BIND_FUNC(js_extension_AssetsManagerEx_getBytesPerSecond)
+
 static bool js_extension_AssetsManagerEx_setVerifyCallback(se::State& s)
 {
     cocos2d::extension::AssetsManagerEx* cobj = (cocos2d::extension::AssetsManagerEx*)s.nativeThisObject();
@@ -1224,6 +1261,7 @@ bool js_register_extension_AssetsManagerEx(se::Object* obj)
     cls->defineFunction("getMaxConcurrentTask", _SE(js_extension_AssetsManagerEx_getMaxConcurrentTask));
     cls->defineFunction("setVersionCompareHandle", _SE(js_extension_AssetsManagerEx_setVersionCompareHandle));
     cls->defineFunction("getTotalBytes", _SE(js_extension_AssetsManagerEx_getTotalBytes));
+    cls->defineFunction("getBytesPerSecond", _SE(js_extension_AssetsManagerEx_getBytesPerSecond));
     cls->defineFunction("setVerifyCallback", _SE(js_extension_AssetsManagerEx_setVerifyCallback));
     cls->defineFunction("getStoragePath", _SE(js_extension_AssetsManagerEx_getStoragePath));
     cls->defineFunction("update", _SE(js_extension_AssetsManagerEx_update));
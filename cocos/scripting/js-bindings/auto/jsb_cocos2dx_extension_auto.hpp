@@ -13,6 +13,7 @@ SE_DECLARE_FUNC(js_extension_EventAssetsManagerEx_getDownloadedFiles);
 SE_DECLARE_FUNC(js_extension_EventAssetsManagerEx_getTotalFiles);
 SE_DECLARE_FUNC(js_extension_EventAssetsManagerEx_getAssetId);
 SE_DECLARE_FUNC(js_extension_EventAssetsManagerEx_getTotalBytes);
+SE_DECLARE_FUNC(js_extension_EventAssetsManagerEx_getBytesPerSecond);
 SE_DECLARE_FUNC(js_extension_EventAssetsManagerEx_getCURLECode);
 SE_DECLARE_FUNC(js_extension_EventAssetsManagerEx_getMessage);
 SE_DECLARE_FUNC(js_extension_EventAssetsManagerEx_getCURLMCode);
@@ -62,6 +63,7 @@ SE_DECLARE_FUNC(js_extension_AssetsManagerEx_getState);
 SE_DECLARE_FUNC(js_extension_AssetsManagerEx_getMaxConcurrentTask);
 SE_DECLARE_FUNC(js_extension_AssetsManagerEx_setVersionCompareHandle);
 SE_DECLARE_FUNC(js_extension_AssetsManagerEx_getTotalBytes);
+SE_DECLARE_FUNC(js_extension_AssetsManagerEx_getBytesPerSecond);
 SE_DECLARE_FUNC(js_extension_AssetsManagerEx_setVerifyCallback);
 SE_DECLARE_FUNC(js_extension_AssetsManagerEx_getStoragePath);
 SE_DECLARE_FUNC(js_extension_AssetsManagerEx_update);
@@ -88,6 +88,26 @@ namespace se {
         return obj;
     }
 
+    static void myArrayBufferFinalizeCallback(void* data)
+    {
+        free(data);
+    }
+
+    Object* Object::createArrayBufferObjectNoCopy(void* bytes, size_t byteLength)
+    {
+        Object* obj = nullptr;
+        JsValueRef jsobj;
+        if (JsNoError == JsCreateExternalArrayBuffer(bytes, (unsigned int)byteLength, myArrayBufferFinalizeCallback, bytes, &jsobj))
+        {
+            obj = Object::_createJSObject(nullptr, jsobj);
+        }
+        else
+        {
+            free(bytes);
+        }
+        return obj;
+    }
+
     Object* Object::createTypedArray(TypedArrayType type, void* data, size_t byteLength)
     {
         if (type == TypedArrayType::NONE)
@@ -149,6 +149,31 @@ namespace se {
         return obj;
     }
 
+    Object* Object::createArrayBufferObjectNoCopy(void* bytes, size_t byteLength)
+    {
+#if (__MAC_OS_X_VERSION_MAX_ALLOWED >= 101200 || __IPHONE_OS_VERSION_MAX_ALLOWED >= 100000)
+        if (isSupportTypedArrayAPI())
+        {
+            JSValueRef exception = nullptr;
+            JSObjectRef jsobj = JSObjectMakeArrayBufferWithBytesNoCopy(__cx, bytes, byteLength, myJSTypedArrayBytesDeallocator, nullptr, &exception);
+            if (exception != nullptr)
+            {
+                free(bytes);
+                ScriptEngine::getInstance()->_clearException(exception);
+                return nullptr;
+            }
+
+            Object* obj = Object::_createJSObject(nullptr, jsobj);
+            if (obj != nullptr)
+                obj->_type = Type::ARRAY_BUFFER;
+            return obj;
+        }
+#endif
+        Object* obj = createArrayBufferObject(bytes, byteLength);
+        free(bytes);
+        return obj;
+    }
+
     Object* Object::createTypedArray(TypedArrayType type, void* data, size_t byteLength)
     {
         if (type == TypedArrayType::NONE)
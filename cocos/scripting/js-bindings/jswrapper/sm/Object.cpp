@@ -149,6 +149,13 @@ namespace se {
         return obj;
     }
 
+    Object* Object::createArrayBufferObjectNoCopy(void* bytes, size_t byteLength)
+    {
+        Object* obj = createArrayBufferObject(bytes, byteLength);
+        free(bytes);
+        return obj;
+    }
+
     Object* Object::createTypedArray(TypedArrayType type, void* data, size_t byteLength)
     {
         if (type == TypedArrayType::NONE)
@@ -225,6 +225,15 @@ namespace se {
         Object* obj = Object::_createJSObject(nullptr, jsobj);
         return obj;
     }
+
+    Object* Object::createArrayBufferObjectNoCopy(void* bytes, size_t byteLength)
+    {
+        // The isolate is created with the default array buffer allocator which releases memory by 'free',
+        // so an internalized buffer allocated by 'malloc' is released correctly while it's garbage collected.
+        v8::Local<v8::ArrayBuffer> jsobj = v8::ArrayBuffer::New(__isolate, bytes, byteLength, v8::ArrayBufferCreationMode::kInternalized);
+        Object* obj = Object::_createJSObject(nullptr, jsobj);
+        return obj;
+    }
     
     Object* Object::createTypedArray(TypedArrayType type, void* data, size_t byteLength)
     {
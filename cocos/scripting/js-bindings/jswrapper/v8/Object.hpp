@@ -108,6 +108,15 @@ namespace se {
          */
         static Object* createArrayBufferObject(void* bytes, size_t byteLength);
 
+        /**
+         *  @brief Creates a JavaScript Array Buffer object which takes the ownership of an existing buffer without copying it.
+         *  @param[in] bytes A pointer to the byte buffer allocated by 'malloc', it will be released by 'free' when the Array Buffer is garbage collected.
+         *  @param[in] byteLength The number of bytes pointed to by the parameter bytes.
+         *  @return A Array Buffer Object whose backing store is the one pointed to data, or nullptr if there is an error.
+         *  @note The return value (non-null) has to be released manually. 'bytes' is released even if there is an error.
+         */
+        static Object* createArrayBufferObjectNoCopy(void* bytes, size_t byteLength);
+
         /**
          *  @brief Creates a JavaScript Object from a JSON formatted string.
          *  @param[in] jsonStr The utf-8 string containing the JSON string to be parsed.
@@ -1082,7 +1082,7 @@ bool seval_to_Data(const se::Value& v, cocos2d::Data* ret)
 
 bool seval_to_DownloaderHints(const se::Value& v, cocos2d::network::DownloaderHints* ret)
 {
-    static cocos2d::network::DownloaderHints ZERO = {0, 0, ""};
+    static cocos2d::network::DownloaderHints ZERO = {0, 0, "", 0, 0, false};
     assert(ret != nullptr);
     SE_PRECONDITION2(v.isObject(), false, "Convert parameter to DownloaderHints failed!");
     se::Value tmp;
@@ -1101,6 +1101,11 @@ bool seval_to_DownloaderHints(const se::Value& v, cocos2d::network::DownloaderHi
     SE_PRECONDITION3(ok && tmp.isString(), false, *ret = ZERO);
     ret->tempFileNameSuffix = tmp.toString();
 
+    // segmented download is optional
+    ret->segmentThresholdInBytes = obj->getProperty("segmentThresholdInBytes", &tmp) && tmp.isNumber() ? tmp.toUint32() : 0;
+    ret->countOfMaxSegmentsPerTask = obj->getProperty("countOfMaxSegmentsPerTask", &tmp) && tmp.isNumber() ? tmp.toUint32() : 0;
+    ret->adaptiveConcurrency = obj->getProperty("adaptiveConcurrency", &tmp) && tmp.isBoolean() ? tmp.toBoolean() : false;
+
     return ok;
 }
 //
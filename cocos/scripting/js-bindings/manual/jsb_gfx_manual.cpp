@@ -202,6 +202,83 @@ static VertexFormat* getVertexFormatFromValue(const se::Value& elementVal)
     return vertexFormat;
 }
 
+static bool js_gfx_DeviceGraphics_setTextureBudget(se::State& s)
+{
+    cocos2d::renderer::DeviceGraphics* cobj = (cocos2d::renderer::DeviceGraphics*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_gfx_DeviceGraphics_setTextureBudget : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    if (argc == 1) {
+        double bytes = 0;
+        bool ok = seval_to_double(args[0], &bytes);
+        SE_PRECONDITION2(ok && bytes >= 0, false, "js_gfx_DeviceGraphics_setTextureBudget : Error processing arguments");
+        cobj->setTextureBudget((size_t)bytes);
+        return true;
+    }
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 1);
+    return false;
+}
+SE_BIND_FUNC(js_gfx_DeviceGraphics_setTextureBudget)
+
+static bool js_gfx_DeviceGraphics_getTextureStats(se::State& s)
+{
+    cocos2d::renderer::DeviceGraphics* cobj = (cocos2d::renderer::DeviceGraphics*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_gfx_DeviceGraphics_getTextureStats : Invalid Native Object");
+    const auto& stats = cobj->getTextureStats();
+    se::HandleObject obj(se::Object::createPlainObject());
+    obj->setProperty("textures", se::Value(stats.textures));
+    obj->setProperty("evictedTextures", se::Value(stats.evictedTextures));
+    obj->setProperty("bytes", se::Value((double)stats.bytes));
+    obj->setProperty("budget", se::Value((double)cobj->getTextureBudget()));
+    obj->setProperty("evictions", se::Value(stats.evictions));
+    obj->setProperty("restores", se::Value(stats.restores));
+    s.rval().setObject(obj);
+    return true;
+}
+SE_BIND_FUNC(js_gfx_DeviceGraphics_getTextureStats)
+
+// Makes the texture evictable, the texture budget calls its onReload() to upload it again,
+// which returns true if the texture is being reloaded.
+static bool js_gfx_Texture2D_setReloadable(se::State& s)
+{
+    cocos2d::renderer::Texture2D* cobj = (cocos2d::renderer::Texture2D*)s.nativeThisObject();
+    SE_PRECONDITION2(cobj, false, "js_gfx_Texture2D_setReloadable : Invalid Native Object");
+    const auto& args = s.args();
+    size_t argc = args.size();
+    if (argc == 1) {
+        if (!args[0].toBoolean())
+        {
+            cobj->setReloadCallback(nullptr);
+            return true;
+        }
+
+        // The texture may outlive its js object, so look the object up on every reload
+        // instead of keeping a pointer that its finalizer would leave dangling.
+        cobj->setReloadCallback([](cocos2d::renderer::Texture2D* texture) -> bool {
+            auto iter = se::NativePtrToObjectMap::find(texture);
+            if (iter == se::NativePtrToObjectMap::end())
+                return false;
+
+            se::Object* thisObj = iter->second;
+            se::ScriptEngine::getInstance()->clearException();
+            se::AutoHandleScope hs;
+
+            se::Value funcVal;
+            if (!thisObj->getProperty("onReload", &funcVal) || !funcVal.isObject() || !funcVal.toObject()->isFunction())
+                return false;
+
+            // only an explicit true means the texture is being reloaded
+            se::Value rval;
+            bool ok = funcVal.toObject()->call(se::EmptyValueArray, thisObj, &rval);
+            return ok && rval.isBoolean() && rval.toBoolean();
+        });
+        return true;
+    }
+    SE_REPORT_ERROR("wrong number of arguments: %d, was expecting %d", (int)argc, 1);
+    return false;
+}
+SE_BIND_FUNC(js_gfx_Texture2D_setReloadable)
+
 static bool js_gfx_VertexBuffer_init(se::State& s)
 {
     cocos2d::renderer::VertexBuffer* cobj = (cocos2d::renderer::VertexBuffer*)s.nativeThisObject();
@@ -859,6 +936,10 @@ bool jsb_register_gfx_manual(se::Object* global)
     
     __jsb_cocos2d_renderer_DeviceGraphics_proto->defineFunction("clear", _SE(js_gfx_DeviceGraphics_clear));
     __jsb_cocos2d_renderer_DeviceGraphics_proto->defineFunction("setUniform", _SE(js_gfx_DeviceGraphics_setUniform));
+    __jsb_cocos2d_renderer_DeviceGraphics_proto->defineFunction("setTextureBudget", _SE(js_gfx_DeviceGraphics_setTextureBudget));
+    __jsb_cocos2d_renderer_DeviceGraphics_proto->defineFunction("getTextureStats", _SE(js_gfx_DeviceGraphics_getTextureStats));
+
+    __jsb_cocos2d_renderer_Texture2D_proto->defineFunction("setReloadable", _SE(js_gfx_Texture2D_setReloadable));
 
     __jsb_cocos2d_renderer_VertexBuffer_proto->defineFunction("init", _SE(js_gfx_VertexBuffer_init));
     __jsb_cocos2d_renderer_VertexBuffer_proto->defineFunction("update", _SE(js_gfx_VertexBuffer_update));
@@ -38,6 +38,7 @@
 #endif
 
 #include <regex>
+#include <thread>
 
 using namespace cocos2d;
 
@@ -46,6 +47,10 @@ se::Object* __glObj = nullptr;
 
 static std::shared_ptr<ThreadPool> g_threadPool;
 
+// image decoding threads grow with queued images up to cores - 1 (2 to 8) and shrink when idle
+#define IMAGE_DECODE_THREAD_MIN_NUM 1
+#define IMAGE_DECODE_THREAD_MAX_NUM 8
+
 static std::shared_ptr<cocos2d::network::Downloader> g_localDownloader = nullptr;
 static std::map<std::string, std::function<void(const std::string&, unsigned char*, int ,const std::string&)>> g_localDownloaderHandlers;
 static uint64_t g_localDownloaderTaskId = 1000000;
@@ -131,14 +136,16 @@ void jsb_init_file_operation_delegate()
         delegate.onGetDataFromFile = [](const std::string& path, const std::function<void(const uint8_t*, size_t)>& readCallback) -> void{
             assert(!path.empty());
 
-            Data fileData;
-
             std::string byteCodePath = removeFileExt(path) + BYTE_CODE_FILE_EXT;
             if (FileUtils::getInstance()->isFileExist(byteCodePath)) {
-                fileData = FileUtils::getInstance()->getDataFromFile(byteCodePath);
+                auto fileData = FileUtils::getInstance()->getMappedFile(byteCodePath);
+                if (!fileData) {
+                    SE_REPORT_ERROR("Can't read code for %s", byteCodePath.c_str());
+                    return;
+                }
 
                 size_t dataLen = 0;
-                uint8_t* data = xxtea_decrypt((unsigned char*)fileData.getBytes(), (uint32_t)fileData.getSize(), (unsigned char*)xxteaKey.c_str(), (uint32_t)xxteaKey.size(), (uint32_t*)&dataLen);
+                uint8_t* data = xxtea_decrypt((unsigned char*)fileData->getBytes(), (uint32_t)fileData->getSize(), (unsigned char*)xxteaKey.c_str(), (uint32_t)xxteaKey.size(), (uint32_t*)&dataLen);
 
                 if (data == nullptr) {
                     SE_REPORT_ERROR("Can't decrypt code for %s", byteCodePath.c_str());
@@ -166,8 +173,14 @@ void jsb_init_file_operation_delegate()
                 return;
             }
 
-            fileData = FileUtils::getInstance()->getDataFromFile(path);
-            readCallback(fileData.getBytes(), fileData.getSize());
+            // Script bundles are passed to the script engine without being copied into memory first.
+            auto fileData = FileUtils::getInstance()->getMappedFile(path);
+            if (fileData) {
+                readCallback(fileData->getBytes(), fileData->getSize());
+            }
+            else {
+                readCallback(nullptr, 0);
+            }
         };
 
         delegate.onGetStringFromFile = [](const std::string& path) -> std::string{
@@ -175,10 +188,14 @@ void jsb_init_file_operation_delegate()
 
             std::string byteCodePath = removeFileExt(path) + BYTE_CODE_FILE_EXT;
             if (FileUtils::getInstance()->isFileExist(byteCodePath)) {
-                Data fileData = FileUtils::getInstance()->getDataFromFile(byteCodePath);
+                auto fileData = FileUtils::getInstance()->getMappedFile(byteCodePath);
+                if (!fileData) {
+                    SE_REPORT_ERROR("Can't read code for %s", byteCodePath.c_str());
+                    return "";
+                }
 
                 uint32_t dataLen;
-                uint8_t* data = xxtea_decrypt((uint8_t*)fileData.getBytes(), (uint32_t)fileData.getSize(), (uint8_t*)xxteaKey.c_str(), (uint32_t)xxteaKey.size(), &dataLen);
+                uint8_t* data = xxtea_decrypt((uint8_t*)fileData->getBytes(), (uint32_t)fileData->getSize(), (uint8_t*)xxteaKey.c_str(), (uint32_t)xxteaKey.size(), &dataLen);
 
                 if (data == nullptr) {
                     SE_REPORT_ERROR("Can't decrypt code for %s", byteCodePath.c_str());
@@ -837,15 +854,15 @@ bool jsb_global_load_image(const std::string& path, const se::Value& callbackVal
         if (!pool)
             return;
         pool->pushTask([=](int tid) mutable {
-            // NOTE: FileUtils::getInstance()->fullPathForFilename isn't a threadsafe method,
-            // Image::initWithImageFile will call fullPathForFilename internally which may
-            // cause thread race issues. Therefore, we get the full path of file before
-            // going into task callback.
-            // Be careful of invoking any Cocos2d-x interface in a sub-thread.
+            // NOTE: FileUtils::getInstance()->fullPathForFilename is threadsafe now, but the full path
+            // of file is still got before going into task callback, so it's resolved only once.
+            // Be careful of invoking any other Cocos2d-x interface in a sub-thread.
             bool loadSucceed = false;
             std::shared_ptr<Image> img(new Image(), [](Image *image) {
                 image->release();
             });
+            // web api returns RGBA8888, decode into it instead of converting afterwards
+            img->setExpandToRGBA8888(true);
 
             if (!errorMsg.empty()) {
                 loadSucceed = false;
@@ -1256,7 +1273,9 @@ SE_BIND_FUNC(JSB_hideInputBox)
 
 bool jsb_register_global_variables(se::Object* global)
 {
-    g_threadPool.reset(ThreadPool::newFixedThreadPool(3));
+    int decodeThreads = (int)std::thread::hardware_concurrency() - 1;
+    decodeThreads = std::max(2, std::min(decodeThreads, IMAGE_DECODE_THREAD_MAX_NUM));
+    g_threadPool.reset(ThreadPool::newCachedThreadPool(IMAGE_DECODE_THREAD_MIN_NUM, decodeThreads, 5, 1, 1));
 
     global->defineFunction("require", _SE(require));
     global->defineFunction("requireModule", _SE(moduleRequire));
@@ -44,6 +44,7 @@
 
 #include "middleware-adapter.h"
 #include "spine-creator-support/SkeletonDataMgr.h"
+#include "spine-creator-support/SkeletonDataCache.h"
 #include "spine-creator-support/SkeletonRenderer.h"
 #include "spine-creator-support/spine-cocos2dx.h"
 
@@ -100,50 +101,84 @@ static bool js_register_spine_initSkeletonData (se::State& s)
     ok = seval_to_float(args[4], &scale);
     SE_PRECONDITION2(ok, false, "js_register_spine_initSkeletonData: Invalid scale!");
     
-    // create atlas from preloaded texture
-    
-    _preloadedAtlasTextures = &textures;
-    spine::spAtlasPage_setCustomTextureLoader(_getPreloadedAtlasTexture);
-
-    spine::Atlas* atlas = new (__FILE__, __LINE__) spine::Atlas(atlasText.c_str(), (int)atlasText.size(), "", &textureLoader);
-    
-    _preloadedAtlasTextures = nullptr;
-    spine::spAtlasPage_setCustomTextureLoader(nullptr);
-    
-    spine::AttachmentLoader* attachmentLoader = new (__FILE__, __LINE__) spine::Cocos2dAtlasAttachmentLoader(atlas);
+    // the atlas and skeleton data are loaded into an arena of their own, it's released with them
+    spine::SpineArena* arena = new spine::SpineArena();
+    spine::Atlas* atlas = nullptr;
+    spine::AttachmentLoader* attachmentLoader = nullptr;
     spine::SkeletonData* skeletonData = nullptr;
+    // the cache the data was read from, or the hash of the source to write one with
+    std::shared_ptr<const cocos2d::MappedFile> cacheFile;
+    uint64_t sourceHash = 0;
+    {
+        spine::SpineArenaScope arenaScope(arena);
+        
+        // create atlas from preloaded texture
+        
+        _preloadedAtlasTextures = &textures;
+        spine::spAtlasPage_setCustomTextureLoader(_getPreloadedAtlasTexture);
 
-    std::size_t length = skeletonDataFile.length();
-    auto binPos = skeletonDataFile.find(".skel", length - 5);
-    if (binPos == std::string::npos) binPos = skeletonDataFile.find(".bin", length - 4);
+        atlas = new (__FILE__, __LINE__) spine::Atlas(atlasText.c_str(), (int)atlasText.size(), "", &textureLoader);
+        
+        _preloadedAtlasTextures = nullptr;
+        spine::spAtlasPage_setCustomTextureLoader(nullptr);
+        
+        attachmentLoader = new (__FILE__, __LINE__) spine::Cocos2dAtlasAttachmentLoader(atlas);
 
-    if (binPos != std::string::npos) {
-        auto fileUtils = cocos2d::FileUtils::getInstance();
-        if (fileUtils->isFileExist(skeletonDataFile))
-        {
-            cocos2d::Data cocos2dData;
-            const auto fullpath = fileUtils->fullPathForFilename(skeletonDataFile);
-            fileUtils->getContents(fullpath, &cocos2dData);
-            
+        std::size_t length = skeletonDataFile.length();
+        auto binPos = skeletonDataFile.find(".skel", length - 5);
+        if (binPos == std::string::npos) binPos = skeletonDataFile.find(".bin", length - 4);
+
+        std::shared_ptr<const cocos2d::MappedFile> binaryFile;
+        if (binPos != std::string::npos) {
+            auto fileUtils = cocos2d::FileUtils::getInstance();
+            if (fileUtils->isFileExist(skeletonDataFile)) {
+                binaryFile = fileUtils->getMappedFile(fileUtils->fullPathForFilename(skeletonDataFile));
+            }
+        }
+
+#if CC_ENABLE_SPINE_DATA_CACHE
+        if (binaryFile) {
+            sourceHash = spine::SkeletonDataCache::hashSource(binaryFile->getBytes(), (size_t)binaryFile->getSize(), scale);
+        } else if (binPos == std::string::npos) {
+            sourceHash = spine::SkeletonDataCache::hashSource((const unsigned char*)skeletonDataFile.data(), skeletonDataFile.size(), scale);
+        }
+        if (sourceHash != 0) {
+            spine::SkeletonDataCache cache(attachmentLoader);
+            skeletonData = cache.readSkeletonDataFile(uuid, sourceHash, cacheFile);
+        }
+#endif
+
+        if (skeletonData) {
+            // read from the cache
+        } else if (binaryFile) {
             spine::SkeletonBinary binary(attachmentLoader);
             binary.setScale(scale);
-            skeletonData = binary.readSkeletonData(cocos2dData.getBytes(), (int)cocos2dData.getSize());
+            skeletonData = binary.readSkeletonData(binaryFile->getBytes(), (int)binaryFile->getSize());
             CCASSERT(skeletonData, !binary.getError().isEmpty() ? binary.getError().buffer() : "Error reading binary skeleton data.");
+        } else if (binPos == std::string::npos) {
+            spine::SkeletonJson json(attachmentLoader);
+            json.setScale(scale);
+            skeletonData = json.readSkeletonData(skeletonDataFile.c_str());
+            CCASSERT(skeletonData, !json.getError().isEmpty() ? json.getError().buffer() : "Error reading json skeleton data.");
         }
-    } else {
-        spine::SkeletonJson json(attachmentLoader);
-        json.setScale(scale);
-        skeletonData = json.readSkeletonData(skeletonDataFile.c_str());
-        CCASSERT(skeletonData, !json.getError().isEmpty() ? json.getError().buffer() : "Error reading json skeleton data.");
     }
     
     if (skeletonData) {
+#if CC_ENABLE_SPINE_DATA_CACHE
+        // written outside of the arena, nothing it allocates is kept
+        if (!cacheFile && sourceHash != 0) {
+            spine::SkeletonDataCache cache(attachmentLoader);
+            if (!cache.writeSkeletonDataFile(uuid, sourceHash, skeletonData)) {
+                CCLOG("Spine skeleton data cache of %s isn't written: %s", uuid.c_str(), cache.getError().c_str());
+            }
+        }
+#endif
         std::vector<int> texturesIndex;
         for (auto it = textures.begin(); it != textures.end(); it++)
         {
             texturesIndex.push_back(it->second->getRealTextureIndex());
         }
-        mgr->setSkeletonData(uuid, skeletonData, atlas, attachmentLoader, texturesIndex);
+        mgr->setSkeletonData(uuid, skeletonData, atlas, attachmentLoader, texturesIndex, arena, cacheFile);
         native_ptr_to_rooted_seval<spine::SkeletonData>(skeletonData, &s.rval());
     } else {
         if (atlas) {
@@ -154,6 +189,7 @@ static bool js_register_spine_initSkeletonData (se::State& s)
             delete attachmentLoader;
             attachmentLoader = nullptr;
         }
+        delete arena;
     }
     return true;
 }
@@ -233,6 +269,25 @@ static bool js_register_spine_retainSkeletonData(se::State& s)
 }
 SE_BIND_FUNC(js_register_spine_retainSkeletonData)
 
+// frameAllocCount is the allocation count since last call, poll it once per frame.
+static bool js_register_spine_getAllocatorStats(se::State& s)
+{
+    auto extension = dynamic_cast<spine::Cocos2dExtension*>(spine::SpineExtension::getInstance());
+    spine::SpineAllocatorStats stats = extension ? extension->getAllocatorStats() : spine::SpineAllocatorStats();
+    
+    se::HandleObject obj(se::Object::createPlainObject());
+    obj->setProperty("liveBytes", se::Value((double)stats.liveBytes));
+    obj->setProperty("liveCount", se::Value((double)stats.liveCount));
+    obj->setProperty("allocCount", se::Value((double)stats.allocCount));
+    obj->setProperty("pooledAllocCount", se::Value((double)stats.pooledAllocCount));
+    obj->setProperty("frameAllocCount", se::Value((double)stats.frameAllocCount));
+    obj->setProperty("arenaBytes", se::Value((double)stats.arenaBytes));
+    
+    s.rval().setObject(obj);
+    return true;
+}
+SE_BIND_FUNC(js_register_spine_getAllocatorStats)
+
 bool register_all_spine_manual(se::Object* obj)
 {
     // Get the ns
@@ -249,6 +304,7 @@ bool register_all_spine_manual(se::Object* obj)
     ns->defineFunction("initSkeletonData", _SE(js_register_spine_initSkeletonData));
     ns->defineFunction("retainSkeletonData", _SE(js_register_spine_retainSkeletonData));
     ns->defineFunction("disposeSkeletonData", _SE(js_register_spine_disposeSkeletonData));
+    ns->defineFunction("getAllocatorStats", _SE(js_register_spine_getAllocatorStats));
     
     spine::setSpineObjectDisposeCallback([](void* spineObj){
         se::Object* seObj = nullptr;
@@ -135,7 +135,18 @@ void JSB_WebSocketDelegate::onMessage(WebSocket* ws, const WebSocket::Data& data
 
         if (data.isBinary)
         {
-            se::HandleObject dataObj(se::Object::createArrayBufferObject(data.bytes, data.len));
+            se::Object* arrayBuffer = nullptr;
+            if (data.isBytesTransferable)
+            {
+                // Take over the received buffer instead of copying it.
+                arrayBuffer = se::Object::createArrayBufferObjectNoCopy(data.bytes, data.len);
+                data.isBytesTransferable = false;
+            }
+            else
+            {
+                arrayBuffer = se::Object::createArrayBufferObject(data.bytes, data.len);
+            }
+            se::HandleObject dataObj(arrayBuffer);
             jsObj->setProperty("data", se::Value(dataObj));
         }
         else
@@ -27,14 +27,14 @@
 #include "base/ccUTF8.h"
 #include "CCAsyncTaskPool.h"
 
+#include "base/ZipUtils.h"
+
 #include <stdio.h>
 #include <errno.h>
-
-#ifdef MINIZIP_FROM_SYSTEM
-#include <minizip/unzip.h>
-#else // from our embedded sources
-#include "unzip/unzip.h"
-#endif
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
 
 NS_CC_EXT_BEGIN
 
@@ -43,13 +43,98 @@ NS_CC_EXT_BEGIN
 #define TEMP_PACKAGE_SUFFIX     "_temp"
 #define MANIFEST_FILENAME       "project.manifest"
 
-#define BUFFER_SIZE    8192
-#define MAX_FILENAME   512
+#define BUFFER_SIZE    (256 * 1024)
+#define MAX_DECOMPRESS_THREADS 4
 
 #define DEFAULT_CONNECTION_TIMEOUT 45
 
+// big assets are downloaded by several range requests
+#define SEGMENT_THRESHOLD (8 * 1024 * 1024)
+#define MAX_SEGMENTS_PER_ASSET 4
+
 #define SAVE_POINT_INTERVAL 0.1
 
+#define SPEED_SAMPLE_INTERVAL 0.5
+
+namespace
+{
+    // Writes a decompressed file through a large buffer, every write but the last one is
+    // a multiple of BUFFER_SIZE at an aligned offset, and big chunks skip the copy.
+    class BufferedFileWriter
+    {
+    public:
+        explicit BufferedFileWriter(unsigned char* buffer)
+        : _buffer(buffer)
+        , _used(0)
+        , _file(nullptr)
+        {
+        }
+
+        ~BufferedFileWriter()
+        {
+            close();
+        }
+
+        bool open(const std::string& path)
+        {
+            _file = fopen(path.c_str(), "wb");
+            if (_file)
+            {
+                // The writes are already buffered.
+                setvbuf(_file, nullptr, _IONBF, 0);
+            }
+            return _file != nullptr;
+        }
+
+        bool write(const unsigned char* data, size_t size)
+        {
+            while (size > 0)
+            {
+                if (_used == 0 && size >= BUFFER_SIZE)
+                {
+                    size_t direct = size - size % BUFFER_SIZE;
+                    if (fwrite(data, 1, direct, _file) != direct)
+                        return false;
+                    data += direct;
+                    size -= direct;
+                    continue;
+                }
+
+                size_t copied = std::min(size, (size_t)BUFFER_SIZE - _used);
+                memcpy(_buffer + _used, data, copied);
+                _used += copied;
+                data += copied;
+                size -= copied;
+                if (_used == BUFFER_SIZE && !flush())
+                    return false;
+            }
+            return true;
+        }
+
+        bool close()
+        {
+            if (!_file)
+                return true;
+            bool succeed = flush();
+            succeed = fclose(_file) == 0 && succeed;
+            _file = nullptr;
+            return succeed;
+        }
+
+    private:
+        bool flush()
+        {
+            size_t used = _used;
+            _used = 0;
+            return used == 0 || fwrite(_buffer, 1, used, _file) == used;
+        }
+
+        unsigned char* _buffer;
+        size_t _used;
+        FILE* _file;
+    };
+}
+
 const std::string AssetsManagerEx::VERSION_ID = "@version";
 const std::string AssetsManagerEx::MANIFEST_ID = "@manifest";
 
@@ -71,6 +156,8 @@ AssetsManagerEx::AssetsManagerEx(const std::string& manifestUrl, const std::stri
 , _totalSize(0)
 , _sizeCollected(0)
 , _totalDownloaded(0)
+, _bytesPerSecond(0)
+, _speedSampleBytes(0)
 , _totalToDownload(0)
 , _totalWaitToDownload(0)
 , _nextSavePoint(0.0)
@@ -100,6 +187,8 @@ AssetsManagerEx::AssetsManagerEx(const std::string& manifestUrl, const std::stri
 , _totalSize(0)
 , _sizeCollected(0)
 , _totalDownloaded(0)
+, _bytesPerSecond(0)
+, _speedSampleBytes(0)
 , _totalToDownload(0)
 , _totalWaitToDownload(0)
 , _nextSavePoint(0.0)
@@ -125,7 +214,10 @@ void AssetsManagerEx::init(const std::string& manifestUrl, const std::string& st
     {
         static_cast<uint32_t>(_maxConcurrentTask),
         DEFAULT_CONNECTION_TIMEOUT,
-        ".tmp"
+        ".tmp",
+        SEGMENT_THRESHOLD,
+        MAX_SEGMENTS_PER_ASSET,
+        true
     };
     _downloader = std::shared_ptr<network::Downloader>(new network::Downloader(hints));
     _downloader->onTaskError = std::bind(&AssetsManagerEx::onError, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4);
@@ -497,130 +589,105 @@ bool AssetsManagerEx::decompress(const std::string &zip)
     }
     const std::string rootPath = zip.substr(0, pos+1);
 
-    // Open the zip file
-    unzFile zipfile = unzOpen(FileUtils::getInstance()->getSuitableFOpen(zip).c_str());
-    if (! zipfile)
+    // Open the zip file, its central directory is indexed so that entries can be read in parallel
+    ZipFile zipFile(zip);
+    std::vector<std::string> entries = zipFile.listFiles();
+    if (entries.empty())
     {
         CCLOG("AssetsManagerEx : can not open downloaded zip file %s\n", zip.c_str());
         return false;
     }
 
-    // Get info about the zip file
-    unz_global_info global_info;
-    if (unzGetGlobalInfo(zipfile, &global_info) != UNZ_OK)
+    // There are not directory entry in some case,
+    // so create the directories of all entries in advance, then entries are independent.
+    std::set<std::string> directories;
+    std::vector<std::string> files;
+    for (const auto& entry : entries)
     {
-        CCLOG("AssetsManagerEx : can not read file global info of %s\n", zip.c_str());
-        unzClose(zipfile);
-        return false;
+        directories.insert(basename(rootPath + entry));
+        if (entry[entry.size() - 1] != '/')
+        {
+            files.push_back(entry);
+        }
     }
-
-    // Buffer to hold data read from the zip file
-    char readBuffer[BUFFER_SIZE];
-    // Loop to extract all files.
-    uLong i;
-    for (i = 0; i < global_info.number_entry; ++i)
-    {
-        // Get info about current file.
-        unz_file_info fileInfo;
-        char fileName[MAX_FILENAME];
-        if (unzGetCurrentFileInfo(zipfile,
-                                  &fileInfo,
-                                  fileName,
-                                  MAX_FILENAME,
-                                  NULL,
-                                  0,
-                                  NULL,
-                                  0) != UNZ_OK)
+    for (const auto& dir : directories)
+    {
+        if (!_fileUtils->isDirectoryExist(dir) && !_fileUtils->createDirectory(dir))
         {
-            CCLOG("AssetsManagerEx : can not read compressed file info\n");
-            unzClose(zipfile);
+            // Failed to create directory
+            CCLOG("AssetsManagerEx : can not create directory %s\n", dir.c_str());
             return false;
         }
-        const std::string fullPath = rootPath + fileName;
+    }
+
+    // Biggest files first, so that a big file at the end doesn't leave the other workers idle
+    std::sort(files.begin(), files.end(), [&zipFile](const std::string& a, const std::string& b) {
+        return zipFile.getFileSize(a) > zipFile.getFileSize(b);
+    });
 
-        // Check if this entry is a directory or a file.
-        const size_t filenameLength = strlen(fileName);
-        if (fileName[filenameLength-1] == '/')
+    auto startTime = std::chrono::steady_clock::now();
+    std::atomic<size_t> nextFile(0);
+    std::atomic<bool> failed(false);
+    std::atomic<uint64_t> extractedBytes(0);
+    auto extract = [&]() {
+        std::unique_ptr<unsigned char[]> buffer(new (std::nothrow) unsigned char[BUFFER_SIZE]);
+        if (!buffer)
         {
-            //There are not directory entry in some case.
-            //So we need to create directory when decompressing file entry
-            if ( !_fileUtils->createDirectory(basename(fullPath)) )
-            {
-                // Failed to create directory
-                CCLOG("AssetsManagerEx : can not create directory %s\n", fullPath.c_str());
-                unzClose(zipfile);
-                return false;
-            }
+            failed = true;
+            return;
         }
-        else
+        for (size_t i = nextFile++; i < files.size() && !failed; i = nextFile++)
         {
-            // Create all directories in advance to avoid issue
-            std::string dir = basename(fullPath);
-            if (!_fileUtils->isDirectoryExist(dir)) {
-                if (!_fileUtils->createDirectory(dir)) {
-                    // Failed to create directory
-                    CCLOG("AssetsManagerEx : can not create directory %s\n", fullPath.c_str());
-                    unzClose(zipfile);
-                    return false;
-                }
-            }
-            // Entry is a file, so extract it.
-            // Open current file.
-            if (unzOpenCurrentFile(zipfile) != UNZ_OK)
-            {
-                CCLOG("AssetsManagerEx : can not extract file %s\n", fileName);
-                unzClose(zipfile);
-                return false;
-            }
+            const std::string& fileName = files[i];
+            const std::string fullPath = rootPath + fileName;
 
             // Create a file to store current file.
-            FILE *out = fopen(FileUtils::getInstance()->getSuitableFOpen(fullPath).c_str(), "wb");
-            if (!out)
+            BufferedFileWriter writer(buffer.get());
+            if (!writer.open(_fileUtils->getSuitableFOpen(fullPath)))
             {
                 CCLOG("AssetsManagerEx : can not create decompress destination file %s (errno: %d)\n", fullPath.c_str(), errno);
-                unzCloseCurrentFile(zipfile);
-                unzClose(zipfile);
-                return false;
+                failed = true;
+                break;
             }
 
             // Write current file content to destinate file.
-            int error = UNZ_OK;
-            do
+            bool succeed = zipFile.readFile(fileName, [&writer, &failed](const unsigned char* chunk, size_t size) {
+                return !failed && writer.write(chunk, size);
+            });
+            if (!writer.close() || !succeed)
             {
-                error = unzReadCurrentFile(zipfile, readBuffer, BUFFER_SIZE);
-                if (error < 0)
-                {
-                    CCLOG("AssetsManagerEx : can not read zip file %s, error code is %d\n", fileName, error);
-                    fclose(out);
-                    unzCloseCurrentFile(zipfile);
-                    unzClose(zipfile);
-                    return false;
-                }
-
-                if (error > 0)
-                {
-                    fwrite(readBuffer, error, 1, out);
-                }
-            } while(error > 0);
-
-            fclose(out);
+                CCLOG("AssetsManagerEx : can not extract file %s\n", fileName.c_str());
+                failed = true;
+                break;
+            }
+            extractedBytes += zipFile.getFileSize(fileName);
         }
+    };
 
-        unzCloseCurrentFile(zipfile);
+    // The calling thread is one of the workers
+    unsigned int threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), (unsigned int)MAX_DECOMPRESS_THREADS);
+    threadCount = std::min(threadCount, (unsigned int)std::max(files.size(), (size_t)1));
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threadCount; ++i)
+    {
+        workers.emplace_back(extract);
+    }
+    extract();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
 
-        // Goto next entry listed in the zip file.
-        if ((i+1) < global_info.number_entry)
-        {
-            if (unzGoToNextFile(zipfile) != UNZ_OK)
-            {
-                CCLOG("AssetsManagerEx : can not read next file for decompressing\n");
-                unzClose(zipfile);
-                return false;
-            }
-        }
+    // Files are written by fopen, the ones looked up before may have been cached as missing.
+    _fileUtils->purgeCachedMissingEntries();
+    if (failed)
+    {
+        return false;
     }
 
-    unzClose(zipfile);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    CCLOG("AssetsManagerEx : decompressed %d files of %s with %u threads, %.0f bytes per second\n",
+          (int)files.size(), zip.c_str(), threadCount, elapsed > 0 ? (double)extractedBytes / elapsed : 0.0);
     return true;
 }
 
@@ -827,6 +894,8 @@ void AssetsManagerEx::prepareUpdate()
     _totalWaitToDownload = _totalToDownload = 0;
     _nextSavePoint = 0;
     _percent = _percentByFile = _sizeCollected = _totalDownloaded = _totalSize = 0;
+    _bytesPerSecond = _speedSampleBytes = 0;
+    _speedSampleTime = std::chrono::steady_clock::time_point();
     _downloadResumed = false;
     _downloadedSize.clear();
     _totalEnabled = false;
@@ -1140,6 +1209,8 @@ void AssetsManagerEx::updateAssets(const DownloadUnits& assets)
         _downloadUnits.clear();
         _downloadedSize.clear();
         _percent = _percentByFile = _sizeCollected = _totalDownloaded = _totalSize = 0;
+        _bytesPerSecond = _speedSampleBytes = 0;
+        _speedSampleTime = std::chrono::steady_clock::time_point();
         _totalWaitToDownload = _totalToDownload = (int)assets.size();
         _nextSavePoint = 0;
         _totalEnabled = false;
@@ -1263,6 +1334,24 @@ void AssetsManagerEx::onProgress(double total, double downloaded, const std::str
             }
             _totalDownloaded += it->second;
         }
+
+        // Sample the download speed, progression of a single file is not steady enough
+        auto now = std::chrono::steady_clock::now();
+        if (_speedSampleTime == std::chrono::steady_clock::time_point())
+        {
+            _speedSampleTime = now;
+            _speedSampleBytes = _totalDownloaded;
+        }
+        else
+        {
+            double elapsed = std::chrono::duration<double>(now - _speedSampleTime).count();
+            if (elapsed >= SPEED_SAMPLE_INTERVAL)
+            {
+                _bytesPerSecond = std::max(0.0, (_totalDownloaded - _speedSampleBytes) / elapsed);
+                _speedSampleTime = now;
+                _speedSampleBytes = _totalDownloaded;
+            }
+        }
         // Collect information if not registed
         if (!found)
         {
@@ -28,6 +28,7 @@
 #define __AssetsManagerEx__
 
 #include <string>
+#include <chrono>
 #include <unordered_map>
 #include <vector>
 
@@ -162,6 +163,10 @@ public:
      */
     double getDownloadedBytes() const {return _totalDownloaded;};
     
+    /** @brief Gets the current download speed of the update in bytes per second, sampled while downloading, it will return 0 before the first sample.
+     */
+    double getBytesPerSecond() const {return _bytesPerSecond;};
+    
     /** @brief Gets the total files count to be downloaded of the update, this will only be available after READY_TO_UPDATE state, under unknown states it will return 0 by default.
      */
     int getTotalFiles() const {return _totalToDownload;};
@@ -381,6 +386,13 @@ private:
     //! Total downloaded file size (sum of all downloaded files)
     double _totalDownloaded;
     
+    //! Download speed in bytes per second
+    double _bytesPerSecond;
+    
+    //! Time and total downloaded size of the last download speed sample
+    std::chrono::steady_clock::time_point _speedSampleTime;
+    double _speedSampleBytes;
+    
     //! Downloaded size for each file
     std::unordered_map<std::string, double> _downloadedSize;
     
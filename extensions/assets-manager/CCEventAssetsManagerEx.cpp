@@ -65,6 +65,11 @@ double EventAssetsManagerEx::getTotalBytes() const
     return _manager->getTotalBytes();
 }
 
+double EventAssetsManagerEx::getBytesPerSecond() const
+{
+    return _manager->getBytesPerSecond();
+}
+
 int EventAssetsManagerEx::getDownloadedFiles() const
 {
     return _manager->getDownloadedFiles();
@@ -76,6 +76,8 @@ public:
     
     double getTotalBytes() const;
     
+    double getBytesPerSecond() const;
+    
     int getDownloadedFiles() const;
     
     int getTotalFiles() const;